@@ -9,6 +9,7 @@
 
 #include "UrlHelper.h"
 #include "base64.h"
+#include <cgv/utils/file.h>
 
 
 #if defined(_MSC_VER) && _MSC_VER >= 1400
@@ -95,6 +96,11 @@ unsigned webserver::Request(void* _ws) {
 
 	request_func_(&req);
 
+	if (!req.file_path.empty() && !cgv::utils::file::read(req.file_path, req.answer, false)) {
+		req.status = "404 Not Found";
+		req.answer.clear();
+	}
+
 	std::stringstream str_str;
 	str_str << req.answer.size();
 
@@ -121,7 +127,7 @@ unsigned webserver::Request(void* _ws) {
 	sp->send_line(std::string("Date: ") + asctime_remove_nl + " GMT");
 	sp->send_line(std::string("Server: ") +serverName);
 	sp->send_line("Connection: close");
-	sp->send_line("Content-Type: text/html; charset=ISO-8859-1");
+	sp->send_line("Content-Type: " + (req.content_type.empty() ? std::string("text/html; charset=ISO-8859-1") : req.content_type));
 	sp->send_line("Content-Length: " + str_str.str());
 	sp->send_line("");
 	sp->send_line(req.answer);
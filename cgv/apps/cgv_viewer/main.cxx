@@ -40,10 +40,34 @@ int main(int argc, char** argv)
 	std::vector<command_info> unprocessed;
 	std::vector<int> unknown;
 	bool loaded_config = false;
+	// consecutive plugin commands are collected and loaded together
+	std::vector<std::string> plugin_names;
+	auto load_collected_plugins = [&plugin_names]() {
+		if (plugin_names.empty())
+			return;
+		std::vector<void*> handles = load_plugins(plugin_names);
+		for (size_t i = 0; i < plugin_names.size(); ++i) {
+			if (handles[i])
+				std::cout << "read plugin " << plugin_names[i] << std::endl;
+			else
+				std::cerr << "error reading plugin " << plugin_names[i] << std::endl;
+		}
+		plugin_names.clear();
+	};
 	unsigned ai;
 	for (ai = 1; (int)ai < argc; ++ai) {
 		command_info info;
 		cgv::base::analyze_command(cgv::utils::token(argv[ai], argv[ai] + std::string((const char*)argv[ai]).length()), true, &info);
+		if (info.command_type == CT_PLUGIN) {
+			plugin_names.push_back(to_string(info.parameters[0]));
+			continue;
+		}
+		// lazy construction has to be defined before the collected plugins are loaded
+		if (info.command_type == CT_LAZY) {
+			process_command(info);
+			continue;
+		}
+		load_collected_plugins();
 		switch (info.command_type) {
 		case CT_UNKNOWN:
 			unknown.push_back(ai);
@@ -62,6 +86,7 @@ int main(int argc, char** argv)
 			break;
 		}
 	}
+	load_collected_plugins();
 
 	if (!loaded_config) {
 		std::string base_cfg_file_name = "base.cfg";
@@ -1,16 +1,50 @@
 #include <cgv/base/register.h>
+#include <cgv/utils/statistics.h>
+#include <cgv/utils/file.h>
+#include <cgv/utils/scan.h>
+#include <cgv/utils/convert.h>
+#include <nlohmann/json.hpp>
 #include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <map>
 
 using namespace cgv::base;
 
+/// options of the benchmark mode given on the command line
+struct benchmark_options
+{
+	bool enabled = false;
+	std::string filter;
+	unsigned nr_warm_up_repetitions = 1;
+	unsigned nr_repetitions = 10;
+	std::string json_file_name;
+	std::string csv_file_name;
+	std::string baseline_file_name;
+	double tolerance = 0.1;
+};
+
+/// statistics of one benchmark with times in seconds
+struct benchmark_result
+{
+	std::string name;
+	unsigned nr_repetitions = 0;
+	double min = 0, median = 0, p90 = 0, mean = 0, stddev = 0, max = 0;
+	double throughput = 0;
+	std::string unit;
+};
 
 struct test_listener : public base, public registration_listener
 {
 	static std::vector<base_ptr> tests;
+	static std::vector<base_ptr> benchmarks;
 	void register_object(base_ptr object, const std::string& options)
 	{
 		if (object->get_interface<test>())
 			tests.push_back(object);
+		if (object->get_interface<benchmark>())
+			benchmarks.push_back(object);
 	}
 	void unregister_object(base_ptr object, const std::string& options)
 	{
@@ -43,16 +77,194 @@ struct test_listener : public base, public registration_listener
 			std::cout << (tests.size()-succeeded) << " tests of " << tests.size() << " failed" << std::endl;
 		return false;
 	}
+	/// compute statistics from the durations of a benchmark state
+	static benchmark_result compute_result(const std::string& name, benchmark_state& state)
+	{
+		benchmark_result r;
+		r.name = name;
+		r.nr_repetitions = (unsigned)state.durations.size();
+		cgv::utils::statistics stats;
+		for (double d : state.durations)
+			stats.update(d);
+		if (stats.get_count() > 0) {
+			r.min = stats.get_min();
+			r.max = stats.get_max();
+			r.mean = stats.get_average();
+			r.stddev = stats.get_count() > 1 ? stats.get_standard_deviation() : 0.0;
+		}
+		r.median = cgv::utils::compute_percentile(state.durations, 0.5);
+		r.p90 = cgv::utils::compute_percentile(state.durations, 0.9);
+		r.unit = state.work_unit;
+		if (r.median > 0 && state.work_per_repetition > 0)
+			r.throughput = state.work_per_repetition / r.median;
+		return r;
+	}
+	static bool write_json(const std::string& file_name, const std::vector<benchmark_result>& results)
+	{
+		nlohmann::json j;
+		j["benchmarks"] = nlohmann::json::array();
+		for (const auto& r : results)
+			j["benchmarks"].push_back({ {"name", r.name}, {"repetitions", r.nr_repetitions}, {"min", r.min}, {"median", r.median},
+				{"p90", r.p90}, {"mean", r.mean}, {"stddev", r.stddev}, {"max", r.max}, {"throughput", r.throughput}, {"unit", r.unit} });
+		std::ofstream os(file_name.c_str());
+		if (os.fail())
+			return false;
+		os << std::setw(2) << j << std::endl;
+		return !os.fail();
+	}
+	static bool write_csv(const std::string& file_name, const std::vector<benchmark_result>& results)
+	{
+		std::ofstream os(file_name.c_str());
+		if (os.fail())
+			return false;
+		os << "name,repetitions,min,median,p90,mean,stddev,max,throughput,unit\n" << std::setprecision(9);
+		for (const auto& r : results)
+			os << '"' << r.name << "\"," << r.nr_repetitions << "," << r.min << "," << r.median << "," << r.p90 << ","
+			   << r.mean << "," << r.stddev << "," << r.max << "," << r.throughput << "," << r.unit << "\n";
+		return !os.fail();
+	}
+	/// read median times per benchmark name from a json or csv file written in benchmark mode
+	static bool read_baseline(const std::string& file_name, std::map<std::string, double>& medians)
+	{
+		std::string content;
+		if (!cgv::utils::file::read(file_name, content, true))
+			return false;
+		if (cgv::utils::to_lower(cgv::utils::file::get_extension(file_name)) == "csv") {
+			std::stringstream is(content);
+			std::string l;
+			// skip header
+			std::getline(is, l);
+			while (std::getline(is, l)) {
+				if (!l.empty() && l.back() == '\r')
+					l.pop_back();
+				size_t name_end = l.rfind('"');
+				if (l.empty() || l[0] != '"' || name_end == 0 || name_end == std::string::npos)
+					continue;
+				std::vector<std::string> fields;
+				std::stringstream ss(l.substr(name_end + 2));
+				std::string f;
+				while (std::getline(ss, f, ','))
+					fields.push_back(f);
+				double median;
+				if (fields.size() > 2 && cgv::utils::is_double(fields[2], median))
+					medians[l.substr(1, name_end - 1)] = median;
+			}
+			return true;
+		}
+		try {
+			nlohmann::json j = nlohmann::json::parse(content);
+			for (const auto& b : j.at("benchmarks"))
+				medians[b.at("name").get<std::string>()] = b.at("median").get<double>();
+		}
+		catch (const std::exception& e) {
+			std::cerr << "could not parse baseline " << file_name << ": " << e.what() << std::endl;
+			return false;
+		}
+		return true;
+	}
+	/// execute all benchmarks matching the filter, report statistics and return false if a benchmark failed or regressed
+	static bool perform_benchmarks(const benchmark_options& options)
+	{
+		std::map<std::string, double> baseline;
+		if (!options.baseline_file_name.empty() && !read_baseline(options.baseline_file_name, baseline)) {
+			std::cerr << "could not read baseline " << options.baseline_file_name << std::endl;
+			return false;
+		}
+		std::vector<benchmark_result> results;
+		unsigned nr_failed = 0, nr_regressions = 0;
+		for (const auto& bp : benchmarks) {
+			benchmark* b = bp->get_interface<benchmark>();
+			std::string name = b->get_benchmark_name();
+			if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+				continue;
+			std::cout << "benchmark " << name << ":";
+			std::cout.flush();
+			benchmark_state state(options.nr_warm_up_repetitions, options.nr_repetitions);
+			if (!b->exec_benchmark(state) || state.durations.empty()) {
+				std::cout << "failed" << std::endl;
+				++nr_failed;
+				continue;
+			}
+			benchmark_result r = compute_result(name, state);
+			std::cout << " median " << 1000 * r.median << " ms, p90 " << 1000 * r.p90 << " ms, min " << 1000 * r.min
+				<< " ms, stddev " << 1000 * r.stddev << " ms";
+			if (r.throughput > 0)
+				std::cout << ", " << r.throughput << " " << r.unit << "/s";
+			auto bi = baseline.find(name);
+			if (bi != baseline.end() && bi->second > 0) {
+				double ratio = r.median / bi->second;
+				std::cout << ", " << std::showpos << 100 * (ratio - 1) << std::noshowpos << "% to baseline";
+				if (ratio > 1 + options.tolerance) {
+					std::cout << " REGRESSION";
+					++nr_regressions;
+				}
+				else if (ratio < 1 - options.tolerance)
+					std::cout << " improved";
+			}
+			std::cout << std::endl;
+			results.push_back(r);
+		}
+		if (results.empty() && nr_failed == 0)
+			std::cout << "no benchmarks registered" << std::endl;
+		if (!options.json_file_name.empty() && !write_json(options.json_file_name, results)) {
+			std::cerr << "could not write " << options.json_file_name << std::endl;
+			++nr_failed;
+		}
+		if (!options.csv_file_name.empty() && !write_csv(options.csv_file_name, results)) {
+			std::cerr << "could not write " << options.csv_file_name << std::endl;
+			++nr_failed;
+		}
+		if (nr_failed > 0)
+			std::cout << nr_failed << " benchmarks failed" << std::endl;
+		if (nr_regressions > 0)
+			std::cout << nr_regressions << " benchmarks regressed by more than " << 100 * options.tolerance << "%" << std::endl;
+		return nr_failed == 0 && nr_regressions == 0;
+	}
 };
 
 std::vector<base_ptr> test_listener::tests;
+std::vector<base_ptr> test_listener::benchmarks;
+
+/// extract benchmark options from the command line and keep remaining arguments for command processing
+void extract_benchmark_options(int& argc, char** argv, benchmark_options& options)
+{
+	int ci = 1;
+	for (int ai = 1; ai < argc; ++ai) {
+		std::string arg = argv[ai];
+		size_t pos = arg.find('=');
+		std::string key = arg.substr(0, pos), value = pos == std::string::npos ? std::string() : arg.substr(pos + 1);
+		int i;
+		double d;
+		if (key == "benchmark") {
+			options.enabled = true;
+			options.filter = value;
+		}
+		else if (key == "warm_up" && cgv::utils::is_integer(value, i) && i >= 0)
+			options.nr_warm_up_repetitions = i;
+		else if (key == "repetitions" && cgv::utils::is_integer(value, i) && i > 0)
+			options.nr_repetitions = i;
+		else if (key == "json")
+			options.json_file_name = value;
+		else if (key == "csv")
+			options.csv_file_name = value;
+		else if (key == "baseline")
+			options.baseline_file_name = value;
+		else if (key == "tolerance" && cgv::utils::is_double(value, d) && d >= 0)
+			options.tolerance = d;
+		else
+			argv[ci++] = argv[ai];
+	}
+	argc = ci;
+}
 
 int main(int argc, char** argv)
 {
+	benchmark_options options;
+	extract_benchmark_options(argc, argv, options);
 	register_object(new test_listener());
 	enable_registration();
 	process_command_line_args(argc, argv);
-	bool res = test_listener::perform_tests();
+	bool res = options.enabled ? test_listener::perform_benchmarks(options) : test_listener::perform_tests();
 #if _MSC_VER >= 1600
 	std::cin.get();
 #endif
@@ -4,11 +4,13 @@
 #include "group.h"
 #include <cgv/reflect/get_reflection_handler.h>
 #include <cgv/reflect/set_reflection_handler.h>
+#include <cgv/reflect/reflection_cache.h>
 #include <cgv/type/variant.h>
 #include <cgv/utils/tokenizer.h>
 #include <cgv/utils/scan.h>
 #include <iostream>
 #include <stdlib.h>
+#include <typeinfo>
 
 using namespace cgv::type;
 using namespace cgv::reflect;
@@ -163,6 +165,20 @@ bool base::self_reflect(reflection_handler&)
 	return true;
 }
 
+/// return whether set_void, get_void and find_member_ptr can use a per type cache of member offsets
+bool base::use_reflection_cache() const
+{
+	return false;
+}
+
+/// look up a plain property name in the reflection cache of the type of the given instance
+static const reflection_cache::member_info* find_cached_member(base* instance, const std::string& property)
+{
+	if (!instance->use_reflection_cache() || !reflection_cache::is_plain_member_name(property))
+		return 0;
+	return reflection_cache::get(typeid(*instance), *instance).find(property);
+}
+
 
 /// overload to implement the execution of a method based on the method name and the given parameters
 bool base::call_void(const std::string& method, 
@@ -180,6 +196,13 @@ bool base::call_void(const std::string& method,
 /// abstract interface for the setter, by default it simply returns false
 bool base::set_void(const std::string& property, const std::string& value_type, const void* value_ptr)
 {
+	if (const reflection_cache::member_info* mi = find_cached_member(this, property)) {
+		void* member_ptr = mi->get_member_ptr(this);
+		if (!set_reflection_handler::set_member_void(member_ptr, mi->rt, value_type, value_ptr))
+			return false;
+		on_set(member_ptr);
+		return true;
+	}
 	set_reflection_handler ssrh(property, value_type, value_ptr);
 	self_reflect(ssrh);
 	if (ssrh.found_valid_target()) {
@@ -214,6 +237,8 @@ void base::on_set(void* member_ptr)
 /// abstract interface for the getter, by default it simply returns false
 bool base::get_void(const std::string& property, const std::string& value_type, void* value_ptr)
 {
+	if (const reflection_cache::member_info* mi = find_cached_member(this, property))
+		return get_reflection_handler::get_member_void(mi->get_member_ptr(this), mi->rt, value_type, value_ptr);
 	get_reflection_handler gsrh(property, value_type, value_ptr);
 	self_reflect(gsrh);
 	if (gsrh.found_valid_target())
@@ -359,6 +384,11 @@ bool base::is_property(const std::string& property_name, std::string* type_name)
     property is copied to the referenced string.*/
 void* base::find_member_ptr(const std::string& property_name, std::string* type_name)
 {
+	if (const reflection_cache::member_info* mi = find_cached_member(this, property_name)) {
+		if (type_name)
+			*type_name = mi->rt->get_type_name();
+		return mi->get_member_ptr(this);
+	}
 	find_reflection_handler fsrh(property_name);
 	self_reflect(fsrh);
 	if (!fsrh.found_target())
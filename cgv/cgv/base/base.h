@@ -146,6 +146,13 @@ public:
 	    with corresponding reflection handlers. 
 		The default implementation of self_reflect is empty. */
 	virtual bool self_reflect(cgv::reflect::reflection_handler&);
+	//! return whether set_void, get_void and find_member_ptr can use a per type cache of member offsets
+	/*! The cache is built from the first instance of a type and looks up plain property names without
+	    traversing the self_reflect() method. The default implementation returns false. Overload to return
+		true only if self_reflect() reflects members of the instance itself, i.e. no members of other objects
+		such as objects referenced by pointers, and maps each property name to the same member independent
+		of the state of the instance. */
+	virtual bool use_reflection_cache() const;
 	//! return a semicolon separated list of property declarations
 	/*! of the form "name1:type1;name2:type2;...", by default an empty 
 		list is returned. The types should by consistent with the names 
@@ -0,0 +1,763 @@
+#include "graph_io.h"
+#include "named.h"
+#include <cgv/reflect/reflection_handler.h>
+#include <cgv/type/standard_types.h>
+#include <cgv/type/variant.h>
+#include <cgv/type/info/type_id.h>
+#include <cgv/utils/file.h>
+#include <algorithm>
+#include <unordered_map>
+#include <iostream>
+#include <string.h>
+
+using namespace cgv::reflect;
+using namespace cgv::type;
+using namespace cgv::type::info;
+
+namespace cgv {
+	namespace base {
+
+namespace {
+
+const char object_graph_magic[8] = { 'C', 'G', 'V', 'G', 'R', 'A', 'P', 'H' };
+const uint32_type object_graph_format_version = 1;
+const uint32_type no_parent = ~uint32_type(0);
+const uint64_type absent_field = ~uint64_type(0);
+
+/// file header at offset 0, all offsets are relative to the file start
+struct object_graph_header
+{
+	char magic[8];
+	uint32_type format_version;
+	uint32_type version;
+	uint32_type nr_types;
+	uint32_type nr_objects;
+	uint64_type content_offset;
+	uint64_type type_table_offset;
+	uint64_type object_table_offset;
+	uint64_type file_size;
+};
+
+/// different ways to store a member value in an object blob
+enum FieldKind { FK_VALUE, FK_STRING, FK_TEXT, FK_ARRAY };
+
+/// determine how a member described by the given reflection traits is stored and return false if it cannot be stored
+bool classify_member(abst_reflection_traits* rt, FieldKind& kind)
+{
+	TypeId tid = rt->get_type_id();
+	if (tid == TI_STRING)
+		kind = FK_STRING;
+	else if (is_fundamental(tid) && tid != TI_WSTRING)
+		kind = FK_VALUE;
+	else if (rt->has_string_conversions())
+		kind = FK_TEXT;
+	else
+		return false;
+	return true;
+}
+
+/// check whether array elements of the given type can be copied in one block
+bool is_block_type(abst_reflection_traits* rt)
+{
+	TypeId tid = rt->get_type_id();
+	return is_fundamental(tid) && tid != TI_STRING && tid != TI_WSTRING;
+}
+
+/// description of one member in the schema of a type
+struct field_info
+{
+	std::string name;
+	uint32_type kind;
+	uint32_type type_id;
+	uint32_type size;
+};
+
+/// schema of all members written for a type name
+struct type_schema
+{
+	std::string type_name;
+	std::vector<field_info> fields;
+	std::unordered_map<std::string, uint32_type> field_indices;
+	/// return index of field or -1 if not contained
+	int find(const std::string& name) const
+	{
+		auto iter = field_indices.find(name);
+		return iter == field_indices.end() ? -1 : int(iter->second);
+	}
+	/// add field if not contained and return its index or -1 if a field of the same name is stored differently
+	int find_or_add(const std::string& name, FieldKind kind, TypeId tid, unsigned size)
+	{
+		int fi = find(name);
+		if (fi == -1) {
+			field_info f = { name, uint32_type(kind), uint32_type(kind == FK_TEXT ? TI_UNDEF : tid), size };
+			fi = int(fields.size());
+			fields.push_back(f);
+			field_indices[name] = fi;
+		}
+		else {
+			const field_info& f = fields[fi];
+			if (f.kind != uint32_type(kind) || (kind != FK_TEXT && (f.type_id != uint32_type(tid) || f.size != size)))
+				return -1;
+		}
+		return fi;
+	}
+};
+
+/// helper to append aligned data to a byte buffer
+struct byte_writer
+{
+	std::vector<char>& buffer;
+	byte_writer(std::vector<char>& _buffer) : buffer(_buffer) {}
+	void align(size_t a = 8) { buffer.resize((buffer.size() + a - 1) / a * a, 0); }
+	size_t append(const void* ptr, size_t n)
+	{
+		size_t pos = buffer.size();
+		buffer.resize(pos + n);
+		if (n > 0)
+			memcpy(&buffer[pos], ptr, n);
+		return pos;
+	}
+	template <typename T>
+	size_t put(const T& value) { return append(&value, sizeof(T)); }
+	void put_string(const std::string& s)
+	{
+		put(uint32_type(s.size()));
+		append(s.data(), s.size());
+		align(4);
+	}
+	template <typename T>
+	void patch(size_t pos, const T& value) { memcpy(&buffer[pos], &value, sizeof(T)); }
+};
+
+/// helper to read from a byte range with bounds checking
+struct byte_reader
+{
+	const char* data;
+	size_t size;
+	size_t pos;
+	bool failed;
+	byte_reader(const char* _data, size_t _size, size_t _pos = 0) : data(_data), size(_size), pos(_pos), failed(_pos > _size) {}
+	bool has(size_t n) const { return !failed && n <= size - pos; }
+	bool get(void* ptr, size_t n)
+	{
+		if (!has(n)) {
+			failed = true;
+			return false;
+		}
+		memcpy(ptr, data + pos, n);
+		pos += n;
+		return true;
+	}
+	template <typename T>
+	bool get(T& value) { return get(&value, sizeof(T)); }
+	void align(size_t a = 8) { pos = (pos + a - 1) / a * a; if (pos > size) failed = true; }
+	bool get_string(std::string& s)
+	{
+		uint32_type n;
+		if (!get(n) || !has(n)) {
+			failed = true;
+			return false;
+		}
+		s.assign(data + pos, n);
+		pos += n;
+		align(4);
+		return !failed;
+	}
+};
+
+/// common functionality of reading and writing handlers, which flatten members of structures to paths like "a.b" or "c[2].d"
+class object_graph_reflection_handler : public reflection_handler
+{
+protected:
+	struct frame
+	{
+		std::string path;
+		GroupKind group_kind;
+		bool block;
+		/// number of reflected array elements
+		size_t nr_elements;
+		/// number of array elements stored in blob
+		size_t nr_stored;
+		/// position of array elements in blob
+		size_t data_pos;
+		/// size of an array element
+		unsigned element_size;
+	};
+	std::vector<frame> frames;
+	/// fields are processed only for their first occurrence
+	std::vector<bool> processed;
+	bool mark_processed(int fi)
+	{
+		if (fi >= int(processed.size()))
+			processed.resize(fi + 1, false);
+		if (processed[fi])
+			return false;
+		processed[fi] = true;
+		return true;
+	}
+	std::string member_path(const std::string& member_name) const
+	{
+		if (frames.empty())
+			return member_name;
+		const frame& f = frames.back();
+		if (member_name.empty()) {
+			if (is_array_kind(f.group_kind))
+				return f.path + "[" + std::to_string(nesting_info_stack.back().idx) + "]";
+			return f.path;
+		}
+		return f.path.empty() ? member_name : f.path + "." + member_name;
+	}
+	/// start an array of block type and return whether to traverse it
+	virtual bool begin_block(frame& f, void* group_ptr, abst_reflection_traits* rt) = 0;
+	/// process the size member of an array of block type
+	virtual void process_block_size(frame& f, void* member_ptr, abst_reflection_traits* rt) = 0;
+	/// process all elements of an array of block type given the pointer to the first element
+	virtual void process_block_data(frame& f, void* first_element_ptr) = 0;
+	/// process a member that is not part of a block
+	virtual void process_field(const std::string& path, FieldKind kind, void* member_ptr, abst_reflection_traits* rt) = 0;
+public:
+	int reflect_group_begin(GroupKind group_kind, const std::string& group_name, void* group_ptr, abst_reflection_traits* rt, unsigned grp_size)
+	{
+		frame f;
+		f.group_kind = group_kind;
+		f.block = false;
+		f.nr_elements = f.nr_stored = f.data_pos = 0;
+		f.element_size = 0;
+		switch (group_kind) {
+		case GK_BASE_CLASS:
+			if (!frames.empty())
+				f.path = frames.back().path;
+			break;
+		case GK_STRUCTURE:
+			f.path = member_path(group_name);
+			break;
+		case GK_ARRAY:
+		case GK_VECTOR:
+			f.path = member_path(group_name);
+			if (is_block_type(rt)) {
+				f.block = true;
+				f.nr_elements = grp_size;
+				f.element_size = rt->size();
+				if (!begin_block(f, group_ptr, rt))
+					return GT_SKIP;
+			}
+			break;
+		default:
+			return GT_SKIP;
+		}
+		frames.push_back(f);
+		return GT_COMPLETE;
+	}
+	void reflect_group_end(GroupKind)
+	{
+		frames.pop_back();
+	}
+	bool reflect_member_void(const std::string& member_name, void* member_ptr, abst_reflection_traits* rt)
+	{
+		if (!frames.empty() && frames.back().block) {
+			frame& f = frames.back();
+			if (member_name == "size")
+				process_block_size(f, member_ptr, rt);
+			else if (nesting_info_stack.back().idx == 0)
+				process_block_data(f, member_ptr);
+			return true;
+		}
+		FieldKind kind;
+		if (classify_member(rt, kind))
+			process_field(member_path(member_name), kind, member_ptr, rt);
+		return true;
+	}
+	bool reflect_method_void(const std::string&, method_interface*,
+		abst_reflection_traits*, const std::vector<abst_reflection_traits*>&)
+	{
+		return true;
+	}
+};
+
+/// writes member values into a value buffer and extends the schema of the type by new fields
+class object_graph_write_handler : public object_graph_reflection_handler
+{
+protected:
+	type_schema& schema;
+	byte_writer values;
+	bool begin_block(frame& f, void*, abst_reflection_traits* rt)
+	{
+		int fi = schema.find_or_add(f.path, FK_ARRAY, rt->get_type_id(), f.element_size);
+		if (fi == -1 || !mark_processed(fi))
+			return false;
+		values.align();
+		offsets.push_back(std::make_pair(uint32_type(fi), uint64_type(values.put(uint64_type(f.nr_elements)))));
+		values.align();
+		f.data_pos = values.buffer.size();
+		values.buffer.resize(f.data_pos + f.nr_elements * f.element_size, 0);
+		return true;
+	}
+	void process_block_size(frame&, void*, abst_reflection_traits*)
+	{
+	}
+	void process_block_data(frame& f, void* first_element_ptr)
+	{
+		if (f.nr_elements > 0)
+			memcpy(&values.buffer[f.data_pos], first_element_ptr, f.nr_elements * f.element_size);
+	}
+	void process_field(const std::string& path, FieldKind kind, void* member_ptr, abst_reflection_traits* rt)
+	{
+		int fi = schema.find_or_add(path, kind, rt->get_type_id(), rt->size());
+		if (fi == -1 || !mark_processed(fi))
+			return;
+		values.align();
+		offsets.push_back(std::make_pair(uint32_type(fi), uint64_type(values.buffer.size())));
+		switch (kind) {
+		case FK_VALUE:
+			values.append(member_ptr, rt->size());
+			break;
+		case FK_STRING: {
+			const std::string& s = *static_cast<const std::string*>(member_ptr);
+			values.put(uint64_type(s.size()));
+			values.append(s.data(), s.size());
+			break;
+		}
+		case FK_TEXT: {
+			std::string s;
+			rt->get_to_string(member_ptr, s);
+			values.put(uint64_type(s.size()));
+			values.append(s.data(), s.size());
+			break;
+		}
+		default:
+			break;
+		}
+	}
+public:
+	/// pairs of field index and offset into value buffer
+	std::vector<std::pair<uint32_type, uint64_type> > offsets;
+	object_graph_write_handler(type_schema& _schema, std::vector<char>& _values) : schema(_schema), values(_values) {}
+};
+
+/// reads member values from the blob of an object by matching member paths against the schema of the file
+class object_graph_read_handler : public object_graph_reflection_handler
+{
+protected:
+	const type_schema& schema;
+	const char* blob;
+	size_t blob_size;
+	uint32_type nr_fields;
+	/// return position of field in blob or absent_field if not available
+	uint64_type find_field(const std::string& path, int& fi)
+	{
+		fi = schema.find(path);
+		if (fi == -1 || uint32_type(fi) >= nr_fields)
+			return absent_field;
+		uint64_type offset;
+		memcpy(&offset, blob + 8 + 8 * size_t(fi), 8);
+		if (offset != absent_field && offset >= blob_size) {
+			failed = true;
+			return absent_field;
+		}
+		return offset;
+	}
+	bool begin_block(frame& f, void* group_ptr, abst_reflection_traits* rt)
+	{
+		int fi;
+		uint64_type offset = find_field(f.path, fi);
+		if (offset == absent_field || !mark_processed(fi))
+			return false;
+		const field_info& fld = schema.fields[fi];
+		if (fld.kind != FK_ARRAY || fld.type_id != uint32_type(rt->get_type_id()) || fld.size != f.element_size)
+			return false;
+		byte_reader br(blob, blob_size, size_t(offset));
+		uint64_type n;
+		if (!br.get(n)) {
+			failed = true;
+			return false;
+		}
+		br.align();
+		if (!br.has(size_t(n * f.element_size)) || n > blob_size) {
+			failed = true;
+			return false;
+		}
+		f.nr_stored = size_t(n);
+		f.data_pos = br.pos;
+		changed_members.push_back(group_ptr);
+		return true;
+	}
+	void process_block_size(frame& f, void* member_ptr, abst_reflection_traits* rt)
+	{
+		uint64_type n = f.nr_stored;
+		assign_variant(rt->get_type_name(), member_ptr, get_type_name(TI_UINT64), &n);
+		f.nr_elements = f.nr_stored;
+	}
+	void process_block_data(frame& f, void* first_element_ptr)
+	{
+		size_t n = std::min(f.nr_elements, f.nr_stored);
+		if (n > 0)
+			memcpy(first_element_ptr, blob + f.data_pos, n * f.element_size);
+	}
+	bool read_string(byte_reader& br, std::string& s)
+	{
+		uint64_type n;
+		if (!br.get(n) || !br.has(size_t(n))) {
+			failed = true;
+			return false;
+		}
+		s.assign(blob + br.pos, size_t(n));
+		return true;
+	}
+	void process_field(const std::string& path, FieldKind kind, void* member_ptr, abst_reflection_traits* rt)
+	{
+		int fi;
+		uint64_type offset = find_field(path, fi);
+		if (offset == absent_field || !mark_processed(fi))
+			return;
+		const field_info& fld = schema.fields[fi];
+		byte_reader br(blob, blob_size, size_t(offset));
+		bool changed = false;
+		switch (kind) {
+		case FK_VALUE:
+			if (fld.kind != FK_VALUE || fld.type_id == TI_STRING || fld.type_id == TI_WSTRING)
+				break;
+			if (fld.type_id == uint32_type(rt->get_type_id()) && fld.size == rt->size())
+				changed = br.get(member_ptr, fld.size);
+			else if (fld.size <= 8 && is_fundamental(TypeId(fld.type_id))) {
+				// convert values of members whose type changed
+				uint64_type tmp = 0;
+				if ((changed = br.get(&tmp, fld.size)))
+					assign_variant(rt->get_type_name(), member_ptr, get_type_name(TypeId(fld.type_id)), &tmp);
+			}
+			break;
+		case FK_STRING:
+		case FK_TEXT:
+			if (fld.kind == FK_STRING || fld.kind == FK_TEXT) {
+				std::string s;
+				if (read_string(br, s)) {
+					if (kind == FK_STRING) {
+						static_cast<std::string*>(member_ptr)->swap(s);
+						changed = true;
+					}
+					else
+						changed = rt->set_from_string(member_ptr, s);
+				}
+			}
+			break;
+		default:
+			break;
+		}
+		if (br.failed)
+			failed = true;
+		if (changed)
+			changed_members.push_back(member_ptr);
+	}
+public:
+	bool failed;
+	/// pointers to all members that have been read
+	std::vector<void*> changed_members;
+	object_graph_read_handler(const type_schema& _schema, const char* _blob, size_t _blob_size, uint32_type _nr_fields)
+		: schema(_schema), blob(_blob), blob_size(_blob_size), nr_fields(_nr_fields), failed(false) {}
+	bool is_creative() const { return true; }
+};
+
+/// collects the objects of a graph in depth first order together with their member blobs
+class object_graph_writer
+{
+protected:
+	struct object_record
+	{
+		uint32_type type_index;
+		uint32_type parent_index;
+		std::string name;
+		std::vector<char> blob;
+	};
+	std::vector<type_schema> types;
+	std::unordered_map<std::string, uint32_type> type_indices;
+	std::vector<object_record> objects;
+public:
+	void add(base_ptr object, uint32_type parent_index)
+	{
+		std::string type_name = object->get_type_name();
+		auto iter = type_indices.find(type_name);
+		uint32_type ti;
+		if (iter == type_indices.end()) {
+			ti = uint32_type(types.size());
+			types.push_back(type_schema());
+			types.back().type_name = type_name;
+			type_indices[type_name] = ti;
+		}
+		else
+			ti = iter->second;
+		uint32_type oi = uint32_type(objects.size());
+		objects.push_back(object_record());
+		objects[oi].type_index = ti;
+		objects[oi].parent_index = parent_index;
+		named_ptr np = object->cast<named>();
+		if (np)
+			objects[oi].name = np->get_name();
+
+		std::vector<char> values;
+		object_graph_write_handler ogwh(types[ti], values);
+		object->self_reflect(ogwh);
+
+		// blob consists of number of fields, offset table and values
+		uint32_type nr_fields = uint32_type(types[ti].fields.size());
+		size_t table_size = 8 + 8 * size_t(nr_fields);
+		std::vector<char>& blob = objects[oi].blob;
+		byte_writer bw(blob);
+		bw.put(nr_fields);
+		bw.put(uint32_type(0));
+		for (uint32_type fi = 0; fi < nr_fields; ++fi)
+			bw.put(absent_field);
+		for (const auto& o : ogwh.offsets)
+			bw.patch(8 + 8 * size_t(o.first), uint64_type(o.second + table_size));
+		bw.append(values.empty() ? 0 : &values[0], values.size());
+
+		group_ptr gp = object->cast<group>();
+		if (gp)
+			for (unsigned ci = 0; ci < gp->get_nr_children(); ++ci)
+				add(gp->get_child(ci), oi);
+	}
+	void write(std::vector<char>& buffer, const std::string& content, unsigned version) const
+	{
+		buffer.clear();
+		byte_writer bw(buffer);
+		object_graph_header header;
+		memset(&header, 0, sizeof(object_graph_header));
+		memcpy(header.magic, object_graph_magic, 8);
+		header.format_version = object_graph_format_version;
+		header.version = version;
+		header.nr_types = uint32_type(types.size());
+		header.nr_objects = uint32_type(objects.size());
+		bw.put(header);
+
+		header.content_offset = bw.buffer.size();
+		bw.put_string(content);
+		bw.align();
+
+		header.type_table_offset = bw.buffer.size();
+		for (const auto& t : types) {
+			bw.put_string(t.type_name);
+			bw.put(uint32_type(t.fields.size()));
+			for (const auto& f : t.fields) {
+				bw.put(f.kind);
+				bw.put(f.type_id);
+				bw.put(f.size);
+				bw.put_string(f.name);
+			}
+		}
+		bw.align();
+
+		header.object_table_offset = bw.buffer.size();
+		std::vector<size_t> data_offset_positions;
+		for (const auto& o : objects) {
+			bw.put(o.type_index);
+			bw.put(o.parent_index);
+			data_offset_positions.push_back(bw.put(uint64_type(0)));
+			bw.put(uint64_type(o.blob.size()));
+			bw.put_string(o.name);
+			bw.align();
+		}
+		for (size_t oi = 0; oi < objects.size(); ++oi) {
+			bw.align();
+			bw.patch(data_offset_positions[oi], uint64_type(bw.buffer.size()));
+			bw.append(&objects[oi].blob[0], objects[oi].blob.size());
+		}
+		header.file_size = bw.buffer.size();
+		bw.patch(0, header);
+	}
+};
+
+/// parses the tables of a serialized object graph and restores objects from their blobs
+class object_graph_reader
+{
+protected:
+	struct object_entry
+	{
+		uint32_type type_index;
+		uint32_type parent_index;
+		uint64_type data_offset;
+		uint64_type data_size;
+		std::string name;
+		std::vector<uint32_type> children;
+	};
+	const char* data;
+	size_t size;
+	const object_graph_factory& factory;
+	std::vector<type_schema> types;
+	std::vector<object_entry> objects;
+public:
+	object_graph_reader(const char* _data, size_t _size, const object_graph_factory& _factory) : data(_data), size(_size), factory(_factory) {}
+	bool parse(const std::string& content, unsigned version, unsigned* file_version)
+	{
+		object_graph_header header;
+		byte_reader br(data, size);
+		if (!br.get(header) || memcmp(header.magic, object_graph_magic, 8) != 0) {
+			std::cerr << "object graph: invalid file header" << std::endl;
+			return false;
+		}
+		if (header.format_version > object_graph_format_version) {
+			std::cerr << "object graph: format version " << header.format_version << " not supported" << std::endl;
+			return false;
+		}
+		if (header.file_size > size) {
+			std::cerr << "object graph: file truncated to " << size << " of " << header.file_size << " bytes" << std::endl;
+			return false;
+		}
+		std::string file_content;
+		br.pos = size_t(header.content_offset);
+		if (!br.get_string(file_content))
+			return false;
+		if (file_content != content) {
+			std::cerr << "object graph: content '" << file_content << "' does not match '" << content << "'" << std::endl;
+			return false;
+		}
+		if (header.version > version) {
+			std::cerr << "object graph: version " << header.version << " is newer than supported version " << version << std::endl;
+			return false;
+		}
+		if (file_version)
+			*file_version = header.version;
+		// each type entry takes at least 8 and each object entry at least 28 bytes, which bounds the counts before allocation
+		if (header.nr_types > size / 8 || header.nr_objects > size / 28) {
+			std::cerr << "object graph: corrupt type or object table" << std::endl;
+			return false;
+		}
+
+		br.pos = size_t(header.type_table_offset);
+		types.resize(header.nr_types);
+		for (auto& t : types) {
+			uint32_type nr_fields;
+			if (!br.get_string(t.type_name) || !br.get(nr_fields) || !br.has(size_t(nr_fields) * 16))
+				break;
+			t.fields.resize(nr_fields);
+			for (uint32_type fi = 0; fi < nr_fields; ++fi) {
+				field_info& f = t.fields[fi];
+				if (!(br.get(f.kind) && br.get(f.type_id) && br.get(f.size) && br.get_string(f.name)))
+					break;
+				t.field_indices[f.name] = fi;
+			}
+		}
+		br.pos = size_t(header.object_table_offset);
+		objects.resize(header.nr_objects);
+		for (uint32_type oi = 0; !br.failed && oi < header.nr_objects; ++oi) {
+			object_entry& o = objects[oi];
+			if (!(br.get(o.type_index) && br.get(o.parent_index) && br.get(o.data_offset) && br.get(o.data_size) && br.get_string(o.name)))
+				break;
+			br.align();
+			if (o.type_index >= header.nr_types || o.data_offset > size || o.data_size > size - o.data_offset || o.data_size < 8 ||
+				(oi == 0 ? o.parent_index != no_parent : o.parent_index >= oi)) {
+				br.failed = true;
+				break;
+			}
+			if (oi > 0)
+				objects[o.parent_index].children.push_back(oi);
+		}
+		if (br.failed || objects.empty()) {
+			std::cerr << "object graph: corrupt type or object table" << std::endl;
+			return false;
+		}
+		return true;
+	}
+	bool restore(uint32_type oi, base_ptr& object)
+	{
+		const object_entry& o = objects[oi];
+		const type_schema& t = types[o.type_index];
+		if (!object || object->get_type_name() != t.type_name) {
+			if (!factory) {
+				std::cerr << "object graph: cannot restore object " << o.name << " of type " << t.type_name;
+				if (object)
+					std::cerr << " into object of type " << object->get_type_name();
+				std::cerr << std::endl;
+				return false;
+			}
+			object = factory(t.type_name);
+			if (!object) {
+				std::cerr << "object graph: could not construct object of type " << t.type_name << std::endl;
+				return false;
+			}
+			named_ptr np = object->cast<named>();
+			if (np)
+				np->set_name(o.name);
+		}
+		const char* blob = data + o.data_offset;
+		uint32_type nr_fields;
+		memcpy(&nr_fields, blob, 4);
+		if (8 + 8 * uint64_type(nr_fields) > o.data_size) {
+			std::cerr << "object graph: corrupt blob of object " << o.name << std::endl;
+			return false;
+		}
+		object_graph_read_handler ogrh(t, blob, size_t(o.data_size), nr_fields);
+		object->self_reflect(ogrh);
+		if (ogrh.failed) {
+			std::cerr << "object graph: corrupt blob of object " << o.name << std::endl;
+			return false;
+		}
+		for (void* member_ptr : ogrh.changed_members)
+			object->on_set(member_ptr);
+
+		if (o.children.empty())
+			return true;
+		group_ptr gp = object->cast<group>();
+		if (!gp) {
+			std::cerr << "object graph: object " << o.name << " of type " << t.type_name << " has children but is no group" << std::endl;
+			return false;
+		}
+		for (unsigned ci = 0; ci < o.children.size(); ++ci) {
+			base_ptr existing;
+			if (ci < gp->get_nr_children())
+				existing = gp->get_child(ci);
+			base_ptr child = existing;
+			if (!restore(o.children[ci], child))
+				return false;
+			if (child != existing) {
+				if (existing) {
+					gp->remove_child(existing);
+					gp->insert_child(ci, child);
+				}
+				else
+					gp->append_child(child);
+			}
+		}
+		return true;
+	}
+};
+
+}
+
+bool write_object_graph(std::vector<char>& buffer, base_ptr root, const std::string& content, unsigned version)
+{
+	if (!root)
+		return false;
+	object_graph_writer ogw;
+	ogw.add(root, no_parent);
+	ogw.write(buffer, content, version);
+	return true;
+}
+
+bool write_object_graph(const std::string& file_name, base_ptr root, const std::string& content, unsigned version)
+{
+	std::vector<char> buffer;
+	if (!write_object_graph(buffer, root, content, version))
+		return false;
+	return cgv::utils::file::write(file_name, &buffer[0], buffer.size(), false);
+}
+
+bool read_object_graph(const char* data, size_t size, base_ptr& root, const std::string& content, unsigned version,
+					   const object_graph_factory& factory, unsigned* file_version)
+{
+	object_graph_reader ogr(data, size, factory);
+	if (!ogr.parse(content, version, file_version))
+		return false;
+	return ogr.restore(0, root);
+}
+
+bool read_object_graph(const std::string& file_name, base_ptr& root, const std::string& content, unsigned version,
+					   const object_graph_factory& factory, unsigned* file_version)
+{
+	std::string buffer;
+	if (!cgv::utils::file::read(file_name, buffer, false)) {
+		std::cerr << "object graph: could not read file " << file_name << std::endl;
+		return false;
+	}
+	return read_object_graph(buffer.data(), buffer.size(), root, content, version, factory, file_version);
+}
+
+	}
+}
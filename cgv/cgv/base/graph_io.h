@@ -0,0 +1,52 @@
+#pragma once
+
+#include "group.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace base {
+
+/**@name binary serialization of object graphs
+   The object graph below a root object is traversed in depth first order, where the children of
+   cgv::base::group objects are visited recursively. The members of each object are extracted with
+   its self_reflect() method. For each type name a schema of the reflected members is written once
+   to the file header and each object stores its member values in a dense blob with a table of
+   field offsets. Vectors and arrays of fundamental types are stored in one block each.
+
+   All tables and blobs are 8 byte aligned and addressed by offsets relative to the file start, such
+   that a file can be read from a memory mapped file without parsing more than the tables. When
+   reading, members are matched by name against the schema of the file. Members missing in the file
+   keep their values and members of the file that are no longer reflected are ignored, such that
+   files stay readable when classes evolve. Together with the content description and version this
+   allows to restore scene and session states written by older versions of an application.
+*/
+//@{
+
+/// callback used when reading an object graph to construct objects from their type name
+typedef std::function<base_ptr(const std::string& type_name)> object_graph_factory;
+
+/// serialize the object graph below root into the given buffer, where content and version describe the application specific content
+extern CGV_API bool write_object_graph(std::vector<char>& buffer, base_ptr root, const std::string& content, unsigned version);
+/// serialize the object graph below root into a file
+extern CGV_API bool write_object_graph(const std::string& file_name, base_ptr root, const std::string& content, unsigned version);
+//! restore an object graph from a buffer of the given size in bytes, e.g. a memory mapped file.
+/*! If root points to an object graph, the objects of the file are matched against the objects of the graph in
+    traversal order and need to have the same type names. Otherwise or for additional children of groups, objects
+	are constructed with the factory. Reading fails if content does not match or if the file version is newer than
+	the given version. On success the version of the file is written to file_version if provided. After the members
+	of an object have been read, on_set() is called for each of them. */
+extern CGV_API bool read_object_graph(const char* data, size_t size, base_ptr& root, const std::string& content, unsigned version,
+									  const object_graph_factory& factory = object_graph_factory(), unsigned* file_version = 0);
+/// restore an object graph from a file, see read_object_graph for the semantics of the parameters
+extern CGV_API bool read_object_graph(const std::string& file_name, base_ptr& root, const std::string& content, unsigned version,
+									  const object_graph_factory& factory = object_graph_factory(), unsigned* file_version = 0);
+//@}
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -4,8 +4,16 @@
 #include <cgv/utils/advanced_scan.h>
 #include <cgv/utils/file.h>
 #include <cgv/type/variant.h>
+#include <cgv/reflect/reflection_cache.h>
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <set>
 
@@ -22,6 +30,10 @@
 #endif
 #endif
 
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+
 using namespace cgv::utils;
 
 namespace cgv {
@@ -164,8 +176,69 @@ std::vector<base_ptr>& ref_listeners()
 	return listeners;
 }
 
+/// type names of lazily constructed objects together with the declared object names, which are empty if not known
+std::vector<std::pair<std::string, std::string>>& ref_lazy_types()
+{
+	static std::vector<std::pair<std::string, std::string>> lazy_types;
+	return lazy_types;
+}
+
+/// registration events of object constructors whose construction has been deferred
+std::vector<std::pair<base_ptr, std::string>>& ref_lazy_objects()
+{
+	static std::vector<std::pair<base_ptr, std::string>> lazy_objects;
+	return lazy_objects;
+}
+
+std::vector<plugin_load_info>& ref_plugin_load_infos()
+{
+	static std::vector<plugin_load_info> plugin_load_infos;
+	return plugin_load_infos;
+}
+
+bool& ref_concurrent_plugin_loading_enabled()
+{
+	static bool enabled = true;
+	return enabled;
+}
+
 /****************** helper functions **************/
 
+/// check whether a type name, which can be mangled as returned by type_info, matches a given name that can omit the name spaces
+bool type_name_matches(const std::string& _type_name, const std::string& name)
+{
+	std::string type_name = _type_name;
+#ifdef __GNUC__
+	int status;
+	char* demangled = abi::__cxa_demangle(_type_name.c_str(), 0, 0, &status);
+	if (demangled) {
+		type_name = demangled;
+		free(demangled);
+	}
+#endif
+	if (type_name == name)
+		return true;
+	size_t pos = type_name.rfind("::", type_name.find('<'));
+	return pos != std::string::npos && type_name.compare(pos + 2, std::string::npos, name) == 0;
+}
+
+bool is_lazy_type(const std::string& type_name)
+{
+	for (const auto& lt : ref_lazy_types())
+		if (type_name_matches(type_name, lt.first))
+			return true;
+	return false;
+}
+
+/// return the object name declared for a lazily constructed type or an empty string if it is not known before construction
+std::string get_lazy_object_name(const std::string& type_name)
+{
+	for (const auto& lt : ref_lazy_types())
+		if (type_name_matches(type_name, lt.first))
+			return lt.second;
+	return std::string();
+}
+
 void show_split_lines(const std::string& s)
 {
 	if (s.empty())
@@ -362,6 +435,58 @@ registration_order_definition::registration_order_definition(const std::string&
 	define_registration_order(partial_order, before_contructor_execution, when);
 }
 
+void define_lazy_construction(const std::string& type_names)
+{
+	std::vector<cgv::utils::token> toks;
+	cgv::utils::tokenizer(type_names).set_ws(";").bite_all(toks);
+	for (auto t : toks) {
+		std::string type_name = to_string(t), object_name;
+		size_t pos = type_name.find('(');
+		if (pos != std::string::npos && type_name.back() == ')') {
+			object_name = type_name.substr(pos + 1, type_name.size() - pos - 2);
+			type_name.erase(pos);
+		}
+		ref_lazy_types().push_back(std::make_pair(type_name, object_name));
+	}
+}
+
+lazy_construction_definition::lazy_construction_definition(const std::string& type_names)
+{
+	define_lazy_construction(type_names);
+}
+
+/// construct and register the lazily constructed objects whose constructor is accepted by the given predicate
+template <typename P>
+void construct_lazy_objects_if(P accept)
+{
+	std::vector<std::pair<base_ptr, std::string>>& L = ref_lazy_objects();
+	for (size_t i = 0; i < L.size();) {
+		object_constructor* oc = L[i].first->get_interface<object_constructor>();
+		if (!accept(oc)) {
+			++i;
+			continue;
+		}
+		// remove event before construction as constructors can register further objects
+		std::pair<base_ptr, std::string> event = L[i];
+		L.erase(L.begin() + i);
+		if (is_registration_debugging_enabled())
+			std::cout << "REG LAZY CONSTRUCT " << oc->get_constructed_type_name() << "('" << event.second << "')" << std::endl;
+		register_object(oc->construct_object(), event.second);
+	}
+}
+
+void construct_lazy_objects(const std::string& type_name)
+{
+	construct_lazy_objects_if([&type_name](const object_constructor* oc) {
+		return type_name.empty() || type_name_matches(oc->get_constructed_type_name(), type_name);
+	});
+}
+
+unsigned get_nr_lazy_objects()
+{
+	return (unsigned)ref_lazy_objects().size();
+}
+
 void enable_registration_debugging()
 {
 	ref_registration_debugging_enabled() = true;
@@ -396,6 +521,16 @@ void enable_registration()
 		base_ptr o = ref_registration_events()[i].first;
 		object_constructor* obr = o->get_interface<object_constructor>();
 		if (obr) {
+			// keep constructors of lazily constructed objects until they are needed
+			if (is_lazy_type(obr->get_constructed_type_name())) {
+				if (is_registration_debugging_enabled())
+					std::cout << "REG DEFER " << obr->get_constructed_type_name() << "('"
+							  << ref_registration_events()[i].second << "')" << std::endl;
+				ref_lazy_objects().push_back(ref_registration_events()[i]);
+				ref_registration_events().erase(ref_registration_events().begin() + i);
+				--i;
+				continue;
+			}
 			if (is_registration_debugging_enabled())
 				std::cout << "REG CONSTRUCT " << obr->get_constructed_type_name() << "('"
 						  << ref_registration_events()[i].second << "')";
@@ -518,6 +653,7 @@ bool request_exit_from_all_objects()
 /// access to number of permanently registered objects
 unsigned get_nr_permanently_registered_objects()
 {
+	construct_lazy_objects();
 	return (unsigned)ref_object_collection().objects.size();
 }
 
@@ -653,13 +789,27 @@ void unregister_object(base_ptr object, const std::string& options)
 /// in case permanent registration is active, look for a registered object by name
 named_ptr find_object_by_name(const std::string& name)
 {
-	return ref_object_collection().find_object_by_name(name);
+	named_ptr np = ref_object_collection().find_object_by_name(name);
+	// construct the lazily constructed objects that can have the name, i.e. whose declared name matches or is unknown
+	if (!np && get_nr_lazy_objects() > 0) {
+		construct_lazy_objects_if([&name](const object_constructor* oc) {
+			std::string object_name = get_lazy_object_name(oc->get_constructed_type_name());
+			return object_name.empty() || object_name == name;
+		});
+		np = ref_object_collection().find_object_by_name(name);
+	}
+	return np;
 }
 
 /// in case permanent registration is active, look for a registered object by type name
 base_ptr find_object_by_type(const std::string& type_name)
 {
-	return ref_object_collection().find_object_by_type(type_name);
+	base_ptr bp = ref_object_collection().find_object_by_type(type_name);
+	if (!bp && get_nr_lazy_objects() > 0) {
+		construct_lazy_objects(type_name);
+		bp = ref_object_collection().find_object_by_type(type_name);
+	}
+	return bp;
 }
 
 std::string get_config_file_name(const std::string& _file_name)
@@ -701,6 +851,21 @@ config_file_observer* find_config_file_observer(const std::string& file_name, co
 	return ref_config_file_driver()->find_config_file_observer(file_name, content);
 }
 
+/// load plugins collected from consecutive plugin commands and report the result of each
+void load_plugin_commands(std::vector<std::string>& plugin_names)
+{
+	if (plugin_names.empty())
+		return;
+	std::vector<void*> handles = load_plugins(plugin_names);
+	for (size_t i = 0; i < plugin_names.size(); ++i) {
+		if (handles[i])
+			std::cout << "read plugin " << plugin_names[i] << std::endl;
+		else
+			std::cerr << "error reading plugin " << plugin_names[i] << std::endl;
+	}
+	plugin_names.clear();
+}
+
 bool process_config_file_ext(const std::string& _file_name, bool* persistent = 0)
 {
 	// update file name extension
@@ -724,9 +889,10 @@ bool process_config_file_ext(const std::string& _file_name, bool* persistent = 0
 	std::vector<line> lines;
 	split_to_lines(content, lines);
 
-	// interpret each line as a command
+	// interpret each line as a command, where consecutive plugin commands are loaded together
 	unsigned int i;
 	std::string cfg_file_dir = cgv::utils::file::get_path(_file_name);
+	std::vector<std::string> plugin_names;
 	for (i = 0; i < lines.size(); ++i) {
 		command_info info;
 		std::string line;
@@ -774,9 +940,21 @@ bool process_config_file_ext(const std::string& _file_name, bool* persistent = 0
 		else
 			analyze_command(token(line), false, &info);
 
+		if (info.command_type == CT_PLUGIN) {
+			plugin_names.push_back(to_string(info.parameters[0]));
+			continue;
+		}
+		// lazy construction has to be defined before the collected plugins are loaded
+		if (info.command_type == CT_LAZY) {
+			process_command_ext(info, persistent, cfo, &content[0]);
+			continue;
+		}
+		if (info.command_type != CT_EMPTY && info.command_type != CT_COMMENT)
+			load_plugin_commands(plugin_names);
 		process_command_ext(info, persistent, cfo, &content[0]);
 		// process_command_ext((token&)(lines[i]), false, persistent, cfo, &content[0]);
 	}
+	load_plugin_commands(plugin_names);
 	return true;
 }
 
@@ -819,6 +997,40 @@ test_registration::test_registration(const std::string& _test_name, bool (*_test
 	register_object(base_ptr(new test(_test_name, _test_func)), "");
 }
 
+benchmark_state::benchmark_state(unsigned _nr_warm_up_repetitions, unsigned _nr_repetitions)
+	: nr_warm_up_repetitions(_nr_warm_up_repetitions), nr_repetitions(_nr_repetitions), work_per_repetition(0)
+{
+}
+
+void benchmark_state::set_work(double amount, const std::string& unit)
+{
+	work_per_repetition = amount;
+	work_unit = unit;
+}
+
+benchmark::benchmark(const std::string& _benchmark_name, bool (*_benchmark_func)(benchmark_state&))
+	: benchmark_name(_benchmark_name), benchmark_func(_benchmark_func) {}
+
+std::string benchmark::get_benchmark_name() const
+{
+	return benchmark_name;
+}
+
+bool benchmark::exec_benchmark(benchmark_state& state) const
+{
+	return benchmark_func(state);
+}
+
+std::string benchmark::get_type_name() const
+{
+	return "benchmark";
+}
+
+benchmark_registration::benchmark_registration(const std::string& _benchmark_name, bool (*_benchmark_func)(benchmark_state&))
+{
+	register_object(base_ptr(new benchmark(_benchmark_name, _benchmark_func)), "");
+}
+
 /// construct
 factory::factory(const std::string& _created_type_name, bool _singleton, const std::string& _object_options)
 	: created_type_name(_created_type_name), is_singleton(_singleton), object_options(_object_options)
@@ -1007,6 +1219,10 @@ CommandType analyze_command(const cgv::utils::token& cmd, bool eliminate_quotes,
 	// detect predefined commands
 	if (cmd_tok == "show all")
 		return update_info(info_ptr, CT_SHOW);
+	if (cmd_tok == "show plugins") {
+		token what_tok(cmd_tok.begin + 5, cmd_tok.end);
+		return update_info(info_ptr, CT_SHOW, &what_tok);
+	}
 	if (cmd_tok == "persistent")
 		return update_info(info_ptr, CT_PERSISTENT);
 	if (cmd_tok == "initial")
@@ -1037,6 +1253,8 @@ CommandType analyze_command(const cgv::utils::token& cmd, bool eliminate_quotes,
 		return update_info(info_ptr, CT_CONFIG, &args_tok);
 	if (cmd_header == "gui")
 		return update_info(info_ptr, CT_GUI, &args_tok);
+	if (cmd_header == "lazy")
+		return update_info(info_ptr, CT_LAZY, &args_tok);
 
 	// split composed commands into head and argument
 	std::vector<token> toks;
@@ -1057,7 +1275,10 @@ bool process_command_ext(const command_info& info, bool* persistent, config_file
 {
 	switch (info.command_type) {
 	case CT_SHOW:
-		show_all();
+		if (!info.parameters.empty() && info.parameters[0] == "plugins")
+			show_plugin_load_report();
+		else
+			show_all();
 		return true;
 	case CT_PERSISTENT:
 		if (persistent)
@@ -1090,6 +1311,9 @@ bool process_command_ext(const command_info& info, bool* persistent, config_file
 		}
 		std::cerr << "error reading gui file " << info.parameters[0] << std::endl;
 		return false;
+	case CT_LAZY:
+		define_lazy_construction(to_string(info.parameters[0]));
+		return true;
 	case CT_NAME:
 	case CT_TYPE: {
 		base_ptr bp;
@@ -1396,50 +1620,105 @@ void record_error_platform(const std::string& dll_name, std::vector<std::string>
 #endif
 }
 
+/// determine the two candidate file names of a plugin in the order in which loading is tried
+void get_plugin_file_names(const std::string& plugin_name, std::string fn[2])
+{
+	fn[0] = plugin_name;
+	fn[1] = extend_plugin_name(fn[0]);
+#ifdef WIN32
+	if (cgv::utils::to_lower(cgv::utils::file::get_extension(fn[0]) != "dll"))
+		fn[0] += ".dll";
+#elif __APPLE__
+	if (cgv::utils::to_lower(cgv::utils::file::get_extension(fn[0]) != "dylib"))
+		fn[0] = std::string("lib") + fn[0] + ".dylib";
+#else
+	if (cgv::utils::to_lower(cgv::utils::file::get_extension(fn[0]) != "so"))
+		fn[0] = std::string("lib") + fn[0] + ".so";
+#endif
+#ifndef NDEBUG
+	std::swap(fn[0], fn[1]);
+#endif
+}
+
+/// read the files of the plugins given in file_name into the file system cache, looking in the library search path
+void prefetch_plugin_files(const std::string& file_name)
+{
+	std::vector<std::string> dirs = { "", ref_prog_path_prefix() };
+#ifdef _WIN32
+	const char* search_path = getenv("PATH");
+	const char* path_separators = ";";
+#else
+	const char* search_path = getenv("LD_LIBRARY_PATH");
+	const char* path_separators = ":";
+#endif
+	if (search_path) {
+		std::vector<token> toks;
+		bite_all(tokenizer(search_path).set_ws(path_separators), toks);
+		for (auto t : toks)
+			dirs.push_back(to_string(t) + "/");
+	}
+	std::vector<token> names;
+	bite_all(tokenizer(file_name).set_ws(",|;"), names);
+	std::vector<char> buffer(1 << 20);
+	for (auto& plugin_name : names) {
+		std::string fn[2];
+		get_plugin_file_names(to_string(plugin_name), fn);
+		for (unsigned i = 0; i < 2 * dirs.size(); ++i) {
+			FILE* fp = fopen((dirs[i / 2] + fn[i % 2]).c_str(), "rb");
+			if (!fp)
+				continue;
+			while (fread(buffer.data(), 1, buffer.size(), fp) == buffer.size())
+				;
+			fclose(fp);
+			break;
+		}
+	}
+}
+
 void* load_plugin(const std::string& file_name)
 {
+	typedef std::chrono::steady_clock clock;
+	plugin_load_info info;
+	info.name = file_name;
+
 	std::vector<token> names;
 	bite_all(tokenizer(file_name).set_ws(",|;"), names);
 
 	bool enabled = is_registration_enabled();
 	if (enabled)
 		disable_registration();
+	size_t nr_events = ref_registration_events().size();
 
 	void* result = nullptr;
 	std::vector<std::string> errors = {};
+	auto start = clock::now();
 	for (auto& plugin_name : names) {
 		std::string fn[2];
-		fn[0] = to_string(plugin_name);
-		fn[1] = extend_plugin_name(fn[0]);
-#ifdef WIN32
-		if (cgv::utils::to_lower(cgv::utils::file::get_extension(fn[0]) != "dll"))
-			fn[0] += ".dll";
-#elif __APPLE__
-		if (cgv::utils::to_lower(cgv::utils::file::get_extension(fn[0]) != "dylib"))
-			fn[0] = std::string("lib") + fn[0] + ".dylib";
-#else
-		if (cgv::utils::to_lower(cgv::utils::file::get_extension(fn[0]) != "so"))
-			fn[0] = std::string("lib") + fn[0] + ".so";
-#endif
-#ifndef NDEBUG
-		std::swap(fn[0], fn[1]);
-#endif
+		get_plugin_file_names(to_string(plugin_name), fn);
 
 		result = nullptr;
 		for (auto& dll_name : fn) {
 			ref_plugin_name() = dll_name;
 			result = load_plugin_platform(dll_name);
 			if (result) {
+				if (!info.file_name.empty())
+					info.file_name += ";";
+				info.file_name += dll_name;
 				break;
 			}
 
 			record_error_platform(dll_name, errors);
 		}
 	}
+	info.load_time = std::chrono::duration<double>(clock::now() - start).count();
+	info.nr_registration_events = unsigned(ref_registration_events().size() - std::min(nr_events, ref_registration_events().size()));
 
+	start = clock::now();
 	if (enabled)
 		enable_registration();
 	ref_plugin_name().clear();
+	info.registration_time = std::chrono::duration<double>(clock::now() - start).count();
+	ref_plugin_load_infos().push_back(info);
 
 	if (result == nullptr && !errors.empty()) {
 		std::cerr << "failed to load plugin " << file_name << std::endl;
@@ -1451,8 +1730,98 @@ void* load_plugin(const std::string& file_name)
 	return result;
 }
 
+std::vector<void*> load_plugins(const std::vector<std::string>& file_names)
+{
+	typedef std::chrono::steady_clock clock;
+	size_t n = file_names.size();
+	std::vector<double> prefetch_times(n, 0.0);
+	// index of the next plugin to be prefetched, which the loading thread advances past the plugin it loads
+	std::atomic<size_t> next_prefetch(1);
+	std::vector<std::thread> threads;
+	if (is_concurrent_plugin_loading_enabled() && n > 1) {
+		size_t nr_threads = std::min(n - 1, size_t(std::max(std::thread::hardware_concurrency(), 2u)));
+		for (size_t t = 0; t < nr_threads; ++t)
+			threads.push_back(std::thread([&]() {
+				for (size_t i = next_prefetch++; i < n; i = next_prefetch++) {
+					auto start = clock::now();
+					prefetch_plugin_files(file_names[i]);
+					prefetch_times[i] = std::chrono::duration<double>(clock::now() - start).count();
+				}
+			}));
+	}
+	std::vector<void*> handles;
+	// plugins can load further plugins during their initialization, such that the info of each plugin is found behind the infos of the plugins loaded by it
+	std::vector<size_t> info_indices;
+	for (size_t i = 0; i < n; ++i) {
+		size_t expected = next_prefetch.load();
+		while (expected <= i && !next_prefetch.compare_exchange_weak(expected, i + 1))
+			;
+		handles.push_back(load_plugin(file_names[i]));
+		info_indices.push_back(ref_plugin_load_infos().size() - 1);
+	}
+	next_prefetch = n;
+	for (auto& t : threads)
+		t.join();
+	for (size_t i = 0; i < n; ++i)
+		ref_plugin_load_infos()[info_indices[i]].prefetch_time = prefetch_times[i];
+	return handles;
+}
+
+void enable_concurrent_plugin_loading()
+{
+	ref_concurrent_plugin_loading_enabled() = true;
+}
+
+void disable_concurrent_plugin_loading()
+{
+	ref_concurrent_plugin_loading_enabled() = false;
+}
+
+bool is_concurrent_plugin_loading_enabled()
+{
+	return ref_concurrent_plugin_loading_enabled();
+}
+
+const std::vector<plugin_load_info>& get_plugin_load_infos()
+{
+	return ref_plugin_load_infos();
+}
+
+void show_plugin_load_report()
+{
+	const std::vector<plugin_load_info>& infos = ref_plugin_load_infos();
+	size_t width = 6;
+	for (const auto& info : infos)
+		width = std::max(width, info.name.size());
+	double total[3] = { 0, 0, 0 };
+	std::cout << "\n\n_______________ plugin load report (times in ms) _________________\n\n";
+	std::cout << std::left << std::setw(int(width)) << "plugin" << std::right << std::setw(10) << "prefetch"
+			  << std::setw(10) << "load" << std::setw(10) << "register" << std::setw(8) << "events" << "\n";
+	std::cout << std::fixed << std::setprecision(1);
+	for (const auto& info : infos) {
+		std::cout << std::left << std::setw(int(width)) << info.name << std::right << std::setw(10)
+				  << 1000 * info.prefetch_time << std::setw(10) << 1000 * info.load_time << std::setw(10)
+				  << 1000 * info.registration_time << std::setw(8) << info.nr_registration_events;
+		if (info.file_name.empty())
+			std::cout << "  failed";
+		std::cout << "\n";
+		total[0] += info.prefetch_time;
+		total[1] += info.load_time;
+		total[2] += info.registration_time;
+	}
+	std::cout << std::left << std::setw(int(width)) << "total" << std::right << std::setw(10) << 1000 * total[0]
+			  << std::setw(10) << 1000 * total[1] << std::setw(10) << 1000 * total[2] << "\n";
+	if (get_nr_lazy_objects() > 0)
+		std::cout << get_nr_lazy_objects() << " objects are not constructed yet\n";
+	std::cout.unsetf(std::ios::floatfield);
+	std::cout << std::setprecision(6);
+	std::cout << "__________________________________________________________________\n" << std::endl;
+}
+
 bool unload_plugin(void* handle)
 {
+	// cached member offsets can belong to types of the unloaded plugin
+	cgv::reflect::reflection_cache::clear_all();
 #ifdef _WIN32
 	return FreeLibrary((HMODULE)handle) != 0;
 #else
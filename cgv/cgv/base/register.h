@@ -7,6 +7,8 @@
 #include <string>
 #include <iostream>
 #include <map>
+#include <vector>
+#include <chrono>
 
 #include "lib_begin.h"
 
@@ -49,6 +51,30 @@ struct CGV_API registration_order_definition
 	registration_order_definition(const std::string& partial_order, bool before_contructor_execution = false, const std::string& when = "always");
 };
 
+//! defer construction of objects of the given types until they are first needed
+/*! \c type_names is a semicolon separated list of type names, which match with or without name spaces. Objects
+    of these types that are registered while registration is disabled, as it is the case for objects registered by
+	static constructors of plugins, are not constructed when registration is enabled. Instead they are constructed
+	and registered when they are looked up with find_object_by_type() or find_object_by_name(), when the permanently
+	registered objects are accessed, or when construct_lazy_objects() is called. Therefore only objects that are not
+	needed by registration listeners should be constructed lazily, for example no drivers or servers. A type name can
+	be followed by the name of its object in parentheses, as in "type(name)". Otherwise the name is only known after
+	construction and an unsuccessful find_object_by_name() constructs all objects of this type. The same definition
+	is made with the command "lazy:type_1;type_2(name)" in config files or on the command line, where it needs to
+	precede the plugins that register the objects. */
+extern void CGV_API define_lazy_construction(const std::string& type_names);
+
+/// helper class whose constructor calls the \c define_lazy_construction() function
+struct CGV_API lazy_construction_definition
+{
+	lazy_construction_definition(const std::string& type_names);
+};
+
+/// construct and register lazily constructed objects of the given type or all of them if type_name is empty
+extern void CGV_API construct_lazy_objects(const std::string& type_name = "");
+/// return the number of objects whose construction has been deferred
+extern unsigned CGV_API get_nr_lazy_objects();
+
 /// enable registration debugging
 extern void CGV_API enable_registration_debugging();
 /// disable registration debugging
@@ -408,6 +434,68 @@ struct CGV_API test_registration
 };
 //@}
 
+/**@name benchmark registration */
+//@{
+/// state of a benchmark execution that is passed to the benchmark function
+class CGV_API benchmark_state
+{
+public:
+	/// number of untimed repetitions executed before measurement
+	unsigned nr_warm_up_repetitions;
+	/// number of timed repetitions
+	unsigned nr_repetitions;
+	/// durations of the timed repetitions in seconds
+	std::vector<double> durations;
+	/// amount of work done in one repetition, which is used to report throughput
+	double work_per_repetition;
+	/// unit of work, e.g. "points" or "bytes"
+	std::string work_unit;
+	/// construct state with given repetition counts
+	benchmark_state(unsigned _nr_warm_up_repetitions = 1, unsigned _nr_repetitions = 10);
+	/// set amount of work per repetition and its unit
+	void set_work(double amount, const std::string& unit);
+	/// call f for warm-up and then time each of the repetitions, where set up should be done before calling measure
+	template <typename F>
+	void measure(F f)
+	{
+		for (unsigned i = 0; i < nr_warm_up_repetitions; ++i)
+			f();
+		durations.clear();
+		for (unsigned i = 0; i < nr_repetitions; ++i) {
+			auto start = std::chrono::steady_clock::now();
+			f();
+			durations.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+	}
+};
+
+/// structure used to register a benchmark function that sets up its data, calls benchmark_state::measure() and returns whether it could be executed
+class CGV_API benchmark : public base
+{
+protected:
+	/// name of benchmark
+	std::string benchmark_name;
+	/// pointer to benchmark function
+	bool (*benchmark_func)(benchmark_state&);
+public:
+	/// constructor for a benchmark structure
+	benchmark(const std::string& _benchmark_name, bool (*_benchmark_func)(benchmark_state&));
+	/// implementation of the type name function of the base class
+	std::string get_type_name() const;
+	/// access to name of benchmark
+	std::string get_benchmark_name() const;
+	/// execute benchmark and return whether this was successful
+	bool exec_benchmark(benchmark_state& state) const;
+};
+
+/// declare an instance of benchmark_registration as static variable in order to register a benchmark function in a test plugin
+struct CGV_API benchmark_registration
+{
+	/// the constructor creates a benchmark structure and registeres it
+	benchmark_registration(const std::string& _benchmark_name, bool (*_benchmark_func)(benchmark_state&));
+};
+//@}
+
 
 
 
@@ -471,14 +559,15 @@ enum CommandType
 	CT_UNKNOWN,    // command is not known to framework
 	CT_EMPTY,      // command specification was empty
 	CT_COMMENT,    // a comment was given starting with '/'
-	CT_SHOW,       // a show command was specified, currently only show all is supported
+	CT_SHOW,       // a show command was specified, which is "show all" or "show plugins"
 	CT_PERSISTENT, // the persistent command means that all successive value set commands in a config file should be updated during execution when the user changes one of them
 	CT_INITIAL,    // reverts a persistent command
 	CT_PLUGIN,     // loads a plugin
 	CT_CONFIG,     // executes a config file
 	CT_GUI,        // loads a gui description file
 	CT_NAME,       // sets a value of a registered object of the given name
-	CT_TYPE        // sets a value of a registered object of the given type
+	CT_TYPE,       // sets a value of a registered object of the given type
+	CT_LAZY        // defers construction of objects of the given types
 };
 
 /// a structure to store an analized command
@@ -486,7 +575,7 @@ struct command_info
 {
 	/// the command type
 	CommandType command_type;
-	/// the parameters, one file name parameter for PLUGIN, CONFIG, GUI and two parameters (name/type, declarations) for NAME or TYPE commands
+	/// the parameters, one file name parameter for PLUGIN, CONFIG, GUI, one type list for LAZY and two parameters (name/type, declarations) for NAME or TYPE commands
 	std::vector<cgv::utils::token> parameters;
 };
 
@@ -508,9 +597,11 @@ extern bool CGV_API process_command(const command_info& info);
 
 	The following commands are supported:
 	- show all                   ... print out information on all registered objects
+	- show plugins               ... print out timings of all loaded plugins
 	- plugin:file_name           ... read a plugin
 	- config:file_name           ... read a config file
 	- gui:file_name              ... read a gui description file
+	- lazy:type_1;type_2(name)   ... defer construction of objects of the given types, see define_lazy_construction()
 	- name(xxx):assignment list  ... find registered object by name xxx and process assignments on them
 	- type(yyy):assignment list  ... find registered object by type yyy and process assignments on them
 
@@ -583,6 +674,40 @@ extern CGV_API void* load_plugin(const std::string& file_name);
 extern CGV_API std::string& ref_plugin_name();
 /// unload the plugin with the given handle
 extern CGV_API bool unload_plugin(void* handle);
+//! load several plugins and return their handles, which are 0 for plugins that could not be loaded.
+/*! The plugins are loaded in the given order with the same registration events and registration orders as
+    sequential calls to load_plugin(). If concurrent plugin loading is enabled, the plugin files are located and
+	read into the file system cache by worker threads in the mean time, which hides most of the i/o of plugins
+	that are loaded later. Dynamic loaders execute the static constructors of libraries under a global lock,
+	such that this part is not done concurrently. */
+extern CGV_API std::vector<void*> load_plugins(const std::vector<std::string>& file_names);
+/// enable concurrent reading of plugin files in load_plugins (default)
+extern CGV_API void enable_concurrent_plugin_loading();
+/// disable concurrent reading of plugin files in load_plugins
+extern CGV_API void disable_concurrent_plugin_loading();
+/// check whether concurrent plugin loading is enabled
+extern CGV_API bool is_concurrent_plugin_loading_enabled();
+
+/// information recorded for each plugin loaded with load_plugin() or load_plugins()
+struct plugin_load_info
+{
+	/// plugin name as passed to load_plugin
+	std::string name;
+	/// file name of the loaded library or empty if loading failed
+	std::string file_name;
+	/// seconds spent by a worker thread to read the plugin file in advance
+	double prefetch_time = 0;
+	/// seconds spent to load the library including the static constructors
+	double load_time = 0;
+	/// seconds spent to construct and register the objects registered by the plugin
+	double registration_time = 0;
+	/// number of registration events emitted by the plugin
+	unsigned nr_registration_events = 0;
+};
+/// return information on all loaded plugins in the order of loading
+extern CGV_API const std::vector<plugin_load_info>& get_plugin_load_infos();
+/// print a table with the timings of all loaded plugins, which is also done by the command "show plugins"
+extern CGV_API void show_plugin_load_report();
 //@}
 
 
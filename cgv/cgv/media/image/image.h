@@ -3,6 +3,8 @@
 #include <algorithm>
 #include "image_reader.h"
 #include "image_writer.h"
+#include "wavelet_codec.h"
+#include "image_resampler.h"
 #include <cgv/math/functions.h>
 
 #include "lib_begin.h"
@@ -40,6 +42,18 @@ namespace cgv {
 					}
 					return false;
 				}
+				/// read image from a wavelet stream file, where skipped levels reduce the resolution by a factor of two each for fast previews
+				bool read_wavelet(const std::string& file_name, unsigned nr_skipped_levels = 0, const wavelet_codec_config& config = wavelet_codec_config())
+				{
+					wavelet_codec codec(config);
+					return codec.read(file_name, *this, dv, nr_skipped_levels);
+				}
+				/// write image to a wavelet stream file
+				bool write_wavelet(const std::string& file_name, const wavelet_codec_config& config = wavelet_codec_config())
+				{
+					wavelet_codec codec(config);
+					return codec.write(file_name, dv);
+				}
 				void hflip()
 				{
 					// swap order of rows
@@ -224,6 +238,43 @@ namespace cgv {
 						}
 					}
 				}
+				/// construct a resampled version of given image with the separable filter based resampler, falls back to resize for unsupported formats
+				void resample(unsigned size_x, unsigned size_y, const image& I, ResamplingFilter filter = RF_BILINEAR, unsigned nr_threads = 0)
+				{
+					if (!is_resampling_supported(I)) {
+						resize(size_x, size_y, I);
+						return;
+					}
+					// copy format and set target dimensions
+					*static_cast<cgv::data::data_format*>(this) = I;
+					set_width(size_x);
+					set_height(size_y);
+
+					// allocate data
+					new(&dv) cgv::data::data_view(this);
+
+					resample_image(cgv::data::const_data_view(&I, I.get_ptr<void>()), dv, filter, nr_threads);
+				}
+				/// compute a mipmap pyramid whose first level is a copy of this image and each further level halves the resolution down to 1x1
+				void compute_mipmaps(std::vector<image>& levels, ResamplingFilter filter = RF_BOX, unsigned nr_threads = 0) const
+				{
+					unsigned w = (unsigned)get_width();
+					unsigned h = (unsigned)get_height();
+					unsigned n = 1;
+					while (w > 1 || h > 1) {
+						w = std::max(w / 2, 1u);
+						h = std::max(h / 2, 1u);
+						++n;
+					}
+					// construct all levels before filling them such that the views never refer to moved formats
+					levels.clear();
+					levels.resize(n);
+					levels[0].copy(*this);
+					for (unsigned i = 1; i < n; ++i) {
+						const image& prev = levels[i - 1];
+						levels[i].resample(std::max((unsigned)prev.get_width() / 2, 1u), std::max((unsigned)prev.get_height() / 2, 1u), prev, filter, nr_threads);
+					}
+				}
 				/// construct a resized version of given image using the down- and upscale methods
 				void resize(unsigned size_x, unsigned size_y, const image& I)
 				{
@@ -0,0 +1,146 @@
+#include "image_batch_reader.h"
+#include "image_reader.h"
+#include <algorithm>
+
+using namespace cgv::data;
+
+namespace cgv {
+	namespace media {
+		namespace image {
+
+image_batch_reader::image_batch_reader(unsigned _nr_threads, size_t _memory_budget)
+	: nr_threads(_nr_threads), memory_budget(_memory_budget), target_views(0),
+	  next_file(0), next_to_report(0), nr_bytes_in_flight(0), nr_succeeded(0), cancelled(false)
+{
+	if (nr_threads == 0)
+		nr_threads = std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+image_batch_reader::~image_batch_reader()
+{
+	wait();
+}
+
+bool image_batch_reader::start(const std::vector<std::string>& _file_names, callback_type _callback, std::vector<data_view>* _target_views)
+{
+	if (is_running())
+		return false;
+	if (_target_views && _target_views->size() < _file_names.size())
+		return false;
+	file_names = _file_names;
+	callback = _callback;
+	target_views = _target_views;
+	states.clear();
+	states.resize(file_names.size());
+	for (auto& s : states) {
+		s.nr_bytes = 0;
+		s.done = s.success = false;
+	}
+	next_file = next_to_report = nr_bytes_in_flight = nr_succeeded = 0;
+	cancelled = false;
+	unsigned n = (unsigned)std::min(size_t(nr_threads), file_names.size());
+	for (unsigned i = 0; i < n; ++i)
+		workers.push_back(std::thread(&image_batch_reader::work, this));
+	return true;
+}
+
+void image_batch_reader::cancel()
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	cancelled = true;
+	memory_cv.notify_all();
+}
+
+size_t image_batch_reader::wait()
+{
+	for (auto& w : workers)
+		w.join();
+	workers.clear();
+	return nr_succeeded;
+}
+
+size_t image_batch_reader::read_images(const std::vector<std::string>& _file_names, callback_type _callback, std::vector<data_view>* _target_views)
+{
+	if (!start(_file_names, _callback, _target_views))
+		return 0;
+	return wait();
+}
+
+bool image_batch_reader::decode(size_t idx)
+{
+	file_state& s = states[idx];
+	image_reader ir(s.format);
+	if (!ir.open(file_names[idx]))
+		return false;
+	bool success;
+	if (target_views) {
+		const data_view& dv = (*target_views)[idx];
+		const data_format* df = dv.get_format();
+		if (dv.empty() || !df || df->get_width() != s.format.get_width() || df->get_height() != s.format.get_height() ||
+			df->get_component_format() != s.format.get_component_format())
+			success = false;
+		else
+			success = ir.read_image(dv);
+	}
+	else {
+		// wait until the image fits into the memory budget, the next image to be reported is always decoded to ensure progress
+		s.nr_bytes = s.format.get_nr_bytes();
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			memory_cv.wait(lock, [&]() { return idx == next_to_report || nr_bytes_in_flight + s.nr_bytes <= memory_budget || cancelled; });
+			nr_bytes_in_flight += s.nr_bytes;
+		}
+		s.dv = data_view(&s.format);
+		success = ir.read_image(static_cast<const data_view&>(s.dv));
+	}
+	ir.close();
+	return success;
+}
+
+void image_batch_reader::finish(size_t idx, bool success)
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		states[idx].done = true;
+		states[idx].success = success;
+	}
+	// report all consecutive finished files, the thread that finishes the next file to be reported drains the queue
+	std::lock_guard<std::mutex> report_lock(report_mtx);
+	while (true) {
+		size_t i;
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			if (next_to_report >= states.size() || !states[next_to_report].done)
+				return;
+			i = next_to_report;
+		}
+		file_state& s = states[i];
+		if (s.success)
+			++nr_succeeded;
+		if (callback)
+			callback(i, s.success, target_views ? (*target_views)[i] : s.dv);
+		s.dv = data_view();
+		std::lock_guard<std::mutex> lock(mtx);
+		nr_bytes_in_flight -= s.nr_bytes;
+		++next_to_report;
+		memory_cv.notify_all();
+	}
+}
+
+void image_batch_reader::work()
+{
+	while (true) {
+		size_t idx;
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			if (cancelled || next_file >= file_names.size())
+				return;
+			idx = next_file++;
+		}
+		finish(idx, decode(idx));
+	}
+}
+
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cgv/data/data_view.h>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace media {
+		namespace image {
+
+/** decodes batches of image files concurrently on a pool of worker threads through the
+    registered image reader drivers. Images are either decoded into preallocated data
+	views, for example the slices of a volume, or into views allocated by the batch reader
+	that are released after the completion callback returned. In the latter case the memory
+	of decoded images that are not yet reported is bounded by the memory budget. Completion
+	callbacks are serialized and called in the order of the file names from worker threads. */
+class CGV_API image_batch_reader
+{
+public:
+	/// type of completion callback receiving index of file, whether decoding succeeded and the view holding the image
+	typedef std::function<void(size_t idx, bool success, const cgv::data::data_view& dv)> callback_type;
+protected:
+	/// per file decoding state
+	struct file_state
+	{
+		cgv::data::data_format format;
+		cgv::data::data_view dv;
+		size_t nr_bytes;
+		bool done;
+		bool success;
+	};
+	unsigned nr_threads;
+	size_t memory_budget;
+	std::vector<std::string> file_names;
+	std::vector<cgv::data::data_view>* target_views;
+	callback_type callback;
+	std::vector<file_state> states;
+	/** own threads instead of tasks of the cgv::os::task_scheduler, as the workers block in file i/o and while waiting
+	    for the memory budget, which would stall the compute workers shared with parallel_for and task_group */
+	std::vector<std::thread> workers;
+	/// protects the scheduling state
+	std::mutex mtx;
+	/// serializes the ordered completion callbacks
+	std::mutex report_mtx;
+	std::condition_variable memory_cv;
+	size_t next_file;
+	size_t next_to_report;
+	size_t nr_bytes_in_flight;
+	size_t nr_succeeded;
+	bool cancelled;
+	/// decode one file into a preallocated or newly allocated view
+	bool decode(size_t idx);
+	/// mark file as done and report all consecutive finished files
+	void finish(size_t idx, bool success);
+	/// worker thread main loop
+	void work();
+public:
+	/// construct with given number of threads (0 uses all hardware threads) and budget in bytes for images allocated by the reader
+	image_batch_reader(unsigned _nr_threads = 0, size_t _memory_budget = size_t(256) << 20);
+	/// wait for the running batch
+	~image_batch_reader();
+	//! start decoding the given files asynchronously
+	/*! If target views are given, the vector needs to contain one allocated view per file whose format matches the
+	    image file and it must stay valid until wait() returns. As data_view deep copies on copy construction, construct
+		the views in place with emplace_back. Returns false if a batch is already running. */
+	bool start(const std::vector<std::string>& _file_names, callback_type _callback, std::vector<cgv::data::data_view>* _target_views = 0);
+	/// return whether a batch has been started and not been waited for
+	bool is_running() const { return !workers.empty(); }
+	/// stop handing out further files, which will not be reported
+	void cancel();
+	/// wait for the running batch to finish and return the number of successfully decoded files
+	size_t wait();
+	/// convenience function that starts a batch and waits for it
+	size_t read_images(const std::vector<std::string>& _file_names, callback_type _callback, std::vector<cgv::data::data_view>* _target_views = 0);
+};
+
+		}
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -80,7 +80,12 @@ public:
 		paletted image formats to non paletted ones. In case palettes are used, the components in the file_format
 		will be '0', '1', ... for the components that reference the i-th palette. */
 	image_reader(cgv::data::data_format& file_format, std::vector<cgv::data::data_format>* palette_formats = 0);
-	~image_reader() {}
+	/// destruct the chosen reader
+	~image_reader();
+	/// readers own the chosen reader and cannot be copied
+	image_reader(const image_reader&) = delete;
+	/// readers own the chosen reader and cannot be assigned
+	image_reader& operator = (const image_reader&) = delete;
 	/// overload to return the type name of this object
 	std::string get_type_name() const;
 	/// return a string with a list of supported extensions, where the list entries are separated with the passed character that defaults to a semicolon
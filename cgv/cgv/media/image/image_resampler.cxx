@@ -0,0 +1,276 @@
+#include "image_resampler.h"
+#include <cgv/os/task_scheduler.h>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CGV_RESAMPLE_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__AVX__)
+#define CGV_RESAMPLE_AVX
+#include <immintrin.h>
+#endif
+
+using namespace cgv::data;
+using namespace cgv::type::info;
+
+namespace cgv {
+	namespace media {
+		namespace image {
+
+namespace {
+
+float sinc(float x)
+{
+	if (std::abs(x) < 1e-6f)
+		return 1.0f;
+	x *= 3.14159265358979f;
+	return std::sin(x) / x;
+}
+
+/// zeroth order modified bessel function of the first kind used by the kaiser window
+double bessel_i0(double x)
+{
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; ++k) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+		if (term < 1e-12 * sum)
+			break;
+	}
+	return sum;
+}
+
+float get_filter_radius(ResamplingFilter filter)
+{
+	switch (filter) {
+	case RF_BOX: return 0.5f;
+	case RF_BILINEAR: return 1.0f;
+	default: return 3.0f;
+	}
+}
+
+float evaluate_filter(ResamplingFilter filter, float x)
+{
+	x = std::abs(x);
+	switch (filter) {
+	case RF_BOX:
+		return x <= 0.5f ? 1.0f : 0.0f;
+	case RF_BILINEAR:
+		return x < 1.0f ? 1.0f - x : 0.0f;
+	case RF_LANCZOS:
+		return x < 3.0f ? sinc(x) * sinc(x / 3.0f) : 0.0f;
+	default: {
+		if (x >= 3.0f)
+			return 0.0f;
+		const double alpha = 4.0;
+		double t = x / 3.0;
+		return float(sinc(x) * bessel_i0(alpha * std::sqrt(1.0 - t * t)) / bessel_i0(alpha));
+	}
+	}
+}
+
+/// precomputed source indices and weights contributing to each target sample along one axis
+struct contribution_table
+{
+	std::vector<uint32_t> begin;
+	std::vector<int32_t> index;
+	std::vector<float> weight;
+
+	void build(size_t src_n, size_t dst_n, ResamplingFilter filter)
+	{
+		float scale = float(src_n) / float(dst_n);
+		float filter_scale = std::max(scale, 1.0f);
+		float support = get_filter_radius(filter) * filter_scale;
+		begin.resize(dst_n + 1);
+		index.clear();
+		weight.clear();
+		for (size_t i = 0; i < dst_n; ++i) {
+			begin[i] = uint32_t(index.size());
+			float center = (i + 0.5f) * scale - 0.5f;
+			int left = int(std::ceil(center - support));
+			int right = int(std::floor(center + support));
+			float sum = 0.0f;
+			for (int j = left; j <= right; ++j) {
+				float w = evaluate_filter(filter, (j - center) / filter_scale);
+				if (w == 0.0f)
+					continue;
+				index.push_back(std::min(std::max(j, 0), int(src_n) - 1));
+				weight.push_back(w);
+				sum += w;
+			}
+			// fall back to nearest sample if no tap has been hit
+			if (index.size() == begin[i]) {
+				index.push_back(std::min(std::max(int(std::floor(center + 0.5f)), 0), int(src_n) - 1));
+				weight.push_back(1.0f);
+				sum = 1.0f;
+			}
+			for (size_t k = begin[i]; k < index.size(); ++k)
+				weight[k] /= sum;
+		}
+		begin[dst_n] = uint32_t(index.size());
+	}
+};
+
+inline float to_float(uint8_t v) { return float(v); }
+inline float to_float(float v) { return v; }
+
+/// filter one source row horizontally into a row of floats with nr_components floats per target pixel
+template <typename T>
+void filter_row(const T* src, float* dst, const contribution_table& ct, size_t dst_w, unsigned nr_components)
+{
+#ifdef CGV_RESAMPLE_SSE2
+	if (nr_components == 4) {
+		for (size_t x = 0; x < dst_w; ++x) {
+			__m128 acc = _mm_setzero_ps();
+			for (uint32_t k = ct.begin[x]; k < ct.begin[x + 1]; ++k) {
+				const T* p = src + 4 * size_t(ct.index[k]);
+				__m128 v;
+				if (sizeof(T) == 1) {
+					int32_t packed;
+					std::memcpy(&packed, p, 4);
+					__m128i zero = _mm_setzero_si128();
+					__m128i bytes = _mm_cvtsi32_si128(packed);
+					v = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+				}
+				else
+					v = _mm_loadu_ps(reinterpret_cast<const float*>(p));
+				acc = _mm_add_ps(acc, _mm_mul_ps(v, _mm_set1_ps(ct.weight[k])));
+			}
+			_mm_storeu_ps(dst + 4 * x, acc);
+		}
+		return;
+	}
+#endif
+	for (size_t x = 0; x < dst_w; ++x) {
+		float acc[4] = { 0, 0, 0, 0 };
+		for (uint32_t k = ct.begin[x]; k < ct.begin[x + 1]; ++k) {
+			const T* p = src + nr_components * size_t(ct.index[k]);
+			float w = ct.weight[k];
+			for (unsigned c = 0; c < nr_components; ++c)
+				acc[c] += w * to_float(p[c]);
+		}
+		for (unsigned c = 0; c < nr_components; ++c)
+			dst[nr_components * x + c] = acc[c];
+	}
+}
+
+/// accumulate a weighted source row of floats onto the accumulation row
+void accumulate_row(float* acc, const float* src, float w, size_t n)
+{
+	size_t i = 0;
+#if defined(CGV_RESAMPLE_AVX)
+	__m256 w8 = _mm256_set1_ps(w);
+	for (; i + 8 <= n; i += 8)
+		_mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), w8)));
+#elif defined(CGV_RESAMPLE_SSE2)
+	__m128 w4 = _mm_set1_ps(w);
+	for (; i + 4 <= n; i += 4)
+		_mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(_mm_loadu_ps(src + i), w4)));
+#endif
+	for (; i < n; ++i)
+		acc[i] += w * src[i];
+}
+
+void store_row(const float* acc, float* dst, size_t n)
+{
+	std::copy(acc, acc + n, dst);
+}
+
+void store_row(const float* acc, uint8_t* dst, size_t n)
+{
+	size_t i = 0;
+#ifdef CGV_RESAMPLE_SSE2
+	for (; i + 16 <= n; i += 16) {
+		__m128i a = _mm_cvtps_epi32(_mm_loadu_ps(acc + i));
+		__m128i b = _mm_cvtps_epi32(_mm_loadu_ps(acc + i + 4));
+		__m128i c = _mm_cvtps_epi32(_mm_loadu_ps(acc + i + 8));
+		__m128i d = _mm_cvtps_epi32(_mm_loadu_ps(acc + i + 12));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+	}
+#endif
+	for (; i < n; ++i)
+		dst[i] = uint8_t(std::min(std::max(std::lround(acc[i]), 0l), 255l));
+}
+
+template <typename T>
+void resample_band(const T* src, T* dst, size_t src_w, size_t dst_w, unsigned nr_components,
+				   const contribution_table& ct_x, const contribution_table& ct_y, size_t y_begin, size_t y_end)
+{
+	// determine range of source rows needed for the band and filter them horizontally
+	int32_t row_begin = ct_y.index[ct_y.begin[y_begin]], row_end = row_begin;
+	for (uint32_t k = ct_y.begin[y_begin]; k < ct_y.begin[y_end]; ++k) {
+		row_begin = std::min(row_begin, ct_y.index[k]);
+		row_end = std::max(row_end, ct_y.index[k]);
+	}
+	size_t row_size = dst_w * nr_components;
+	std::vector<float> rows((row_end - row_begin + 1) * row_size);
+	for (int32_t y = row_begin; y <= row_end; ++y)
+		filter_row(src + size_t(y) * src_w * nr_components, &rows[(y - row_begin) * row_size], ct_x, dst_w, nr_components);
+	// filter vertically
+	std::vector<float> acc(row_size);
+	for (size_t y = y_begin; y < y_end; ++y) {
+		std::fill(acc.begin(), acc.end(), 0.0f);
+		for (uint32_t k = ct_y.begin[y]; k < ct_y.begin[y + 1]; ++k)
+			accumulate_row(&acc.front(), &rows[(ct_y.index[k] - row_begin) * row_size], ct_y.weight[k], row_size);
+		store_row(&acc.front(), dst + y * row_size, row_size);
+	}
+}
+
+/// process bands of target rows in parallel by handing out band indices to the tasks of the shared scheduler
+template <typename F>
+void process_bands(size_t nr_bands, unsigned nr_threads, F f)
+{
+	cgv::os::parallel_for(0, nr_bands, [&](size_t bi, size_t) { f(bi); }, 1, nr_threads);
+}
+
+}
+
+bool is_resampling_supported(const data_format& df)
+{
+	TypeId type_id = df.get_component_type();
+	if (type_id != TI_UINT8 && type_id != TI_FLT32)
+		return false;
+	if (df.is_packing() || df.get_nr_components() == 0 || df.get_nr_components() > 4)
+		return false;
+	return df.get_entry_size() == df.get_nr_components() * get_type_size(type_id);
+}
+
+bool resample_image(const const_data_view& src, const data_view& dst, ResamplingFilter filter, unsigned nr_threads)
+{
+	const data_format* src_df = src.get_format();
+	const data_format* dst_df = dst.get_format();
+	if (!src_df || !dst_df || src.empty() || dst.empty())
+		return false;
+	if (!is_resampling_supported(*src_df) || src_df->get_component_format() != dst_df->get_component_format())
+		return false;
+	size_t src_w = src_df->get_width(), src_h = src_df->get_height();
+	size_t dst_w = dst_df->get_width(), dst_h = dst_df->get_height();
+	if (src_w == 0 || src_h == 0 || dst_w == 0 || dst_h == 0)
+		return false;
+	contribution_table ct_x, ct_y;
+	ct_x.build(src_w, dst_w, filter);
+	ct_y.build(src_h, dst_h, filter);
+
+	if (nr_threads == 0)
+		nr_threads = cgv::os::task_scheduler::get().get_concurrency();
+	// use several bands per thread for load balancing but keep bands large enough to amortize the overlap of source rows
+	size_t band_height = std::max(size_t(8), dst_h / (4 * nr_threads));
+	size_t nr_bands = (dst_h + band_height - 1) / band_height;
+	unsigned nr_components = src_df->get_nr_components();
+	process_bands(nr_bands, nr_threads, [&](size_t bi) {
+		size_t y_begin = bi * band_height, y_end = std::min(y_begin + band_height, dst_h);
+		if (src_df->get_component_type() == TI_UINT8)
+			resample_band(src.get_ptr<uint8_t>(), dst.get_ptr<uint8_t>(), src_w, dst_w, nr_components, ct_x, ct_y, y_begin, y_end);
+		else
+			resample_band(src.get_ptr<float>(), dst.get_ptr<float>(), src_w, dst_w, nr_components, ct_x, ct_y, y_begin, y_end);
+	});
+	return true;
+}
+
+		}
+	}
+}
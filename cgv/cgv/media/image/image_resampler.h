@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cgv/data/data_view.h>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace media {
+		namespace image {
+
+/// reconstruction filters supported by the image resampler
+enum ResamplingFilter
+{
+	RF_BOX,      //!< box filter that averages the covered area when downscaling
+	RF_BILINEAR, //!< tent filter that interpolates bilinearly when upscaling
+	RF_LANCZOS,  //!< lanczos windowed sinc with three lobes
+	RF_KAISER    //!< kaiser windowed sinc with three lobes, well suited for mipmap generation
+};
+
+/// return whether the resampler supports the format, which needs to have unpacked uint8 or flt32 components
+extern CGV_API bool is_resampling_supported(const cgv::data::data_format& df);
+
+/** resample the 2d source view into the allocated 2d target view with the given filter. Source and target need
+    to have the same component format but can differ in resolution. Both passes of the separable filter are
+	vectorized with SSE2 or AVX, if enabled for the build, and distributed over bands of target rows processed
+	by nr_threads threads (0 uses all hardware threads). Returns false for unsupported formats. */
+extern CGV_API bool resample_image(const cgv::data::const_data_view& src, const cgv::data::data_view& dst,
+								   ResamplingFilter filter = RF_BILINEAR, unsigned nr_threads = 0);
+
+		}
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -0,0 +1,684 @@
+#include "wavelet_codec.h"
+#include "image_proc.h"
+#include <cgv/math/fvec.h>
+#include <cgv/utils/file.h>
+#include <cgv/os/task_scheduler.h>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <sstream>
+#include <cstring>
+
+using namespace cgv::data;
+using namespace cgv::type::info;
+
+namespace cgv {
+	namespace media {
+		namespace image {
+
+namespace {
+
+/// magic number "CWV1" at the beginning of each stream
+const uint32_t wavelet_magic = 0x31565743;
+
+/// header stored at the beginning of each stream, followed by the component format description and the block table
+struct stream_header
+{
+	uint32_t magic;
+	uint32_t nr_dimensions;
+	uint32_t resolution[3];
+	uint32_t tile_size;
+	uint32_t nr_levels;
+	uint32_t quantization;
+	uint32_t nr_tiles;
+	uint32_t format_length;
+};
+
+/// coefficients are processed as single component vectors to reuse the lifting transform of image_proc.h
+typedef cgv::math::fvec<int32_t, 1> coeff_type;
+
+/// number of unary bits after which a value is stored verbatim
+const unsigned escape_length = 24;
+
+class bit_writer
+{
+	std::vector<char>& out;
+	uint64_t acc;
+	unsigned nr_bits;
+public:
+	bit_writer(std::vector<char>& _out) : out(_out), acc(0), nr_bits(0) {}
+	void put(uint32_t bits, unsigned n)
+	{
+		acc = (acc << n) | (bits & ((uint64_t(1) << n) - 1));
+		nr_bits += n;
+		while (nr_bits >= 8) {
+			nr_bits -= 8;
+			out.push_back(char((acc >> nr_bits) & 0xff));
+		}
+		acc &= (uint64_t(1) << nr_bits) - 1;
+	}
+	void put_ones(unsigned n)
+	{
+		while (n > 0) {
+			unsigned m = std::min(n, 24u);
+			put((1u << m) - 1, m);
+			n -= m;
+		}
+	}
+	void flush()
+	{
+		if (nr_bits > 0)
+			put(0, 8 - nr_bits);
+	}
+};
+
+class bit_reader
+{
+	const uint8_t* ptr;
+	const uint8_t* end;
+	uint64_t acc;
+	unsigned nr_bits;
+	bool overrun;
+public:
+	bit_reader(const char* begin, size_t size) : ptr(reinterpret_cast<const uint8_t*>(begin)), end(ptr + size), acc(0), nr_bits(0), overrun(false) {}
+	uint32_t get(unsigned n)
+	{
+		while (nr_bits < n) {
+			if (ptr < end)
+				acc = (acc << 8) | *ptr++;
+			else {
+				acc <<= 8;
+				overrun = true;
+			}
+			nr_bits += 8;
+		}
+		nr_bits -= n;
+		uint32_t bits = uint32_t((acc >> nr_bits) & ((uint64_t(1) << n) - 1));
+		acc &= (uint64_t(1) << nr_bits) - 1;
+		return bits;
+	}
+	bool has_overrun() const { return overrun; }
+};
+
+/// adaptive Golomb-Rice parameter estimation as in LOCO-I
+struct rice_context
+{
+	uint32_t A, N;
+	rice_context() : A(4), N(1) {}
+	unsigned get_k() const
+	{
+		unsigned k = 0;
+		while ((N << k) < A && k < 30)
+			++k;
+		return k;
+	}
+	void update(uint32_t u)
+	{
+		A += u;
+		if (++N == 64) {
+			A >>= 1;
+			N >>= 1;
+		}
+	}
+};
+
+void encode_value(bit_writer& bw, rice_context& ctx, int32_t v)
+{
+	uint32_t u = (uint32_t(v) << 1) ^ uint32_t(v >> 31);
+	unsigned k = ctx.get_k();
+	uint32_t q = u >> k;
+	if (q < escape_length) {
+		bw.put_ones(q);
+		bw.put(0, 1);
+		bw.put(u, k);
+	}
+	else {
+		bw.put_ones(escape_length);
+		bw.put(u, 32);
+	}
+	ctx.update(u);
+}
+
+int32_t decode_value(bit_reader& br, rice_context& ctx)
+{
+	unsigned k = ctx.get_k();
+	uint32_t q = 0;
+	while (q < escape_length && br.get(1) == 1)
+		++q;
+	uint32_t u = q == escape_length ? br.get(32) : ((q << k) | br.get(k));
+	ctx.update(u);
+	return int32_t(u >> 1) ^ -int32_t(u & 1);
+}
+
+int32_t quantize(int32_t v, int32_t q)
+{
+	return v >= 0 ? (v + q / 2) / q : -((q / 2 - v) / q);
+}
+
+/// tiling of the data and the coefficient regions of the transform levels
+struct tile_layout
+{
+	size_t resolution[3];
+	unsigned extent[3];
+	size_t nr_tiles_per_axis[3];
+	unsigned nr_levels;
+	unsigned nr_components;
+
+	void init(const size_t* _resolution, unsigned tile_size, unsigned _nr_levels, unsigned _nr_components)
+	{
+		for (unsigned a = 0; a < 3; ++a) {
+			resolution[a] = _resolution[a];
+			extent[a] = resolution[a] > 1 ? tile_size : 1;
+			nr_tiles_per_axis[a] = (resolution[a] + extent[a] - 1) / extent[a];
+		}
+		nr_levels = _nr_levels;
+		nr_components = _nr_components;
+	}
+	size_t get_nr_tiles() const { return nr_tiles_per_axis[0] * nr_tiles_per_axis[1] * nr_tiles_per_axis[2]; }
+	size_t get_plane_size() const { return size_t(extent[0]) * extent[1] * extent[2]; }
+	void get_origin(size_t ti, size_t* origin) const
+	{
+		for (unsigned a = 0; a < 3; ++a) {
+			origin[a] = (ti % nr_tiles_per_axis[a]) * extent[a];
+			ti /= nr_tiles_per_axis[a];
+		}
+	}
+	/// compute the size of the low pass region after the given number of levels
+	void get_region(unsigned level, unsigned* region) const
+	{
+		for (unsigned a = 0; a < 3; ++a)
+			region[a] = std::max(extent[a] >> level, 1u);
+	}
+	/// compute the resolution when the given number of levels are skipped
+	size_t get_resolution(unsigned a, unsigned nr_skipped_levels) const
+	{
+		if (extent[a] == 1)
+			return resolution[a];
+		return (resolution[a] + (size_t(1) << nr_skipped_levels) - 1) >> nr_skipped_levels;
+	}
+};
+
+/// apply the forward or inverse lifting transform along axis a of the given region of a coefficient plane
+void transform_axis(coeff_type* plane, const tile_layout& tl, const unsigned* region, unsigned a, bool inverse)
+{
+	size_t step[3] = { 1, tl.extent[0], size_t(tl.extent[0]) * tl.extent[1] };
+	if (region[a] < 2)
+		return;
+	unsigned other = a == 2 ? 1 : 2;
+	unsigned outside = a == 0 ? 1 : 0;
+	for (unsigned i = 0; i < region[other]; ++i) {
+		coeff_type* ptr = plane + i * step[other];
+		if (inverse)
+			integer_inverse_wavelet_transform<coeff_type, coeff_type, coeff_type>(ptr, region[a], region[outside], step[a], step[outside], 1, 0xffffffff, true, 1, 1);
+		else
+			integer_wavelet_transform<coeff_type, coeff_type, coeff_type>(ptr, region[a], region[outside], step[a], step[outside], 1, 0xffffffff, true, 1, 1);
+	}
+}
+
+void forward_transform(coeff_type* plane, const tile_layout& tl)
+{
+	for (unsigned l = 0; l < tl.nr_levels; ++l) {
+		unsigned region[3];
+		tl.get_region(l, region);
+		for (unsigned a = 0; a < 3; ++a)
+			transform_axis(plane, tl, region, a, false);
+	}
+}
+
+void inverse_transform(coeff_type* plane, const tile_layout& tl, unsigned nr_skipped_levels)
+{
+	for (unsigned l = tl.nr_levels; l > nr_skipped_levels; --l) {
+		unsigned region[3];
+		tl.get_region(l - 1, region);
+		for (unsigned a = 3; a > 0; --a)
+			transform_axis(plane, tl, region, a - 1, true);
+	}
+}
+
+/// iterate the coefficient positions of the given chunk, where chunk 0 is the coarse low pass band and chunk c>0 the details of level nr_levels-c+1
+template <typename F>
+void for_each_coefficient(const tile_layout& tl, unsigned chunk, F f)
+{
+	unsigned outer[3], inner[3] = { 0, 0, 0 };
+	if (chunk == 0)
+		tl.get_region(tl.nr_levels, outer);
+	else {
+		unsigned level = tl.nr_levels - chunk + 1;
+		tl.get_region(level - 1, outer);
+		tl.get_region(level, inner);
+	}
+	for (unsigned z = 0; z < outer[2]; ++z)
+		for (unsigned y = 0; y < outer[1]; ++y)
+			for (unsigned x = 0; x < outer[0]; ++x) {
+				if (x < inner[0] && y < inner[1] && z < inner[2])
+					continue;
+				f(x, y, z, x + tl.extent[0] * (y + size_t(tl.extent[1]) * z));
+			}
+}
+
+void encode_chunk(const coeff_type* planes, const tile_layout& tl, unsigned chunk, int32_t quantization, std::vector<char>& out)
+{
+	bit_writer bw(out);
+	size_t row = tl.extent[0], slice = row * tl.extent[1];
+	for (unsigned ci = 0; ci < tl.nr_components; ++ci) {
+		const coeff_type* plane = planes + ci * tl.get_plane_size();
+		rice_context ctx;
+		for_each_coefficient(tl, chunk, [&](unsigned x, unsigned y, unsigned z, size_t i) {
+			int32_t v = plane[i][0];
+			if (chunk == 0) {
+				// predict low pass coefficients from previous neighbor
+				if (x > 0)
+					v -= plane[i - 1][0];
+				else if (y > 0)
+					v -= plane[i - row][0];
+				else if (z > 0)
+					v -= plane[i - slice][0];
+			}
+			else if (quantization > 1)
+				v = quantize(v, quantization);
+			encode_value(bw, ctx, v);
+		});
+	}
+	bw.flush();
+}
+
+bool decode_chunk(const char* data, size_t size, const tile_layout& tl, unsigned chunk, int32_t quantization, coeff_type* planes)
+{
+	bit_reader br(data, size);
+	size_t row = tl.extent[0], slice = row * tl.extent[1];
+	for (unsigned ci = 0; ci < tl.nr_components; ++ci) {
+		coeff_type* plane = planes + ci * tl.get_plane_size();
+		rice_context ctx;
+		for_each_coefficient(tl, chunk, [&](unsigned x, unsigned y, unsigned z, size_t i) {
+			int32_t v = decode_value(br, ctx);
+			if (chunk == 0) {
+				if (x > 0)
+					v += plane[i - 1][0];
+				else if (y > 0)
+					v += plane[i - row][0];
+				else if (z > 0)
+					v += plane[i - slice][0];
+			}
+			else
+				v *= quantization;
+			plane[i][0] = v;
+		});
+	}
+	return !br.has_overrun();
+}
+
+/// access to the components of the densely stored entries of a data view
+struct entry_access
+{
+	size_t resolution[3];
+	size_t entry_size;
+	size_t component_offset[4];
+	size_t get_offset(size_t x, size_t y, size_t z) const { return entry_size * (x + resolution[0] * (y + resolution[1] * z)); }
+	void init(const data_format& df, const size_t* _resolution)
+	{
+		std::copy(_resolution, _resolution + 3, resolution);
+		entry_size = df.get_entry_size();
+		size_t component_size = packing_info::align(get_type_size(df.get_component_type()), df.get_component_alignment());
+		for (unsigned ci = 0; ci < 4; ++ci)
+			component_offset[ci] = ci * component_size;
+	}
+};
+
+/// copy a tile with replicated borders into the coefficient planes
+template <typename T>
+void extract_tile(const unsigned char* data_ptr, const entry_access& ea, const tile_layout& tl, const size_t* origin, coeff_type* planes)
+{
+	size_t plane_size = tl.get_plane_size();
+	size_t i = 0;
+	for (unsigned z = 0; z < tl.extent[2]; ++z) {
+		size_t sz = std::min(origin[2] + z, ea.resolution[2] - 1);
+		for (unsigned y = 0; y < tl.extent[1]; ++y) {
+			size_t sy = std::min(origin[1] + y, ea.resolution[1] - 1);
+			for (unsigned x = 0; x < tl.extent[0]; ++x, ++i) {
+				size_t sx = std::min(origin[0] + x, ea.resolution[0] - 1);
+				const unsigned char* entry_ptr = data_ptr + ea.get_offset(sx, sy, sz);
+				for (unsigned ci = 0; ci < tl.nr_components; ++ci)
+					planes[ci * plane_size + i][0] = int32_t(*reinterpret_cast<const T*>(entry_ptr + ea.component_offset[ci]));
+			}
+		}
+	}
+}
+
+/// copy the low pass region of a decoded tile into the (possibly downsampled) target data
+template <typename T>
+void store_tile(unsigned char* data_ptr, const entry_access& ea, const tile_layout& tl, const size_t* origin, unsigned nr_skipped_levels, const coeff_type* planes)
+{
+	unsigned region[3];
+	tl.get_region(nr_skipped_levels, region);
+	size_t plane_size = tl.get_plane_size();
+	size_t target_origin[3];
+	for (unsigned a = 0; a < 3; ++a)
+		target_origin[a] = tl.extent[a] == 1 ? origin[a] : origin[a] >> nr_skipped_levels;
+	const int32_t min_value = int32_t(std::numeric_limits<T>::min());
+	const int32_t max_value = int32_t(std::numeric_limits<T>::max());
+	for (unsigned z = 0; z < region[2] && target_origin[2] + z < ea.resolution[2]; ++z)
+		for (unsigned y = 0; y < region[1] && target_origin[1] + y < ea.resolution[1]; ++y)
+			for (unsigned x = 0; x < region[0] && target_origin[0] + x < ea.resolution[0]; ++x) {
+				unsigned char* entry_ptr = data_ptr + ea.get_offset(target_origin[0] + x, target_origin[1] + y, target_origin[2] + z);
+				size_t i = x + tl.extent[0] * (y + size_t(tl.extent[1]) * z);
+				for (unsigned ci = 0; ci < tl.nr_components; ++ci) {
+					int32_t v = std::min(std::max(planes[ci * plane_size + i][0], min_value), max_value);
+					*reinterpret_cast<T*>(entry_ptr + ea.component_offset[ci]) = T(v);
+				}
+			}
+}
+
+/// process tiles in parallel by handing out tile indices to the tasks of the shared scheduler, where nr_threads = 0 uses all threads of the scheduler
+template <typename F>
+void process_tiles(size_t nr_tiles, unsigned nr_threads, F f)
+{
+	cgv::os::parallel_for(0, nr_tiles, [&](size_t ti, size_t) {
+		std::vector<coeff_type> planes;
+		f(ti, planes);
+	}, 1, nr_threads);
+}
+
+bool is_supported_type(TypeId type_id)
+{
+	return type_id == TI_INT8 || type_id == TI_UINT8 || type_id == TI_INT16 || type_id == TI_UINT16;
+}
+
+unsigned floor_log2(unsigned v)
+{
+	unsigned l = 0;
+	while (v > 1) {
+		v >>= 1;
+		++l;
+	}
+	return l;
+}
+
+}
+
+wavelet_codec_config::wavelet_codec_config() : tile_size(64), nr_levels(4), quantization(1), nr_threads(0)
+{
+}
+
+size_t wavelet_stream_info::get_prefix_size(unsigned nr_skipped_levels) const
+{
+	unsigned nr_chunks = nr_levels + 1 - std::min(nr_skipped_levels, nr_levels);
+	size_t size = data_offset;
+	for (size_t i = 0; i < nr_chunks * size_t(nr_tiles); ++i)
+		size += block_sizes[i];
+	return size;
+}
+
+size_t wavelet_stream_info::get_resolution(unsigned i, unsigned nr_skipped_levels) const
+{
+	size_t r = format.get_resolution(i);
+	if (r <= 1)
+		return r;
+	nr_skipped_levels = std::min(nr_skipped_levels, nr_levels);
+	return (r + (size_t(1) << nr_skipped_levels) - 1) >> nr_skipped_levels;
+}
+
+wavelet_codec::wavelet_codec(const wavelet_codec_config& _config) : config(_config)
+{
+}
+
+bool wavelet_codec::encode(const const_data_view& dv, std::vector<char>& stream)
+{
+	const data_format* df_ptr = dv.get_format();
+	if (!df_ptr || dv.empty()) {
+		last_error = "wavelet_codec::encode: empty data view";
+		return false;
+	}
+	const data_format& df = *df_ptr;
+	unsigned nr_dimensions = df.get_nr_dimensions();
+	if (nr_dimensions < 2 || nr_dimensions > 3) {
+		last_error = "wavelet_codec::encode: only 2d and 3d data is supported";
+		return false;
+	}
+	if (!is_supported_type(df.get_component_type()) || df.is_packing() || df.get_nr_components() > 4) {
+		last_error = "wavelet_codec::encode: only 8 and 16 bit integer components without packing are supported";
+		return false;
+	}
+	if (config.tile_size < 2 || (config.tile_size & (config.tile_size - 1)) != 0) {
+		last_error = "wavelet_codec::encode: tile size needs to be a power of two";
+		return false;
+	}
+	size_t resolution[3] = { df.get_width(), df.get_height(), nr_dimensions > 2 ? df.get_depth() : 1 };
+	tile_layout tl;
+	tl.init(resolution, config.tile_size, std::min(config.nr_levels, floor_log2(config.tile_size)), df.get_nr_components());
+	entry_access ea;
+	ea.init(df, resolution);
+	size_t nr_tiles = tl.get_nr_tiles();
+	unsigned nr_chunks = tl.nr_levels + 1;
+	int32_t quantization = std::max(int32_t(config.quantization), 1);
+
+	// transform and encode tiles in parallel
+	std::vector<std::vector<char>> blocks(nr_chunks * nr_tiles);
+	const unsigned char* data_ptr = dv.get_ptr<unsigned char>();
+	TypeId type_id = df.get_component_type();
+	process_tiles(nr_tiles, config.nr_threads, [&](size_t ti, std::vector<coeff_type>& planes) {
+		planes.resize(tl.get_plane_size() * tl.nr_components);
+		size_t origin[3];
+		tl.get_origin(ti, origin);
+		switch (type_id) {
+		case TI_INT8: extract_tile<int8_t>(data_ptr, ea, tl, origin, &planes.front()); break;
+		case TI_UINT8: extract_tile<uint8_t>(data_ptr, ea, tl, origin, &planes.front()); break;
+		case TI_INT16: extract_tile<int16_t>(data_ptr, ea, tl, origin, &planes.front()); break;
+		default: extract_tile<uint16_t>(data_ptr, ea, tl, origin, &planes.front()); break;
+		}
+		for (unsigned ci = 0; ci < tl.nr_components; ++ci)
+			forward_transform(&planes[ci * tl.get_plane_size()], tl);
+		for (unsigned c = 0; c < nr_chunks; ++c)
+			encode_chunk(&planes.front(), tl, c, quantization, blocks[c * nr_tiles + ti]);
+	});
+
+	// assemble stream from header, format description, block table and blocks
+	std::stringstream ss;
+	ss << df.get_component_format();
+	std::string format_description = ss.str();
+	stream_header header;
+	header.magic = wavelet_magic;
+	header.nr_dimensions = nr_dimensions;
+	for (unsigned a = 0; a < 3; ++a)
+		header.resolution[a] = uint32_t(resolution[a]);
+	header.tile_size = config.tile_size;
+	header.nr_levels = tl.nr_levels;
+	header.quantization = uint32_t(quantization);
+	header.nr_tiles = uint32_t(nr_tiles);
+	header.format_length = uint32_t(format_description.size());
+	size_t size = sizeof(stream_header) + format_description.size() + sizeof(uint32_t) * blocks.size();
+	for (const auto& b : blocks)
+		size += b.size();
+	stream.resize(size);
+	char* ptr = &stream.front();
+	std::memcpy(ptr, &header, sizeof(stream_header));
+	ptr += sizeof(stream_header);
+	std::memcpy(ptr, format_description.data(), format_description.size());
+	ptr += format_description.size();
+	for (const auto& b : blocks) {
+		uint32_t block_size = uint32_t(b.size());
+		std::memcpy(ptr, &block_size, sizeof(uint32_t));
+		ptr += sizeof(uint32_t);
+	}
+	for (const auto& b : blocks) {
+		if (!b.empty())
+			std::memcpy(ptr, &b.front(), b.size());
+		ptr += b.size();
+	}
+	return true;
+}
+
+bool wavelet_codec::read_info(const char* data, size_t size, wavelet_stream_info& info)
+{
+	stream_header header;
+	if (size < sizeof(stream_header)) {
+		last_error = "wavelet_codec::read_info: stream too short";
+		return false;
+	}
+	std::memcpy(&header, data, sizeof(stream_header));
+	if (header.magic != wavelet_magic) {
+		last_error = "wavelet_codec::read_info: stream does not start with wavelet magic";
+		return false;
+	}
+	if (header.nr_dimensions < 2 || header.nr_dimensions > 3 || header.tile_size < 2 ||
+		(header.tile_size & (header.tile_size - 1)) != 0 || header.nr_levels > floor_log2(header.tile_size)) {
+		last_error = "wavelet_codec::read_info: invalid header";
+		return false;
+	}
+	size_t nr_blocks = size_t(header.nr_levels + 1) * header.nr_tiles;
+	info.data_offset = sizeof(stream_header) + header.format_length + sizeof(uint32_t) * nr_blocks;
+	if (size < info.data_offset) {
+		last_error = "wavelet_codec::read_info: stream too short for block table";
+		return false;
+	}
+	std::string format_description(data + sizeof(stream_header), header.format_length);
+	component_format cf;
+	if (!cf.set_component_format(format_description)) {
+		last_error = "wavelet_codec::read_info: invalid component format " + format_description;
+		return false;
+	}
+	info.format = data_format();
+	info.format.set_component_format(cf);
+	if (header.nr_dimensions == 2)
+		info.format.set_dimensions(header.resolution[0], header.resolution[1]);
+	else
+		info.format.set_dimensions(header.resolution[0], header.resolution[1], header.resolution[2]);
+	info.tile_size = header.tile_size;
+	info.nr_levels = header.nr_levels;
+	info.quantization = std::max(header.quantization, 1u);
+	info.nr_tiles = header.nr_tiles;
+	info.block_sizes.resize(nr_blocks);
+	if (nr_blocks > 0)
+		std::memcpy(&info.block_sizes.front(), data + sizeof(stream_header) + header.format_length, sizeof(uint32_t) * nr_blocks);
+	return true;
+}
+
+bool wavelet_codec::decode(const char* data, size_t size, data_format& df, data_view& dv, unsigned nr_skipped_levels)
+{
+	wavelet_stream_info info;
+	if (!read_info(data, size, info))
+		return false;
+	nr_skipped_levels = std::min(nr_skipped_levels, info.nr_levels);
+	if (size < info.get_prefix_size(nr_skipped_levels)) {
+		last_error = "wavelet_codec::decode: stream too short for requested levels";
+		return false;
+	}
+	unsigned nr_dimensions = info.format.get_nr_dimensions();
+	if (!is_supported_type(info.format.get_component_type()) || info.format.is_packing() || info.format.get_nr_components() > 4) {
+		last_error = "wavelet_codec::decode: unsupported component format";
+		return false;
+	}
+	size_t resolution[3] = { info.format.get_width(), info.format.get_height(), nr_dimensions > 2 ? info.format.get_depth() : 1 };
+	tile_layout tl;
+	tl.init(resolution, info.tile_size, info.nr_levels, info.format.get_nr_components());
+	if (tl.get_nr_tiles() != info.nr_tiles) {
+		last_error = "wavelet_codec::decode: tile count does not match resolution";
+		return false;
+	}
+	// allocate target data with reduced resolution
+	size_t target_resolution[3];
+	for (unsigned a = 0; a < 3; ++a)
+		target_resolution[a] = tl.get_resolution(a, nr_skipped_levels);
+	df = info.format;
+	if (nr_dimensions == 2)
+		df.set_dimensions(target_resolution[0], target_resolution[1]);
+	else
+		df.set_dimensions(target_resolution[0], target_resolution[1], target_resolution[2]);
+	dv = data_view(&df);
+	entry_access ea;
+	ea.init(df, target_resolution);
+
+	// compute offsets of blocks
+	size_t nr_tiles = info.nr_tiles;
+	unsigned nr_chunks = info.nr_levels + 1 - nr_skipped_levels;
+	std::vector<size_t> block_offsets(nr_chunks * nr_tiles);
+	size_t offset = info.data_offset;
+	for (size_t i = 0; i < block_offsets.size(); ++i) {
+		block_offsets[i] = offset;
+		offset += info.block_sizes[i];
+	}
+	// decode and inverse transform tiles in parallel
+	unsigned char* data_ptr = dv.get_ptr<unsigned char>();
+	TypeId type_id = df.get_component_type();
+	int32_t quantization = int32_t(info.quantization);
+	std::atomic<bool> success(true);
+	process_tiles(nr_tiles, config.nr_threads, [&](size_t ti, std::vector<coeff_type>& planes) {
+		planes.resize(tl.get_plane_size() * tl.nr_components);
+		for (unsigned c = 0; c < nr_chunks; ++c) {
+			size_t bi = c * nr_tiles + ti;
+			if (!decode_chunk(data + block_offsets[bi], info.block_sizes[bi], tl, c, quantization, &planes.front()))
+				success = false;
+		}
+		for (unsigned ci = 0; ci < tl.nr_components; ++ci)
+			inverse_transform(&planes[ci * tl.get_plane_size()], tl, nr_skipped_levels);
+		size_t origin[3];
+		tl.get_origin(ti, origin);
+		switch (type_id) {
+		case TI_INT8: store_tile<int8_t>(data_ptr, ea, tl, origin, nr_skipped_levels, &planes.front()); break;
+		case TI_UINT8: store_tile<uint8_t>(data_ptr, ea, tl, origin, nr_skipped_levels, &planes.front()); break;
+		case TI_INT16: store_tile<int16_t>(data_ptr, ea, tl, origin, nr_skipped_levels, &planes.front()); break;
+		default: store_tile<uint16_t>(data_ptr, ea, tl, origin, nr_skipped_levels, &planes.front()); break;
+		}
+	});
+	if (!success) {
+		last_error = "wavelet_codec::decode: corrupt coefficient block";
+		return false;
+	}
+	return true;
+}
+
+bool wavelet_codec::write(const std::string& file_name, const const_data_view& dv)
+{
+	std::vector<char> stream;
+	if (!encode(dv, stream))
+		return false;
+	if (!cgv::utils::file::write(file_name, &stream.front(), stream.size(), false)) {
+		last_error = "wavelet_codec::write: could not write file " + file_name;
+		return false;
+	}
+	return true;
+}
+
+bool wavelet_codec::read(const std::string& file_name, data_format& df, data_view& dv, unsigned nr_skipped_levels)
+{
+	size_t file_size = cgv::utils::file::size(file_name);
+	if (file_size < sizeof(stream_header)) {
+		last_error = "wavelet_codec::read: could not read header of file " + file_name;
+		return false;
+	}
+	// read header first to determine the size of the block table and then only the needed prefix
+	std::vector<char> stream(sizeof(stream_header));
+	if (!cgv::utils::file::read(file_name, &stream.front(), stream.size())) {
+		last_error = "wavelet_codec::read: could not read header of file " + file_name;
+		return false;
+	}
+	stream_header header;
+	std::memcpy(&header, &stream.front(), sizeof(stream_header));
+	size_t table_end = sizeof(stream_header) + header.format_length + sizeof(uint32_t) * size_t(header.nr_levels + 1) * header.nr_tiles;
+	if (header.magic != wavelet_magic || table_end > file_size) {
+		last_error = "wavelet_codec::read: invalid header in file " + file_name;
+		return false;
+	}
+	stream.resize(table_end);
+	if (!cgv::utils::file::read(file_name, &stream.front(), stream.size())) {
+		last_error = "wavelet_codec::read: could not read block table of file " + file_name;
+		return false;
+	}
+	wavelet_stream_info info;
+	if (!read_info(&stream.front(), stream.size(), info))
+		return false;
+	size_t prefix_size = info.get_prefix_size(nr_skipped_levels);
+	if (prefix_size > file_size) {
+		last_error = "wavelet_codec::read: file " + file_name + " is truncated";
+		return false;
+	}
+	stream.resize(prefix_size);
+	if (prefix_size > table_end && !cgv::utils::file::read(file_name, &stream[table_end], prefix_size - table_end, false, table_end)) {
+		last_error = "wavelet_codec::read: could not read coefficients of file " + file_name;
+		return false;
+	}
+	return decode(&stream.front(), stream.size(), df, dv, nr_skipped_levels);
+}
+
+		}
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cgv/data/data_view.h>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace media {
+		namespace image {
+
+/// configuration of the tiled wavelet codec
+struct CGV_API wavelet_codec_config
+{
+	/// edge length of square (2d) or cubic (3d) tiles, needs to be a power of two
+	unsigned tile_size;
+	/// number of transform levels, which is clamped to log2(tile_size)
+	unsigned nr_levels;
+	/// quantization step of the detail coefficients, 1 results in lossless compression
+	unsigned quantization;
+	/// number of threads used to process tiles, 0 uses all hardware threads
+	unsigned nr_threads;
+	/// construct with 64 tile size, 4 levels, lossless quantization and all hardware threads
+	wavelet_codec_config();
+};
+
+/// information stored in the header of a wavelet stream
+struct CGV_API wavelet_stream_info
+{
+	/// data format of the full resolution data
+	cgv::data::data_format format;
+	/// edge length of tiles
+	unsigned tile_size;
+	/// number of transform levels
+	unsigned nr_levels;
+	/// quantization step of detail coefficients
+	unsigned quantization;
+	/// number of tiles
+	unsigned nr_tiles;
+	/// offset of the first coefficient block
+	size_t data_offset;
+	/// byte sizes of coefficient blocks ordered by level (coarse first) and tile
+	std::vector<uint32_t> block_sizes;
+	/// return the number of bytes at the beginning of the stream needed to decode with the given number of skipped levels
+	size_t get_prefix_size(unsigned nr_skipped_levels = 0) const;
+	/// return the resolution of the i-th dimension when decoded with the given number of skipped levels
+	size_t get_resolution(unsigned i, unsigned nr_skipped_levels = 0) const;
+};
+
+/** lossless or near-lossless codec for 2d images and 3d volumes based on the
+    integer lifting transform in image_proc.h. The data is split into tiles that
+	are transformed and entropy coded in parallel with adaptive Golomb-Rice codes.
+	The coefficient blocks are stored coarse level first, such that a prefix of
+	the stream suffices to decode a downsampled preview. Supported component
+	types are 8 and 16 bit integers without packing. */
+class CGV_API wavelet_codec
+{
+protected:
+	/// configuration used for encoding and threading
+	wavelet_codec_config config;
+	/// last error message
+	std::string last_error;
+public:
+	/// construct codec from configuration
+	wavelet_codec(const wavelet_codec_config& _config = wavelet_codec_config());
+	/// return reference to configuration
+	wavelet_codec_config& ref_config() { return config; }
+	/// return a reference to the last error message
+	const std::string& get_last_error() const { return last_error; }
+	/// encode a 2d or 3d data view into the given stream
+	bool encode(const cgv::data::const_data_view& dv, std::vector<char>& stream);
+	/// read the header information from the beginning of a stream, which needs to contain at least the header and block table
+	bool read_info(const char* data, size_t size, wavelet_stream_info& info);
+	//! decode stream into given format and newly allocated data view
+	/*! The finest \c nr_skipped_levels levels are ignored such that the resolution is reduced by a
+	    factor of two per skipped level. In this case only the prefix of size
+		\c wavelet_stream_info::get_prefix_size(nr_skipped_levels) needs to be available. */
+	bool decode(const char* data, size_t size, cgv::data::data_format& df, cgv::data::data_view& dv, unsigned nr_skipped_levels = 0);
+	/// encode data view to a file
+	bool write(const std::string& file_name, const cgv::data::const_data_view& dv);
+	/// decode file, thereby only reading the part of the file needed for the given number of skipped levels
+	bool read(const std::string& file_name, cgv::data::data_format& df, cgv::data::data_view& dv, unsigned nr_skipped_levels = 0);
+};
+
+		}
+	}
+}
+
+#include <cgv/config/lib_end.h>
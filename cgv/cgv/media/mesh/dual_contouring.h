@@ -3,6 +3,7 @@
 #include <vector>
 #include <deque>
 #include <cgv/utils/progression.h>
+#include <cgv/utils/trace_profiler.h>
 #include <cgv/math/qem.h>
 #include <cgv/math/mfunc.h>
 #include <cgv/media/axis_aligned_box.h>
@@ -293,6 +294,7 @@ public:
 				 unsigned int _resx, unsigned int _resy, unsigned int _resz,
 				 bool show_progress = false)
 	{
+		CGV_PROFILE_ZONE("dual_contouring::extract");
 		// prepare private members
 		resx = _resx; resy = _resy; resz = _resz;
 		minp = p = box.get_min_pnt();
@@ -2,6 +2,7 @@
 
 #include <cgv/math/ftransform.h>
 #include <cgv/math/inv.h>
+#include <cgv/os/task_scheduler.h>
 
 namespace cgv {
 	namespace media {
@@ -206,13 +207,14 @@ void dynamic_mesh<T>::apply_blend_shapes(const std::vector<T>& weights, idx_type
 			bs_ptrs.push_back(&blend_shape_data[bs.blend_shape_data_range[0]]);
 		}
 		// next apply them to mesh positions
-#pragma omp parallel for
-		for (int vi = 0; vi < n; ++vi) {
-			vec3_type p(T(0));
-			for (int wi = 0; wi < weights.size(); ++wi)
-				p += weights[wi]*bs_ptrs[wi][vi];
-			this->position(vi) += p;
-		}
+		cgv::os::parallel_for(0, n, [&](size_t begin, size_t end) {
+			for (int vi = int(begin); vi < int(end); ++vi) {
+				vec3_type p(T(0));
+				for (int wi = 0; wi < weights.size(); ++wi)
+					p += weights[wi]*bs_ptrs[wi][vi];
+				this->position(vi) += p;
+			}
+		}, 4096);
 	}
 	else {
 		for (idx_type bi = blend_shape_offset, wi = 0; wi < weights.size(); ++wi, ++bi) {
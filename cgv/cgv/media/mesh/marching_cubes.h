@@ -3,6 +3,7 @@
 #include <vector>
 #include <deque>
 #include <cgv/utils/progression.h>
+#include <cgv/utils/trace_profiler.h>
 #include <cgv/math/fvec.h>
 #include <cgv/math/mfunc.h>
 #include <cgv/media/axis_aligned_box.h>
@@ -132,6 +133,7 @@ public:
 		unsigned int resx, unsigned int resy, unsigned int resz,
 		const Eval& eval, const Valid& valid, bool show_progress = false)
 	{
+		CGV_PROFILE_ZONE("marching_cubes::extract");
 		// prepare private members
 		p = box.get_min_pnt();
 		d = box.get_extent();
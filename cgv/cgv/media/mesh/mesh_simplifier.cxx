@@ -0,0 +1,652 @@
+#include "mesh_simplifier.h"
+#include <cgv/math/qem.h>
+#include <cgv/os/task_scheduler.h>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <cmath>
+
+namespace cgv {
+	namespace media {
+		namespace mesh {
+
+simplification_parameters::simplification_parameters()
+	: target_nr_faces(0), max_error(-1), normal_weight(0.1), tex_coord_weight(0.1), color_weight(0.1),
+	  boundary_weight(100), min_normal_cosine(0.2), nr_threads(0)
+{
+}
+
+namespace {
+
+typedef simple_mesh_base::idx_type idx_type;
+/// maximum dimension of vertex vectors: position, normal, texture coordinates and rgba color
+const unsigned max_dim = 12;
+/// number of coefficients of a quadric of maximum dimension
+const unsigned max_qem_size = (max_dim + 1) * (max_dim + 2) / 2;
+
+/// candidate edge collapse in the heap of a cell, which is invalidated by changes of the stamps of its vertices
+struct collapse_candidate
+{
+	double cost;
+	idx_type u, v;
+	uint32_t stamp_u, stamp_v;
+	bool operator < (const collapse_candidate& c) const { return cost > c.cost; }
+};
+
+/** vertex vectors, quadrics and triangle connectivity of a mesh during simplification. Quadrics are
+    stored in the packed layout of cgv::math::qem, i.e. scalar part, vector part and upper triangle of
+	the matrix part, in one array for all vertices. */
+struct simplification_state
+{
+	unsigned n, q;
+	unsigned matrix_index[max_dim][max_dim];
+	double min_normal_cosine, boundary_weight;
+	std::vector<double> vectors;
+	std::vector<double> quadrics;
+	std::vector<idx_type> triangles;
+	std::vector<idx_type> triangle_faces;
+	std::vector<uint8_t> triangle_alive;
+	std::vector<std::vector<idx_type> > vertex_triangles;
+	std::vector<uint32_t> stamps;
+	std::vector<uint8_t> vertex_alive, locked, boundary;
+	std::vector<uint32_t> cells;
+
+	void init_layout(unsigned _n)
+	{
+		n = _n;
+		q = (n + 1) * (n + 2) / 2;
+		unsigned k = n + 1;
+		for (unsigned i = 0; i < n; ++i)
+			for (unsigned j = i; j < n; ++j, ++k)
+				matrix_index[i][j] = matrix_index[j][i] = k;
+	}
+	double* vector(idx_type v) { return &vectors[size_t(n) * v]; }
+	const double* vector(idx_type v) const { return &vectors[size_t(n) * v]; }
+	double* quadric(idx_type v) { return &quadrics[size_t(q) * v]; }
+	const double* quadric(idx_type v) const { return &quadrics[size_t(q) * v]; }
+	/// evaluate packed quadric at x
+	double evaluate(const double* Q, const double* x) const
+	{
+		double e = Q[0];
+		for (unsigned i = 0; i < n; ++i) {
+			double Ax = 0;
+			for (unsigned j = 0; j < n; ++j)
+				Ax += Q[matrix_index[i][j]] * x[j];
+			e += (2 * Q[i + 1] + Ax) * x[i];
+		}
+		return std::max(e, 0.0);
+	}
+	/// add area weighted quadric measuring the squared distance to the plane of a triangle in n dimensions
+	void add_triangle_quadric(cgv::math::qem<double>& Q, const double* p0, const double* p1, const double* p2) const
+	{
+		double e1[max_dim], e2[max_dim];
+		double l1 = 0, d = 0;
+		for (unsigned i = 0; i < n; ++i) {
+			e1[i] = p1[i] - p0[i];
+			e2[i] = p2[i] - p0[i];
+			l1 += e1[i] * e1[i];
+		}
+		l1 = std::sqrt(l1);
+		if (l1 < 1e-30)
+			return;
+		for (unsigned i = 0; i < n; ++i) {
+			e1[i] /= l1;
+			d += e1[i] * e2[i];
+		}
+		double l2 = 0;
+		for (unsigned i = 0; i < n; ++i) {
+			e2[i] -= d * e1[i];
+			l2 += e2[i] * e2[i];
+		}
+		l2 = std::sqrt(l2);
+		if (l2 < 1e-30)
+			return;
+		double pe1 = 0, pe2 = 0, pp = 0;
+		for (unsigned i = 0; i < n; ++i) {
+			e2[i] /= l2;
+			pe1 += p0[i] * e1[i];
+			pe2 += p0[i] * e2[i];
+			pp += p0[i] * p0[i];
+		}
+		double w = 0.5 * l1 * l2;
+		Q(0) += w * (pp - pe1 * pe1 - pe2 * pe2);
+		for (unsigned i = 0; i < n; ++i) {
+			Q(i + 1) += w * (pe1 * e1[i] + pe2 * e2[i] - p0[i]);
+			for (unsigned j = i; j < n; ++j)
+				Q(matrix_index[i][j]) += w * ((i == j ? 1.0 : 0.0) - e1[i] * e1[j] - e2[i] * e2[j]);
+		}
+	}
+	/// add quadric of plane through boundary edge (a,b) that is perpendicular to the triangle with third vertex c
+	void add_boundary_quadric(cgv::math::qem<double>& Q, const double* a, const double* b, const double* c) const
+	{
+		typedef cgv::math::fvec<double, 3> dvec3;
+		dvec3 pa(3, a), e = dvec3(3, b) - pa;
+		dvec3 nml = cross(e, cross(e, dvec3(3, c) - pa));
+		double l = nml.length();
+		if (l < 1e-30)
+			return;
+		nml /= l;
+		double d = -dot(nml, pa), w = boundary_weight * e.sqr_length();
+		Q(0) += w * d * d;
+		for (unsigned i = 0; i < 3; ++i) {
+			Q(i + 1) += w * d * nml[i];
+			for (unsigned j = i; j < 3; ++j)
+				Q(matrix_index[i][j]) += w * nml[i] * nml[j];
+		}
+	}
+	/// return number of alive triangles incident to u that contain v
+	unsigned count_shared_triangles(idx_type u, idx_type v) const
+	{
+		unsigned count = 0;
+		for (idx_type t : vertex_triangles[u])
+			if (triangles[3 * t] == v || triangles[3 * t + 1] == v || triangles[3 * t + 2] == v)
+				++count;
+		return count;
+	}
+	/// accumulate the quadric of vertex v from its incident triangles and boundary edges
+	void compute_vertex_quadric(idx_type v)
+	{
+		cgv::math::qem<double> Q;
+		Q.set_extern_data(q, quadric(v));
+		Q.zeros();
+		for (idx_type t : vertex_triangles[v]) {
+			const idx_type* tri = &triangles[3 * t];
+			add_triangle_quadric(Q, vector(tri[0]), vector(tri[1]), vector(tri[2]));
+			for (unsigned k = 0; k < 3; ++k) {
+				idx_type a = tri[k], b = tri[(k + 1) % 3];
+				if ((a == v || b == v) && count_shared_triangles(v, a == v ? b : a) == 1) {
+					add_boundary_quadric(Q, vector(a), vector(b), vector(tri[(k + 2) % 3]));
+					boundary[v] = 1;
+				}
+			}
+		}
+	}
+	/// collect the sorted neighbors of vertex v
+	void collect_neighbors(idx_type v, std::vector<idx_type>& neighbors) const
+	{
+		neighbors.clear();
+		for (idx_type t : vertex_triangles[v])
+			for (unsigned k = 0; k < 3; ++k)
+				if (triangles[3 * t + k] != v)
+					neighbors.push_back(triangles[3 * t + k]);
+		std::sort(neighbors.begin(), neighbors.end());
+		neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+	}
+	/** minimize packed quadric by solving A x = -b with an LDL^T decomposition of the positive semi definite
+	    matrix part, return false if the system is close to singular and otherwise the minimal error c + b x */
+	bool minimize(const double* Q, double* x, double& error) const
+	{
+		double L[max_dim][max_dim], D[max_dim];
+		double max_diag = 0;
+		for (unsigned i = 0; i < n; ++i)
+			max_diag = std::max(max_diag, Q[matrix_index[i][i]]);
+		double eps = 1e-9 * max_diag;
+		for (unsigned j = 0; j < n; ++j) {
+			double d = Q[matrix_index[j][j]];
+			for (unsigned k = 0; k < j; ++k)
+				d -= L[j][k] * L[j][k] * D[k];
+			if (d <= eps)
+				return false;
+			D[j] = d;
+			for (unsigned i = j + 1; i < n; ++i) {
+				double l = Q[matrix_index[i][j]];
+				for (unsigned k = 0; k < j; ++k)
+					l -= L[i][k] * L[j][k] * D[k];
+				L[i][j] = l / d;
+			}
+		}
+		for (unsigned i = 0; i < n; ++i) {
+			double y = -Q[i + 1];
+			for (unsigned k = 0; k < i; ++k)
+				y -= L[i][k] * x[k];
+			x[i] = y;
+		}
+		for (unsigned i = n; i-- > 0; ) {
+			double z = x[i] / D[i];
+			for (unsigned k = i + 1; k < n; ++k)
+				z -= L[k][i] * x[k];
+			x[i] = z;
+		}
+		error = Q[0];
+		for (unsigned i = 0; i < n; ++i)
+			error += Q[i + 1] * x[i];
+		error = std::max(error, 0.0);
+		return true;
+	}
+	/** determine for the edge (u,v) the removed vertex r, the surviving vertex s and the target vector x of s
+	    and return the cost of the collapse or infinity if the collapse is not possible */
+	double plan_collapse(idx_type u, idx_type v, idx_type& r, idx_type& s, double* x) const
+	{
+		r = u;
+		s = v;
+		if (locked[r] || (boundary[r] && !boundary[s]))
+			std::swap(r, s);
+		if (locked[r])
+			return std::numeric_limits<double>::infinity();
+		double Q[max_qem_size];
+		const double* Qr = quadric(r), * Qs = quadric(s);
+		for (unsigned i = 0; i < q; ++i)
+			Q[i] = Qr[i] + Qs[i];
+		const double* pr = vector(r), * ps = vector(s);
+		if (locked[s]) {
+			std::copy(ps, ps + n, x);
+			return evaluate(Q, x);
+		}
+		// accept optimal vector only if it stays close to the edge
+		double cost;
+		if (minimize(Q, x, cost)) {
+			double dist = 0, edge_length = 0;
+			for (unsigned i = 0; i < 3; ++i) {
+				double m = 0.5 * (pr[i] + ps[i]);
+				dist += (x[i] - m) * (x[i] - m);
+				edge_length += (pr[i] - ps[i]) * (pr[i] - ps[i]);
+			}
+			if (dist <= 4 * edge_length)
+				return cost;
+		}
+		double mid[max_dim];
+		for (unsigned i = 0; i < n; ++i)
+			mid[i] = 0.5 * (pr[i] + ps[i]);
+		double cost_r = evaluate(Q, pr), cost_s = evaluate(Q, ps), cost_mid = evaluate(Q, mid);
+		const double* best = ps;
+		cost = cost_s;
+		if (cost_mid < cost) {
+			best = mid;
+			cost = cost_mid;
+		}
+		if (cost_r < cost) {
+			best = pr;
+			cost = cost_r;
+		}
+		std::copy(best, best + n, x);
+		return cost;
+	}
+	/// check connectivity, partition ownership and normal flips of collapsing r into s with target vector x
+	bool is_collapse_valid(idx_type r, idx_type s, const double* x, uint32_t cell,
+						   std::vector<idx_type>& neighbors_r, std::vector<idx_type>& neighbors_s) const
+	{
+		collect_neighbors(r, neighbors_r);
+		collect_neighbors(s, neighbors_s);
+		for (idx_type w : neighbors_r)
+			if (cells[w] != cell)
+				return false;
+		for (idx_type w : neighbors_s)
+			if (cells[w] != cell)
+				return false;
+		// link condition ensuring that the collapse preserves manifoldness
+		unsigned nr_shared = count_shared_triangles(r, s);
+		if (nr_shared == 0 || nr_shared > 2)
+			return false;
+		if (nr_shared == 2 && boundary[r] && boundary[s])
+			return false;
+		unsigned nr_common = 0;
+		for (size_t i = 0, j = 0; i < neighbors_r.size() && j < neighbors_s.size(); ) {
+			if (neighbors_r[i] < neighbors_s[j])
+				++i;
+			else if (neighbors_s[j] < neighbors_r[i])
+				++j;
+			else {
+				++nr_common;
+				++i;
+				++j;
+			}
+		}
+		if (nr_common != nr_shared)
+			return false;
+		// reject collapses that flip or degenerate remaining triangles
+		for (idx_type m : { r, s }) {
+			for (idx_type t : vertex_triangles[m]) {
+				const idx_type* tri = &triangles[3 * t];
+				if ((tri[0] == r || tri[1] == r || tri[2] == r) && (tri[0] == s || tri[1] == s || tri[2] == s))
+					continue;
+				typedef cgv::math::fvec<double, 3> dvec3;
+				dvec3 p[3], p_new[3];
+				for (unsigned k = 0; k < 3; ++k) {
+					p[k] = dvec3(3, vector(tri[k]));
+					p_new[k] = tri[k] == m ? dvec3(3, x) : p[k];
+				}
+				dvec3 n_old = cross(p[1] - p[0], p[2] - p[0]);
+				dvec3 n_new = cross(p_new[1] - p_new[0], p_new[2] - p_new[0]);
+				double l_old = n_old.length(), l_new = n_new.length();
+				if (l_new < 1e-30)
+					return false;
+				if (l_old > 1e-30 && dot(n_old, n_new) < min_normal_cosine * l_old * l_new)
+					return false;
+			}
+		}
+		return true;
+	}
+	/// collapse r into s with target vector x and return number of removed triangles
+	size_t collapse(idx_type r, idx_type s, const double* x)
+	{
+		std::copy(x, x + n, vector(s));
+		cgv::math::qem<double> Qr, Qs;
+		Qr.set_extern_data(q, quadric(r));
+		Qs.set_extern_data(q, quadric(s));
+		Qs += Qr;
+		vertex_alive[r] = 0;
+		++stamps[r];
+		++stamps[s];
+		size_t nr_removed = 0;
+		for (idx_type t : vertex_triangles[r]) {
+			idx_type* tri = &triangles[3 * t];
+			if (tri[0] == s || tri[1] == s || tri[2] == s) {
+				triangle_alive[t] = 0;
+				++nr_removed;
+				for (unsigned k = 0; k < 3; ++k)
+					if (tri[k] != r && tri[k] != s) {
+						auto& vt = vertex_triangles[tri[k]];
+						vt.erase(std::find(vt.begin(), vt.end(), t));
+					}
+			}
+			else {
+				for (unsigned k = 0; k < 3; ++k)
+					if (tri[k] == r)
+						tri[k] = s;
+				vertex_triangles[s].push_back(t);
+			}
+		}
+		auto& vt = vertex_triangles[s];
+		vt.erase(std::remove_if(vt.begin(), vt.end(), [&](idx_type t) { return !triangle_alive[t]; }), vt.end());
+		std::vector<idx_type>().swap(vertex_triangles[r]);
+		return nr_removed;
+	}
+	/// push the collapse candidates of all edges incident to v whose other vertex lies in the cell and whose cost does not exceed the threshold
+	void push_candidates(idx_type v, uint32_t cell, double max_cost, const std::vector<idx_type>& neighbors, std::vector<collapse_candidate>& heap, bool keep_heap)
+	{
+		double x[max_dim];
+		idx_type r, s;
+		for (idx_type w : neighbors) {
+			if (cells[w] != cell)
+				continue;
+			double cost = plan_collapse(v, w, r, s, x);
+			if (cost > max_cost)
+				continue;
+			heap.push_back({ cost, v, w, stamps[v], stamps[w] });
+			if (keep_heap)
+				std::push_heap(heap.begin(), heap.end());
+		}
+	}
+	/** estimate the collapse cost below which the given fraction of the edges lies from a sample of the edges
+	    of at most max_nr_samples vertices */
+	double estimate_cost_quantile(double fraction, size_t max_nr_samples) const
+	{
+		size_t nr_vertices = vertex_alive.size(), step = std::max(size_t(1), nr_vertices / max_nr_samples);
+		std::vector<double> costs;
+		std::vector<idx_type> neighbors;
+		double x[max_dim];
+		idx_type r, s;
+		for (size_t u = 0; u < nr_vertices; u += step) {
+			if (!vertex_alive[u])
+				continue;
+			collect_neighbors(idx_type(u), neighbors);
+			for (idx_type w : neighbors)
+				if (w > u)
+					costs.push_back(plan_collapse(idx_type(u), w, r, s, x));
+		}
+		if (costs.empty())
+			return 0;
+		size_t k = std::min(costs.size() - 1, size_t(fraction * costs.size()));
+		std::nth_element(costs.begin(), costs.begin() + k, costs.end());
+		return costs[k];
+	}
+	/** collapse edges of the given vertices of a cell in the order of increasing cost up to the cost threshold
+	    until the number of remaining triangles to be removed drops to zero. Only vertices whose neighbors belong
+		to the cell are touched, such that cells can be simplified concurrently. Returns number of collapses. */
+	size_t simplify_cell(uint32_t cell, const std::vector<idx_type>& vertices, double max_cost, std::atomic<ptrdiff_t>& nr_to_remove)
+	{
+		std::vector<collapse_candidate> heap;
+		std::vector<idx_type> neighbors_r, neighbors_s;
+		for (idx_type u : vertices) {
+			if (!vertex_alive[u])
+				continue;
+			collect_neighbors(u, neighbors_r);
+			neighbors_r.erase(neighbors_r.begin(), std::upper_bound(neighbors_r.begin(), neighbors_r.end(), u));
+			push_candidates(u, cell, max_cost, neighbors_r, heap, false);
+		}
+		std::make_heap(heap.begin(), heap.end());
+		size_t nr_collapses = 0;
+		double x[max_dim];
+		while (!heap.empty() && nr_to_remove > 0) {
+			std::pop_heap(heap.begin(), heap.end());
+			collapse_candidate c = heap.back();
+			heap.pop_back();
+			if (!vertex_alive[c.u] || !vertex_alive[c.v] || stamps[c.u] != c.stamp_u || stamps[c.v] != c.stamp_v)
+				continue;
+			idx_type r, s;
+			double cost = plan_collapse(c.u, c.v, r, s, x);
+			if (cost > max_cost)
+				break;
+			if (!is_collapse_valid(r, s, x, cell, neighbors_r, neighbors_s))
+				continue;
+			nr_to_remove -= ptrdiff_t(collapse(r, s, x));
+			++nr_collapses;
+			collect_neighbors(s, neighbors_s);
+			push_candidates(s, cell, max_cost, neighbors_s, heap, true);
+		}
+		return nr_collapses;
+	}
+};
+
+}
+
+template <typename T>
+mesh_simplifier<T>::mesh_simplifier(const simplification_parameters& _parameters) : parameters(_parameters)
+{
+	statistics = simplification_statistics();
+}
+
+template <typename T>
+bool mesh_simplifier<T>::simplify(mesh_type& mesh)
+{
+	typedef typename mesh_type::vec3_type vec3_type;
+	typedef typename mesh_type::vec2_type vec2_type;
+	statistics = simplification_statistics();
+	idx_type nr_positions = mesh.get_nr_positions();
+	if (nr_positions == 0 || mesh.get_nr_faces() == 0)
+		return false;
+	unsigned nr_threads = parameters.nr_threads;
+	if (nr_threads == 0)
+		nr_threads = cgv::os::task_scheduler::get().get_concurrency();
+
+	// decide on the attributes considered in the quadrics
+	bool use_normals = parameters.normal_weight > 0 && mesh.has_normals() && mesh.has_normal_indices();
+	bool use_tex_coords = parameters.tex_coord_weight > 0 && mesh.has_tex_coords() && mesh.has_tex_coord_indices();
+	bool use_colors = parameters.color_weight > 0 && mesh.has_colors() && mesh.get_nr_colors() == nr_positions;
+	simplification_state S;
+	S.init_layout(3 + (use_normals ? 3 : 0) + (use_tex_coords ? 2 : 0) + (use_colors ? 4 : 0));
+	unsigned normal_offset = 3, tex_coord_offset = normal_offset + (use_normals ? 3 : 0), color_offset = tex_coord_offset + (use_tex_coords ? 2 : 0);
+	S.min_normal_cosine = parameters.min_normal_cosine;
+	S.boundary_weight = parameters.boundary_weight;
+
+	// construct vertex vectors with positions normalized to the unit diagonal
+	auto box = mesh.compute_box();
+	vec3_type box_min = box.get_min_pnt(), extent = box.get_extent();
+	double diagonal = extent.length();
+	if (diagonal == 0)
+		diagonal = 1;
+	S.vectors.resize(size_t(S.n) * nr_positions, 0.0);
+	S.locked.resize(nr_positions, 0);
+	std::vector<idx_type> first_tex_coord(use_tex_coords ? nr_positions : 0, idx_type(-1));
+	std::vector<uint32_t> nr_tex_coords(use_tex_coords ? nr_positions : 0, 0);
+	for (idx_type pi = 0; pi < nr_positions; ++pi)
+		for (unsigned i = 0; i < 3; ++i)
+			S.vector(pi)[i] = (mesh.position(pi)[i] - box_min[i]) / diagonal;
+	for (idx_type ci = 0; ci < mesh.get_nr_corners(); ++ci) {
+		double* x = S.vector(mesh.c2p(ci));
+		if (use_normals) {
+			const vec3_type& nml = mesh.normal(mesh.c2n(ci));
+			for (unsigned i = 0; i < 3; ++i)
+				x[normal_offset + i] += nml[i];
+		}
+		if (use_tex_coords) {
+			idx_type pi = mesh.c2p(ci), ti = mesh.c2t(ci);
+			if (first_tex_coord[pi] == idx_type(-1))
+				first_tex_coord[pi] = ti;
+			else if (ti != first_tex_coord[pi] && mesh.tex_coord(ti) != mesh.tex_coord(first_tex_coord[pi]))
+				S.locked[pi] = 1;
+			const vec2_type& tc = mesh.tex_coord(ti);
+			x[tex_coord_offset] += tc[0];
+			x[tex_coord_offset + 1] += tc[1];
+			++nr_tex_coords[pi];
+		}
+	}
+	for (idx_type pi = 0; pi < nr_positions; ++pi) {
+		double* x = S.vector(pi);
+		if (use_normals) {
+			double l = std::sqrt(x[normal_offset] * x[normal_offset] + x[normal_offset + 1] * x[normal_offset + 1] + x[normal_offset + 2] * x[normal_offset + 2]);
+			for (unsigned i = 0; i < 3; ++i)
+				x[normal_offset + i] *= l > 0 ? parameters.normal_weight / l : 0.0;
+		}
+		if (use_tex_coords && nr_tex_coords[pi] > 0)
+			for (unsigned i = 0; i < 2; ++i)
+				x[tex_coord_offset + i] *= parameters.tex_coord_weight / nr_tex_coords[pi];
+		if (use_colors) {
+			rgba col;
+			mesh.put_color(pi, col);
+			for (unsigned i = 0; i < 4; ++i)
+				x[color_offset + i] = parameters.color_weight * col[i];
+		}
+	}
+
+	// triangulate faces and build vertex to triangle adjacency
+	for (idx_type fi = 0; fi < mesh.get_nr_faces(); ++fi) {
+		idx_type c0 = mesh.begin_corner(fi);
+		for (idx_type ci = c0 + 1; ci + 1 < mesh.end_corner(fi); ++ci) {
+			idx_type p0 = mesh.c2p(c0), p1 = mesh.c2p(ci), p2 = mesh.c2p(ci + 1);
+			if (p0 == p1 || p1 == p2 || p2 == p0)
+				continue;
+			S.triangles.push_back(p0);
+			S.triangles.push_back(p1);
+			S.triangles.push_back(p2);
+			S.triangle_faces.push_back(fi);
+		}
+	}
+	size_t nr_triangles = S.triangle_faces.size();
+	S.triangle_alive.resize(nr_triangles, 1);
+	std::vector<uint32_t> valence(nr_positions, 0);
+	for (idx_type pi : S.triangles)
+		++valence[pi];
+	S.vertex_triangles.resize(nr_positions);
+	for (idx_type pi = 0; pi < nr_positions; ++pi)
+		S.vertex_triangles[pi].reserve(valence[pi]);
+	for (size_t t = 0; t < nr_triangles; ++t)
+		for (unsigned k = 0; k < 3; ++k)
+			S.vertex_triangles[S.triangles[3 * t + k]].push_back(idx_type(t));
+	S.vertex_alive.resize(nr_positions);
+	for (idx_type pi = 0; pi < nr_positions; ++pi)
+		S.vertex_alive[pi] = valence[pi] > 0 ? 1 : 0;
+	S.stamps.resize(nr_positions, 0);
+	S.boundary.resize(nr_positions, 0);
+	S.quadrics.resize(size_t(S.q) * nr_positions);
+	cgv::os::parallel_for(0, nr_positions, [&](size_t begin, size_t end) {
+		for (size_t pi = begin; pi < end; ++pi)
+			S.compute_vertex_quadric(idx_type(pi));
+	}, 4096, nr_threads);
+
+	statistics.nr_vertices_before = nr_positions;
+	statistics.nr_triangles_before = nr_triangles;
+	double max_cost = parameters.max_error < 0 ? std::numeric_limits<double>::max() : parameters.max_error * parameters.max_error;
+	std::atomic<ptrdiff_t> nr_to_remove(parameters.target_nr_faces == 0 ? std::numeric_limits<ptrdiff_t>::max() :
+		ptrdiff_t(nr_triangles) - ptrdiff_t(std::min(parameters.target_nr_faces, nr_triangles)));
+
+	/* Simplify slabs along the longest extent independently, which improves memory locality and is done in parallel.
+	   Each pass collapses edges up to the cost below which the edges that need to be collapsed lie, such that collapses
+	   roughly follow the global order of increasing cost. Subsequent passes shift the slabs by half a slab width. */
+	S.cells.resize(nr_positions);
+	unsigned nr_slabs = std::max(4 * nr_threads, unsigned(nr_positions / 32768));
+	if (nr_slabs > 1) {
+		unsigned axis = extent[1] > extent[0] ? 1 : 0;
+		if (extent[2] > extent[axis])
+			axis = 2;
+		double axis_extent = std::max(double(extent[axis]) / diagonal, 1e-30);
+		for (unsigned pass = 0; pass < 8 && nr_to_remove > 0; ++pass) {
+			size_t nr_alive = nr_triangles - size_t(std::count(S.triangle_alive.begin(), S.triangle_alive.end(), 0));
+			double fraction = nr_to_remove == std::numeric_limits<ptrdiff_t>::max() ? 1.0 : double(nr_to_remove) / nr_alive;
+			double cost_threshold = std::min(max_cost, S.estimate_cost_quantile(std::min(fraction, 1.0), 16384));
+			uint32_t nr_cells = nr_slabs + pass % 2;
+			std::vector<std::vector<idx_type> > cell_vertices(nr_cells);
+			for (idx_type pi = 0; pi < nr_positions; ++pi) {
+				double c = S.vector(pi)[axis] / axis_extent * nr_slabs + 0.5 * (pass % 2);
+				S.cells[pi] = uint32_t(std::min(std::max(c, 0.0), double(nr_cells - 1)));
+				if (S.vertex_alive[pi])
+					cell_vertices[S.cells[pi]].push_back(pi);
+			}
+			std::atomic<size_t> nr_collapses(0);
+			cgv::os::parallel_for(0, nr_cells, [&](size_t ci, size_t) {
+				nr_collapses += S.simplify_cell(uint32_t(ci), cell_vertices[ci], cost_threshold, nr_to_remove);
+			}, 1, nr_threads);
+			statistics.nr_parallel_collapses += nr_collapses;
+			// stop once passes become ineffective
+			if (nr_collapses < nr_alive / 50)
+				break;
+		}
+	}
+
+	// sequential pass over the complete mesh reaches the target triangle count
+	if (nr_to_remove > 0) {
+		std::fill(S.cells.begin(), S.cells.end(), 0);
+		std::vector<idx_type> vertices;
+		for (idx_type pi = 0; pi < nr_positions; ++pi)
+			if (S.vertex_alive[pi])
+				vertices.push_back(pi);
+		statistics.nr_sequential_collapses = S.simplify_cell(0, vertices, max_cost, nr_to_remove);
+	}
+	size_t nr_alive = nr_triangles - size_t(std::count(S.triangle_alive.begin(), S.triangle_alive.end(), 0));
+
+	// construct simplified mesh with per position attributes
+	mesh_type result;
+	for (size_t mi = 0; mi < mesh.get_nr_materials(); ++mi)
+		result.ref_material(result.new_material()) = mesh.get_material(mi);
+	for (size_t gi = 0; gi < mesh.get_nr_groups(); ++gi)
+		result.new_group(mesh.group_name(gi));
+	std::vector<idx_type> vertex_map(nr_positions, idx_type(-1));
+	idx_type nr_vertices = 0;
+	for (idx_type pi = 0; pi < nr_positions; ++pi)
+		if (S.vertex_alive[pi] && !S.vertex_triangles[pi].empty())
+			vertex_map[pi] = nr_vertices++;
+	if (use_colors)
+		result.ensure_colors(mesh.get_color_storage_type(), nr_vertices);
+	for (idx_type pi = 0; pi < nr_positions; ++pi) {
+		if (vertex_map[pi] == idx_type(-1))
+			continue;
+		const double* x = S.vector(pi);
+		result.new_position(vec3_type(T(box_min[0] + x[0] * diagonal), T(box_min[1] + x[1] * diagonal), T(box_min[2] + x[2] * diagonal)));
+		if (use_normals) {
+			vec3_type nml(T(x[normal_offset]), T(x[normal_offset + 1]), T(x[normal_offset + 2]));
+			nml.normalize();
+			result.new_normal(nml);
+		}
+		if (use_tex_coords)
+			result.new_tex_coord(vec2_type(T(x[tex_coord_offset] / parameters.tex_coord_weight), T(x[tex_coord_offset + 1] / parameters.tex_coord_weight)));
+		if (use_colors) {
+			double w = 1.0 / parameters.color_weight;
+			result.set_color(vertex_map[pi], rgba(float(x[color_offset] * w), float(x[color_offset + 1] * w), float(x[color_offset + 2] * w), float(x[color_offset + 3] * w)));
+		}
+	}
+	bool copy_materials = mesh.get_nr_materials() > 0, copy_groups = mesh.get_nr_groups() > 0;
+	for (size_t t = 0; t < nr_triangles; ++t) {
+		if (!S.triangle_alive[t])
+			continue;
+		idx_type fi = result.start_face();
+		if (copy_materials)
+			result.material_index(fi) = mesh.material_index(S.triangle_faces[t]);
+		if (copy_groups)
+			result.group_index(fi) = mesh.group_index(S.triangle_faces[t]);
+		for (unsigned k = 0; k < 3; ++k) {
+			idx_type vi = vertex_map[S.triangles[3 * t + k]];
+			result.new_corner(vi, use_normals ? vi : idx_type(-1), use_tex_coords ? vi : idx_type(-1));
+		}
+	}
+	statistics.nr_vertices_after = nr_vertices;
+	statistics.nr_triangles_after = nr_alive;
+	mesh = std::move(result);
+	return true;
+}
+
+template class mesh_simplifier<float>;
+template class mesh_simplifier<double>;
+
+		}
+	}
+}
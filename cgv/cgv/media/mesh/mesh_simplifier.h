@@ -0,0 +1,77 @@
+#pragma once
+
+#include "simple_mesh.h"
+
+#include "../lib_begin.h"
+
+namespace cgv {
+	namespace media {
+		namespace mesh {
+
+/// parameters steering the quadric error metric based simplification of a simple_mesh
+struct CGV_API simplification_parameters
+{
+	/// number of triangles at which simplification stops, 0 lets only the error threshold stop simplification
+	size_t target_nr_faces;
+	/// maximum quadric error given as distance relative to the bounding box diagonal, negative values disable the threshold
+	double max_error;
+	/// weight of per vertex normals in the attribute aware quadrics, 0 ignores normals
+	double normal_weight;
+	/// weight of per vertex texture coordinates in the attribute aware quadrics, 0 ignores texture coordinates
+	double tex_coord_weight;
+	/// weight of per position colors in the attribute aware quadrics, 0 ignores colors
+	double color_weight;
+	/// weight of the constraint planes perpendicular to boundary edges
+	double boundary_weight;
+	/// minimum cosine between a face normal before and after a collapse
+	double min_normal_cosine;
+	/// number of threads used to simplify partitions in parallel, 0 uses all hardware threads
+	unsigned nr_threads;
+	/// set defaults
+	simplification_parameters();
+};
+
+/// statistics gathered during the last simplification
+struct simplification_statistics
+{
+	size_t nr_vertices_before, nr_vertices_after;
+	size_t nr_triangles_before, nr_triangles_after;
+	/// number of edge collapses performed in parallel partitions and in the final sequential pass
+	size_t nr_parallel_collapses, nr_sequential_collapses;
+};
+
+/** edge collapse simplification of simple meshes based on quadric error metrics (cgv::math::qem) that are
+    extended by vertex attributes following Garland and Heckbert 98. Each vertex corresponds to a position of
+	the mesh. Normals and texture coordinates are averaged per position and colors need to be stored per position.
+	Positions with discontinuous texture coordinates are not moved in order to preserve texture seams.
+	Polygonal faces are triangulated, tangents are dropped and material and group indices are preserved.
+
+	The mesh is split into slabs along its longest extent that are simplified in parallel where only edges
+	whose one-ring lies completely inside of a slab are collapsed. Each pass collapses edges up to an estimated
+	cost quantile such that the result is close to the global greedy order. Passes alternate between shifted
+	slab boundaries and a final sequential pass removes the remaining triangles. */
+template <typename T = float>
+class CGV_API mesh_simplifier
+{
+public:
+	/// type of simplified mesh
+	typedef simple_mesh<T> mesh_type;
+protected:
+	simplification_parameters parameters;
+	simplification_statistics statistics;
+public:
+	/// construct with default parameters
+	mesh_simplifier(const simplification_parameters& _parameters = simplification_parameters());
+	/// return reference to simplification parameters
+	simplification_parameters& ref_parameters() { return parameters; }
+	/// return statistics of last simplification
+	const simplification_statistics& get_statistics() const { return statistics; }
+	/// simplify mesh in place and return whether the mesh could be simplified
+	bool simplify(mesh_type& mesh);
+};
+
+		}
+	}
+}
+
+#include <cgv/config/lib_end.h>
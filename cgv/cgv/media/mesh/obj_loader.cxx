@@ -1,6 +1,8 @@
 #include "obj_loader.h"
 #include <cgv/utils/file.h>
+#include <cgv/utils/mapped_file.h>
 #include <cgv/type/standard_types.h>
+#include <cgv/utils/trace_profiler.h>
 
 using namespace cgv::utils::file;
 using namespace cgv::type;
@@ -140,6 +142,7 @@ const char* get_bin_extension<float>()
 template <typename T>
 bool obj_loader_generic<T>::read_obj(const std::string& file_name)
 {
+	CGV_PROFILE_ZONE("obj_loader::read_obj");
 	// check if binary file exists
 	std::string bin_fn = drop_extension(file_name) + get_bin_extension<T>();
 	if (exists(bin_fn) &&
@@ -181,23 +184,23 @@ bool obj_loader_generic<T>::read_obj(const std::string& file_name)
 template <typename T>
 bool obj_loader_generic<T>::read_obj_bin(const std::string& file_name)
 {
-	// open binary file
-	FILE* fp = fopen(file_name.c_str(), "rb");
-	if (!fp)
+	CGV_PROFILE_ZONE("obj_loader::read_obj_bin");
+	// map binary file
+	cgv::utils::mapped_file mf(file_name);
+	if (!mf.is_open())
 		return false;
+	mf.advise(cgv::utils::mapped_file::SEQUENTIAL);
 
 	// read element count
 	uint32_type v, n, t, f, h, g, m, l = 0;
-	if (1!=fread(&v, sizeof(uint32_type), 1, fp) ||
-		1!=fread(&n, sizeof(uint32_type), 1, fp) ||
-		1!=fread(&t, sizeof(uint32_type), 1, fp) ||
-		1!=fread(&f, sizeof(uint32_type), 1, fp) ||
-		1!=fread(&h, sizeof(uint32_type), 1, fp) ||
-		1!=fread(&g, sizeof(uint32_type), 1, fp) ||
-		1!=fread(&m, sizeof(uint32_type), 1, fp)) {
-		fclose(fp);
+	if (!mf.read(v) ||
+		!mf.read(n) ||
+		!mf.read(t) ||
+		!mf.read(f) ||
+		!mf.read(h) ||
+		!mf.read(g) ||
+		!mf.read(m))
 		return false;
-	}
 	bool has_colors = false;
 	if (v > 0x7FFFFFFF) {
 		v = 0xFFFFFFFF - v;
@@ -209,10 +212,8 @@ bool obj_loader_generic<T>::read_obj_bin(const std::string& file_name)
 		has_lines = true;
 	}
 	if (has_lines) {
-		if (1 != fread(&l, sizeof(uint32_type), 1, fp)) {
-			fclose(fp);
+		if (!mf.read(l))
 			return false;
-		}
 	}
 	// reserve space
 	vertices.resize(v);
@@ -220,77 +221,50 @@ bool obj_loader_generic<T>::read_obj_bin(const std::string& file_name)
 		colors.resize(v);
 
 	vertex_indices.resize(h);
-	if (v != fread(&vertices[0], sizeof(vec3_type), v, fp) ||
-		h > 0 && h != fread(&vertex_indices[0], sizeof(unsigned), h, fp) )
-	{
-		fclose(fp);
+	if (!mf.read_array(&vertices[0], v) ||
+		h > 0 && !mf.read_array(&vertex_indices[0], h))
 		return false;
-	}
 	if (has_colors) {
-		if (v != fread(&colors[0], sizeof(color_type), v, fp))
-		{
-			fclose(fp);
+		if (!mf.read_array(&colors[0], v))
 			return false;
-		}
 	}
 	if (n > 0) {
 		normals.resize(n);
 		normal_indices.resize(h);
-		if (n != fread(&normals[0], sizeof(vec3_type), n, fp) ||
-			h > 0 && h != fread(&normal_indices[0], sizeof(unsigned), h, fp) )
-		{
-			fclose(fp);
+		if (!mf.read_array(&normals[0], n) ||
+			h > 0 && !mf.read_array(&normal_indices[0], h))
 			return false;
-		}
 	}
 	if (t > 0) {
 		texcoords.resize(t);
 		texcoord_indices.resize(h);
-		if (t != fread(&texcoords[0], sizeof(vec2_type), t, fp) ||
-			h > 0 && h != fread(&texcoord_indices[0], sizeof(unsigned), h, fp) )
-		{
-			fclose(fp);
+		if (!mf.read_array(&texcoords[0], t) ||
+			h > 0 && !mf.read_array(&texcoord_indices[0], h))
 			return false;
-		}
 	}
 	lines.resize(l);
-	if (l > 0 && l != fread(&lines[0], sizeof(line_info), l, fp))
-	{
-		fclose(fp);
+	if (l > 0 && !mf.read_array(&lines[0], l))
 		return false;
-	}
 	faces.resize(f);
-	if (f > 0 && f != fread(&faces[0], sizeof(face_info), f, fp))
-	{
-		fclose(fp);
+	if (f > 0 && !mf.read_array(&faces[0], f))
 		return false;
-	}
 	groups.resize(g);
 	for (unsigned gi=0; gi<g; ++gi) {
-		if (!read_string_bin(groups[gi].name, fp) ||
-			!read_string_bin(groups[gi].parameters, fp))
-		{
-			fclose(fp);
+		if (!mf.read_string_bin(groups[gi].name) ||
+			!mf.read_string_bin(groups[gi].parameters))
 			return false;
-		}
 	}
-	if (1 != fread(&this->have_default_material, sizeof(bool), 1, fp))
-	{
-		fclose(fp);
+	if (!mf.read(this->have_default_material))
 		return false;
-	}
 	if (this->have_default_material)
 		materials.push_back(obj_material());
 	
 	for (unsigned mi=0; mi<m; ++mi) {
 		std::string s;
-		if (!read_string_bin(s, fp)) {
-			fclose(fp);
+		if (!mf.read_string_bin(s))
 			return false;
-		}
 		obj_reader_generic<T>::read_mtl(s);
 	}
-	fclose(fp);
 	return true;
 }
 
@@ -5,6 +5,7 @@
 #include <cgv/utils/advanced_scan.h>
 #include <cgv/utils/tokenizer.h>
 #include <cgv/base/import.h>
+#include <cgv/utils/trace_profiler.h>
 
 using namespace cgv::math;
 using namespace cgv::type;
@@ -21,10 +22,13 @@ namespace cgv {
 
 			bool is_double_impl(const char* begin, const char* end, float& value)
 			{
-				double valued;
-				bool res = cgv::utils::is_double(begin, end, valued);
-				value = (float)valued;
-				return res;
+				// parse directly to float to avoid rounding twice
+				float new_value;
+				const char* p = cgv::utils::parse_float(begin, end, new_value);
+				if (!p || !(p == end || *p == 0 || cgv::utils::is_space(*p)))
+					return false;
+				value = new_value;
+				return true;
 			}
 
 			bool is_double_impl(const char* begin, const char* end, double& value)
@@ -194,6 +198,7 @@ void obj_reader_generic<T>::parse_and_process_texcoord(const std::vector<cgv::ut
 
 bool obj_reader_base::read_obj(const std::string& file_name)
 {
+	CGV_PROFILE_ZONE("obj_reader::read_obj");
 	std::string content;
 	if (!cgv::base::read_data_file(file_name, content, true))
 		return false;
@@ -310,6 +315,7 @@ bool obj_reader_base::parse_obj(const std::string & content, const std::string p
 
 bool obj_reader_base::read_mtl(const std::string& file_name)
 {
+	CGV_PROFILE_ZONE("obj_reader::read_mtl");
 	std::string fn = cgv::base::find_data_file(file_name, "McpD", "", path_name);
 	if (path_name.empty()) {
 		path_name = file::get_path(file_name);
@@ -6,12 +6,63 @@
 #include <cgv/utils/advanced_scan.h>
 #include <cgv/media/mesh/obj_reader.h>
 #include <cgv/math/bucket_sort.h>
+#include <cgv/os/task_scheduler.h>
 #include <fstream>
+#include <numeric>
+#include <algorithm>
+#include <cgv/utils/trace_profiler.h>
 
 namespace cgv {
 	namespace media {
 		namespace mesh {
 
+namespace {
+
+typedef simple_mesh_base::idx_type idx_type;
+
+/// return number of bits needed to represent the indices below n
+unsigned nr_index_bits(size_t n)
+{
+	unsigned b = 1;
+	while (b < 32 && (size_t(1) << b) < n)
+		++b;
+	return b;
+}
+
+/** call f(begin, end) for each run of half-edges that share the same edge and whose smaller position index is pi,
+	where half-edges are given as pairs of other position index and corner index and are collected in the buffer */
+template <typename F>
+void for_each_edge_at(const simple_mesh_base& M, const simple_mesh_base::corner_table& T, idx_type pi,
+					  std::vector<std::pair<idx_type, idx_type>>& half_edges, F f)
+{
+	// outgoing half-edges include degenerate ones, incoming half-edges are considered from larger position indices only
+	half_edges.clear();
+	for (const idx_type* ci = T.begin_vertex_corners(pi); ci != T.end_vertex_corners(pi); ++ci) {
+		idx_type pj = M.c2p(T.next[*ci]), pk = M.c2p(T.prev[*ci]);
+		if (pj >= pi)
+			half_edges.push_back(std::make_pair(pj, *ci));
+		if (pk > pi)
+			half_edges.push_back(std::make_pair(pk, T.prev[*ci]));
+	}
+	for (size_t i = 1; i < half_edges.size(); ++i)
+		for (size_t j = i; j > 0 && half_edges[j].first < half_edges[j - 1].first; --j)
+			std::swap(half_edges[j], half_edges[j - 1]);
+	for (size_t i = 0; i < half_edges.size(); ) {
+		size_t j = i + 1;
+		while (j < half_edges.size() && half_edges[j].first == half_edges[i].first)
+			++j;
+		f(&half_edges[i], &half_edges[0] + j);
+		i = j;
+	}
+}
+
+}
+
+void simple_mesh_base::corner_table::clear()
+{
+	*this = corner_table();
+}
+
 std::string simple_mesh_base::get_attribute_name(attribute_type attr)
 {
 	const char* attribute_names[] = { "position", "texcoords", "normal", "tangent", "color" };
@@ -46,8 +97,11 @@ simple_mesh_base::simple_mesh_base(simple_mesh_base&& smb) :
 	group_indices(std::move(smb.group_indices)),
 	group_names(std::move(smb.group_names)),
 	material_indices(std::move(smb.material_indices)),
-	materials(std::move(smb.materials))
+	materials(std::move(smb.materials)),
+	ct(std::move(smb.ct)),
+	ct_valid(smb.ct_valid)
 {
+	smb.ct_valid = false;
 }
 simple_mesh_base& simple_mesh_base::operator=(const simple_mesh_base& smb)
 {
@@ -60,6 +114,7 @@ simple_mesh_base& simple_mesh_base::operator=(const simple_mesh_base& smb)
 	group_names=smb.group_names;
 	material_indices=smb.material_indices;
 	materials = smb.materials;
+	ct_valid = false;
 	return *this;
 }
 simple_mesh_base& simple_mesh_base::operator=(simple_mesh_base&& smb)
@@ -73,10 +128,14 @@ simple_mesh_base& simple_mesh_base::operator=(simple_mesh_base&& smb)
 	group_names=std::move(smb.group_names);
 	material_indices=std::move(smb.material_indices);
 	materials = std::move(smb.materials);
+	ct = std::move(smb.ct);
+	ct_valid = smb.ct_valid;
+	smb.ct_valid = false;
 	return *this;
 }
 simple_mesh_base::idx_type simple_mesh_base::start_face()
 {
+	ct_valid = false;
 	faces.push_back((cgv::type::uint32_type)position_indices.size());
 	if (!materials.empty())
 		material_indices.push_back(idx_type(materials.size()) - 1);
@@ -87,6 +146,7 @@ simple_mesh_base::idx_type simple_mesh_base::start_face()
 simple_mesh_base::idx_type simple_mesh_base::new_corner(idx_type position_index, idx_type normal_index,
 														idx_type tex_coord_index)
 {
+	ct_valid = false;
 	position_indices.push_back(position_index);
 	if (normal_index != -1) //FIXME: -1 underflows unsigned int!
 		normal_indices.push_back(normal_index);
@@ -98,6 +158,7 @@ void simple_mesh_base::revert_face_orientation()
 {
 	bool nmls = position_indices.size() == normal_indices.size();
 	bool tcs  = position_indices.size() == tex_coord_indices.size();
+	ct_valid = false;
 	for (idx_type fi = 0; fi < get_nr_faces(); ++fi) {
 		idx_type ci = begin_corner(fi);
 		idx_type cj = end_corner(fi);
@@ -262,6 +323,103 @@ simple_mesh_base::idx_type simple_mesh_base::extract_vertex_attribute_buffer_bas
 	}
 	return vs;
 }
+void simple_mesh_base::invalidate_corner_table()
+{
+	ct_valid = false;
+}
+const simple_mesh_base::corner_table& simple_mesh_base::get_corner_table(unsigned nr_threads) const
+{
+	std::lock_guard<std::mutex> lock(ct_mutex);
+	// positions can also be added through ref_positions() without invalidating the table
+	if (!ct_valid || ct.v2c_begin.size() != size_t(get_nr_positions()) + 1 || ct.next.size() != position_indices.size()) {
+		build_corner_table(nr_threads);
+		ct_valid = true;
+	}
+	return ct;
+}
+void simple_mesh_base::build_corner_table(unsigned nr_threads) const
+{
+	idx_type nr_corners = get_nr_corners(), nr_positions = get_nr_positions();
+	nr_threads = cgv::os::choose_nr_chunks(nr_corners, nr_threads);
+	ct.next.resize(nr_corners);
+	ct.prev.resize(nr_corners);
+	ct.c2f.resize(nr_corners);
+	cgv::os::parallel_chunks(get_nr_faces(), nr_threads, [&](unsigned, size_t b, size_t e) {
+		for (idx_type fi = idx_type(b); fi < e; ++fi) {
+			idx_type cb = begin_corner(fi), ce = end_corner(fi), cp = ce - 1;
+			for (idx_type ci = cb; ci < ce; ++ci) {
+				ct.next[cp] = ci;
+				ct.prev[ci] = cp;
+				ct.c2f[ci] = fi;
+				cp = ci;
+			}
+		}
+	});
+	// radix sort corners by position to extract the incident corners of each position
+	std::vector<uint32_t> position_keys(position_indices);
+	ct.v2c.resize(nr_corners);
+	std::iota(ct.v2c.begin(), ct.v2c.end(), idx_type(0));
+	cgv::os::parallel_radix_sort(position_keys, ct.v2c, nr_index_bits(nr_positions), nr_threads);
+	ct.v2c_begin.resize(nr_positions + 1);
+	cgv::os::parallel_chunks(nr_corners, nr_threads, [&](unsigned, size_t b, size_t e) {
+		for (size_t i = b; i < e; ++i)
+			for (idx_type pi = i == 0 ? 0 : position_keys[i - 1] + 1; pi <= position_keys[i]; ++pi)
+				ct.v2c_begin[pi] = idx_type(i);
+	});
+	for (idx_type pi = nr_corners == 0 ? 0 : position_keys.back() + 1; pi <= nr_positions; ++pi)
+		ct.v2c_begin[pi] = nr_corners;
+	position_keys = std::vector<uint32_t>();
+	// match half-edges at the smaller position index of their edge
+	ct.inv.resize(nr_corners);
+	std::vector<idx_type> nr_matched(nr_threads, 0);
+	cgv::os::parallel_chunks(nr_positions, nr_threads, [&](unsigned t, size_t b, size_t e) {
+		std::vector<std::pair<idx_type, idx_type>> half_edges;
+		for (idx_type pi = idx_type(b); pi < e; ++pi)
+			for_each_edge_at(*this, ct, pi, half_edges, [&](const std::pair<idx_type, idx_type>* he_begin, const std::pair<idx_type, idx_type>* he_end) {
+				if (he_end - he_begin == 2) {
+					ct.inv[he_begin[0].second] = he_begin[1].second;
+					ct.inv[he_begin[1].second] = he_begin[0].second;
+					++nr_matched[t];
+				}
+				else
+					for (auto he = he_begin; he != he_end; ++he)
+						ct.inv[he->second] = idx_type(-1);
+			});
+	});
+	ct.nr_manifold_edges = std::accumulate(nr_matched.begin(), nr_matched.end(), idx_type(0));
+	// enumerate edges in corner order by their corners of smaller index
+	std::vector<idx_type> edge_offsets(nr_threads + 1, 0);
+	cgv::os::parallel_chunks(nr_corners, nr_threads, [&](unsigned t, size_t b, size_t e) {
+		for (size_t ci = b; ci < e; ++ci)
+			if (ct.inv[ci] > ci)
+				++edge_offsets[t + 1];
+	});
+	std::partial_sum(edge_offsets.begin(), edge_offsets.end(), edge_offsets.begin());
+	ct.c2e.resize(nr_corners);
+	ct.e2c.resize(edge_offsets.back());
+	cgv::os::parallel_chunks(nr_corners, nr_threads, [&](unsigned t, size_t b, size_t e) {
+		idx_type ei = edge_offsets[t];
+		for (idx_type ci = idx_type(b); ci < e; ++ci) {
+			idx_type cj = ct.inv[ci];
+			if (cj > ci) {
+				ct.c2e[ci] = ei;
+				if (cj != idx_type(-1))
+					ct.c2e[cj] = ei;
+				ct.e2c[ei++] = ci;
+			}
+		}
+	});
+	ct.p2c.resize(nr_positions);
+	cgv::os::parallel_chunks(nr_positions, nr_threads, [&](unsigned, size_t b, size_t e) {
+		for (idx_type pi = idx_type(b); pi < e; ++pi) {
+			idx_type& cj = ct.p2c[pi];
+			cj = idx_type(-1);
+			for (const idx_type* ci = ct.begin_vertex_corners(pi); ci != ct.end_vertex_corners(pi); ++ci)
+				if (cj == idx_type(-1) || !ct.is_boundary(cj))
+					cj = *ci;
+		}
+	});
+}
 simple_mesh_base::idx_type simple_mesh_base::compute_inv(
 	std::vector<idx_type>& inv,
 	bool link_non_manifold_edges,
@@ -273,135 +431,61 @@ simple_mesh_base::idx_type simple_mesh_base::compute_inv(
 	std::vector<idx_type>* unmatched_elements,
 	std::vector<idx_type>* non_manifold_elements) const
 {
-	uint32_t fi, e = 0;
-	if (p2c_ptr)
-		p2c_ptr->resize(get_nr_positions());
-	if (next_ptr)
-		next_ptr->resize(get_nr_corners());
-	if (prev_ptr)
-		prev_ptr->resize(get_nr_corners());
-	inv.resize(get_nr_corners(), uint32_t(-1));
-	std::vector<idx_type> pis(get_nr_corners()), perm0, perm;
-	// extract min position indices per corner
-	//idx_type a = 0;
-	//std::cout << "before sort" << std::endl;
-	for (fi = 0; fi < get_nr_faces(); ++fi) {
-		idx_type cb = begin_corner(fi), ce = end_corner(fi), cp = ce - 1, pp = c2p(cp);
-		for (idx_type ci = cb; ci < ce; ++ci) {
-			idx_type pi = c2p(ci);
-			if (p2c_ptr)
-				p2c_ptr->at(pi) = ci;
-			if (next_ptr)
-				next_ptr->at(cp) = ci;
-			if (prev_ptr)
-				prev_ptr->at(ci) = cp;
-			pis[cp] = std::min(pp, pi);
-			//if (++a < 20)
-			//	std::cout << "   " << a - 1 << " : " << pp << "," << pi << std::endl;
-			cp = ci;
-			pp = pi;
-		}
+	if (!link_non_manifold_edges && !unmatched && !non_manifold && !unmatched_elements && !non_manifold_elements) {
+		const corner_table& T = get_corner_table();
+		inv = T.inv;
+		if (p2c_ptr)
+			*p2c_ptr = T.p2c;
+		if (next_ptr)
+			*next_ptr = T.next;
+		if (prev_ptr)
+			*prev_ptr = T.prev;
+		return T.nr_manifold_edges;
 	}
-	// sort corners by min position indices
-	cgv::math::bucket_sort(pis, get_nr_positions(), perm0);
-	//std::cout << "after min sort" << std::endl;
-	//for (a=0; a < 20; ++a)
-	//	std::cout << "   " << a << " : " << c2p(perm0[a]) << "," << c2p(next_ptr->at(perm0[a])) << " (" << pis[perm0[a]] << ")" << std::endl;
-	// extract max position indices per corner and fill p2c, next and prev vectors
-	for (fi = 0; fi < get_nr_faces(); ++fi) {
-		idx_type cb = begin_corner(fi), ce = end_corner(fi), cp = ce - 1;
-		for (idx_type ci = cb; ci < ce; ++ci) {
-			idx_type pi = c2p(ci);
-			pis[cp] = std::max(c2p(cp), pi);
-			cp = ci;
-		}
-	}
-	// sort corners by max position indices
-	cgv::math::bucket_sort(pis, get_nr_positions(), perm, &perm0);
-	//std::cout << "after max sort" << std::endl;
-	//for (a = 0; a < 20; ++a)
-	//	std::cout << "   " << a << " : " << c2p(perm[a]) << "," << c2p(next_ptr->at(perm[a])) << " (" << pis[perm[a]] << ")" << std::endl;
-	// store target in pis
-	for (fi = 0; fi < get_nr_faces(); ++fi) {
-		idx_type cb = begin_corner(fi), ce = end_corner(fi), cp = ce - 1;
-		for (idx_type ci = cb; ci < ce; ++ci) {
-			pis[cp] = c2p(ci);
-			cp = ci;
-		}
-	}
-	perm0.clear();
-	// finally perform matching
-	idx_type i = 0;
-	while (i < perm.size()) {
-		idx_type ci = perm[i], pi0 = c2p(ci), pi1 = pis[ci];
-		idx_type cnt = 1;
-		while (i + cnt < perm.size()) {
-			idx_type cj = perm[i + cnt], pj0 = c2p(cj), pj1 = pis[cj];
-			if (std::min(pi0, pi1) == std::min(pj0, pj1) && std::max(pi0, pi1) == std::max(pj0, pj1)) {
-				++cnt;
-			}
-			else
-				break;
-		}
-		if (cnt == 1) {
-			if (unmatched)
-				unmatched->push_back(ci);
-			if (unmatched_elements) {
-				unmatched_elements->push_back(pi0);
-				unmatched_elements->push_back(pi1);
-			}
-		}
-		else if (cnt == 2) {
-			inv[perm[i]] = perm[i + 1];
-			inv[perm[i + 1]] = perm[i];
-			++e;
-		}
-		else {
-			if (link_non_manifold_edges) {
-				idx_type cl = perm[i + cnt - 1];
-				for (idx_type k = 0; k < cnt; ++k) {
-					idx_type ck = perm[i + k];
-					inv[cl] = ck;
-					cl = ck;
+	const corner_table& T = get_corner_table();
+	inv.assign(get_nr_corners(), idx_type(-1));
+	idx_type e = 0;
+	std::vector<std::pair<idx_type, idx_type>> half_edges;
+	for (idx_type pi = 0; pi < get_nr_positions(); ++pi)
+		for_each_edge_at(*this, T, pi, half_edges, [&](const std::pair<idx_type, idx_type>* he_begin, const std::pair<idx_type, idx_type>* he_end) {
+			idx_type ci = he_begin->second, pi0 = c2p(ci), pi1 = c2p(T.next[ci]);
+			idx_type cnt = idx_type(he_end - he_begin);
+			if (cnt == 1) {
+				if (unmatched)
+					unmatched->push_back(ci);
+				if (unmatched_elements) {
+					unmatched_elements->push_back(pi0);
+					unmatched_elements->push_back(pi1);
 				}
 			}
-			if (non_manifold)
-				non_manifold->push_back(ci);
-			if (non_manifold_elements) {
-				non_manifold_elements->push_back(pi0);
-				non_manifold_elements->push_back(pi1);
+			else if (cnt == 2) {
+				inv[ci] = he_begin[1].second;
+				inv[he_begin[1].second] = ci;
+				++e;
 			}
-		}
-		i += cnt;
-	}
-	return e;
-	/*
-	std::map<std::pair<uint32_t, uint32_t>, uint32_t> pipj2ci;
-	for (fi = 0; fi < get_nr_faces(); ++fi) {
-		uint32_t prev_ci = end_corner(fi) - 1;
-		for (uint32_t ci = begin_corner(fi); ci < end_corner(fi); ++ci) {
-			uint32_t pi = c2p(ci);
-			if (p2c_ptr)
-				p2c_ptr->at(pi) = ci;
-			uint32_t next_ci = ci + 1 == end_corner(fi) ? begin_corner(fi) : ci + 1;
-			if (next_ptr)
-				next_ptr->at(ci) = next_ci;
-			if (prev_ptr)
-				prev_ptr->at(ci) = prev_ci;
-			prev_ci = ci;
-			uint32_t pj = c2p(next_ci);
-			std::pair<uint32_t, uint32_t> pipj(std::min(pi, pj), std::max(pi, pj));
-			if (pipj2ci.find(pipj) == pipj2ci.end())
-				pipj2ci[pipj] = ci;
 			else {
-				uint32_t inv_ci = pipj2ci[pipj];
-				inv[ci] = inv_ci;
-				inv[inv_ci] = ci;
-				pipj2ci.erase(pipj2ci.find(pipj));
+				if (link_non_manifold_edges) {
+					idx_type cl = he_end[-1].second;
+					for (auto he = he_begin; he != he_end; ++he) {
+						inv[cl] = he->second;
+						cl = he->second;
+					}
+				}
+				if (non_manifold)
+					non_manifold->push_back(ci);
+				if (non_manifold_elements) {
+					non_manifold_elements->push_back(pi0);
+					non_manifold_elements->push_back(pi1);
+				}
 			}
-		}
-	}
-	*/
+		});
+	if (p2c_ptr)
+		*p2c_ptr = T.p2c;
+	if (next_ptr)
+		*next_ptr = T.next;
+	if (prev_ptr)
+		*prev_ptr = T.prev;
+	return e;
 }
 simple_mesh_base::idx_type simple_mesh_base::compute_c2e(const std::vector<uint32_t>& inv, std::vector<uint32_t>& c2e, std::vector<uint32_t>* e2c_ptr) const
 {
@@ -423,11 +507,7 @@ simple_mesh_base::idx_type simple_mesh_base::compute_c2e(const std::vector<uint3
 }
 void simple_mesh_base::compute_c2f(std::vector<uint32_t>& c2f) const
 {
-	c2f.resize(get_nr_corners(), -1);
-	for (uint32_t fi = 0; fi < get_nr_faces(); ++fi) {
-		for (uint32_t ci = begin_corner(fi); ci < end_corner(fi); ++ci)
-			c2f[ci] = fi;
-	}
+	c2f = get_corner_table().c2f;
 }
 template <typename T>
 void simple_mesh<T>::construct(const obj_loader_generic<T>& loader, bool copy_grp_info, bool copy_material_info)
@@ -491,6 +571,7 @@ public:
 	void process_face(unsigned vcount, int *vertices, int *texcoords, int *normals)
 	{
 		obj_reader_base::convert_to_positive(vcount, vertices, texcoords, normals, unsigned(mesh.positions.size()), unsigned(mesh.normals.size()), unsigned(mesh.tex_coords.size()));
+		mesh.invalidate_corner_table();
 		mesh.faces.push_back(idx_type(mesh.position_indices.size()));
 		if (obj_reader_base::get_current_group() != -1)
 			mesh.group_indices.push_back(obj_reader_base::get_current_group());
@@ -583,6 +664,8 @@ void simple_mesh<T>::clear()
 	material_indices.clear();
 	materials.clear();
 	destruct_colors();
+	ct_valid = false;
+	ct.clear();
 }
 
 template <typename T>
@@ -590,6 +673,7 @@ bool read_off(const std::string& file_name,
 	std::vector<cgv::math::fvec<T,3>>& positions, std::vector<cgv::rgba>& vertex_colors, 
 	std::vector<std::vector<uint32_t>>& faces, std::vector<cgv::rgba>& face_colors)
 {
+	CGV_PROFILE_ZONE("read_off");
 	std::string content;
 	if (!cgv::utils::file::read(file_name, content, true))
 		return false;
@@ -693,6 +777,7 @@ bool read_off(const std::string& file_name,
 template <typename T>
 bool simple_mesh<T>::read(const std::string& file_name)
 { 
+	CGV_PROFILE_ZONE("simple_mesh::read");
 	std::string ext = cgv::utils::to_lower(cgv::utils::file::get_extension(file_name));
 	if (ext == "obj") {
 		simple_mesh_obj_reader<T> reader(*this);
@@ -795,16 +880,23 @@ void simple_mesh<T>::compute_vertex_normals(bool use_parallel_implementation)
 	// initialize normals to null vectors
 	normals.resize(positions.size(), vec3_type(T(0)));
 	if (use_parallel_implementation) {
-#pragma omp parallel for
-		for (int fi = 0; fi < int(get_nr_faces()); ++fi) {
-			vec3_type nml;
-			if (compute_face_normal(fi, nml))
-				for (idx_type ci = begin_corner(fi); ci < end_corner(fi); ++ci)
-					normal(normal_indices[ci]) += nml;
-		}
-#pragma omp parallel for
-		for (int ni = 0; ni < int(normals.size()); ++ni)
-			normals[ni].normalize();
+		// compute face normals and gather them per position over the incident corners of the corner table
+		const corner_table& CT = get_corner_table();
+		unsigned nr_threads = cgv::os::choose_nr_chunks(get_nr_corners());
+		std::vector<vec3_type> face_normals(get_nr_faces());
+		cgv::os::parallel_chunks(get_nr_faces(), nr_threads, [&](unsigned, size_t b, size_t e) {
+			for (idx_type fi = idx_type(b); fi < e; ++fi)
+				if (!compute_face_normal(fi, face_normals[fi]))
+					face_normals[fi] = vec3_type(T(0));
+		});
+		cgv::os::parallel_chunks(get_nr_positions(), nr_threads, [&](unsigned, size_t b, size_t e) {
+			for (idx_type pi = idx_type(b); pi < e; ++pi) {
+				vec3_type& nml = normals[pi];
+				for (const idx_type* ci = CT.begin_vertex_corners(pi); ci != CT.end_vertex_corners(pi); ++ci)
+					nml += face_normals[CT.c2f[*ci]];
+				nml.normalize();
+			}
+		});
 	}
 	else {
 		vec3_type nml;
@@ -1001,13 +1093,13 @@ template <typename T> simple_mesh<T>::simple_mesh(const std::string& conway_nota
 }
 template <typename T> void simple_mesh<T>::ambo()
 {
-	std::vector<uint32_t> c2e;
-	std::vector<uint32_t> e2c;
-	std::vector<uint32_t> inv;
-	std::vector<uint32_t> prev;
-	std::vector<uint32_t> p2c;
-	compute_inv(inv, /*link_non_manifold_edges*/false, &p2c, 0, &prev);
-	uint32_t e = compute_c2e(inv, c2e, &e2c);
+	const corner_table& CT = get_corner_table();
+	const auto& c2e = CT.c2e;
+	const auto& e2c = CT.e2c;
+	const auto& inv = CT.inv;
+	const auto& prev = CT.prev;
+	const auto& p2c = CT.p2c;
+	uint32_t e = CT.get_nr_edges();
 	mesh_type new_M;
 	// create one vertex per edge
 	for (uint32_t ei = 0; ei < e; ++ei) {
@@ -1037,10 +1129,10 @@ template <typename T> void simple_mesh<T>::ambo()
 }
 template <typename T> void simple_mesh<T>::truncate(T lambda)
 {
-	std::vector<uint32_t> inv;
-	std::vector<uint32_t> prev;
-	std::vector<uint32_t> p2c;
-	compute_inv(inv, /*link_non_manifold_edges*/false, &p2c, 0, &prev);
+	const corner_table& CT = get_corner_table();
+	const auto& inv = CT.inv;
+	const auto& prev = CT.prev;
+	const auto& p2c = CT.p2c;
 	uint32_t c = get_nr_corners();
 	mesh_type new_M;
 	// create one vertex per corner
@@ -1073,10 +1165,10 @@ template <typename T> void simple_mesh<T>::truncate(T lambda)
 }
 template <typename T> void simple_mesh<T>::snub(T lambda)
 {
-	std::vector<uint32_t> inv;
-	std::vector<uint32_t> prev;
-	std::vector<uint32_t> p2c;
-	compute_inv(inv, /*link_non_manifold_edges*/false, &p2c, 0, &prev);
+	const corner_table& CT = get_corner_table();
+	const auto& inv = CT.inv;
+	const auto& prev = CT.prev;
+	const auto& p2c = CT.p2c;
 	uint32_t c = get_nr_corners();
 	mesh_type new_M;
 	// create one vertex per corner
@@ -1118,12 +1210,11 @@ template <typename T> void simple_mesh<T>::snub(T lambda)
 }
 template <typename T> void simple_mesh<T>::dual()
 {
-	std::vector<uint32_t> c2f;
-	std::vector<uint32_t> p2c;
-	std::vector<uint32_t> inv;
-	std::vector<uint32_t> prev;
-	compute_inv(inv, /*link_non_manifold_edges*/false, &p2c, 0, &prev);
-	compute_c2f(c2f);
+	const corner_table& CT = get_corner_table();
+	const auto& c2f = CT.c2f;
+	const auto& p2c = CT.p2c;
+	const auto& inv = CT.inv;
+	const auto& prev = CT.prev;
 	uint32_t f = get_nr_faces();
 	mesh_type new_M;
 	// create one vertex per face
@@ -1150,12 +1241,10 @@ template <typename T> void simple_mesh<T>::dual()
 }
 template <typename T> void simple_mesh<T>::gyro(T lambda)
 {
-	std::vector<uint32_t> c2f;
-	std::vector<uint32_t> p2c;
-	std::vector<uint32_t> inv;
-	std::vector<uint32_t> prev;
-	compute_inv(inv, /*link_non_manifold_edges*/false, &p2c, 0, &prev);
-	compute_c2f(c2f);
+	const corner_table& CT = get_corner_table();
+	const auto& c2f = CT.c2f;
+	const auto& inv = CT.inv;
+	const auto& prev = CT.prev;
 	uint32_t v = get_nr_positions();
 	uint32_t f = get_nr_faces();
 	uint32_t c = get_nr_corners();
@@ -1196,15 +1285,11 @@ template <typename T> void simple_mesh<T>::gyro(T lambda)
 }
 template <typename T> void simple_mesh<T>::join()
 {
-	std::vector<uint32_t> c2e;
-	std::vector<uint32_t> e2c;
-	std::vector<uint32_t> inv;
-	std::vector<uint32_t> prev;
-	std::vector<uint32_t> p2c;
-	compute_inv(inv, /*link_non_manifold_edges*/false, &p2c, 0, &prev);
-	uint32_t e = compute_c2e(inv, c2e, &e2c);
-	std::vector<uint32_t> c2f;
-	compute_c2f(c2f);
+	const corner_table& CT = get_corner_table();
+	const auto& e2c = CT.e2c;
+	const auto& inv = CT.inv;
+	uint32_t e = CT.get_nr_edges();
+	const auto& c2f = CT.c2f;
 
 	uint32_t f = get_nr_faces();
 	uint32_t v = get_nr_positions();
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <vector>
+#include <mutex>
 
 #include <cgv/math/fvec.h>
 #include <cgv/math/fmat.h>
@@ -48,6 +49,48 @@ public:
 		AF_tangent = 8, /// tangent vectors for u coordinate
 		AF_color = 16  /// vertex colors (uses position indexing)
 	};
+	/** compact corner table connectivity that is cached by the mesh, see simple_mesh_base::get_corner_table().
+		Each corner ci is identified with the half-edge pointing in winding order from c2p(ci) to c2p(next[ci]).
+		Non-manifold edges are cut into unmatched half-edges, for which inv is -1. */
+	struct CGV_API corner_table
+	{
+		/// per corner the corner of the inverse half-edge or -1
+		std::vector<idx_type> inv;
+		/// per corner the next corner in its face
+		std::vector<idx_type> next;
+		/// per corner the previous corner in its face
+		std::vector<idx_type> prev;
+		/// per corner its face index
+		std::vector<idx_type> c2f;
+		/// per corner its edge index, where unmatched half-edges form edges on their own
+		std::vector<idx_type> c2e;
+		/// per edge the corner of smaller index
+		std::vector<idx_type> e2c;
+		/// per position one incident corner or -1, for boundary positions a corner with unmatched half-edge
+		std::vector<idx_type> p2c;
+		/// per position plus one the offset of its corners into v2c
+		std::vector<idx_type> v2c_begin;
+		/// corners sorted by position and then by index
+		std::vector<idx_type> v2c;
+		/// number of edges with two matched half-edges
+		idx_type nr_manifold_edges = 0;
+		/// return the number of edges
+		idx_type get_nr_edges() const { return idx_type(e2c.size()); }
+		/// return whether the half-edge of corner ci is unmatched
+		bool is_boundary(idx_type ci) const { return inv[ci] == idx_type(-1); }
+		/// return the corner at the same position in the face across the edge entering ci or -1 at a boundary
+		idx_type next_around_vertex(idx_type ci) const { return inv[prev[ci]]; }
+		/// return the corner at the same position in the face across the edge leaving ci or -1 at a boundary
+		idx_type prev_around_vertex(idx_type ci) const { return is_boundary(ci) ? idx_type(-1) : next[inv[ci]]; }
+		/// return pointer to first corner incident to position pi
+		const idx_type* begin_vertex_corners(idx_type pi) const { return v2c.data() + v2c_begin[pi]; }
+		/// return pointer behind the last corner incident to position pi
+		const idx_type* end_vertex_corners(idx_type pi) const { return v2c.data() + v2c_begin[pi + 1]; }
+		/// return the number of corners incident to position pi
+		idx_type get_nr_vertex_corners(idx_type pi) const { return v2c_begin[pi + 1] - v2c_begin[pi]; }
+		/// release memory
+		void clear();
+	};
 	static std::string get_attribute_name(attribute_type attr);
 	static AttributeFlags get_attribute_flag(attribute_type attr);
 	virtual          bool  has_attribute(attribute_type attr) const = 0;
@@ -64,6 +107,14 @@ protected:
 	std::vector<std::string> group_names;
 	std::vector<idx_type> material_indices;
 	std::vector<mat_type> materials;
+	/// cached corner table
+	mutable corner_table ct;
+	/// whether the cached corner table is up to date
+	mutable bool ct_valid = false;
+	/// serializes building the cached corner table in concurrent const calls
+	mutable std::mutex ct_mutex;
+	/// build the corner table in parallel
+	void build_corner_table(unsigned nr_threads) const;
 public:
 	/// default constructor
 	simple_mesh_base();
@@ -218,6 +269,8 @@ public:
 		index of the corner corresponding to matched half-edges. For non-manifold edges
 		two strategies are supported: cyclic linking (\c link_non_manifold_edges = true)
 		or cutting into unmatched half-edges (\c link_non_manifold_edges = false).
+		In the latter case without requested lists of unmatched or non-manifold edges,
+		the vectors are copied from the cached corner table.
 		The function fills the optionally provided vectors
 		- \c p2c ... per position the index of one incident corner
 		- \c next ... per corner the index of the next corner in the face
@@ -237,6 +290,16 @@ public:
 		std::vector<idx_type>* non_manifold = 0,
 		std::vector<idx_type>* unmatched_elements = 0,
 		std::vector<idx_type>* non_manifold_elements = 0) const;
+	//! return the corner table, which is built on first access after a change of the connectivity
+	/*! The table is built with the given number of threads, where 0 uses all hardware threads. Concurrent const
+	    calls, also of compute_inv() and compute_c2f(), are safe as building is guarded by a mutex, but the mesh must
+		not be modified at the same time. Changes through start_face(), new_corner(), new_position(), ref_positions(),
+		revert_face_orientation() and assignment invalidate the table. */
+	const corner_table& get_corner_table(unsigned nr_threads = 0) const;
+	/// return whether an up to date corner table is cached
+	bool has_corner_table() const { return ct_valid; }
+	/// invalidate cached corner table, which needs to be called after modifying the connectivity directly
+	void invalidate_corner_table();
 	/// given the inv corners compute vector storing per corner the edge index and optionally per edge one corner index and return edge count (implementation assumes closed manifold connectivity)
 	idx_type compute_c2e(const std::vector<idx_type>& inv, std::vector<idx_type>& c2e, std::vector<idx_type>* e2c_ptr = 0) const;
 	/// compute index vector with per corner its face index
@@ -324,13 +387,13 @@ public:
 	void clear();
 
 	/// add a new position and return position index
-	idx_type new_position(const vec3_type& p) { positions.push_back(p); return idx_type(positions.size()-1); }
+	idx_type new_position(const vec3_type& p) { positions.push_back(p); ct_valid = false; return idx_type(positions.size()-1); }
 	/// access to positions
 	idx_type get_nr_positions() const { return idx_type(positions.size()); }
 	vec3_type& position(idx_type pi) { return positions[pi]; }
 	const vec3_type& position(idx_type pi) const { return positions[pi]; }
 	const std::vector<vec3_type>& get_positions() const { return positions; }
-	std::vector<vec3_type>& ref_positions() { return positions; }
+	std::vector<vec3_type>& ref_positions() { ct_valid = false; return positions; }
 
 	/// add a new normal and return normal index
 	idx_type new_normal(const vec3_type& n) { normals.push_back(n); return idx_type(normals.size()-1); }
@@ -3,10 +3,12 @@
 #include <fstream>
 #include <stdio.h>
 #include <cgv/utils/file.h>
+#include <cgv/utils/mapped_file.h>
 #include <cgv/utils/scan.h>
 #include <cgv/utils/tokenizer.h>
 #include <cgv/media/image/image_reader.h>
 #include <cgv/media/image/image_writer.h>
+#include <cgv/media/image/wavelet_codec.h>
 #include <cgv/media/video/video_reader.h>
 
 namespace cgv {
@@ -44,6 +46,7 @@ namespace cgv {
 
 			bool read_avi(const std::string& file_name, volume& V, volume_info* info_ptr = 0);
 
+			bool read_cwv(const std::string& file_name, volume& V, volume_info* info_ptr = 0);
 
 			bool write_vox(const std::string& file_name, const volume& V);
 
@@ -52,6 +55,7 @@ namespace cgv {
 
 			bool write_tiff(const std::string& file_name, const volume& V, const std::string& options);
 
+			bool write_cwv(const std::string& file_name, const volume& V);
 
 			bool read_header(const std::string& file_name, volume_info& info, bool(*unknown_line_callback)(const std::string& line, const std::vector<cgv::utils::token>&, volume_info& info))
 			{
@@ -74,6 +78,8 @@ namespace cgv {
 					return read_tiff(file_name, V, info_ptr);
 				if (ext == "AVI")
 					return read_avi(file_name, V, info_ptr);
+				if (ext == "CWV")
+					return read_cwv(file_name, V, info_ptr);
 
 				std::cerr << "unsupported extension " << ext << std::endl;
 				return false;
@@ -98,6 +104,8 @@ namespace cgv {
 					return write_qim(file_name, V);
 				if (ext == "TIF" || ext == "TIFF")
 					return write_tiff(file_name, V, options);
+				if (ext == "CWV")
+					return write_cwv(file_name, V);
 
 				std::cerr << "unsupported extension " << ext << std::endl;
 				return false;
@@ -342,28 +350,20 @@ namespace cgv {
 				if (V.get_extent() != info.extent)
 					V.ref_extent() = info.extent;
 
-				// open file and jump to offset
-				FILE* fp = fopen(file_name.c_str(), "rb");
-				if (!fp) {
+				// map file and copy voxels starting at offset
+				cgv::utils::mapped_file mf(file_name);
+				if (!mf.is_open()) {
 					std::cerr << "cannot open file " << file_name << std::endl;
 					return false;
 				}
-				if (offset > 0) {
-					fseek(fp, (long)offset, SEEK_SET);
-				}
-
-				// read data
 				std::size_t n = V.get_nr_voxels();
 				unsigned N = V.get_voxel_size();
-				std::size_t nr = fread(V.get_data_ptr<unsigned char>(), N, n, fp);
-				if (nr != n) {
+				mf.advise(cgv::utils::mapped_file::SEQUENTIAL, offset, n * N);
+				if (!mf.seek(offset) || !mf.read((unsigned char*)V.get_data_ptr<unsigned char>(), n * N)) {
+					std::size_t nr = mf.size() > offset ? (mf.size() - offset) / N : 0;
 					std::cerr << "could not read the expected number " << n << " of voxels but only " << nr << std::endl;
-					fclose(fp);
 					return false;
 				}
-
-				// close and return success
-				fclose(fp);
 				return true;
 			}
 
@@ -560,6 +560,36 @@ namespace cgv {
 				return iw.close();
 			}
 
+		
+			bool read_cwv(const std::string& file_name, volume& V, volume_info* info_ptr)
+			{
+				cgv::media::image::wavelet_codec codec;
+				if (!codec.read(file_name, V.get_format(), V.get_data_view())) {
+					std::cerr << "could not read wavelet volume " << file_name << ": " << codec.get_last_error() << std::endl;
+					return false;
+				}
+				volume::dimension_type size = V.get_dimensions();
+				V.ref_extent() = volume::point_type(1, 1, 1) * size / (float)cgv::math::max_value(size);
+				if (info_ptr) {
+					info_ptr->dimensions = size;
+					info_ptr->type_id = V.get_component_type();
+					info_ptr->components = V.get_component_format();
+					info_ptr->extent = V.get_extent();
+					info_ptr->position.zeros();
+					info_ptr->orientation.identity();
+				}
+				return true;
+			}
+
+			bool write_cwv(const std::string& file_name, const volume& V)
+			{
+				cgv::media::image::wavelet_codec codec;
+				if (!codec.write(file_name, V.get_data_view())) {
+					std::cerr << "could not write wavelet volume " << file_name << ": " << codec.get_last_error() << std::endl;
+					return false;
+				}
+				return true;
+			}
 		}
 	}
-}
\ No newline at end of file
+}
@@ -45,6 +45,11 @@ struct http_request
 	std::string auth_realm;
 	/// set this member to the html page to be returned
 	std::string answer;
+	/// content type of the answer, which defaults to html if empty
+	std::string content_type;
+	/** if not empty, the content of this file is returned instead of answer, which
+	    server implementations can transmit without copying it through user space */
+	std::string file_path;
 };
 
 	}
@@ -1,8 +1,15 @@
 #include "priority.h"
+#include <algorithm>
 #include <iostream>
+#include <string>
+#include <thread>
 
 #ifdef WIN32
 #include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <dirent.h>
 #endif
 
 namespace cgv {
@@ -68,7 +75,61 @@ bool set_execution_priority(ExecutionPriority p)
 	std::cerr << "set_execution_priority not implemented" << std::endl;
 	return false;
 #endif
+}
+
+unsigned get_nr_processors()
+{
+	return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+unsigned get_numa_node(unsigned processor)
+{
+#ifdef WIN32
+	UCHAR node;
+	if (processor < 256 && GetNumaProcessorNode(UCHAR(processor), &node) && node != 0xFF)
+		return node;
+#else
+	// sysfs lists the node of a cpu as directory entry nodeX
+	std::string path = std::string("/sys/devices/system/cpu/cpu") + std::to_string(processor);
+	DIR* dir = opendir(path.c_str());
+	if (dir) {
+		unsigned node = 0;
+		while (dirent* entry = readdir(dir)) {
+			std::string name = entry->d_name;
+			if (name.size() > 4 && name.compare(0, 4, "node") == 0 && name.find_first_not_of("0123456789", 4) == std::string::npos) {
+				node = unsigned(std::stoul(name.substr(4)));
+				break;
+			}
+		}
+		closedir(dir);
+		return node;
+	}
+#endif
+	return 0;
+}
+
+bool set_thread_affinity(unsigned processor)
+{
+#ifdef WIN32
+	if (processor >= 8 * sizeof(DWORD_PTR) || SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << processor) == 0) {
+		std::cerr << "could not pin thread to processor " << processor << std::endl;
+		return false;
+	}
+	return true;
+#elif defined(__linux__)
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	CPU_SET(processor, &cpu_set);
+	if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) != 0) {
+		std::cerr << "could not pin thread to processor " << processor << std::endl;
+		return false;
+	}
+	return true;
+#else
+	std::cerr << "set_thread_affinity not implemented" << std::endl;
+	return false;
+#endif
 }
 
 	}
-}
\ No newline at end of file
+}
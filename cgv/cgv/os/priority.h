@@ -18,6 +18,15 @@ ExecutionPriority CGV_API get_execution_priority();
 /// set the execution priority of the current thread and process
 bool CGV_API set_execution_priority(ExecutionPriority ep);
 
+/// return the number of logical processors available to the process
+unsigned CGV_API get_nr_processors();
+
+/// return the index of the NUMA node of the given logical processor or 0 if it cannot be determined
+unsigned CGV_API get_numa_node(unsigned processor);
+
+/// pin the current thread to the given logical processor
+bool CGV_API set_thread_affinity(unsigned processor);
+
 	}
 }
 
@@ -0,0 +1,308 @@
+#include "task_scheduler.h"
+#include "priority.h"
+
+namespace cgv {
+	namespace os {
+
+namespace {
+	/// scheduler and worker index of the calling thread
+	thread_local const task_scheduler* current_scheduler = 0;
+	thread_local int current_worker = -1;
+	/// number of calls to task_scheduler::idle() that only yield before the waiting thread blocks
+	const unsigned nr_idle_spins = 64;
+}
+
+struct task_scheduler::worker
+{
+	std::mutex mutex;
+	std::deque<task> tasks;
+	std::thread thread;
+	/// processor that the worker is pinned to
+	unsigned processor;
+	/// other workers in the order in which they are visited for stealing
+	std::vector<unsigned> victims;
+};
+
+task_scheduler::task_scheduler(unsigned nr_workers, bool _pin_threads) : nr_queued(0), nr_sleeping(0), nr_waiting(0), stop_request(false), pin_threads(_pin_threads)
+{
+	start(nr_workers);
+}
+
+task_scheduler::~task_scheduler()
+{
+	shutdown();
+	// tasks submitted without workers are executed by the destructing thread
+	while (execute_one())
+		;
+}
+
+task_scheduler& task_scheduler::get()
+{
+	static task_scheduler scheduler(get_nr_processors() - 1);
+	return scheduler;
+}
+
+void task_scheduler::start(unsigned nr_workers)
+{
+	// order processors by NUMA node, such that neighboring workers share a node
+	unsigned nr_processors = get_nr_processors();
+	std::vector<std::pair<unsigned, unsigned> > processors;
+	for (unsigned p = 0; p < nr_processors; ++p)
+		processors.push_back(std::make_pair(pin_threads ? get_numa_node(p) : 0u, p));
+	std::stable_sort(processors.begin(), processors.end());
+	std::vector<unsigned> nodes(nr_workers);
+	for (unsigned wi = 0; wi < nr_workers; ++wi) {
+		// the first processor is left to the thread that waits for the workers
+		const auto& p = processors[(wi + 1) % nr_processors];
+		workers.push_back(std::unique_ptr<worker>(new worker()));
+		workers.back()->processor = p.second;
+		nodes[wi] = p.first;
+	}
+	for (unsigned wi = 0; wi < nr_workers; ++wi) {
+		std::vector<unsigned>& victims = workers[wi]->victims;
+		for (unsigned d = 1; d < nr_workers; ++d)
+			victims.push_back((wi + d) % nr_workers);
+		std::stable_partition(victims.begin(), victims.end(), [&](unsigned vi) { return nodes[vi] == nodes[wi]; });
+	}
+	for (unsigned wi = 0; wi < nr_workers; ++wi)
+		workers[wi]->thread = std::thread(&task_scheduler::work, this, wi);
+}
+
+void task_scheduler::shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		stop_request = true;
+	}
+	wake_up.notify_all();
+	for (auto& w : workers)
+		w->thread.join();
+	workers.clear();
+	stop_request = false;
+}
+
+unsigned task_scheduler::get_nr_workers() const
+{
+	return unsigned(workers.size());
+}
+
+unsigned task_scheduler::get_concurrency() const
+{
+	return unsigned(workers.size()) + 1;
+}
+
+void task_scheduler::configure(unsigned nr_workers, bool _pin_threads)
+{
+	shutdown();
+	pin_threads = _pin_threads;
+	start(nr_workers);
+}
+
+int task_scheduler::get_current_worker_index() const
+{
+	return current_scheduler == this ? current_worker : -1;
+}
+
+void task_scheduler::submit(task&& t)
+{
+	int wi = get_current_worker_index();
+	if (wi >= 0) {
+		std::lock_guard<std::mutex> lock(workers[wi]->mutex);
+		workers[wi]->tasks.push_back(std::move(t));
+	}
+	else {
+		std::lock_guard<std::mutex> lock(injection_mutex);
+		injected.push_back(std::move(t));
+	}
+	++nr_queued;
+	// sleeping workers check nr_queued after incrementing nr_sleeping, such that no wake up is lost
+	if (nr_sleeping > 0) {
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+		}
+		wake_up.notify_one();
+	}
+	notify_waiting();
+}
+
+void task_scheduler::notify_waiting()
+{
+	// waiting threads check their condition after incrementing nr_waiting, such that no wake up is lost
+	if (nr_waiting > 0) {
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+		}
+		task_finished.notify_all();
+	}
+}
+
+bool task_scheduler::acquire(int worker_index, task& t)
+{
+	if (nr_queued == 0)
+		return false;
+	if (worker_index >= 0) {
+		worker& w = *workers[worker_index];
+		std::lock_guard<std::mutex> lock(w.mutex);
+		if (!w.tasks.empty()) {
+			t = std::move(w.tasks.back());
+			w.tasks.pop_back();
+			--nr_queued;
+			return true;
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(injection_mutex);
+		if (!injected.empty()) {
+			t = std::move(injected.front());
+			injected.pop_front();
+			--nr_queued;
+			return true;
+		}
+	}
+	unsigned nr_victims = unsigned(worker_index >= 0 ? workers[worker_index]->victims.size() : workers.size());
+	for (unsigned i = 0; i < nr_victims; ++i) {
+		worker& v = *workers[worker_index >= 0 ? workers[worker_index]->victims[i] : i];
+		std::lock_guard<std::mutex> lock(v.mutex);
+		if (!v.tasks.empty()) {
+			t = std::move(v.tasks.front());
+			v.tasks.pop_front();
+			--nr_queued;
+			return true;
+		}
+	}
+	return false;
+}
+
+void task_scheduler::execute(task& t)
+{
+	std::exception_ptr e;
+	try {
+		t.function();
+	}
+	catch (...) {
+		e = std::current_exception();
+	}
+	// release captured state before the group can be destructed
+	t.function = nullptr;
+	if (t.group)
+		t.group->task_done(e);
+}
+
+bool task_scheduler::execute_one()
+{
+	task t;
+	if (!acquire(get_current_worker_index(), t))
+		return false;
+	execute(t);
+	return true;
+}
+
+void task_scheduler::idle(const task_group& group, unsigned nr_idle_rounds)
+{
+	if (nr_idle_rounds < nr_idle_spins) {
+		std::this_thread::yield();
+		return;
+	}
+	// block while another thread executes a long task of the group
+	std::unique_lock<std::mutex> lock(sleep_mutex);
+	++nr_waiting;
+	task_finished.wait(lock, [&]() { return nr_queued > 0 || group.nr_pending == 0; });
+	--nr_waiting;
+}
+
+void task_scheduler::work(unsigned worker_index)
+{
+	current_scheduler = this;
+	current_worker = int(worker_index);
+	if (pin_threads)
+		set_thread_affinity(workers[worker_index]->processor);
+	while (true) {
+		task t;
+		if (acquire(int(worker_index), t)) {
+			execute(t);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		++nr_sleeping;
+		wake_up.wait(lock, [this]() { return nr_queued > 0 || stop_request; });
+		--nr_sleeping;
+		if (stop_request && nr_queued == 0)
+			break;
+	}
+	current_scheduler = 0;
+	current_worker = -1;
+}
+
+task_group::task_group(task_scheduler& _scheduler) : scheduler(_scheduler), nr_pending(0)
+{
+}
+
+task_group::~task_group()
+{
+	try {
+		wait();
+	}
+	catch (...) {
+	}
+}
+
+void task_group::task_done(std::exception_ptr e)
+{
+	std::function<void()> c;
+	{
+		std::lock_guard<std::mutex> lock(group_mutex);
+		if (e && !exception)
+			exception = e;
+		// the last finished task hands its count over to the continuation
+		if (nr_pending == 1 && continuation)
+			c.swap(continuation);
+		else
+			--nr_pending;
+		// notify under the lock, as the group can be destructed once a waiting thread acquired it
+		if (!c)
+			scheduler.notify_waiting();
+	}
+	if (c)
+		scheduler.submit(task_scheduler::task{ std::move(c), this });
+}
+
+void task_group::then(std::function<void()> f)
+{
+	{
+		std::lock_guard<std::mutex> lock(group_mutex);
+		if (nr_pending > 0) {
+			continuation = f;
+			return;
+		}
+		++nr_pending;
+	}
+	scheduler.submit(task_scheduler::task{ f, this });
+}
+
+bool task_group::is_done() const
+{
+	return nr_pending == 0;
+}
+
+void task_group::wait()
+{
+	unsigned nr_idle_rounds = 0;
+	while (nr_pending > 0) {
+		if (scheduler.execute_one())
+			nr_idle_rounds = 0;
+		else
+			scheduler.idle(*this, nr_idle_rounds++);
+	}
+	// the lock ensures that task_done() has released the mutex before the group can be destructed
+	std::exception_ptr e;
+	{
+		std::lock_guard<std::mutex> lock(group_mutex);
+		e = exception;
+		exception = nullptr;
+	}
+	if (e)
+		std::rethrow_exception(e);
+}
+
+	}
+}
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace os {
+
+class task_group;
+
+/** Framework wide work-stealing task scheduler. Each worker thread owns a task queue, to which tasks submitted
+    from the worker are appended. A worker executes its own tasks in last-in first-out order and steals the oldest
+	tasks of other workers if its queue is empty, where workers on the same NUMA node are visited first. Tasks
+	submitted from other threads are placed in a shared injection queue. Threads waiting for a task_group execute
+	pending tasks instead of blocking, such that nested parallelism does not deadlock or oversubscribe the cores.
+	If no task is pending, they yield for a short time and then block until a task is queued or finished.
+
+	Libraries should use the shared instance returned by get() through task_group, parallel_for and
+	parallel_reduce instead of constructing their own threads. By default it runs one worker less than there are
+	logical processors, as the thread waiting for a parallel computation participates in it. */
+class CGV_API task_scheduler
+{
+public:
+	/// a task is a function together with the group that waits for its completion
+	struct task
+	{
+		std::function<void()> function;
+		task_group* group;
+	};
+protected:
+	struct worker;
+	/// one entry per worker thread
+	std::vector<std::unique_ptr<worker> > workers;
+	/// tasks submitted from threads that are not workers of this scheduler
+	std::deque<task> injected;
+	std::mutex injection_mutex;
+	/// number of tasks in all queues
+	std::atomic<size_t> nr_queued;
+	/// number of workers waiting for tasks
+	std::atomic<unsigned> nr_sleeping;
+	/// idle workers wait for this condition
+	std::mutex sleep_mutex;
+	std::condition_variable wake_up;
+	/// number of threads blocked in idle() while waiting for a task group
+	std::atomic<unsigned> nr_waiting;
+	/// threads waiting for a task group block on this condition until a task is queued or finished
+	std::condition_variable task_finished;
+	bool stop_request;
+	bool pin_threads;
+	/// execute one task and notify its group
+	void execute(task& t);
+	/// main loop of worker threads
+	void work(unsigned worker_index);
+	/// remove a task from the queues in the order of preference for the given worker or -1 for other threads
+	bool acquire(int worker_index, task& t);
+	/// start the given number of worker threads
+	void start(unsigned nr_workers);
+	/// stop all worker threads after the queues have been emptied
+	void shutdown();
+public:
+	/// construct scheduler with the given number of worker threads and optionally pin workers to processors in NUMA node order
+	task_scheduler(unsigned nr_workers, bool pin_threads = false);
+	/// complete all queued tasks and join worker threads
+	~task_scheduler();
+	/// return the shared scheduler of the framework
+	static task_scheduler& get();
+	/// return the number of worker threads
+	unsigned get_nr_workers() const;
+	/// return the number of threads that execute tasks concurrently, i.e. the workers and the waiting thread
+	unsigned get_concurrency() const;
+	/// restart with a different number of worker threads, which must only be called while no task is pending
+	void configure(unsigned nr_workers, bool pin_threads = false);
+	/// return index of the worker of this scheduler executing the calling thread or -1 for other threads
+	int get_current_worker_index() const;
+	/// queue a task for execution
+	void submit(task&& t);
+	/// execute one pending task in the calling thread and return false if no task was pending
+	bool execute_one();
+	/// wait for the given group while no task is pending, where the thread yields while \c nr_idle_rounds, the number of calls since it executed a task, is small and then blocks until a task is queued or finished
+	void idle(const task_group& group, unsigned nr_idle_rounds);
+	/// wake up threads blocked in idle(), called when a task is queued or a task of a group finished
+	void notify_waiting();
+};
+
+/** A task group collects tasks whose completion is awaited together. After all tasks have finished, an optional
+    continuation is executed as a further task of the group, which can again run tasks in the group. The first
+	exception thrown by a task is rethrown by wait(). */
+class CGV_API task_group
+{
+protected:
+	task_scheduler& scheduler;
+	/// number of tasks that have been run but are not finished, including a launched continuation
+	std::atomic<size_t> nr_pending;
+	/// protects continuation and exception
+	std::mutex group_mutex;
+	std::function<void()> continuation;
+	std::exception_ptr exception;
+	friend class task_scheduler;
+	/// called by the scheduler when a task of the group finished
+	void task_done(std::exception_ptr e);
+public:
+	/// construct task group for the given or the shared scheduler
+	task_group(task_scheduler& _scheduler = task_scheduler::get());
+	/// wait for pending tasks without rethrowing exceptions
+	~task_group();
+	/// run function as task of the group
+	template <typename F>
+	void run(F f)
+	{
+		++nr_pending;
+		scheduler.submit(task_scheduler::task{ std::function<void()>(f), this });
+	}
+	/// set function that is run as task of the group once all tasks run so far have finished
+	void then(std::function<void()> f);
+	/// check whether all tasks and the continuation have finished
+	bool is_done() const;
+	/// execute pending tasks until all tasks of the group and the continuation have finished and rethrow the first exception of a task
+	void wait();
+};
+
+/// call f(b, e) for consecutive blocks [b,e) of at most grain_size indices in [begin,end), which are handed out dynamically to at most max_concurrency threads or to all threads of the shared scheduler if max_concurrency is 0
+template <typename F>
+void parallel_for(size_t begin, size_t end, F f, size_t grain_size = 1, unsigned max_concurrency = 0)
+{
+	if (end <= begin)
+		return;
+	grain_size = std::max(grain_size, size_t(1));
+	size_t nr_blocks = (end - begin + grain_size - 1) / grain_size;
+	task_scheduler& scheduler = task_scheduler::get();
+	unsigned concurrency = scheduler.get_concurrency();
+	if (max_concurrency > 0)
+		concurrency = std::min(concurrency, max_concurrency);
+	size_t nr_tasks = std::min(size_t(concurrency), nr_blocks);
+	if (nr_tasks <= 1) {
+		for (size_t b = begin; b < end; b += grain_size)
+			f(b, std::min(end, b + grain_size));
+		return;
+	}
+	std::atomic<size_t> next_block(0);
+	auto process_blocks = [&]() {
+		for (size_t bi = next_block++; bi < nr_blocks; bi = next_block++)
+			f(begin + bi * grain_size, std::min(end, begin + (bi + 1) * grain_size));
+	};
+	task_group group(scheduler);
+	for (size_t ti = 1; ti < nr_tasks; ++ti)
+		group.run(process_blocks);
+	process_blocks();
+	group.wait();
+}
+
+/// compute map(b, e) for blocks as in parallel_for and combine the results with reduce in the order of the blocks, such that the result does not depend on the number of threads
+template <typename T, typename M, typename R>
+T parallel_reduce(size_t begin, size_t end, const T& identity, M map, R reduce, size_t grain_size = 1, unsigned max_concurrency = 0)
+{
+	if (end <= begin)
+		return identity;
+	grain_size = std::max(grain_size, size_t(1));
+	std::vector<T> partial((end - begin + grain_size - 1) / grain_size, identity);
+	parallel_for(begin, end, [&](size_t b, size_t e) { partial[(b - begin) / grain_size] = map(b, e); }, grain_size, max_concurrency);
+	T result = identity;
+	for (const T& p : partial)
+		result = reduce(result, p);
+	return result;
+}
+
+/// return the number of chunks into which parallel_chunks() splits n elements, which is limited by max_concurrency or by the concurrency of the shared scheduler if max_concurrency is 0 and by the minimum chunk size, below which chunks do not pay off the synchronization
+inline unsigned choose_nr_chunks(size_t n, unsigned max_concurrency = 0, size_t min_chunk_size = 65536)
+{
+	if (max_concurrency == 0)
+		max_concurrency = task_scheduler::get().get_concurrency();
+	return unsigned(std::max(std::min(size_t(max_concurrency), n / std::max(min_chunk_size, size_t(1))), size_t(1)));
+}
+
+/// split [0,n) into nr_chunks contiguous chunks of equal size and call f(chunk_index, begin, end) for each chunk in parallel, which allows to keep per chunk state such as histograms
+template <typename F>
+void parallel_chunks(size_t n, unsigned nr_chunks, F f)
+{
+	parallel_for(0, nr_chunks, [&](size_t cb, size_t ce) {
+		for (size_t c = cb; c < ce; ++c)
+			f(unsigned(c), n * c / nr_chunks, n * (c + 1) / nr_chunks);
+	}, 1, nr_chunks);
+}
+
+/** stable parallel least significant digit radix sort of n keys by their lower nr_key_bits bits, where the values are permuted
+	together with the keys if values is not null. The scratch buffers keys_tmp and values_tmp need to provide space for n
+	entries. Each of the nr_chunks chunks of parallel_chunks() counts and scatters its keys per digit of 8 bits, where digits
+	shared by all keys are skipped. */
+template <typename K, typename V>
+void parallel_radix_sort(size_t n, K* keys, V* values, K* keys_tmp, V* values_tmp, unsigned nr_key_bits, unsigned nr_chunks)
+{
+	const unsigned digit_bits = 8;
+	const size_t nr_buckets = size_t(1) << digit_bits;
+	K* keys_out = keys;
+	V* values_out = values;
+	// histograms[c*nr_buckets+d] counts digit d in chunk c and is then turned into the scatter offset
+	std::vector<size_t> histograms(nr_chunks * nr_buckets);
+	for (unsigned shift = 0; shift < nr_key_bits; shift += digit_bits) {
+		std::fill(histograms.begin(), histograms.end(), size_t(0));
+		parallel_chunks(n, nr_chunks, [&](unsigned c, size_t b, size_t e) {
+			size_t* histogram = &histograms[c * nr_buckets];
+			for (size_t i = b; i < e; ++i)
+				++histogram[(keys[i] >> shift) & (nr_buckets - 1)];
+		});
+		size_t offset = 0;
+		bool skip_pass = false;
+		for (size_t d = 0; d < nr_buckets; ++d) {
+			size_t bucket_begin = offset;
+			for (unsigned c = 0; c < nr_chunks; ++c) {
+				size_t count = histograms[c * nr_buckets + d];
+				histograms[c * nr_buckets + d] = offset;
+				offset += count;
+			}
+			if (offset - bucket_begin == n)
+				skip_pass = true;
+		}
+		if (skip_pass)
+			continue;
+		parallel_chunks(n, nr_chunks, [&](unsigned c, size_t b, size_t e) {
+			size_t* offsets = &histograms[c * nr_buckets];
+			if (values) {
+				for (size_t i = b; i < e; ++i) {
+					size_t j = offsets[(keys[i] >> shift) & (nr_buckets - 1)]++;
+					keys_tmp[j] = keys[i];
+					values_tmp[j] = values[i];
+				}
+			}
+			else {
+				for (size_t i = b; i < e; ++i)
+					keys_tmp[offsets[(keys[i] >> shift) & (nr_buckets - 1)]++] = keys[i];
+			}
+		});
+		std::swap(keys, keys_tmp);
+		std::swap(values, values_tmp);
+	}
+	// after an odd number of scatter passes the result lives in the scratch buffers
+	if (keys != keys_out) {
+		std::copy(keys, keys + n, keys_out);
+		if (values)
+			std::copy(values, values + n, values_out);
+	}
+}
+
+/// stable parallel radix sort of keys together with values by the lower nr_key_bits bits of the keys, where nr_chunks is chosen with choose_nr_chunks() if 0
+template <typename K, typename V>
+void parallel_radix_sort(std::vector<K>& keys, std::vector<V>& values, unsigned nr_key_bits, unsigned nr_chunks = 0)
+{
+	if (nr_chunks == 0)
+		nr_chunks = choose_nr_chunks(keys.size());
+	std::vector<K> keys_tmp(keys.size());
+	std::vector<V> values_tmp(values.size());
+	parallel_radix_sort(keys.size(), keys.data(), values.data(), keys_tmp.data(), values_tmp.data(), nr_key_bits, nr_chunks);
+}
+
+/// stable parallel radix sort of keys by their lower nr_key_bits bits, where nr_chunks is chosen with choose_nr_chunks() if 0
+template <typename K>
+void parallel_radix_sort(std::vector<K>& keys, unsigned nr_key_bits, unsigned nr_chunks = 0)
+{
+	if (nr_chunks == 0)
+		nr_chunks = choose_nr_chunks(keys.size());
+	std::vector<K> keys_tmp(keys.size());
+	parallel_radix_sort(keys.size(), keys.data(), (K*)0, keys_tmp.data(), (K*)0, nr_key_bits, nr_chunks);
+}
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -0,0 +1,147 @@
+#include "reflection_cache.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+
+namespace cgv {
+	namespace reflect {
+
+/// reflection handler that records all members that a find_reflection_handler could match with a plain member name
+class reflection_cache_builder : public reflection_handler
+{
+protected:
+	reflection_cache& cache;
+	char* instance_ptr;
+	/// record first occurrence of a name only, as the find_reflection_handler stops at the first match
+	void record(const std::string& member_name, void* member_ptr, abst_reflection_traits* rt, GroupKind group_kind, bool cacheable)
+	{
+		if (!reflection_cache::is_plain_member_name(member_name) || cache.members.find(member_name) != cache.members.end())
+			return;
+		reflection_cache::member_info mi;
+		mi.offset = static_cast<char*>(member_ptr) - instance_ptr;
+		mi.group_kind = group_kind;
+		mi.rt = 0;
+		if (cacheable)
+			mi.rt = rt->clone();
+		cache.members[member_name] = mi;
+	}
+public:
+	reflection_cache_builder(reflection_cache& _cache, void* _instance_ptr) : cache(_cache), instance_ptr(static_cast<char*>(_instance_ptr)) {}
+	/// follow the traversal of the find_reflection_handler for a plain member name
+	int reflect_group_begin(GroupKind group_kind, const std::string& group_name, void* group_ptr, abst_reflection_traits* rt, unsigned)
+	{
+		switch (group_kind) {
+		case GK_BASE_CLASS:
+			record(rt->get_type_name(), group_ptr, rt, group_kind, true);
+			return GT_COMPLETE;
+		case GK_STRUCTURE:
+			if (group_name.empty())
+				return GT_COMPLETE;
+			record(group_name, group_ptr, rt, group_kind, true);
+			return GT_SKIP;
+		case GK_ARRAY:
+		case GK_VECTOR:
+			// unnamed arrays terminate the search of the find_reflection_handler
+			if (group_name.empty())
+				return GT_TERMINATE;
+			// group size can change from instance to instance
+			record(group_name, group_ptr, rt, group_kind, false);
+			return GT_SKIP;
+		default:
+			return GT_SKIP;
+		}
+	}
+	///
+	bool reflect_member_void(const std::string& member_name, void* member_ptr, abst_reflection_traits* rt)
+	{
+		// unnamed members terminate the search of the find_reflection_handler
+		if (member_name.empty())
+			return false;
+		record(member_name, member_ptr, rt, GK_NO_GROUP, true);
+		return true;
+	}
+	/// ignore methods
+	bool reflect_method_void(const std::string&, method_interface*,
+		abst_reflection_traits*, const std::vector<abst_reflection_traits*>&)
+	{
+		return true;
+	}
+};
+
+reflection_cache::~reflection_cache()
+{
+	for (auto& m : members)
+		if (m.second.rt)
+			delete m.second.rt;
+}
+
+const reflection_cache::member_info* reflection_cache::find(const std::string& member_name) const
+{
+	auto iter = members.find(member_name);
+	if (iter == members.end() || !iter->second.rt)
+		return 0;
+	return &iter->second;
+}
+
+size_t reflection_cache::get_nr_members() const
+{
+	size_t n = 0;
+	for (const auto& m : members)
+		if (m.second.rt)
+			++n;
+	return n;
+}
+
+bool reflection_cache::is_plain_member_name(const std::string& target)
+{
+	return !target.empty() && target.find_first_of(".[]'\"\\") == std::string::npos;
+}
+
+void reflection_cache::build_void(void* instance_ptr, bool (*self_reflect)(void*, reflection_handler&))
+{
+	reflection_cache_builder rcb(*this, instance_ptr);
+	self_reflect(instance_ptr, rcb);
+}
+
+namespace {
+	std::mutex& ref_cache_mutex()
+	{
+		static std::mutex m;
+		return m;
+	}
+	std::map<std::type_index, std::unique_ptr<reflection_cache> >& ref_caches()
+	{
+		static std::map<std::type_index, std::unique_ptr<reflection_cache> > caches;
+		return caches;
+	}
+}
+
+const reflection_cache& reflection_cache::get_void(const std::type_info& ti, void* instance_ptr, bool (*self_reflect)(void*, reflection_handler&))
+{
+	std::type_index key(ti);
+	{
+		std::lock_guard<std::mutex> lock(ref_cache_mutex());
+		auto iter = ref_caches().find(key);
+		if (iter != ref_caches().end())
+			return *iter->second;
+	}
+	// build outside of lock as self reflection can call arbitrary code
+	std::unique_ptr<reflection_cache> cache(new reflection_cache());
+	cache->build_void(instance_ptr, self_reflect);
+	std::lock_guard<std::mutex> lock(ref_cache_mutex());
+	auto& entry = ref_caches()[key];
+	if (!entry)
+		entry = std::move(cache);
+	return *entry;
+}
+
+void reflection_cache::clear_all()
+{
+	std::lock_guard<std::mutex> lock(ref_cache_mutex());
+	ref_caches().clear();
+}
+
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "reflection_handler.h"
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace reflect {
+
+/** The reflection cache stores for one type the members that the cgv::reflect::find_reflection_handler
+    would find for a target that is a plain member name, i.e. that does not contain any . or [] operators.
+	For each name the offset of the member relative to the reflected instance is recorded together with
+	the reflection traits, such that the member of any instance of the same type can be accessed with a
+	single hash table lookup instead of a traversal of the self_reflect() method.
+
+	The cache is only correct for types whose self reflection exposes members at fixed offsets relative
+	to the instance. Members that are reflected from temporaries or through pointers to other objects
+	would be accessed at wrong addresses for other instances. Therefore types need to opt in, as done with
+	cgv::base::base::use_reflection_cache(). Names that are not found in the cache need to be looked up
+	with a find_reflection_handler. */
+class CGV_API reflection_cache
+{
+public:
+	/// information on a cached member
+	struct member_info
+	{
+		/// offset of member relative to the reflected instance in bytes
+		std::ptrdiff_t offset;
+		/// reflection traits of member type
+		abst_reflection_traits* rt;
+		/// group kind that the find_reflection_handler reports for the member
+		reflection_handler::GroupKind group_kind;
+		/// return pointer to member in given instance
+		void* get_member_ptr(void* instance) const { return static_cast<char*>(instance) + offset; }
+	};
+protected:
+	/// map from name to member info, where names that cannot be cached are mapped to a null traits pointer
+	std::unordered_map<std::string, member_info> members;
+	friend class reflection_cache_builder;
+public:
+	/// destruct cached reflection traits
+	~reflection_cache();
+	/// return the cached member info for the given member name or null pointer if name is not cached
+	const member_info* find(const std::string& member_name) const;
+	/// return the number of cached members
+	size_t get_nr_members() const;
+	/// check whether a target only consists of a member name without operators such that it can be looked up in the cache
+	static bool is_plain_member_name(const std::string& target);
+	/// build the cache of a type from an instance by calling the given self reflection function on a recording reflection handler
+	template <typename T>
+	void build(T& instance)
+	{
+		build_void(&instance, [](void* instance_ptr, reflection_handler& rh) { return static_cast<T*>(instance_ptr)->self_reflect(rh); });
+	}
+	/// type independent implementation of build
+	void build_void(void* instance_ptr, bool (*self_reflect)(void*, reflection_handler&));
+	/// return the cache of the type with the given type info, which is built from the given instance if the type is seen for the first time
+	template <typename T>
+	static const reflection_cache& get(const std::type_info& ti, T& instance)
+	{
+		return get_void(ti, &instance, [](void* instance_ptr, reflection_handler& rh) { return static_cast<T*>(instance_ptr)->self_reflect(rh); });
+	}
+	/// type independent implementation of get
+	static const reflection_cache& get_void(const std::type_info& ti, void* instance_ptr, bool (*self_reflect)(void*, reflection_handler&));
+	/// remove all caches, which is necessary if the layout of a type changes, for example when a plugin is reloaded
+	static void clear_all();
+};
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
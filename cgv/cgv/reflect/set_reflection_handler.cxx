@@ -27,7 +27,14 @@ void set_reflection_handler::process_member_void(const std::string& member_name,
 	                     abst_reflection_traits* rt, GroupKind group_kind, unsigned grp_size)
 {
 	find_reflection_handler::process_member_void(member_name, member_ptr, rt, group_kind, grp_size);
-	valid = false;
+	valid = set_member_void(member_ptr, rt, value_type, value_ptr, value_rt);
+}
+
+/// assign value specified by type name or reflection traits to the member described by rt and return whether conversion was possible
+bool set_reflection_handler::set_member_void(void* member_ptr, abst_reflection_traits* rt,
+	const std::string& value_type, const void* value_ptr, abst_reflection_traits* value_rt)
+{
+	bool valid = false;
 	if (value_rt) {
 		if (info::is_fundamental(rt->get_type_id())) {
 			if (info::is_fundamental(value_rt->get_type_id())) {
@@ -64,6 +71,7 @@ void set_reflection_handler::process_member_void(const std::string& member_name,
 			valid = rt->set_from_string(member_ptr, *static_cast<const std::string*>(value_ptr));
 		}
 	}
+	return valid;
 }
 
 	}
@@ -27,6 +27,9 @@ public:
 	///
 	void process_member_void(const std::string& member_name, void* member_ptr, 
 						     abst_reflection_traits* rt, GroupKind group_kind, unsigned grp_size);
+	/// assign value specified by type name or reflection traits to the member described by rt and return whether conversion was possible
+	static bool set_member_void(void* member_ptr, abst_reflection_traits* rt,
+								const std::string& value_type, const void* value_ptr, abst_reflection_traits* value_rt = 0);
 };
 
 #ifdef REFLECT_TRAITS_WITH_DECLTYPE
@@ -118,6 +118,12 @@ bool render_config::self_reflect(cgv::reflect::reflection_handler& srh)
 		srh.reflect_member("show_error_on_console", show_error_on_console);
 }
 
+/// all reflected members belong to the configuration, such that the reflection cache can be used
+bool render_config::use_reflection_cache() const
+{
+	return true;
+}
+
 /// return a pointer to the current shader configuration
 render_config_ptr get_render_config()
 {
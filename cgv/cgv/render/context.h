@@ -599,6 +599,8 @@ struct CGV_API render_config : public cgv::base::base, public context_config
 	std::string get_type_name() const;
 	/// reflect the shader_path member
 	bool self_reflect(cgv::reflect::reflection_handler& srh);
+	/// all reflected members belong to the configuration, such that the reflection cache can be used
+	bool use_reflection_cache() const;
 };
 
 /// type of ref counted pointer to render configuration
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cgv {
+	namespace signal {
+
+/** callable object with void return type used as slot of a lock_free_signal. Callables that fit
+    into an internal buffer of buffer_size bytes, like function pointers, member function pointers
+	with instance pointer or lambdas with few captures, are stored without heap allocation. */
+template <typename... Args>
+class small_function
+{
+public:
+	/// size of the internal buffer in bytes
+	static const size_t buffer_size = 4 * sizeof(void*);
+protected:
+	enum Operation { OP_COPY, OP_DESTROY };
+	typedef void (*invoke_type)(const void* storage, Args... args);
+	typedef void (*manage_type)(Operation op, void* dst, const void* src);
+	typename std::aligned_storage<buffer_size, alignof(std::max_align_t)>::type storage;
+	invoke_type invoke_ptr;
+	manage_type manage_ptr;
+	/// callable types that are stored in the internal buffer
+	template <typename F>
+	struct is_local
+	{
+		static const bool value = sizeof(F) <= buffer_size && alignof(std::max_align_t) % alignof(F) == 0 &&
+			std::is_nothrow_copy_constructible<F>::value;
+	};
+	template <typename F>
+	static F& local(const void* s) { return *static_cast<F*>(const_cast<void*>(s)); }
+	template <typename F>
+	static F*& remote(const void* s) { return *static_cast<F**>(const_cast<void*>(s)); }
+	template <typename F>
+	void init(const F& f, std::true_type)
+	{
+		new (&storage) F(f);
+		invoke_ptr = [](const void* s, Args... args) { local<F>(s)(args...); };
+		manage_ptr = [](Operation op, void* dst, const void* src) {
+			if (op == OP_COPY)
+				new (dst) F(local<F>(src));
+			else
+				local<F>(dst).~F();
+		};
+	}
+	template <typename F>
+	void init(const F& f, std::false_type)
+	{
+		new (&storage) F*(new F(f));
+		invoke_ptr = [](const void* s, Args... args) { (*remote<F>(s))(args...); };
+		manage_ptr = [](Operation op, void* dst, const void* src) {
+			if (op == OP_COPY)
+				new (dst) F*(new F(*remote<F>(src)));
+			else
+				delete remote<F>(dst);
+		};
+	}
+public:
+	/// construct from callable
+	template <typename F>
+	small_function(const F& f)
+	{
+		typedef typename std::decay<F>::type D;
+		init<D>(f, std::integral_constant<bool, is_local<D>::value>());
+	}
+	/// copy construct
+	small_function(const small_function& sf) : invoke_ptr(sf.invoke_ptr), manage_ptr(sf.manage_ptr)
+	{
+		manage_ptr(OP_COPY, &storage, &sf.storage);
+	}
+	/// assignment via copy construction
+	small_function& operator = (const small_function& sf)
+	{
+		if (this != &sf) {
+			manage_ptr(OP_DESTROY, &storage, 0);
+			invoke_ptr = sf.invoke_ptr;
+			manage_ptr = sf.manage_ptr;
+			manage_ptr(OP_COPY, &storage, &sf.storage);
+		}
+		return *this;
+	}
+	/// destruct stored callable
+	~small_function()
+	{
+		manage_ptr(OP_DESTROY, &storage, 0);
+	}
+	/// check whether callable is stored without heap allocation
+	template <typename F>
+	static bool is_stored_locally() { return is_local<typename std::decay<F>::type>::value; }
+	/// call stored callable
+	void operator () (Args... args) const
+	{
+		invoke_ptr(&storage, args...);
+	}
+};
+
+/** Signal that can be emitted and modified concurrently from any thread. In contrast to cgv::signal::signal,
+    slots are stored by value in small_function instances and no tacker bookkeeping is done, such that
+	connections to methods of objects need to be disconnected explicitly with the connection id returned by
+	connect() before the object is destroyed.
+
+	The slots are kept in an immutable list. Connecting and disconnecting copy the list under a mutex and
+	publish the new list with an atomic exchange. Emission only increments the counter of active emissions
+	of the current epoch, loads the current list and calls the slots without locking or allocating memory,
+	i.e. it is wait-free apart from the called slots. Replaced lists are retired in the current epoch.
+	A modification advances the epoch once all emissions of the previous epoch have finished and then deletes
+	the lists retired before, such that the retired lists are bounded by the oldest emission in progress also
+	if the signal is emitted continuously. The destructor deletes the remaining lists. As a consequence a slot that is disconnected while another thread emits
+	the signal can still be called by this emission once. Slots can connect and disconnect slots of the
+	emitted signal, which takes effect with the next emission. */
+template <typename... Args>
+class lock_free_signal
+{
+public:
+	/// type of callable slots
+	typedef small_function<Args...> slot_type;
+	/// type of handles returned by connect
+	typedef size_t connection_id;
+protected:
+	struct slot
+	{
+		connection_id id;
+		slot_type function;
+		slot(connection_id _id, const slot_type& _function) : id(_id), function(_function) {}
+	};
+	typedef std::vector<slot> slot_list;
+	/// currently published slot list or null pointer if no slot is connected
+	std::atomic<slot_list*> slots;
+	/// epoch of emissions, whose parity selects the counter of nr_emitting
+	std::atomic<unsigned> epoch;
+	/// number of emissions in progress per parity of the epoch in which they started
+	mutable std::atomic<unsigned> nr_emitting[2];
+	/// serializes modifications of the slot list
+	std::mutex modify_mutex;
+	/// replaced slot lists per parity of the epoch in which they were retired, as they can still be in use by emissions
+	std::vector<slot_list*> retired[2];
+	/// id given to the next connected slot
+	connection_id next_id;
+	/// delete the given retired slot lists
+	static void delete_slot_lists(std::vector<slot_list*>& slot_lists)
+	{
+		for (slot_list* sl : slot_lists)
+			delete sl;
+		slot_lists.clear();
+	}
+	/** delete the lists retired in the previous epoch if all emissions started in it have finished and advance the
+		epoch if lists have been retired in the current one. Emissions that start after the epoch is advanced load a list
+		that is not retired yet. modify_mutex must be locked. */
+	void reclaim()
+	{
+		unsigned e = epoch.load();
+		for (;;) {
+			if (nr_emitting[(e + 1) & 1].load() != 0)
+				return;
+			delete_slot_lists(retired[(e + 1) & 1]);
+			if (retired[e & 1].empty())
+				return;
+			epoch.store(++e);
+		}
+	}
+	/// publish new list and retire the replaced one in the current epoch; modify_mutex must be locked
+	void publish(slot_list* new_slots)
+	{
+		if (new_slots && new_slots->empty()) {
+			delete new_slots;
+			new_slots = 0;
+		}
+		slot_list* old_slots = slots.exchange(new_slots);
+		if (old_slots)
+			retired[epoch.load() & 1].push_back(old_slots);
+		reclaim();
+	}
+	/// count emission in the current epoch until destruction, also if a slot throws an exception
+	struct emission_guard
+	{
+		std::atomic<unsigned>& counter;
+		emission_guard(const lock_free_signal& sig) : counter(sig.nr_emitting[sig.epoch.load() & 1]) { counter.fetch_add(1); }
+		~emission_guard() { counter.fetch_sub(1); }
+	};
+public:
+	/// construct signal without slots
+	lock_free_signal() : slots(0), epoch(0), next_id(1) { nr_emitting[0] = 0; nr_emitting[1] = 0; }
+	/// signals cannot be copied
+	lock_free_signal(const lock_free_signal&) = delete;
+	/// signals cannot be assigned
+	lock_free_signal& operator = (const lock_free_signal&) = delete;
+	/// delete slot lists, which requires that no emission is in progress
+	~lock_free_signal()
+	{
+		delete slots.load();
+		delete_slot_lists(retired[0]);
+		delete_slot_lists(retired[1]);
+	}
+	/// connect a copy of the given callable and return the id needed to disconnect it
+	template <typename F>
+	connection_id connect(const F& f)
+	{
+		std::lock_guard<std::mutex> lock(modify_mutex);
+		slot_list* old_slots = slots.load();
+		slot_list* new_slots = old_slots ? new slot_list(*old_slots) : new slot_list();
+		connection_id id = next_id++;
+		new_slots->push_back(slot(id, slot_type(f)));
+		publish(new_slots);
+		return id;
+	}
+	/// disconnect the slot with the given id and return whether it was connected
+	bool disconnect(connection_id id)
+	{
+		std::lock_guard<std::mutex> lock(modify_mutex);
+		slot_list* old_slots = slots.load();
+		if (!old_slots)
+			return false;
+		slot_list* new_slots = new slot_list();
+		new_slots->reserve(old_slots->size());
+		for (const slot& s : *old_slots)
+			if (s.id != id)
+				new_slots->push_back(s);
+		if (new_slots->size() == old_slots->size()) {
+			delete new_slots;
+			return false;
+		}
+		publish(new_slots);
+		return true;
+	}
+	/// disconnect all slots
+	void disconnect_all()
+	{
+		std::lock_guard<std::mutex> lock(modify_mutex);
+		publish(0);
+	}
+	/// return the number of connected slots
+	size_t get_nr_slots() const
+	{
+		emission_guard guard(*this);
+		const slot_list* sl = slots.load();
+		return sl ? sl->size() : 0;
+	}
+	/// return the number of replaced slot lists that are not deleted yet, as emissions in progress can still use them
+	size_t get_nr_retired_slot_lists()
+	{
+		std::lock_guard<std::mutex> lock(modify_mutex);
+		return retired[0].size() + retired[1].size();
+	}
+	/// call all slots connected at the time of the call in the order of connection
+	void operator () (Args... args) const
+	{
+		emission_guard guard(*this);
+		const slot_list* sl = slots.load();
+		if (sl)
+			for (const slot& s : *sl)
+				s.function(args...);
+	}
+};
+
+/// connect a lock free signal to a method of an object and return the connection id
+template <typename X, typename... Args>
+size_t connect(lock_free_signal<Args...>& s, X* ip, void (X::*mp)(Args...))
+{
+	return s.connect([ip, mp](Args... args) { (ip->*mp)(args...); });
+}
+
+/// connect a lock free signal to a const method of an object and return the connection id
+template <typename X, typename... Args>
+size_t connect(lock_free_signal<Args...>& s, const X* ip, void (X::*mp)(Args...) const)
+{
+	return s.connect([ip, mp](Args... args) { (ip->*mp)(args...); });
+}
+
+/// connect a lock free signal to a copy of a callable and return the connection id
+template <typename F, typename... Args>
+size_t connect(lock_free_signal<Args...>& s, const F& f)
+{
+	return s.connect(f);
+}
+
+	}
+}
@@ -0,0 +1,124 @@
+#include <cgv/utils/chunked_file_reader.h>
+#include <cgv/utils/file.h>
+#include <stdio.h>
+
+namespace cgv {
+	namespace utils {
+
+chunked_file_reader::chunked_file_reader(size_t _chunk_size, unsigned nr_chunks) : chunks(nr_chunks < 2 ? 2 : nr_chunks), chunk_size(_chunk_size)
+{
+	read_index = nr_filled = consume_index = 0;
+	consumed_chunk = false;
+	finished = failed = stop = false;
+	file_size = 0;
+}
+
+chunked_file_reader::~chunked_file_reader()
+{
+	close();
+}
+
+bool chunked_file_reader::open(const std::string& file_name, size_t offset, size_t length)
+{
+	close();
+	file_size = file::size(file_name);
+	if (file_size == size_t(-1) || offset > file_size) {
+		file_size = 0;
+		return false;
+	}
+	FILE* fp = ::fopen(file_name.c_str(), "rb");
+	if (!fp)
+		return false;
+	if (offset != 0) {
+		if (
+#ifdef _WIN32
+			_fseeki64
+#else
+			fseeko64
+#endif
+			(fp, offset, SEEK_SET) != 0) {
+			fclose(fp);
+			return false;
+		}
+	}
+	if (length > file_size - offset)
+		length = file_size - offset;
+	read_index = nr_filled = consume_index = 0;
+	consumed_chunk = false;
+	finished = failed = stop = false;
+	thread = std::thread(&chunked_file_reader::read_chunks, this, (void*)fp, length);
+	return true;
+}
+
+void chunked_file_reader::read_chunks(void* fp, size_t length)
+{
+	size_t n = chunks.size();
+	while (length > 0) {
+		chunk* c;
+		{
+			// wait for a slot that neither holds an unconsumed chunk nor the chunk handed out last
+			std::unique_lock<std::mutex> lock(mutex);
+			chunk_released.wait(lock, [&]() { return stop || nr_filled + (consumed_chunk ? 1 : 0) < n; });
+			if (stop)
+				break;
+			c = &chunks[read_index % n];
+		}
+		c->size = length < chunk_size ? length : chunk_size;
+		if (c->data.size() < c->size)
+			c->data.resize(c->size);
+		bool success = ::fread(c->data.data(), 1, c->size, (FILE*)fp) == c->size;
+		length -= c->size;
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!success) {
+			failed = true;
+			break;
+		}
+		++read_index;
+		++nr_filled;
+		chunk_filled.notify_one();
+	}
+	::fclose((FILE*)fp);
+	std::lock_guard<std::mutex> lock(mutex);
+	finished = true;
+	chunk_filled.notify_one();
+}
+
+bool chunked_file_reader::next_chunk(const char*& data, size_t& size)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	if (consumed_chunk) {
+		consumed_chunk = false;
+		chunk_released.notify_one();
+	}
+	chunk_filled.wait(lock, [&]() { return nr_filled > 0 || finished; });
+	if (nr_filled == 0 || failed)
+		return false;
+	const chunk& c = chunks[consume_index % chunks.size()];
+	data = c.data.data();
+	size = c.size;
+	++consume_index;
+	--nr_filled;
+	consumed_chunk = true;
+	return true;
+}
+
+bool chunked_file_reader::has_failed()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return failed;
+}
+
+void chunked_file_reader::close()
+{
+	if (thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+			chunk_released.notify_one();
+		}
+		thread.join();
+	}
+}
+
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace utils {
+/**
+* reader that reads a file in chunks of fixed size on a background thread, such that parsing or
+* converting one chunk overlaps with reading the following ones. The chunks are handed out in
+* file order by next_chunk(), where a chunk stays valid until the next call to next_chunk().
+*/
+class CGV_API chunked_file_reader
+{
+	struct chunk
+	{
+		std::vector<char> data;
+		size_t size;
+	};
+	std::vector<chunk> chunks;
+	size_t chunk_size;
+	/// index of chunk to be read next by the background thread and number of read chunks that are not handed out yet
+	size_t read_index, nr_filled;
+	/// index of chunk handed out last
+	size_t consume_index;
+	bool consumed_chunk;
+	bool finished, failed, stop;
+	size_t file_size;
+	std::mutex mutex;
+	std::condition_variable chunk_filled, chunk_released;
+	std::thread thread;
+	void read_chunks(void* fp, size_t length);
+	chunked_file_reader(const chunked_file_reader&);
+	chunked_file_reader& operator = (const chunked_file_reader&);
+public:
+	/// construct reader with the given chunk size in bytes and the number of chunks that can be read ahead
+	chunked_file_reader(size_t _chunk_size = 4 << 20, unsigned nr_chunks = 3);
+	/// stop reading and close the file
+	~chunked_file_reader();
+	/// open the file and start reading \c length bytes starting at \c offset or the complete rest of the file
+	bool open(const std::string& file_name, size_t offset = 0, size_t length = size_t(-1));
+	/// wait for the next chunk and return false if the file has been read completely or a read error occurred
+	bool next_chunk(const char*& data, size_t& size);
+	/// return whether a read error occurred
+	bool has_failed();
+	/// return the size of the opened file
+	size_t get_file_size() const { return file_size; }
+	/// stop reading and close the file
+	void close();
+};
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -0,0 +1,259 @@
+#include <cgv/utils/mapped_file.h>
+#include <cgv/type/standard_types.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cgv {
+	namespace utils {
+
+mapped_file::mapped_file() : access_mode(READ), access_hint(NORMAL), file(0), mapping(0), ptr(0), 
+	file_size(0), pos(0), prefetched_until(0), prefetch_window(8 << 20)
+{
+}
+
+mapped_file::mapped_file(const std::string& file_name, MODE m, size_t size) : access_mode(READ), access_hint(NORMAL), 
+	file(0), mapping(0), ptr(0), file_size(0), pos(0), prefetched_until(0), prefetch_window(8 << 20)
+{
+	open(file_name, m, size);
+}
+
+mapped_file::~mapped_file()
+{
+	close();
+}
+
+bool mapped_file::is_open() const
+{
+	return file != 0;
+}
+
+#ifdef _WIN32
+
+bool mapped_file::open(const std::string& file_name, MODE m, size_t size)
+{
+	close();
+	HANDLE h = CreateFileA(file_name.c_str(), m == READ ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE,
+		m == READ ? FILE_SHARE_READ : 0, NULL, m == READ ? OPEN_EXISTING : OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (h == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER fs;
+	if (m == READ_WRITE && size > 0) {
+		fs.QuadPart = (LONGLONG)size;
+		if (!SetFilePointerEx(h, fs, NULL, FILE_BEGIN) || !SetEndOfFile(h)) {
+			CloseHandle(h);
+			return false;
+		}
+	}
+	else if (!GetFileSizeEx(h, &fs)) {
+		CloseHandle(h);
+		return false;
+	}
+	if (fs.QuadPart > 0) {
+		HANDLE mh = CreateFileMappingA(h, NULL, m == READ ? PAGE_READONLY : PAGE_READWRITE, fs.HighPart, fs.LowPart, NULL);
+		if (mh == NULL) {
+			CloseHandle(h);
+			return false;
+		}
+		ptr = (char*)MapViewOfFile(mh, m == READ ? FILE_MAP_READ : FILE_MAP_WRITE, 0, 0, 0);
+		if (!ptr) {
+			CloseHandle(mh);
+			CloseHandle(h);
+			return false;
+		}
+		mapping = mh;
+	}
+	file = h;
+	filename = file_name;
+	access_mode = m;
+	access_hint = NORMAL;
+	file_size = (size_t)fs.QuadPart;
+	pos = prefetched_until = 0;
+	return true;
+}
+
+void mapped_file::close()
+{
+	if (ptr) {
+		if (access_mode == READ_WRITE)
+			FlushViewOfFile(ptr, 0);
+		UnmapViewOfFile(ptr);
+	}
+	if (mapping)
+		CloseHandle((HANDLE)mapping);
+	if (file)
+		CloseHandle((HANDLE)file);
+	file = mapping = 0;
+	ptr = 0;
+	file_size = pos = prefetched_until = 0;
+}
+
+bool mapped_file::advise(ACCESS_HINT hint, size_t offset, size_t length)
+{
+	if (!ptr || offset >= file_size)
+		return false;
+	if (length > file_size - offset)
+		length = file_size - offset;
+	access_hint = hint;
+	// windows only supports explicit prefetching
+	if (hint == WILL_NEED || hint == SEQUENTIAL)
+		return prefetch(offset, hint == SEQUENTIAL && length > prefetch_window ? prefetch_window : length);
+	return true;
+}
+
+bool mapped_file::prefetch(size_t offset, size_t length)
+{
+	if (!ptr || offset >= file_size)
+		return false;
+	if (length > file_size - offset)
+		length = file_size - offset;
+#if _WIN32_WINNT >= 0x0602
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = ptr + offset;
+	range.NumberOfBytes = length;
+	return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0) != 0;
+#else
+	return true;
+#endif
+}
+
+bool mapped_file::flush()
+{
+	return ptr && access_mode == READ_WRITE && FlushViewOfFile(ptr, 0) != 0;
+}
+
+#else
+
+bool mapped_file::open(const std::string& file_name, MODE m, size_t size)
+{
+	close();
+	int fd = ::open(file_name.c_str(), m == READ ? O_RDONLY : O_RDWR | O_CREAT, 0644);
+	if (fd < 0)
+		return false;
+	if (m == READ_WRITE && size > 0 && ftruncate(fd, (off_t)size) != 0) {
+		::close(fd);
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		::close(fd);
+		return false;
+	}
+	if (st.st_size > 0) {
+		void* p = mmap(0, (size_t)st.st_size, m == READ ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (p == MAP_FAILED) {
+			::close(fd);
+			return false;
+		}
+		ptr = (char*)p;
+	}
+	// store descriptor incremented by one such that a valid descriptor is never 0
+	file = (void*)(size_t)(fd + 1);
+	filename = file_name;
+	access_mode = m;
+	access_hint = NORMAL;
+	file_size = (size_t)st.st_size;
+	pos = prefetched_until = 0;
+	return true;
+}
+
+void mapped_file::close()
+{
+	if (ptr)
+		munmap(ptr, file_size);
+	if (file)
+		::close(int((size_t)file) - 1);
+	file = 0;
+	ptr = 0;
+	file_size = pos = prefetched_until = 0;
+}
+
+bool mapped_file::advise(ACCESS_HINT hint, size_t offset, size_t length)
+{
+	if (!ptr || offset >= file_size)
+		return false;
+	if (length > file_size - offset)
+		length = file_size - offset;
+	// madvise expects page aligned addresses
+	size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+	size_t aligned_offset = offset - offset % page_size;
+	length += offset - aligned_offset;
+	static const int advice[] = { MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED, MADV_DONTNEED };
+	access_hint = hint;
+	if (hint == SEQUENTIAL)
+		prefetched_until = pos;
+	return madvise(ptr + aligned_offset, length, advice[hint]) == 0;
+}
+
+bool mapped_file::prefetch(size_t offset, size_t length)
+{
+	if (!ptr || offset >= file_size)
+		return false;
+	if (length > file_size - offset)
+		length = file_size - offset;
+	size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+	size_t aligned_offset = offset - offset % page_size;
+	return madvise(ptr + aligned_offset, length + offset - aligned_offset, MADV_WILLNEED) == 0;
+}
+
+bool mapped_file::flush()
+{
+	return ptr && access_mode == READ_WRITE && msync(ptr, file_size, MS_SYNC) == 0;
+}
+
+#endif
+
+void mapped_file::prefetch_ahead()
+{
+	// request the next window when half of the previous one has been consumed
+	if (prefetched_until >= file_size || pos + prefetch_window / 2 < prefetched_until)
+		return;
+	size_t begin = prefetched_until > pos ? prefetched_until : pos;
+	prefetch(begin, pos + prefetch_window - begin);
+	prefetched_until = pos + prefetch_window;
+}
+
+bool mapped_file::read(unsigned char* targetbuffer, size_t num)
+{
+	if (num > file_size - pos)
+		return false;
+	if (num == 0)
+		return true;
+#ifdef _WIN32
+	// on linux MADV_SEQUENTIAL already enables aggressive read ahead, where additional MADV_WILLNEED requests slow down reading
+	if (access_hint == SEQUENTIAL)
+		prefetch_ahead();
+#endif
+	memcpy(targetbuffer, ptr + pos, num);
+	pos += num;
+	return true;
+}
+
+bool mapped_file::read_string_bin(std::string& s)
+{
+	cgv::type::uint16_type length;
+	if (!read(length))
+		return false;
+	s.resize(length);
+	if (length == 0)
+		return true;
+	return read((unsigned char*)&s[0], length);
+}
+
+bool mapped_file::seek(size_t index)
+{
+	if (!is_open() || index > file_size)
+		return false;
+	pos = index;
+	return true;
+}
+
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string>
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace utils {
+/**
+* class to map files of arbitrary size into memory such that binary loaders can access
+* the file content without copying it through stdio buffers.
+*
+* Files are mapped with mmap on linux and with MapViewOfFile on windows. The sequential read
+* interface corresponds to the one of big_binary_file. In the SEQUENTIAL access mode linux reads
+* ahead by itself, while on windows a window in front of the read position is prefetched.
+*/
+class CGV_API mapped_file
+{
+public:
+	enum MODE { READ = 1, READ_WRITE = 3 };
+	/// hints on how the mapped memory is accessed, which are passed to madvise
+	enum ACCESS_HINT { NORMAL, SEQUENTIAL, RANDOM, WILL_NEED, DONT_NEED };
+
+private:
+	MODE access_mode;
+	ACCESS_HINT access_hint;
+	std::string filename;
+	void* file;
+	void* mapping;
+	char* ptr;
+	size_t file_size;
+	size_t pos;
+	size_t prefetched_until;
+	size_t prefetch_window;
+	/// prefetch the next window in case of sequential access
+	void prefetch_ahead();
+	mapped_file(const mapped_file&);
+	mapped_file& operator = (const mapped_file&);
+public:
+	/// construct without opening a file
+	mapped_file();
+	/// open the given file, check success with is_open()
+	mapped_file(const std::string& file_name, MODE m = READ, size_t size = 0);
+	/// unmap and close the file
+	virtual ~mapped_file();
+
+	/** map a file for reading or for reading and writing. In READ_WRITE mode a non zero \c size
+	    creates the file if necessary and resizes it to the given size before mapping. */
+	bool open(const std::string& file_name, MODE m = READ, size_t size = 0);
+	/// flush changes in READ_WRITE mode, unmap and close the file
+	void close();
+	/// return true if the file is opened, which is also the case for empty files that have no mapped data
+	bool is_open() const;
+	/// return the name of the opened file
+	const std::string& get_file_name() const { return filename; }
+	/// return the size of the file in bytes
+	size_t size() const { return file_size; }
+	/// return pointer to the mapped file content
+	const char* data() const { return ptr; }
+	/// return pointer to the mapped file content, which can only be written in READ_WRITE mode
+	char* data() { return ptr; }
+
+	/// tell the operating system how the given range of the mapping is accessed, where SEQUENTIAL also enables prefetching in read() and read_array() on windows
+	bool advise(ACCESS_HINT hint, size_t offset = 0, size_t length = size_t(-1));
+	/// start asynchronous read of the given range into the page cache
+	bool prefetch(size_t offset, size_t length);
+	/// set the number of bytes that are prefetched in front of the read position in case of sequential access on windows (default 8MB)
+	void set_prefetch_window(size_t nr_bytes) { prefetch_window = nr_bytes; }
+	/// write changes back to the file in READ_WRITE mode
+	bool flush();
+
+	/// return pointer to the content at the read position if at least \c nr_bytes are left or 0 otherwise
+	const char* get_ptr(size_t nr_bytes = 0) const { return pos + nr_bytes <= file_size ? ptr + pos : 0; }
+	/// copy num bytes at the read position to the target buffer and advance the read position
+	bool read(unsigned char* targetbuffer, size_t num);
+	/// read a typed value
+	template <typename T>
+	bool read(T& v) { return read((unsigned char*)(&v), sizeof(T)); }
+	/// read an array of typed values
+	template <typename T>
+	bool read_array(T* a, size_t n) { return read((unsigned char*)a, sizeof(T)*n); }
+	/// read a string in the format written by file::write_string_bin
+	bool read_string_bin(std::string& s);
+	/// set the read position to index (position in bytes from the beginning of the file)
+	bool seek(size_t index);
+	/// return the read position in bytes
+	size_t position() const { return pos; }
+};
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
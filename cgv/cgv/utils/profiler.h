@@ -38,6 +38,8 @@ namespace cgv {
 	 * }
 	 * ...
 	 * std::cout << p;
+	 *
+	 * For nested zones, multiple threads and trace export see trace_profiler.h.
 	 */
 
 	template< typename T = std::string>
@@ -1,6 +1,8 @@
 #include "scan.h"
 
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include <algorithm>
 #if __cplusplus >= 201703L
 #include <charconv>
@@ -423,13 +425,20 @@ bool is_integer(const std::string& s, int& value)
 	return is_integer(&s[0], &s[0]+s.size(), value);
 }
 
+namespace {
+	/// implementation of parse_double that optionally fails on values outside of the range of double
+	const char* parse_double_impl(const char* begin, const char* end, double& value, bool accept_out_of_range);
+}
+
 bool is_double(const char* begin, const char* end, double& value)
 {
 	if (begin == end)
 		return false;
 
 #if __cplusplus >= 201703L
-	return from_chars_success(std::from_chars(begin, end, value), end);
+	// out of range values are no doubles as with std::from_chars
+	const char* p = parse_double_impl(begin, end, value, false);
+	return p && (p == end || char_is_zero_or_whitespace(*p));
 #else
 	bool found_digit = false;
 	int nr_dots = 0;
@@ -486,6 +495,279 @@ bool is_double(const std::string& s, double& value)
 	return is_double(&s[0], &s[0]+s.size(), value);
 }
 
+namespace {
+	/// decimal number given by sign, mantissa and exponent to base ten
+	struct decimal_number
+	{
+		bool negative;
+		uint64_t mantissa;
+		int exponent;
+		bool too_many_digits;
+	};
+
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define CGV_UTILS_SCAN_EIGHT_DIGITS
+	/// check with SWAR operations whether all of the eight chars loaded in little endian order are digits
+	inline bool is_eight_digits(uint64_t v)
+	{
+		return (((v & 0xF0F0F0F0F0F0F0F0ull) | (((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull);
+	}
+	/// convert eight digits loaded in little endian order with three multiplications
+	inline uint32_t parse_eight_digits(uint64_t v)
+	{
+		v -= 0x3030303030303030ull;
+		v = v * 10 + (v >> 8);
+		v = (((v & 0x000000FF000000FFull) * 0x000F424000000064ull) + 
+			(((v >> 16) & 0x000000FF000000FFull) * 0x0000271000000001ull)) >> 32;
+		return uint32_t(v);
+	}
+#endif
+
+	/// scan digits into the mantissa, where at most 19 digits fit into 64 bits
+	inline const char* scan_digits(const char* p, const char* end, decimal_number& d, int& nr_digits, bool fraction)
+	{
+		while (p < end) {
+#ifdef CGV_UTILS_SCAN_EIGHT_DIGITS
+			if (end - p >= 8 && nr_digits <= 11) {
+				uint64_t v;
+				memcpy(&v, p, 8);
+				if (is_eight_digits(v)) {
+					d.mantissa = 100000000 * d.mantissa + parse_eight_digits(v);
+					nr_digits += 8;
+					if (fraction)
+						d.exponent -= 8;
+					p += 8;
+					continue;
+				}
+			}
+#endif
+			unsigned digit = unsigned(*p - '0');
+			if (digit > 9)
+				break;
+			if (nr_digits < 19) {
+				d.mantissa = 10 * d.mantissa + digit;
+				// leading zeros do not count
+				if (d.mantissa > 0)
+					++nr_digits;
+				if (fraction)
+					--d.exponent;
+			}
+			else {
+				d.too_many_digits = true;
+				if (!fraction)
+					++d.exponent;
+			}
+			++p;
+		}
+		return p;
+	}
+
+	/// scan decimal number with optional sign, fraction and exponent and return pointer behind it or 0 if no digit was found
+	const char* scan_decimal(const char* p, const char* end, decimal_number& d)
+	{
+		d.negative = false;
+		d.mantissa = 0;
+		d.exponent = 0;
+		d.too_many_digits = false;
+		if (p < end && (*p == '-' || *p == '+'))
+			d.negative = *p++ == '-';
+		int nr_digits = 0;
+		const char* digits_begin = p;
+		p = scan_digits(p, end, d, nr_digits, false);
+		bool found_digit = p > digits_begin;
+		if (p < end && *p == '.') {
+			const char* fraction_begin = ++p;
+			p = scan_digits(p, end, d, nr_digits, true);
+			found_digit = found_digit || p > fraction_begin;
+		}
+		if (!found_digit)
+			return 0;
+		if (p < end && (*p == 'e' || *p == 'E')) {
+			const char* q = p + 1;
+			bool negative_exponent = false;
+			if (q < end && (*q == '-' || *q == '+'))
+				negative_exponent = *q++ == '-';
+			if (q < end && is_digit(*q)) {
+				int exponent = 0;
+				for (; q < end && is_digit(*q); ++q)
+					if (exponent < 100000)
+						exponent = 10 * exponent + (*q - '0');
+				d.exponent += negative_exponent ? -exponent : exponent;
+				p = q;
+			}
+		}
+		return p;
+	}
+
+	/// powers of ten that are exactly representable as double
+	const double exact_powers_of_ten[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	/** compute the double value with a single correctly rounded operation if mantissa and power of ten are exactly 
+	    representable (Clinger's fast path) and return false otherwise */
+	inline bool decimal_to_double(const decimal_number& d, double& value)
+	{
+		if (d.too_many_digits || d.mantissa > (uint64_t(1) << 53) || d.exponent < -22 || d.exponent > 22)
+			return false;
+		value = double(d.mantissa);
+		if (d.exponent < 0)
+			value /= exact_powers_of_ten[-d.exponent];
+		else
+			value *= exact_powers_of_ten[d.exponent];
+		if (d.negative)
+			value = -value;
+		return true;
+	}
+
+	/// same for float where the double result is used if rounding it to float cannot differ from rounding the exact value
+	inline bool decimal_to_float(const decimal_number& d, float& value)
+	{
+		if (d.too_many_digits)
+			return false;
+		if (d.mantissa <= (uint64_t(1) << 24) && d.exponent >= -10 && d.exponent <= 10) {
+			static const float exact_float_powers_of_ten[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+			value = float(d.mantissa);
+			if (d.exponent < 0)
+				value /= exact_float_powers_of_ten[-d.exponent];
+			else
+				value *= exact_float_powers_of_ten[d.exponent];
+			if (d.negative)
+				value = -value;
+			return true;
+		}
+		double value_d;
+		if (!decimal_to_double(d, value_d))
+			return false;
+		// rounding twice only fails if the double lies exactly in the middle between two floats or in the subnormal range
+		double abs_value_d = value_d < 0 ? -value_d : value_d;
+		if (abs_value_d != 0 && (abs_value_d < 1.17549435e-38 || abs_value_d > 3.40282346e38))
+			return false;
+		uint64_t bits;
+		memcpy(&bits, &value_d, 8);
+		if ((bits & 0x1FFFFFFF) == 0x10000000)
+			return false;
+		value = float(value_d);
+		return true;
+	}
+
+	inline void convert_exactly(const char* s, char** e, double& value) { value = strtod(s, e); }
+	inline void convert_exactly(const char* s, char** e, float& value) { value = strtof(s, e); }
+
+	/// exact conversion with the standard library for all cases not covered by the fast paths
+	template <typename T>
+	const char* parse_exactly(const char* begin, const char* end, T& value, bool accept_out_of_range)
+	{
+		// std::from_chars does not accept a plus sign, which must not be followed by another sign
+		if (begin < end && *begin == '+') {
+			if (++begin < end && (*begin == '+' || *begin == '-'))
+				return 0;
+		}
+#if __cplusplus >= 201703L
+		std::from_chars_result r = std::from_chars(begin, end, value);
+		if (r.ec == std::errc())
+			return r.ptr;
+		if (r.ec != std::errc::result_out_of_range || !accept_out_of_range)
+			return 0;
+		end = r.ptr;
+#endif
+		std::string s(begin, end);
+		char* e;
+		T new_value;
+		errno = 0;
+		convert_exactly(s.c_str(), &e, new_value);
+		if (e == s.c_str() || (errno == ERANGE && !accept_out_of_range))
+			return 0;
+		value = new_value;
+		return begin + (e - s.c_str());
+	}
+
+	const char* parse_double_impl(const char* begin, const char* end, double& value, bool accept_out_of_range)
+	{
+		decimal_number d;
+		const char* p = scan_decimal(begin, end, d);
+		if (p && decimal_to_double(d, value))
+			return p;
+		// restrict standard library to the scanned number or to special values like inf and nan
+		return parse_exactly(begin, p ? p : std::min(end, begin + 64), value, accept_out_of_range);
+	}
+}
+
+const char* parse_double(const char* begin, const char* end, double& value)
+{
+	return parse_double_impl(begin, end, value, true);
+}
+
+const char* parse_float(const char* begin, const char* end, float& value)
+{
+	decimal_number d;
+	const char* p = scan_decimal(begin, end, d);
+	if (p && decimal_to_float(d, value))
+		return p;
+	return parse_exactly(begin, p ? p : std::min(end, begin + 64), value, true);
+}
+
+const char* parse_int(const char* begin, const char* end, int& value)
+{
+	const char* p = begin;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+		negative = *p++ == '-';
+	const char* digits_begin = p;
+	int64_t new_value = 0;
+	for (; p < end && is_digit(*p); ++p) {
+		new_value = 10 * new_value + (*p - '0');
+		if (new_value > int64_t(1) << 31)
+			return 0;
+	}
+	if (p == digits_begin || (!negative && new_value > 2147483647))
+		return 0;
+	value = int(negative ? -new_value : new_value);
+	return p;
+}
+
+namespace {
+	/// skip spaces, tabs and line breaks
+	inline const char* skip_whitespace(const char* p, const char* end)
+	{
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+			++p;
+		return p;
+	}
+	template <typename T>
+	size_t parse_numbers(const char* begin, const char* end, T* values, size_t n, const char** new_end, 
+		const char* (*parse)(const char*, const char*, T&))
+	{
+		size_t i = 0;
+		const char* p = skip_whitespace(begin, end);
+		for (; i < n; ++i) {
+			const char* q = parse(p, end, values[i]);
+			if (!q)
+				break;
+			p = skip_whitespace(q, end);
+		}
+		if (new_end)
+			*new_end = p;
+		return i;
+	}
+}
+
+size_t parse_floats(const char* begin, const char* end, float* values, size_t n, const char** new_end)
+{
+	return parse_numbers(begin, end, values, n, new_end, &parse_float);
+}
+
+size_t parse_doubles(const char* begin, const char* end, double* values, size_t n, const char** new_end)
+{
+	return parse_numbers(begin, end, values, n, new_end, &parse_double);
+}
+
+size_t parse_ints(const char* begin, const char* end, int* values, size_t n, const char** new_end)
+{
+	return parse_numbers(begin, end, values, n, new_end, &parse_int);
+}
+
 
 bool is_year(const char* begin, const char* end, unsigned short& year, bool short_allowed)
 {
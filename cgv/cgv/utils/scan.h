@@ -93,6 +93,22 @@ extern CGV_API bool is_integer(const std::string& s, int& value);
 extern CGV_API bool is_double(const char* begin, const char* end, double& value);
 /// check if the passed string defines a double value. If yes, store the value in the passed reference.
 extern CGV_API bool is_double(const std::string& s, double& value);
+/** parse a double value with optional sign, fraction and exponent starting at \c begin and return the pointer behind it
+    or 0 if no number starts at \c begin. The result is correctly rounded as with std::strtod, but values with up to
+	15 significant digits are converted without calling the standard library. */
+extern CGV_API const char* parse_double(const char* begin, const char* end, double& value);
+/// same as parse_double but correctly rounded to float
+extern CGV_API const char* parse_float(const char* begin, const char* end, float& value);
+/// parse an integer value with optional sign starting at \c begin and return the pointer behind it or 0 if no integer in the range of int starts at \c begin
+extern CGV_API const char* parse_int(const char* begin, const char* end, int& value);
+/** parse up to \c n whitespace separated floats from the text range [\c begin, \c end) and return the number of parsed
+    values. Parsing stops at the first text that is not a number. If \c new_end is given, it is set behind the last 
+	parsed value and its trailing whitespace. Used by the ascii readers that parse large files line by line or at once. */
+extern CGV_API size_t parse_floats(const char* begin, const char* end, float* values, size_t n, const char** new_end = 0);
+/// same as parse_floats for double values
+extern CGV_API size_t parse_doubles(const char* begin, const char* end, double* values, size_t n, const char** new_end = 0);
+/// same as parse_floats for int values
+extern CGV_API size_t parse_ints(const char* begin, const char* end, int* values, size_t n, const char** new_end = 0);
 /// check and extract year from string token [\c begin, \c end]
 extern CGV_API bool is_year(const char* begin, const char* end, unsigned short& year, bool short_allowed = true);
 /// check and extract year from string \c s
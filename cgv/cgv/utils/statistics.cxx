@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
 namespace cgv {
 	namespace utils {
@@ -76,5 +77,19 @@ std::ostream& operator << (std::ostream& os, const statistics& s)
 				 << "=" << s.get_average() << "+-" << s.get_standard_deviation() << ">";
 }
 
+double compute_percentile(std::vector<double>& values, double p)
+{
+	if (values.empty())
+		return 0;
+	double r = std::min(std::max(p, 0.0), 1.0) * (values.size() - 1);
+	size_t i = size_t(r);
+	std::nth_element(values.begin(), values.begin() + i, values.end());
+	double v = values[i];
+	if (i + 1 == values.size())
+		return v;
+	double w = *std::min_element(values.begin() + i + 1, values.end());
+	return v + (r - i) * (w - v);
+}
+
 	}
 }
\ No newline at end of file
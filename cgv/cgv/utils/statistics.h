@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <cmath>
+#include <vector>
 
 #include "lib_begin.h"
 
@@ -52,6 +53,9 @@ protected:
 
 extern CGV_API std::ostream& operator << (std::ostream& os, const statistics& s);
 
+/// return the p-th percentile with p in [0,1] of the given values by linear interpolation between closest ranks, which reorders the values; returns 0 for no values
+extern CGV_API double compute_percentile(std::vector<double>& values, double p);
+
 	}
 }
 
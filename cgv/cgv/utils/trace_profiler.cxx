@@ -0,0 +1,266 @@
+#include "trace_profiler.h"
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <map>
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+
+namespace cgv {
+	namespace utils {
+		namespace trace_profiler {
+
+			std::atomic<bool> recording_enabled(false);
+
+			namespace {
+				/// ring buffer written only by its thread
+				struct thread_buffer
+				{
+					std::vector<zone_event> events;
+					/// total number of recorded events
+					std::atomic<size_t> nr_written;
+					/// value of nr_written at the last call to clear()
+					std::atomic<size_t> nr_cleared;
+					uint32_t thread_index;
+					std::string name;
+					thread_buffer(size_t capacity, uint32_t _thread_index) : events(capacity), nr_written(0), nr_cleared(0), thread_index(_thread_index) {}
+				};
+				/// registry of all thread buffers, which are kept after their threads ended
+				struct registry
+				{
+					std::mutex mutex;
+					std::vector<std::unique_ptr<thread_buffer>> buffers;
+					size_t capacity = 65536;
+					std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				};
+				registry& ref_registry()
+				{
+					static registry r;
+					return r;
+				}
+				thread_local thread_buffer* current_buffer = 0;
+				thread_local uint32_t current_depth = 0;
+
+				thread_buffer& ref_buffer()
+				{
+					if (!current_buffer) {
+						registry& r = ref_registry();
+						std::lock_guard<std::mutex> guard(r.mutex);
+						r.buffers.push_back(std::unique_ptr<thread_buffer>(new thread_buffer(r.capacity, uint32_t(r.buffers.size()))));
+						current_buffer = r.buffers.back().get();
+					}
+					return *current_buffer;
+				}
+				/// range of valid events of a buffer
+				void get_range(const thread_buffer& b, size_t& first, size_t& last)
+				{
+					last = b.nr_written.load(std::memory_order_acquire);
+					first = b.nr_cleared.load(std::memory_order_relaxed);
+					if (last > b.events.size())
+						first = std::max(first, last - b.events.size());
+				}
+				void write_json_string(std::ostream& os, const char* s)
+				{
+					os << '"';
+					for (; *s; ++s) {
+						switch (*s) {
+						case '"': os << "\\\""; break;
+						case '\\': os << "\\\\"; break;
+						case '\n': os << "\\n"; break;
+						case '\t': os << "\\t"; break;
+						default:
+							if ((unsigned char)*s < 32)
+								os << ' ';
+							else
+								os << *s;
+						}
+					}
+					os << '"';
+				}
+				/// write nanoseconds as microseconds with three decimals as expected by the trace format
+				void write_microseconds(std::ostream& os, uint64_t ns)
+				{
+					uint64_t f = ns % 1000;
+					os << ns / 1000 << '.' << char('0' + f / 100) << char('0' + f / 10 % 10) << char('0' + f % 10);
+				}
+				/// writes the trace given in the environment variable CGV_TRACE at exit
+				struct environment_trace
+				{
+					std::string file_name;
+					environment_trace()
+					{
+						const char* fn = std::getenv("CGV_TRACE");
+						if (fn && *fn) {
+							file_name = fn;
+							ref_registry();
+							enable();
+						}
+					}
+					~environment_trace()
+					{
+						if (file_name.empty())
+							return;
+						enable(false);
+						if (!write_chrome_trace(file_name))
+							std::cerr << "could not write trace to " << file_name << std::endl;
+					}
+				};
+				environment_trace env_trace;
+			}
+
+			void enable(bool on)
+			{
+				if (on)
+					ref_registry();
+				recording_enabled.store(on, std::memory_order_relaxed);
+			}
+			void set_buffer_capacity(size_t nr_events)
+			{
+				registry& r = ref_registry();
+				std::lock_guard<std::mutex> guard(r.mutex);
+				r.capacity = std::max(nr_events, size_t(1));
+			}
+			uint64_t get_time()
+			{
+				return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - ref_registry().start).count());
+			}
+			void record(const zone_info* info, uint64_t begin, uint64_t end, uint32_t depth)
+			{
+				thread_buffer& b = ref_buffer();
+				size_t i = b.nr_written.load(std::memory_order_relaxed);
+				zone_event& e = b.events[i % b.events.size()];
+				e.info = info;
+				e.begin = begin;
+				e.end = end;
+				e.depth = depth;
+				e.thread_index = b.thread_index;
+				b.nr_written.store(i + 1, std::memory_order_release);
+			}
+			uint32_t& ref_depth()
+			{
+				return current_depth;
+			}
+			void set_thread_name(const std::string& name)
+			{
+				thread_buffer& b = ref_buffer();
+				std::lock_guard<std::mutex> guard(ref_registry().mutex);
+				b.name = name;
+			}
+			void collect_events(std::vector<zone_event>& events)
+			{
+				registry& r = ref_registry();
+				std::lock_guard<std::mutex> guard(r.mutex);
+				events.clear();
+				for (const auto& b : r.buffers) {
+					size_t first, last;
+					get_range(*b, first, last);
+					size_t offset = events.size();
+					for (size_t i = first; i < last; ++i)
+						events.push_back(b->events[i % b->events.size()]);
+					// order by begin and let enclosing zones precede nested zones starting at the same time
+					std::sort(events.begin() + offset, events.end(), [](const zone_event& e0, const zone_event& e1) {
+						return e0.begin < e1.begin || (e0.begin == e1.begin && e0.depth < e1.depth);
+					});
+				}
+			}
+			size_t get_nr_lost_events()
+			{
+				registry& r = ref_registry();
+				std::lock_guard<std::mutex> guard(r.mutex);
+				size_t nr_lost = 0;
+				for (const auto& b : r.buffers) {
+					size_t first, last;
+					get_range(*b, first, last);
+					nr_lost += first - b->nr_cleared.load(std::memory_order_relaxed);
+				}
+				return nr_lost;
+			}
+			void clear()
+			{
+				registry& r = ref_registry();
+				std::lock_guard<std::mutex> guard(r.mutex);
+				for (const auto& b : r.buffers)
+					b->nr_cleared.store(b->nr_written.load(std::memory_order_acquire), std::memory_order_relaxed);
+			}
+			void compute_statistics(std::vector<zone_statistic>& statistics)
+			{
+				std::vector<zone_event> events;
+				collect_events(events);
+				std::map<const zone_info*, zone_statistic> stats;
+				std::vector<const zone_event*> stack;
+				for (const auto& e : events) {
+					while (!stack.empty() && (stack.back()->thread_index != e.thread_index || stack.back()->end <= e.begin))
+						stack.pop_back();
+					double duration = 1e-9 * double(e.end - e.begin);
+					if (!stack.empty())
+						stats[stack.back()->info].self_time -= duration;
+					zone_statistic& s = stats[e.info];
+					s.info = e.info;
+					++s.nr_calls;
+					s.total_time += duration;
+					s.self_time += duration;
+					stack.push_back(&e);
+				}
+				statistics.clear();
+				for (const auto& s : stats)
+					statistics.push_back(s.second);
+				std::sort(statistics.begin(), statistics.end(), [](const zone_statistic& s0, const zone_statistic& s1) {
+					return s0.total_time > s1.total_time;
+				});
+			}
+			void print_statistics(std::ostream& os)
+			{
+				std::vector<zone_statistic> statistics;
+				compute_statistics(statistics);
+				for (const auto& s : statistics)
+					os << s.info->name << ": " << s.nr_calls << " calls, " << s.total_time << " sec, " << s.self_time << " sec self, "
+					   << s.total_time / s.nr_calls << " sec/call (mean)" << std::endl;
+			}
+			void write_chrome_trace(std::ostream& os)
+			{
+				std::vector<zone_event> events;
+				collect_events(events);
+				os << "{\"traceEvents\":[";
+				bool first = true;
+				{
+					registry& r = ref_registry();
+					std::lock_guard<std::mutex> guard(r.mutex);
+					for (const auto& b : r.buffers) {
+						if (!first)
+							os << ",";
+						first = false;
+						std::string name = b->name.empty() ? std::string("thread ") + std::to_string(b->thread_index) : b->name;
+						os << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->thread_index << ",\"args\":{\"name\":";
+						write_json_string(os, name.c_str());
+						os << "}}";
+					}
+				}
+				for (const auto& e : events) {
+					if (!first)
+						os << ",";
+					first = false;
+					os << "\n{\"name\":";
+					write_json_string(os, e.info->name);
+					os << ",\"cat\":\"cgv\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread_index
+					   << ",\"ts\":";
+					write_microseconds(os, e.begin);
+					os << ",\"dur\":";
+					write_microseconds(os, e.end - e.begin);
+					os << ",\"args\":{\"file\":";
+					write_json_string(os, e.info->file);
+					os << ",\"line\":" << e.info->line << ",\"depth\":" << e.depth << "}}";
+				}
+				os << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+			}
+			bool write_chrome_trace(const std::string& file_name)
+			{
+				std::ofstream os(file_name.c_str());
+				if (os.fail())
+					return false;
+				write_chrome_trace(os);
+				return !os.fail();
+			}
+		}
+	}
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace utils {
+		/** Hierarchical and thread aware instrumentation based on scoped zones.
+
+		    Zones are declared with the macros CGV_PROFILE_ZONE(name) and CGV_PROFILE_FUNCTION(), which place a static
+			 zone descriptor with the string literal name and source location in the enclosing function and time
+			 the remainder of the current scope. Completed zones are appended to a ring buffer owned by the calling
+			 thread without any locking, where the oldest events are overwritten once the buffer is full. Nesting
+			 follows from the time intervals and is additionally stored as depth per event.
+
+			 Recording is off by default, in which case a zone costs one relaxed atomic load. It is switched on with
+			 trace_profiler::enable() or by setting the environment variable CGV_TRACE to a file name, which makes
+			 the trace being written in Chrome trace event format when the process exits. The files can be opened
+			 with chrome://tracing or https://ui.perfetto.dev. Defining CGV_DISABLE_PROFILING removes all zones
+			 at compile time.
+
+			 Example:
+
+			 void process()
+			 {
+				 CGV_PROFILE_FUNCTION();
+				 for (auto& c : chunks) {
+					 CGV_PROFILE_ZONE("process chunk");
+					 ...
+				 }
+			 }
+			 ...
+			 cgv::utils::trace_profiler::enable();
+			 process();
+			 cgv::utils::trace_profiler::write_chrome_trace("trace.json");
+		*/
+		namespace trace_profiler {
+			/// static descriptor of a zone
+			struct zone_info
+			{
+				const char* name;
+				const char* file;
+				int line;
+			};
+			/// recorded zone
+			struct zone_event
+			{
+				const zone_info* info;
+				/// begin and end in nanoseconds since start of the profiler
+				uint64_t begin, end;
+				/// nesting depth within the recording thread
+				uint32_t depth;
+				/// index of the recording thread
+				uint32_t thread_index;
+			};
+			/// per zone statistics
+			struct zone_statistic
+			{
+				const zone_info* info;
+				size_t nr_calls;
+				/// total time and time not spent in nested zones of the same thread in seconds
+				double total_time, self_time;
+			};
+			/// flag checked by zones; use enable() to change it
+			extern CGV_API std::atomic<bool> recording_enabled;
+			/// check whether zones are recorded
+			inline bool is_enabled() { return recording_enabled.load(std::memory_order_relaxed); }
+			/// switch recording on or off
+			extern CGV_API void enable(bool on = true);
+			/// set the number of events per thread buffer, which applies to buffers of threads that record their first zone afterwards and defaults to 65536
+			extern CGV_API void set_buffer_capacity(size_t nr_events);
+			/// return current time in nanoseconds since start of the profiler
+			extern CGV_API uint64_t get_time();
+			/// append a completed zone to the buffer of the calling thread
+			extern CGV_API void record(const zone_info* info, uint64_t begin, uint64_t end, uint32_t depth);
+			/// return reference to nesting depth of the calling thread
+			extern CGV_API uint32_t& ref_depth();
+			/// set the name of the calling thread shown in the trace
+			extern CGV_API void set_thread_name(const std::string& name);
+			/// collect recorded events of all threads sorted by thread and begin time; should be called when no zones are recorded concurrently
+			extern CGV_API void collect_events(std::vector<zone_event>& events);
+			/// return the number of events lost due to overwritten ring buffer entries
+			extern CGV_API size_t get_nr_lost_events();
+			/// discard all recorded events
+			extern CGV_API void clear();
+			/// compute per zone statistics sorted by decreasing total time
+			extern CGV_API void compute_statistics(std::vector<zone_statistic>& statistics);
+			/// print statistics in one line per zone
+			extern CGV_API void print_statistics(std::ostream& os);
+			/// write recorded events in Chrome trace event format to stream
+			extern CGV_API void write_chrome_trace(std::ostream& os);
+			/// write recorded events in Chrome trace event format to file and return whether this succeeded
+			extern CGV_API bool write_chrome_trace(const std::string& file_name);
+
+			/// scope object timing a zone, which should be created through the macros
+			class scoped_zone
+			{
+				const zone_info* info;
+				uint64_t begin;
+			public:
+				scoped_zone(const zone_info* _info) : info(0)
+				{
+					if (!is_enabled())
+						return;
+					info = _info;
+					++ref_depth();
+					begin = get_time();
+				}
+				~scoped_zone()
+				{
+					if (!info)
+						return;
+					uint64_t end = get_time();
+					record(info, begin, end, --ref_depth());
+				}
+			};
+		}
+	}
+}
+
+#define CGV_PROFILE_CONCAT_IMPL(A,B) A##B
+#define CGV_PROFILE_CONCAT(A,B) CGV_PROFILE_CONCAT_IMPL(A,B)
+
+#ifdef CGV_DISABLE_PROFILING
+#define CGV_PROFILE_ZONE(NAME)
+#define CGV_PROFILE_FUNCTION()
+#else
+/// time the remainder of the enclosing scope as zone with given string literal name
+#define CGV_PROFILE_ZONE(NAME) \
+	static const cgv::utils::trace_profiler::zone_info CGV_PROFILE_CONCAT(cgv_profile_zone_info_,__LINE__) = { NAME, __FILE__, __LINE__ }; \
+	cgv::utils::trace_profiler::scoped_zone CGV_PROFILE_CONCAT(cgv_profile_zone_,__LINE__)(&CGV_PROFILE_CONCAT(cgv_profile_zone_info_,__LINE__))
+/// time the remainder of the enclosing scope as zone named after the enclosing function
+#define CGV_PROFILE_FUNCTION() CGV_PROFILE_ZONE(__func__)
+#endif
+
+#include <cgv/config/lib_end.h>
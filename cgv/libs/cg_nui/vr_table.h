@@ -137,6 +137,8 @@ public:
 	std::string get_type_name() const { return "vr_table"; }
 	/// reflect member variables
 	bool self_reflect(cgv::reflect::reflection_handler& rh);
+	/// all reflected members belong to the table, such that the reflection cache can be used
+	bool use_reflection_cache() const { return true; }
 	/// callback on member updates to keep data structure consistent
 	void on_set(void* member_ptr);
 	//@name cgv::nui::focusable interface
@@ -1,6 +1,10 @@
 #pragma once
 #include <memory>
 #include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <utility>
 
 #include "lib_begin.h"
 
@@ -89,14 +93,13 @@ template <typename T>
 			return *this;
 		}
 
-		//move assignment
+		//move assignment, the previous data is released by the destructor of source
 		array3d_t& operator=(array3d_t&& source) {
-			dim_x = source.dim_x;
-			dim_y = source.dim_y;
-			dim_z = source.dim_z;
-			dim_xy = source.dim_xy;
-			arr_data = source.arr_data;
-			source.arr_data = nullptr;
+			std::swap(dim_x, source.dim_x);
+			std::swap(dim_y, source.dim_y);
+			std::swap(dim_z, source.dim_z);
+			std::swap(dim_xy, source.dim_xy);
+			std::swap(arr_data, source.arr_data);
 			return *this;
 		}
 
@@ -162,7 +165,9 @@ public:
 	double xMin, xMax, yMin, yMax, zMin, zMax;
 	void build(double* x, double* y, double* z, int num);
 	template <typename T>
-	float distance(T _x, T _y, T _z);
+	float distance(T _x, T _y, T _z) const;
+	/// compute distances of n points given in structure of arrays layout, equivalent to calling distance for each point
+	void distances(const float* x, const float* y, const float* z, float* d, int n) const;
 protected:
 	static DEucl3D MINforwardDE3(Array3dDEucl3D& A, int z, int y, int x);
 	static DEucl3D MINforwardDE4(Array3dDEucl3D& A, int z, int y, int x);
@@ -172,20 +177,23 @@ protected:
 	static DEucl3D MINbackwardDE1(Array3dDEucl3D& A, int z, int y, int x);
 	static void DEuclidean(Array3dDEucl3D& A);
 private:
+	/// distances in cells of the grid used during build
 	Array3dDEucl3D A;
+	/// distances in units of the points stored compactly for lookups
+	Array3dfloat D;
 };
 
 
 //template functions
 template <typename T>
-inline float DT3D::distance(T _x, T _y, T _z)
+inline float DT3D::distance(T _x, T _y, T _z) const
 {
 	int x = round((_x - xMin)*scale);
 	int y = round((_y - yMin)*scale);
 	int z = round((_z - zMin)*scale);
 
 	if (x > -1 && x < size && y > -1 && y < size && z > -1 && z < size)
-		return A(x, y, z).distance;
+		return D(x, y, z);
 
 	float a = 0, b = 0, c = 0;
 	if (x < 0)
@@ -221,7 +229,7 @@ inline float DT3D::distance(T _x, T _y, T _z)
 		z = size - 1;
 	}
 
-	return sqrt(a*a + b * b + c * c) / scale + A(x, y, z).distance;
+	return sqrt(a*a + b * b + c * c) / scale + D(x, y, z);
 }
 
 #include <cgv/config/lib_end.h>
\ No newline at end of file
@@ -23,6 +23,10 @@ namespace cgv {
 			distance_transform_size = 200;
 			distance_transform_expand_factor = 2.0;
 			max_icp_iterations = 50;
+			nr_threads = 0;
+			pool_size = 0;
+			error_bound = 0;
+			nr_pending_nodes = 0;
 
 			init_rot_node.a = -PI;
 			init_rot_node.b = -PI;
@@ -65,7 +69,7 @@ namespace cgv {
 
 		void GoICP::buildKDTree()
 		{
-			neighbor_tree = make_shared<ann_tree>();
+			neighbor_tree = make_shared<kd_tree>();
 			neighbor_tree->build(*target_cloud);
 			
 		}
@@ -95,12 +99,19 @@ namespace cgv {
 
 			// calculate norm of each point in the source cloud to coordinate system origin
 			norm_data.resize(sample_size);
+			source_x.resize(sample_size);
+			source_y.resize(sample_size);
+			source_z.resize(sample_size);
 
 			for (int i = 0; i < sample_size; ++i)
 			{
 				norm_data[i] = source_cloud->pnt(i).length();
+				source_x[i] = source_cloud->pnt(i).x();
+				source_y[i] = source_cloud->pnt(i).y();
+				source_z[i] = source_cloud->pnt(i).z();
 			}
 
+			clear();
 			max_rot_dis = new float*[max_rot_level];
 			for (int i = 0; i < max_rot_level; i++)
 			{
@@ -115,8 +126,6 @@ namespace cgv {
 					max_rot_dis[i][j] = 2 * sin(max_angle / 2)*norm_data[j];
 			}
 
-			min_dis = vector<float>(sample_size);
-
 			// set parameters of ICP
 			icp_obj.set_source_cloud(*source_cloud);
 			icp_obj.eps = mse_threshhold / 1000.0;
@@ -167,9 +176,9 @@ namespace cgv {
 			if (max_rot_dis != nullptr){
 				for (int i = 0; i < max_rot_level; ++i)
 				{
-					delete(max_rot_dis[i]);
+					delete[] max_rot_dis[i];
 				}
-				delete(max_rot_dis);
+				delete[] max_rot_dis;
 				max_rot_dis = nullptr;
 			}
 		}
@@ -12,8 +12,12 @@ WIP
 #include <memory>
 #include "3ddt.h"
 #include "ICP.h"
-#include "ann_tree.h"
+#include "kd_tree.h"
+#include <cgv/os/task_scheduler.h>
 #include <queue>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
 
 #include "lib_begin.h"
 
@@ -48,16 +52,23 @@ namespace cgv {
 			}
 		};
 
+		/** Go-ICP registration finds the globally optimal rigid transformation by a branch and bound search over
+			the rotation space that for each rotation cube runs a nested branch and bound over the translation space.
+			The outer search runs as tasks of the cgv::os::task_scheduler. Each task expands the rotation cubes of its own priority
+			queue and steals the best cube of another queue when its own runs empty. All threads prune against one
+			best error bound that is shared as an atomic and only tightened, such that the result stays within
+			sse_threshhold of the global optimum independently of the number of threads. Distances of all source
+			samples are looked up in a single batch per translation cube. */
 		class CGV_API GoICP : public point_cloud_types {
 			typedef cgv::math::fvec<float, 3> vec3;
 			typedef cgv::math::fmat<float, 4, 4> mat4;
 			typedef cgv::math::fmat<float, 3, 3> mat3;
 		public:
 			/// supported methods for finding nearest neighbor correspondences outside icp. 
-			/// The used icp implementation currently only uses the ann_tree
+			/// The used icp implementation currently only uses the kd_tree
 			enum DistanceComputationMode {
 				DCM_DISTANCE_TRANSFORM = 0, // faster for large pointclouds, setup takes more time
-				DCM_ANN_TREE = 1, // higher precision ,slower distance computation, fast setup
+				DCM_ANN_TREE = 1, // kd_tree with higher precision ,slower distance computation, fast setup
 				DCM_NONE = -1
 			} dc_mode;
 
@@ -79,14 +90,40 @@ namespace cgv {
 				dc_mode = dcm;
 			}
 		protected:
+			/// per thread buffers of the branch and bound in structure of arrays layout
+			struct bnb_workspace {
+				/// rotated and translated source samples
+				std::vector<float> rx, ry, rz;
+				std::vector<float> tx, ty, tz;
+				std::vector<float> min_dis;
+				/// heap of translation nodes
+				std::vector<translation_node> trans_queue;
+			};
+			/// heap of rotation nodes owned by one thread that other threads may steal from
+			struct alignas(64) rotation_queue {
+				std::mutex mutex;
+				std::vector<rotation_node> heap;
+			};
 			template<GoICP::DistanceComputationMode DCM>
 			void outerBnB();
+			/// expand a rotation node and push surviving children to the queue of the given thread
 			template<GoICP::DistanceComputationMode DCM>
-			float innerBnB(float * max_rot_distance_list, translation_node * trans_node_out);
+			void expandRotationNode(const rotation_node& rot_node_parent, int thread_index);
+			template<GoICP::DistanceComputationMode DCM>
+			float innerBnB(bnb_workspace& ws, const float * max_rot_distance_list, translation_node * trans_node_out);
 			template<GoICP::DistanceComputationMode DCM>
 			float distance_to_target(const GoICP::Pnt & p);
+			/// compute ws.min_dis from the transformed samples ws.tx, ws.ty and ws.tz
+			template<GoICP::DistanceComputationMode DCM>
+			void distances_to_target(bnb_workspace& ws);
+			/// return sum of squared distances of the inliers among ws.min_dis
+			float trimmedError(bnb_workspace& ws);
 			template<GoICP::DistanceComputationMode DCM>
-			float icp(mat3 & R_icp, vec3 & t_icp);
+			float icp(bnb_workspace& ws, mat3 & R_icp, vec3 & t_icp);
+			/// lower the shared error bound to error and return whether it was improved
+			bool updateErrorBound(float error);
+			/// pop next node of the given queue or return false if it is empty or all its nodes can be pruned
+			bool popRotationNode(rotation_queue& queue, rotation_node& node);
 			// build the distance transform for the DCM_DISTANCE_TRANSFORM mode
 			void buildDistanceTransform();
 			// build the aproximate nearest neighbor tree for the DCM_ANN_TREE mode
@@ -94,23 +131,34 @@ namespace cgv {
 		private:
 			const point_cloud *source_cloud;
 			const point_cloud *target_cloud;
-			point_cloud temp_source_cloud;
 			int sample_size; // < source cloud size
+			/// source samples in structure of arrays layout
+			std::vector<float> source_x, source_y, source_z;
 
 			Mat rotation;
 			Dir translation;
 			std::vector<float> norm_data;
 			std::shared_ptr<DT3D> distance_transform;
 			ICP icp_obj;
-			std::shared_ptr<ann_tree> neighbor_tree; // alternative to distance transform
+			std::shared_ptr<kd_tree> neighbor_tree; // alternative to distance transform
 
 			float** max_rot_dis; //rotation uncertainity radius
-			std::vector<float> min_dis;
 			int inlier_num;
 
 			rotation_node init_rot_node, optimal_rot_node;
 			translation_node init_trans_node, optimal_trans_node;
 
+			/// best error found so far, used by all threads for pruning
+			std::atomic<float> error_bound;
+			/// number of rotation nodes that are queued or being expanded
+			std::atomic<int> nr_pending_nodes;
+			/// protects the optimal transformation, optimal_error and icp_obj, whose refinement is not reentrant
+			std::mutex optimum_mutex;
+			std::vector<bnb_workspace> workspaces;
+			std::unique_ptr<rotation_queue[]> rotation_queues;
+			/// number of tasks of the outer search, each owning one rotation queue
+			unsigned pool_size;
+
 		public:
 			mat3 optimal_rotation;
 			vec3 optimal_translation;
@@ -122,6 +170,8 @@ namespace cgv {
 			float distance_transform_expand_factor;
 			int max_icp_iterations;
 			bool do_trim;
+			/// number of threads including the calling one, 0 uses all hardware threads
+			unsigned nr_threads;
 		};
 
 		template<GoICP::DistanceComputationMode DCM>
@@ -130,25 +180,69 @@ namespace cgv {
 			switch (DCM) {
 			case DCM_DISTANCE_TRANSFORM:
 				return distance_transform->distance(p.x(), p.y(), p.z());
+			case DCM_ANN_TREE: {
+				Crd sqr_dist;
+				neighbor_tree->find_closest(p, &sqr_dist);
+				return std::sqrt(sqr_dist);
+			}
+			}
+		}
+
+		template<GoICP::DistanceComputationMode DCM>
+		inline void GoICP::distances_to_target(bnb_workspace& ws)
+		{
+			switch (DCM) {
+			case DCM_DISTANCE_TRANSFORM:
+				distance_transform->distances(ws.tx.data(), ws.ty.data(), ws.tz.data(), ws.min_dis.data(), sample_size);
+				break;
 			case DCM_ANN_TREE:
-				return (target_cloud->pnt(neighbor_tree->find_closest(p)) - p).length();
+				for (int i = 0; i < sample_size; ++i)
+					ws.min_dis[i] = distance_to_target<DCM>(Pnt(ws.tx[i], ws.ty[i], ws.tz[i]));
+				break;
 			}
 		}
 
+		inline float GoICP::trimmedError(bnb_workspace& ws)
+		{
+			// only the inlier_num smallest distances contribute, which does not require sorting them
+			if (do_trim && inlier_num < sample_size)
+				std::nth_element(ws.min_dis.begin(), ws.min_dis.begin() + inlier_num, ws.min_dis.end());
+			float error = 0;
+			for (int i = 0; i < inlier_num; ++i)
+				error += ws.min_dis[i] * ws.min_dis[i];
+			return error;
+		}
+
+		inline bool GoICP::updateErrorBound(float error)
+		{
+			float current = error_bound.load();
+			while (error < current)
+				if (error_bound.compare_exchange_weak(current, error))
+					return true;
+			return false;
+		}
+
 		template<GoICP::DistanceComputationMode DCM>
-		inline float GoICP::innerBnB(float * max_rot_distance_list, translation_node * trans_node_out)
+		inline float GoICP::innerBnB(bnb_workspace& ws, const float * max_rot_distance_list, translation_node * trans_node_out)
 		{
-			priority_queue<translation_node> tnodes;
+			std::vector<translation_node>& tnodes = ws.trans_queue;
+			tnodes.clear();
 
-			float opt_trans_err = optimal_error;
+			float opt_trans_err = error_bound.load(std::memory_order_relaxed);
 
-			tnodes.push(init_trans_node);
+			tnodes.push_back(init_trans_node);
 
 			while (!tnodes.empty())
 			{
-				translation_node trans_node_parent = tnodes.top(); tnodes.pop();
+				std::pop_heap(tnodes.begin(), tnodes.end());
+				translation_node trans_node_parent = tnodes.back(); tnodes.pop_back();
 				translation_node trans_node;
 
+				// bounding a rotation cube can also prune against errors found by other threads meanwhile,
+				// whereas searching an upper bound must only return errors of its own translations
+				if (!trans_node_out)
+					opt_trans_err = std::min(opt_trans_err, error_bound.load(std::memory_order_relaxed));
+
 				if (opt_trans_err - trans_node_parent.lb < sse_threshhold)
 				{
 					break;
@@ -163,34 +257,25 @@ namespace cgv {
 					trans_node.y = trans_node_parent.y + (j >> 1 & 1)*trans_node.w;
 					trans_node.z = trans_node_parent.z + (j >> 2 & 1)*trans_node.w;
 
-					vec3 trans = vec3(trans_node.x, trans_node.y, trans_node.z) + vec3(trans_node.w / 2);
-
+					float dx = trans_node.x + trans_node.w / 2, dy = trans_node.y + trans_node.w / 2, dz = trans_node.z + trans_node.w / 2;
 					for (int i = 0; i < sample_size; ++i)
 					{
-						min_dis[i] = distance_to_target<DCM>(temp_source_cloud.pnt(i) + trans);
-
-						if (max_rot_distance_list)
-							min_dis[i] -= max_rot_distance_list[i];
-
-						if (min_dis[i] < 0)
-						{
-							min_dis[i] = 0;
-						}
+						ws.tx[i] = ws.rx[i] + dx;
+						ws.ty[i] = ws.ry[i] + dy;
+						ws.tz[i] = ws.rz[i] + dz;
 					}
+					distances_to_target<DCM>(ws);
 
-					if (do_trim)
-					{
-						sort(min_dis.begin(), min_dis.end());
-					}
+					if (max_rot_distance_list)
+						for (int i = 0; i < sample_size; ++i)
+							ws.min_dis[i] = std::max(ws.min_dis[i] - max_rot_distance_list[i], 0.0f);
 
+					float upper_bound = trimmedError(ws);
 					float lower_bound = 0;
-					float upper_bound = 0;
 					for (int i = 0; i < inlier_num; ++i)
 					{
-						upper_bound += min_dis[i] * min_dis[i];
-						float dis = min_dis[i] - max_trans_dis;
-						if (dis > 0)
-							lower_bound += dis * dis;
+						float dis = std::max(ws.min_dis[i] - max_trans_dis, 0.0f);
+						lower_bound += dis * dis;
 					}
 
 					if (upper_bound < opt_trans_err)
@@ -207,7 +292,8 @@ namespace cgv {
 
 					trans_node.ub = upper_bound;
 					trans_node.lb = lower_bound;
-					tnodes.push(trans_node);
+					tnodes.push_back(trans_node);
+					std::push_heap(tnodes.begin(), tnodes.end());
 				}
 			}
 
@@ -215,101 +301,69 @@ namespace cgv {
 		}
 
 		template<GoICP::DistanceComputationMode DCM>
-		inline void GoICP::outerBnB()
+		inline void GoICP::expandRotationNode(const rotation_node& rot_node_parent, int thread_index)
 		{
 			static const double PI = 3.141592653589793238462643383279502884L;
-			float lower_bound, upper_bound, error, dis;
+			bnb_workspace& ws = workspaces[thread_index];
 			rotation_node rot_node;
 			translation_node trans_node;
-			priority_queue<rotation_node> rotation_queue;
-			optimal_error = 0;
 
-			for (int i = 0; i < source_cloud->get_nr_points(); i++)
-			{
-				min_dis[i] = distance_to_target<DCM>(source_cloud->pnt(i));
-			}
-			if (do_trim)
-			{
-				sort(min_dis.begin(), min_dis.end());
-			}
-			for (int i = 0; i < inlier_num; i++)
-			{
-				optimal_error += min_dis[i] * min_dis[i];
-			}
-
-			mat3 rot_icp = optimal_rotation;
-			vec3 trans_icp = optimal_translation;
+			rot_node.w = rot_node_parent.w / 2;
+			rot_node.l = rot_node_parent.l + 1;
 
-			// Run ICP
-			error = icp<DCM>(rot_icp, trans_icp);
-			if (error < optimal_error)
+			for (int j = 0; j < 8; ++j)
 			{
-				optimal_error = error;
-				optimal_rotation = rot_icp;
-				optimal_translation = trans_icp;
-			}
-
-			rotation_queue.push(init_rot_node);
-			//explore rotation space until convergence is achieved
+				mat3 R;
 
-			while (!rotation_queue.empty()) {
-				rotation_node rot_node_parent = rotation_queue.top();
-				rotation_queue.pop();
+				// calculate new first corner of the sub cube
+				rot_node.a = rot_node_parent.a + (j & 1)*rot_node.w;
+				rot_node.b = rot_node_parent.b + (j >> 1 & 1)*rot_node.w;
+				rot_node.c = rot_node_parent.c + (j >> 2 & 1)*rot_node.w;
 
-				if ((optimal_error - rot_node_parent.lb) <= sse_threshhold) break;
+				// max point of the sub cube
+				vec3 v = vec3(rot_node.a, rot_node.b, rot_node.c) + vec3(rot_node.w / 2);
 
-				rot_node.w = rot_node_parent.w / 2;
-				rot_node.l = rot_node_parent.l + 1;
+				float t = v.length();
+				// ignore subcubes outside the pi ball (rotations > 180 deg)
+				if (t - sqrt(3) * rot_node.w / 2 > PI) continue;
 
-				for (int j = 0; j < 8; ++j)
+				// build rotation matrix from axis angle representation
+				if (t > 0)
 				{
-					mat3 R;
-
-					// calculate new first corner of the sub cube
-					rot_node.a = rot_node_parent.a + (j & 1)*rot_node.w;
-					rot_node.b = rot_node_parent.b + (j >> 1 & 1)*rot_node.w;
-					rot_node.c = rot_node_parent.c + (j >> 2 & 1)*rot_node.w;
-
-					// max point of the sub cube
-					vec3 v = vec3(rot_node.a, rot_node.b, rot_node.c) + vec3(rot_node.w / 2);
-
-					float t = v.length();
-					// ignore subcubes outside the pi ball (rotations > 180 deg)
-					if (t - sqrt(3) * rot_node.w / 2 > PI) continue;
-
-					// build rotation matrix from axis angle representation
-					if (t > 0)
-					{
-						v /= t;
-
-						float c = cos(t);
-						float C = 1 - c;
-						float s = sin(t);
+					v /= t;
 
-						float xyC = v.x() * v.y()*C; float zs = v.z() * s;
-						float xzC = v.x() * v.z()*C; float ys = v.y() * s;
-						float yzC = v.y() * v.z()*C; float xs = v.x() * s;
+					float c = cos(t);
+					float C = 1 - c;
+					float s = sin(t);
 
-						R(0, 0) = c + v.x()*v.x()*C;	R(0, 1) = xyC - zs;			R(0, 2) = xzC + ys;
-						R(1, 0) = xyC + zs;			R(1, 1) = c + v.y()*v.y()*C;	R(1, 2) = yzC - xs;
-						R(2, 0) = xzC - ys;			R(2, 1) = yzC + xs;			R(2, 2) = c + v.z() * v.z()*C;
+					float xyC = v.x() * v.y()*C; float zs = v.z() * s;
+					float xzC = v.x() * v.z()*C; float ys = v.y() * s;
+					float yzC = v.y() * v.z()*C; float xs = v.x() * s;
 
-						temp_source_cloud.resize(sample_size);
+					R(0, 0) = c + v.x()*v.x()*C;	R(0, 1) = xyC - zs;			R(0, 2) = xzC + ys;
+					R(1, 0) = xyC + zs;			R(1, 1) = c + v.y()*v.y()*C;	R(1, 2) = yzC - xs;
+					R(2, 0) = xzC - ys;			R(2, 1) = yzC + xs;			R(2, 2) = c + v.z() * v.z()*C;
+				}
+				else
+					R.identity();
 
-						for (int i = 0; i < sample_size; i++)
-						{
-							const vec3& p = source_cloud->pnt(i);
-							temp_source_cloud.pnt(i) = R * p;
-						}
-					}
-					else
-					{
-						temp_source_cloud.clear();
-						temp_source_cloud.append(*source_cloud);
-					}
+				const float R00 = R(0, 0), R01 = R(0, 1), R02 = R(0, 2);
+				const float R10 = R(1, 0), R11 = R(1, 1), R12 = R(1, 2);
+				const float R20 = R(2, 0), R21 = R(2, 1), R22 = R(2, 2);
+				for (int i = 0; i < sample_size; i++)
+				{
+					float x = source_x[i], y = source_y[i], z = source_z[i];
+					ws.rx[i] = R00 * x + R01 * y + R02 * z;
+					ws.ry[i] = R10 * x + R11 * y + R12 * z;
+					ws.rz[i] = R20 * x + R21 * y + R22 * z;
+				}
 
-					upper_bound = innerBnB<DCM>(nullptr, &trans_node);
+				float upper_bound = innerBnB<DCM>(ws, nullptr, &trans_node);
 
+				if (updateErrorBound(upper_bound))
+				{
+					std::lock_guard<std::mutex> lock(optimum_mutex);
+					// another thread might have stored a better transformation since the bound was updated
 					if (upper_bound < optimal_error)
 					{
 						optimal_error = upper_bound;
@@ -324,76 +378,127 @@ namespace cgv {
 						// Run ICP
 						mat3 R_icp = optimal_rotation;
 						vec3 t_icp = optimal_translation;
-						error = icp<DCM>(R_icp, t_icp);
+						float error = icp<DCM>(ws, R_icp, t_icp);
 
 						if (error < optimal_error)
 						{
 							optimal_error = error;
 							optimal_rotation = R_icp;
 							optimal_translation = t_icp;
+							updateErrorBound(error);
 						}
-
-						priority_queue<rotation_node> new_rotation_queue;
-						while (!rotation_queue.empty())
-						{
-							rotation_node node = rotation_queue.top();
-							rotation_queue.pop();
-							if (node.lb < optimal_error)
-								new_rotation_queue.push(node);
-							else
-								break;
-						}
-						rotation_queue = new_rotation_queue;
 					}
+				}
 
-					lower_bound = innerBnB<DCM>(max_rot_dis[rot_node.l], nullptr);
+				float lower_bound = innerBnB<DCM>(ws, max_rot_dis[rot_node.l], nullptr);
 
-					if (lower_bound >= optimal_error)
-					{
-						continue;
-					}
-
-					rot_node.ub = upper_bound;
-					rot_node.lb = lower_bound;
-					rotation_queue.push(rot_node);
+				if (lower_bound >= error_bound.load())
+				{
+					continue;
 				}
+
+				rot_node.ub = upper_bound;
+				rot_node.lb = lower_bound;
+				rotation_queue& queue = rotation_queues[thread_index];
+				nr_pending_nodes.fetch_add(1);
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				queue.heap.push_back(rot_node);
+				std::push_heap(queue.heap.begin(), queue.heap.end());
 			}
+		}
 
+		inline bool GoICP::popRotationNode(rotation_queue& queue, rotation_node& node)
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.heap.empty())
+				return false;
+			// heap top has the smallest lower bound, so all nodes can be dropped once it converged
+			if (error_bound.load() - queue.heap.front().lb <= sse_threshhold) {
+				nr_pending_nodes.fetch_sub(int(queue.heap.size()));
+				queue.heap.clear();
+				return false;
+			}
+			std::pop_heap(queue.heap.begin(), queue.heap.end());
+			node = queue.heap.back();
+			queue.heap.pop_back();
+			return true;
 		}
 
 		template<GoICP::DistanceComputationMode DCM>
-		inline float GoICP::icp(mat3 & R_icp, vec3 & t_icp)
+		inline void GoICP::outerBnB()
 		{
-			icp_obj.reg_icp(R_icp, t_icp);
+			unsigned n = nr_threads > 0 ? nr_threads : cgv::os::task_scheduler::get().get_concurrency();
+			if (!rotation_queues || pool_size != n) {
+				rotation_queues = std::make_unique<rotation_queue[]>(n);
+				pool_size = n;
+			}
+			workspaces.resize(pool_size);
+			for (auto& ws : workspaces) {
+				ws.rx.resize(sample_size); ws.ry.resize(sample_size); ws.rz.resize(sample_size);
+				ws.tx.resize(sample_size); ws.ty.resize(sample_size); ws.tz.resize(sample_size);
+				ws.min_dis.resize(sample_size);
+			}
+			bnb_workspace& ws = workspaces[0];
 
-			// Transform the source point cloud and use the distance transform to determine the error
-			float error = 0;
-			for (int i = 0; i < source_cloud->get_nr_points(); i++)
-			{
-				const vec3& p = source_cloud->pnt(i);
-				vec3 t = R_icp * p + t_icp;
+			std::copy(source_x.begin(), source_x.end(), ws.tx.begin());
+			std::copy(source_y.begin(), source_y.end(), ws.ty.begin());
+			std::copy(source_z.begin(), source_z.end(), ws.tz.begin());
+			distances_to_target<DCM>(ws);
+			optimal_error = trimmedError(ws);
 
-				if (!do_trim)
-				{
-					float dis = distance_to_target<DCM>(t);
-					error += dis * dis;
-				}
-				else
-				{
-					min_dis[i] = distance_to_target<DCM>(t);
-				}
-			}
-			// do outlier elimination
-			if (do_trim)
+			mat3 rot_icp = optimal_rotation;
+			vec3 trans_icp = optimal_translation;
+
+			// Run ICP
+			float error = icp<DCM>(ws, rot_icp, trans_icp);
+			if (error < optimal_error)
 			{
-				sort(min_dis.begin(), min_dis.end());
+				optimal_error = error;
+				optimal_rotation = rot_icp;
+				optimal_translation = trans_icp;
+			}
+			error_bound = optimal_error;
 
-				for (int i = 0; i < inlier_num; i++)
-				{
-					error += min_dis[i] * min_dis[i];
+			//explore rotation space until convergence is achieved
+			for (unsigned i = 0; i < pool_size; ++i)
+				rotation_queues[i].heap.clear();
+			rotation_queues[0].heap.push_back(init_rot_node);
+			nr_pending_nodes = 1;
+			cgv::os::parallel_for(0, pool_size, [this](size_t thread_index, size_t) {
+				rotation_node node;
+				while (true) {
+					bool found = popRotationNode(rotation_queues[thread_index], node);
+					// steal from the other queues starting with the next one
+					for (unsigned i = 1; !found && i < pool_size; ++i)
+						found = popRotationNode(rotation_queues[(thread_index + i) % pool_size], node);
+					if (!found) {
+						if (nr_pending_nodes.load() == 0)
+							break;
+						std::this_thread::yield();
+						continue;
+					}
+					expandRotationNode<DCM>(node, int(thread_index));
+					nr_pending_nodes.fetch_sub(1);
 				}
+			}, 1, pool_size);
+		}
+
+		template<GoICP::DistanceComputationMode DCM>
+		inline float GoICP::icp(bnb_workspace& ws, mat3 & R_icp, vec3 & t_icp)
+		{
+			icp_obj.reg_icp(R_icp, t_icp);
+
+			// Transform the source point cloud and use the distance transform to determine the error
+			for (int i = 0; i < sample_size; i++)
+			{
+				vec3 t = R_icp * vec3(source_x[i], source_y[i], source_z[i]) + t_icp;
+				ws.tx[i] = t.x();
+				ws.ty[i] = t.y();
+				ws.tz[i] = t.z();
 			}
-			return error;
+			distances_to_target<DCM>(ws);
+			// do outlier elimination
+			return trimmedError(ws);
 		}
 	}
 }
@@ -3,6 +3,7 @@
 #include <random>
 #include <fstream>
 #include "ICP.h"
+#include <cgv/utils/trace_profiler.h>
 
 namespace cgv {
 	namespace pointcloud {
@@ -37,7 +38,7 @@ namespace cgv {
 				std::cerr << "ICP::build_ann_tree: source cloud missing, can't build ann tree\n";
 				return;
 			}
-			source_tree = std::make_shared<ann_tree>();
+			source_tree = std::make_shared<kd_tree>();
 			source_tree->build(*sourceCloud);
 		}
 
@@ -47,7 +48,7 @@ namespace cgv {
 				std::cerr << "ICP::build_ann_tree: target cloud missing, can't build ann tree\n";
 				return;
 			}
-			target_tree = std::make_shared<ann_tree>();
+			target_tree = std::make_shared<kd_tree>();
 			target_tree->build(*targetCloud);
 		}
 		void ICP::clear()
@@ -60,7 +61,7 @@ namespace cgv {
 			sourceCloud = &inputCloud;
 		}
 
-		void ICP::set_target_cloud(const point_cloud& inputCloud, std::shared_ptr<ann_tree> precomputed_tree)
+		void ICP::set_target_cloud(const point_cloud& inputCloud, std::shared_ptr<kd_tree> precomputed_tree)
 		{
 			targetCloud = &inputCloud;
 			if (precomputed_tree)
@@ -82,6 +83,7 @@ namespace cgv {
 		///output the rotation matrix and translation vector
 		void ICP::reg_icp(Mat& rotation_mat, Dir& translation_vec)
 		{
+			CGV_PROFILE_ZONE("ICP::reg_icp");
 			if (!target_tree) {
 				/// create the ann tree
 				//build_ann_tree();
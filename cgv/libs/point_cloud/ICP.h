@@ -2,7 +2,7 @@
 
 #include <vector>
 #include "point_cloud.h"
-#include "ann_tree.h"
+#include "kd_tree.h"
 #include <random>
 #include <ctime>
 #include <cgv/math/svd.h> 
@@ -28,8 +28,8 @@ namespace cgv {
 			float eps;
 			point_cloud* crspd_source;
 			point_cloud* crspd_target;
-			std::shared_ptr<ann_tree> source_tree;
-			std::shared_ptr<ann_tree> target_tree;
+			std::shared_ptr<kd_tree> source_tree;
+			std::shared_ptr<kd_tree> target_tree;
 
 
 			ICP();
@@ -38,7 +38,7 @@ namespace cgv {
 			void build_ann_tree();
 			void clear();
 			void set_source_cloud(const point_cloud& inputCloud);
-			void set_target_cloud(const point_cloud& inputCloud, std::shared_ptr<ann_tree> precomputed_tree = nullptr);
+			void set_target_cloud(const point_cloud& inputCloud, std::shared_ptr<kd_tree> precomputed_tree = nullptr);
 			void set_iterations(int Iter);
 			void set_num_random(int NR);
 			void set_eps(float e);
@@ -8,7 +8,7 @@
 #include <numeric>
 #include <algorithm>
 #include <cgv/math/det.h>
-#include "ann_tree.h"
+#include "kd_tree.h"
 #include "SICP.h"
 
 using namespace std;
@@ -10,6 +10,7 @@
 //#include <cgv/math/mat_block.h>
 #include "point_cloud.h"
 #include "normal_estimator.h"
+#include "kd_tree.h"
 #include "lib_begin.h"
 
 namespace cgv {
@@ -44,7 +45,7 @@ namespace cgv {
 
 			const point_cloud *sourceCloud;
 			const point_cloud *targetCloud;
-			ann_tree neighbor_tree;
+			kd_tree neighbor_tree;
 
 			SICP();
 			~SICP();
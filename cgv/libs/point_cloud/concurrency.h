@@ -202,7 +202,7 @@ class CGV_API SenseReversingBarrier
 
 				if (clear_task) {
 					// there should only be the thread who called run() in here
-					while (ptask->remaining.load(std::memory_order_relaxed) > 0) {
+					while (ptask->remaining.load(std::memory_order_acquire) > 0) {
 						std::this_thread::yield();
 					};
 					current_task = nullptr;
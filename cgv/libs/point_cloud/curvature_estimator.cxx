@@ -1,5 +1,5 @@
 #include "curvature_estimator.h"
-#include "ann_tree.h"
+#include "kd_tree.h"
 #include "neighbor_graph.h"
 #include "normal_estimator.h"
 #include "pca.h"
@@ -85,7 +85,7 @@ void curvature_estimator::compute_unsigned_principal_curvature(std::vector<princ
 	//curvature estimation for points with given normal
 	static constexpr int k = 15;
 	int num_points = pc.get_nr_points();
-	ann_tree neighborhood;
+	kd_tree neighborhood;
 	neighborhood.build(pc);
 	neighbor_graph graph;
 	graph.build(num_points, k, neighborhood);
@@ -131,7 +131,7 @@ void curvature_estimator::compute_principal_curvature(std::vector<principal_curv
 	//curvature estimation for points with given normal
 	static constexpr int k = 15;
 	int num_points = pc.get_nr_points();
-	ann_tree neighborhood;
+	kd_tree neighborhood;
 	neighborhood.build(pc);
 	neighbor_graph graph;
 	graph.build(num_points, k, neighborhood);
@@ -14,7 +14,7 @@ void feature_points_extractor::get_feature_points(const point_cloud& source_pc,
 {
 	std::vector<const Pnt*> knn;
 	std::vector<Idx> N;
-	ann_tree* tree = new ann_tree();
+	kd_tree* tree = new kd_tree();
 	tree->build(source_pc);
 	for (int i = 0; i < source_pc.get_nr_points(); ++i)
 	{
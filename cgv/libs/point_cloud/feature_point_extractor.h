@@ -2,7 +2,8 @@
 
 #include <vector>
 #include "point_cloud.h"
-#include "ann_tree.h"
+#include "kd_tree.h"
+#include <memory>
 #include <random>
 #include <ctime>
 #include <cgv/math/svd.h> 
@@ -19,6 +20,6 @@ class CGV_API feature_points_extractor : public point_cloud_types {
 			float get_nml_deviation(const Nml& a, const Nml& b);
 
 		private:
-			std::shared_ptr<ann_tree> tree;
+			std::shared_ptr<kd_tree> tree;
 };
 #include <cgv/config/lib_end.h>
@@ -0,0 +1,321 @@
+#include "icp_engine.h"
+#include <cgv/math/svd.h>
+#include <cgv/os/task_scheduler.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <chrono>
+#include <iostream>
+
+namespace cgv {
+	namespace pointcloud {
+
+		namespace {
+			/// offsets into accumulator sums shared by both metrics
+			const int SUM_COUNT = 29, SUM_SQR_RESIDUAL = 30, SUM_WEIGHT = 31;
+
+			/// return weight of residual for given kernel and threshold
+			inline icp_engine::Crd kernel_weight(icp_engine::RobustKernel kernel, icp_engine::Crd r, icp_engine::Crd k)
+			{
+				switch (kernel) {
+				case icp_engine::RK_HUBER:
+					return r <= k ? 1.0f : k / r;
+				case icp_engine::RK_TUKEY:
+					if (r >= k)
+						return 0.0f;
+					r /= k;
+					return (1 - r * r) * (1 - r * r);
+				default:
+					return 1.0f;
+				}
+			}
+		}
+
+		icp_engine::icp_engine() : source_cloud(0), target_cloud(0), pool_size(0)
+		{
+			parameters.metric = EM_POINT_TO_POINT;
+			parameters.kernel = RK_NONE;
+			parameters.kernel_threshold = 0;
+			parameters.max_correspondence_distance = 0;
+			parameters.nr_samples = 0;
+			parameters.max_iterations = 50;
+			parameters.min_rotation_change = 1e-5f;
+			parameters.min_translation_change = 1e-6f;
+			parameters.min_relative_error_change = 1e-6f;
+			parameters.nr_threads = 0;
+			statistics = Statistics();
+		}
+
+		icp_engine::~icp_engine()
+		{
+		}
+
+		void icp_engine::set_source_cloud(const point_cloud& cloud)
+		{
+			source_cloud = &cloud;
+		}
+
+		void icp_engine::set_target_cloud(const point_cloud& cloud)
+		{
+			target_cloud = &cloud;
+			target_tree.build(cloud);
+		}
+
+		template <typename F>
+		void icp_engine::run_parallel(F f)
+		{
+			size_t n = samples.size();
+			cgv::os::parallel_for(0, pool_size, [&](size_t thread_index, size_t) {
+				f(n * thread_index / pool_size, n * (thread_index + 1) / pool_size, int(thread_index));
+			}, 1, pool_size);
+		}
+
+		void icp_engine::find_correspondences(const Mat& R, const Dir& t)
+		{
+			bool point_to_plane = parameters.metric == EM_POINT_TO_PLANE;
+			Crd max_sqr_dist = parameters.max_correspondence_distance > 0 ?
+				parameters.max_correspondence_distance * parameters.max_correspondence_distance : std::numeric_limits<Crd>::max();
+			correspondence_buffers& B = buffers;
+			run_parallel([&](size_t begin, size_t end, int) {
+				for (size_t i = begin; i < end; ++i) {
+					Pnt p = R * source_cloud->pnt(samples[i]) + t;
+					Crd sqr_dist;
+					Idx j = target_tree.find_closest(p, &sqr_dist);
+					const Pnt& q = target_cloud->pnt(j);
+					B.px[i] = p[0]; B.py[i] = p[1]; B.pz[i] = p[2];
+					B.qx[i] = q[0]; B.qy[i] = q[1]; B.qz[i] = q[2];
+					if (point_to_plane) {
+						const Nml& nml = target_cloud->nml(j);
+						B.nx[i] = nml[0]; B.ny[i] = nml[1]; B.nz[i] = nml[2];
+					}
+					// rejected correspondences are marked with negative residual
+					if (sqr_dist > max_sqr_dist)
+						B.residual[i] = -1;
+					else if (point_to_plane)
+						B.residual[i] = std::abs(B.nx[i] * (p[0] - B.qx[i]) + B.ny[i] * (p[1] - B.qy[i]) + B.nz[i] * (p[2] - B.qz[i]));
+					else
+						B.residual[i] = std::sqrt(sqr_dist);
+				}
+			});
+		}
+
+		icp_engine::Crd icp_engine::compute_kernel_threshold()
+		{
+			if (parameters.kernel == RK_NONE || parameters.kernel_threshold > 0)
+				return parameters.kernel_threshold;
+			// robust scale estimate from median absolute residual scaled by the usual tuning constants
+			std::vector<Crd>& R = buffers.sorted_residual;
+			R.clear();
+			for (Crd r : buffers.residual)
+				if (r >= 0)
+					R.push_back(r);
+			if (R.empty())
+				return 0;
+			std::nth_element(R.begin(), R.begin() + R.size() / 2, R.end());
+			Crd sigma = 1.4826f * std::max(R[R.size() / 2], Crd(1e-7f));
+			return (parameters.kernel == RK_HUBER ? 1.345f : 4.685f) * sigma;
+		}
+
+		void icp_engine::accumulate(Crd k, accumulator& total)
+		{
+			bool point_to_plane = parameters.metric == EM_POINT_TO_PLANE;
+			RobustKernel kernel = parameters.kernel;
+			correspondence_buffers& B = buffers;
+			run_parallel([&](size_t begin, size_t end, int thread_index) {
+				double* S = accumulators[thread_index].sum;
+				std::fill(S, S + 32, 0.0);
+				for (size_t i = begin; i < end; ++i) {
+					Crd r = B.residual[i];
+					if (r < 0) {
+						B.weight[i] = 0;
+						continue;
+					}
+					double w = B.weight[i] = kernel_weight(kernel, r, k);
+					S[SUM_COUNT] += 1;
+					S[SUM_SQR_RESIDUAL] += r * r;
+					S[SUM_WEIGHT] += w;
+					if (w == 0)
+						continue;
+					if (point_to_plane) {
+						// linearized rotation yields rows a = (p x n, n) and right hand side b = n.(q-p)
+						double px = B.px[i], py = B.py[i], pz = B.pz[i];
+						double nx = B.nx[i], ny = B.ny[i], nz = B.nz[i];
+						double a[6] = { py * nz - pz * ny, pz * nx - px * nz, px * ny - py * nx, nx, ny, nz };
+						double b = nx * (B.qx[i] - px) + ny * (B.qy[i] - py) + nz * (B.qz[i] - pz);
+						int l = 0;
+						for (int u = 0; u < 6; ++u) {
+							double wa = w * a[u];
+							for (int v = u; v < 6; ++v)
+								S[l++] += wa * a[v];
+							S[21 + u] += wa * b;
+						}
+					}
+					else {
+						double p[3] = { B.px[i], B.py[i], B.pz[i] }, q[3] = { B.qx[i], B.qy[i], B.qz[i] };
+						for (int u = 0; u < 3; ++u) {
+							S[1 + u] += w * p[u];
+							S[4 + u] += w * q[u];
+							for (int v = 0; v < 3; ++v)
+								S[7 + 3 * u + v] += w * p[u] * q[v];
+						}
+					}
+				}
+			});
+			std::fill(total.sum, total.sum + 32, 0.0);
+			for (const auto& a : accumulators)
+				for (int i = 0; i < 32; ++i)
+					total.sum[i] += a.sum[i];
+			if (!point_to_plane)
+				total.sum[0] = total.sum[SUM_WEIGHT];
+		}
+
+		bool icp_engine::solve_point_to_point(const accumulator& total, Mat& R, Dir& t)
+		{
+			const double* S = total.sum;
+			double W = S[0];
+			if (W <= 0)
+				return false;
+			double p_mean[3], q_mean[3];
+			for (int u = 0; u < 3; ++u) {
+				p_mean[u] = S[1 + u] / W;
+				q_mean[u] = S[4 + u] / W;
+			}
+			// cross covariance of centered points H = U Sigma V^T gives R = V diag(1,1,det(VU^T)) U^T
+			cgv::math::mat<double> H(3, 3), U, V;
+			cgv::math::diag_mat<double> Sigma;
+			for (int u = 0; u < 3; ++u)
+				for (int v = 0; v < 3; ++v)
+					H(u, v) = S[7 + 3 * u + v] - W * p_mean[u] * q_mean[v];
+			if (!cgv::math::svd(H, U, Sigma, V))
+				return false;
+			double det = cgv::math::det(V * cgv::math::transpose(U));
+			for (int u = 0; u < 3; ++u)
+				for (int v = 0; v < 3; ++v)
+					R(u, v) = Crd(V(u, 0) * U(v, 0) + V(u, 1) * U(v, 1) + (det < 0 ? -1 : 1) * V(u, 2) * U(v, 2));
+			for (int u = 0; u < 3; ++u)
+				t[u] = Crd(q_mean[u] - (R(u, 0) * p_mean[0] + R(u, 1) * p_mean[1] + R(u, 2) * p_mean[2]));
+			return true;
+		}
+
+		bool icp_engine::solve_point_to_plane(const accumulator& total, Mat& R, Dir& t)
+		{
+			// LDL^T factorization of the symmetric 6x6 normal equations stored as upper triangle
+			const double* S = total.sum;
+			double A[6][6], x[6], max_diag = 0;
+			int l = 0;
+			for (int u = 0; u < 6; ++u)
+				for (int v = u; v < 6; ++v)
+					A[u][v] = A[v][u] = S[l++];
+			for (int u = 0; u < 6; ++u)
+				max_diag = std::max(max_diag, A[u][u]);
+			if (max_diag <= 0)
+				return false;
+			for (int j = 0; j < 6; ++j) {
+				for (int k = 0; k < j; ++k)
+					A[j][j] -= A[j][k] * A[j][k] * A[k][k];
+				if (A[j][j] <= 1e-12 * max_diag)
+					return false;
+				for (int i = j + 1; i < 6; ++i) {
+					for (int k = 0; k < j; ++k)
+						A[i][j] -= A[i][k] * A[j][k] * A[k][k];
+					A[i][j] /= A[j][j];
+				}
+			}
+			for (int i = 0; i < 6; ++i) {
+				x[i] = S[21 + i];
+				for (int k = 0; k < i; ++k)
+					x[i] -= A[i][k] * x[k];
+			}
+			for (int i = 5; i >= 0; --i) {
+				x[i] /= A[i][i];
+				for (int k = i + 1; k < 6; ++k)
+					x[i] -= A[k][i] * x[k];
+			}
+			// rotation vector to rotation matrix after Rodrigues
+			double angle = std::sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
+			R.identity();
+			if (angle > 0) {
+				double a[3] = { x[0] / angle, x[1] / angle, x[2] / angle }, c = std::cos(angle), s = std::sin(angle);
+				for (int u = 0; u < 3; ++u)
+					for (int v = 0; v < 3; ++v)
+						R(u, v) = Crd((1 - c) * a[u] * a[v] + (u == v ? c : 0));
+				R(0, 1) -= Crd(s * a[2]); R(1, 0) += Crd(s * a[2]);
+				R(0, 2) += Crd(s * a[1]); R(2, 0) -= Crd(s * a[1]);
+				R(1, 2) -= Crd(s * a[0]); R(2, 1) += Crd(s * a[0]);
+			}
+			t = Dir(Crd(x[3]), Crd(x[4]), Crd(x[5]));
+			return true;
+		}
+
+		bool icp_engine::align(Mat& rotation, Dir& translation)
+		{
+			statistics = Statistics();
+			if (!(source_cloud && target_cloud) || source_cloud->get_nr_points() == 0 || target_tree.is_empty() || target_tree.get_nr_points() == 0) {
+				std::cerr << "icp_engine::align: source or target cloud not set!\n";
+				return false;
+			}
+			bool point_to_plane = parameters.metric == EM_POINT_TO_PLANE;
+			if (point_to_plane && !target_cloud->has_normals()) {
+				std::cerr << "icp_engine::align: point to plane metric needs target normals!\n";
+				return false;
+			}
+			unsigned nr_threads = parameters.nr_threads;
+			if (nr_threads == 0)
+				nr_threads = cgv::os::task_scheduler::get().get_concurrency();
+			pool_size = nr_threads;
+			accumulators.resize(pool_size);
+
+			// choose samples once per alignment with fixed seed and sort them for memory locality
+			Cnt n = source_cloud->get_nr_points();
+			samples.resize(n);
+			std::iota(samples.begin(), samples.end(), 0);
+			if (parameters.nr_samples > 0 && parameters.nr_samples < n) {
+				std::default_random_engine rng(n);
+				for (Cnt i = 0; i < parameters.nr_samples; ++i)
+					std::swap(samples[i], samples[std::uniform_int_distribution<Cnt>(i, n - 1)(rng)]);
+				samples.resize(parameters.nr_samples);
+				std::sort(samples.begin(), samples.end());
+			}
+			size_t m = samples.size(), m_normals = point_to_plane ? m : 0;
+			buffers.px.resize(m); buffers.py.resize(m); buffers.pz.resize(m);
+			buffers.qx.resize(m); buffers.qy.resize(m); buffers.qz.resize(m);
+			buffers.nx.resize(m_normals); buffers.ny.resize(m_normals); buffers.nz.resize(m_normals);
+			buffers.residual.resize(m);
+			buffers.weight.resize(m);
+			buffers.sorted_residual.reserve(m);
+
+			auto start = std::chrono::steady_clock::now();
+			double last_error = -1;
+			accumulator total;
+			for (int iter = 0; iter < parameters.max_iterations; ++iter) {
+				find_correspondences(rotation, translation);
+				Crd k = compute_kernel_threshold();
+				accumulate(k, total);
+				++statistics.nr_iterations;
+				statistics.nr_correspondences = Cnt(total.sum[SUM_COUNT]);
+				if (statistics.nr_correspondences == 0)
+					return false;
+				double error = total.sum[SUM_SQR_RESIDUAL] / total.sum[SUM_COUNT];
+				statistics.rms_error = Crd(std::sqrt(error));
+				Mat R;
+				Dir t;
+				if (!(point_to_plane ? solve_point_to_plane(total, R, t) : solve_point_to_point(total, R, t)))
+					return false;
+				rotation = R * rotation;
+				translation = R * translation + t;
+				// stop on small update or small relative change of error
+				double sin_angle = 0.5 * Dir(R(2, 1) - R(1, 2), R(0, 2) - R(2, 0), R(1, 0) - R(0, 1)).length();
+				double angle = std::atan2(sin_angle, 0.5 * (double(R(0, 0) + R(1, 1) + R(2, 2)) - 1));
+				bool small_update = angle < parameters.min_rotation_change && t.length() < parameters.min_translation_change;
+				bool small_error_change = last_error >= 0 && std::abs(last_error - error) <= parameters.min_relative_error_change * std::max(error, 1e-30);
+				last_error = error;
+				if (small_update || small_error_change) {
+					statistics.converged = true;
+					break;
+				}
+			}
+			statistics.ms_per_iteration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / statistics.nr_iterations;
+			return true;
+		}
+	}
+}
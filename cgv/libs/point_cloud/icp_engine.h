@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include "point_cloud.h"
+#include "kd_tree.h"
+
+#include "lib_begin.h"
+
+namespace cgv {
+
+	namespace pointcloud {
+
+		/** parallel iterative closest point registration of a source cloud to a target cloud. The closest point
+			queries and the accumulation of the normal equations are distributed over the cgv::os::task_scheduler. All
+			per iteration data lives in structure of arrays correspondence buffers and per thread accumulators that
+			are allocated once per alignment, such that iterations do not allocate. The engine supports point to
+			point and point to plane metrics, whose correspondences can be weighted with Huber or Tukey kernels, and
+			stops early if the transformation update or the relative change of the error become small.
+			Closest points are found in a kd_tree over the target positions, which can be queried concurrently. */
+		class CGV_API icp_engine : public point_cloud_types
+		{
+		public:
+			/// error metric minimized per iteration
+			enum ErrorMetric {
+				EM_POINT_TO_POINT = 0,
+				EM_POINT_TO_PLANE = 1 /// needs target normals
+			};
+			/// robust kernel used to weight correspondences by their residual
+			enum RobustKernel {
+				RK_NONE = 0,
+				RK_HUBER = 1,
+				RK_TUKEY = 2
+			};
+			struct Parameters {
+				ErrorMetric metric;
+				RobustKernel kernel;
+				/// kernel threshold in units of distance, 0 estimates it per iteration from the median absolute residual
+				float kernel_threshold;
+				/// correspondences with larger distance are rejected, 0 accepts all
+				float max_correspondence_distance;
+				/// number of randomly chosen source points, 0 uses all points
+				Cnt nr_samples;
+				int max_iterations;
+				/// stop if rotation angle in radians and translation length of an update are both below these
+				float min_rotation_change;
+				float min_translation_change;
+				/// stop if the relative change of the mean squared residual is below this
+				float min_relative_error_change;
+				/// number of threads including the calling one, 0 uses all hardware threads
+				unsigned nr_threads;
+			} parameters;
+
+			struct Statistics {
+				int nr_iterations;
+				/// number of accepted correspondences in last iteration
+				Cnt nr_correspondences;
+				/// root mean squared residual of accepted correspondences in last iteration
+				float rms_error;
+				/// whether iteration stopped before reaching max_iterations
+				bool converged;
+				/// average time per iteration in milliseconds
+				double ms_per_iteration;
+			};
+		protected:
+			const point_cloud* source_cloud;
+			const point_cloud* target_cloud;
+			Statistics statistics;
+
+			/// search tree over the target positions
+			kd_tree target_tree;
+
+			/// indices of source samples
+			std::vector<Idx> samples;
+			/// structure of arrays correspondence buffers
+			struct correspondence_buffers {
+				std::vector<Crd> px, py, pz;
+				std::vector<Crd> qx, qy, qz;
+				std::vector<Crd> nx, ny, nz;
+				std::vector<Crd> residual;
+				std::vector<Crd> weight;
+				/// scratch buffer used to estimate kernel thresholds
+				std::vector<Crd> sorted_residual;
+			} buffers;
+			/// per thread sums of normal equations padded to separate cache lines
+			struct alignas(64) accumulator {
+				double sum[32];
+			};
+			std::vector<accumulator> accumulators;
+
+			/// number of parts of the samples, one per thread
+			unsigned pool_size;
+			/// call f(begin, end, thread index) for each thread on its part of the samples
+			template <typename F>
+			void run_parallel(F f);
+			/// find closest points and residuals for the current transformation
+			void find_correspondences(const Mat& rotation, const Dir& translation);
+			/// return kernel threshold to be used in current iteration
+			Crd compute_kernel_threshold();
+			/// compute weights and accumulate normal equations, return weighted sums in reduced accumulator
+			void accumulate(Crd kernel_threshold, accumulator& total);
+			/// compute update from reduced point to point sums
+			static bool solve_point_to_point(const accumulator& total, Mat& rotation, Dir& translation);
+			/// compute update from reduced point to plane normal equations
+			static bool solve_point_to_plane(const accumulator& total, Mat& rotation, Dir& translation);
+		public:
+			/// construct with default parameters
+			icp_engine();
+			~icp_engine();
+			/// set the source cloud that is moved onto the target
+			void set_source_cloud(const point_cloud& cloud);
+			/// set the target cloud and build the search tree
+			void set_target_cloud(const point_cloud& cloud);
+			//! align source to target
+			/*! rotation and translation hold the initial guess on input and the transformation mapping source to target
+				points on output. Returns false if clouds are missing, if point to plane is requested without target
+				normals or if the problem is degenerate. */
+			bool align(Mat& rotation, Dir& translation);
+			/// return statistics of last alignment
+			const Statistics& get_statistics() const { return statistics; }
+		};
+	}
+}
+
+#include <cgv/config/lib_end.h>
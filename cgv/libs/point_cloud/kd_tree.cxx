@@ -0,0 +1,299 @@
+#include "kd_tree.h"
+#include <cgv/os/task_scheduler.h>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <atomic>
+#include <cgv/utils/trace_profiler.h>
+
+namespace {
+	typedef kd_tree::Cnt Cnt;
+	typedef kd_tree::Crd Crd;
+	typedef kd_tree::Idx Idx;
+
+	/// number of query points processed as one unit of work
+	const Cnt block_size = 1024;
+
+	/// call f(begin, end, block_index) for blocks of n queries distributed dynamically over the tasks of the shared scheduler
+	template <typename F>
+	void for_each_block(Cnt n, unsigned nr_threads, F f)
+	{
+		cgv::os::parallel_for(0, n, [&](size_t begin, size_t end) {
+			f(Cnt(begin), Cnt(end), Cnt(begin / block_size));
+		}, block_size, nr_threads);
+	}
+}
+
+kd_tree::kd_tree() : pc(0)
+{
+}
+
+void kd_tree::clear()
+{
+	nodes.clear();
+	x.clear();
+	y.clear();
+	z.clear();
+	point_indices.clear();
+	pc = 0;
+}
+
+bool kd_tree::is_empty() const
+{
+	return pc == 0;
+}
+
+void kd_tree::build(const point_cloud& _pc)
+{
+	CGV_PROFILE_ZONE("kd_tree::build");
+	clear();
+	pc = &_pc;
+	point_indices.resize(pc->get_nr_points());
+	std::iota(point_indices.begin(), point_indices.end(), 0);
+	build_tree();
+}
+
+void kd_tree::build(const point_cloud& _pc, const std::vector<Idx>& component_indices)
+{
+	CGV_PROFILE_ZONE("kd_tree::build");
+	clear();
+	pc = &_pc;
+	for (Idx ci : component_indices) {
+		Idx pi_begin = Idx(pc->component_point_range(ci).index_of_first_point);
+		Idx pi_end = pi_begin + Idx(pc->component_point_range(ci).nr_points);
+		for (Idx pi = pi_begin; pi < pi_end; ++pi)
+			point_indices.push_back(pi);
+	}
+	build_tree();
+}
+
+void kd_tree::build_tree()
+{
+	Cnt n = Cnt(point_indices.size());
+	nodes.reserve(2 * (n / bucket_size + 1));
+	if (n > 0)
+		build_node(0, n);
+	x.resize(n);
+	y.resize(n);
+	z.resize(n);
+	for (Cnt j = 0; j < n; ++j) {
+		const Pnt& p = pc->pnt(point_indices[j]);
+		x[j] = p[0];
+		y[j] = p[1];
+		z[j] = p[2];
+	}
+}
+
+kd_tree::Cnt kd_tree::build_node(Cnt begin, Cnt end)
+{
+	Cnt ni = Cnt(nodes.size());
+	nodes.push_back(node());
+	nodes[ni].begin = begin;
+	nodes[ni].end = end;
+	nodes[ni].axis = -1;
+	if (end - begin <= bucket_size)
+		return ni;
+	// split at median along the axis of largest extent
+	Box box;
+	for (Cnt j = begin; j < end; ++j)
+		box.add_point(pc->pnt(point_indices[j]));
+	int axis = (int)cgv::math::max_index(box.get_extent());
+	Cnt mid = (begin + end) / 2;
+	std::nth_element(point_indices.begin() + begin, point_indices.begin() + mid, point_indices.begin() + end, [this, axis](Idx i, Idx j) {
+		return pc->pnt(i)[axis] < pc->pnt(j)[axis];
+	});
+	nodes[ni].axis = axis;
+	nodes[ni].split = pc->pnt(point_indices[mid])[axis];
+	Cnt left = build_node(begin, mid);
+	Cnt right = build_node(mid, end);
+	nodes[ni].left = left;
+	nodes[ni].right = right;
+	return ni;
+}
+
+kd_tree::Cnt kd_tree::search_k_nearest(Crd qx, Crd qy, Crd qz, Cnt k, Idx* indices, Crd* sqr_dists) const
+{
+	if (nodes.empty() || k == 0)
+		return 0;
+	const Crd q[3] = { qx, qy, qz };
+	Cnt nr_found = 0;
+	Crd max_sqr_dist = std::numeric_limits<Crd>::max();
+	// stack of postponed far children together with squared distance to their splitting plane
+	Cnt stack[64];
+	Crd stack_dist[64];
+	int sp = 0;
+	stack[sp] = 0;
+	stack_dist[sp++] = 0;
+	while (sp > 0) {
+		--sp;
+		if (stack_dist[sp] >= max_sqr_dist)
+			continue;
+		const node* nd = &nodes[stack[sp]];
+		while (nd->axis >= 0) {
+			Crd diff = q[nd->axis] - nd->split;
+			stack[sp] = diff < 0 ? nd->right : nd->left;
+			stack_dist[sp++] = diff * diff;
+			nd = &nodes[diff < 0 ? nd->left : nd->right];
+		}
+		for (Cnt j = nd->begin; j < nd->end; ++j) {
+			Crd dx = x[j] - qx, dy = y[j] - qy, dz = z[j] - qz;
+			Crd d = dx * dx + dy * dy + dz * dz;
+			if (d >= max_sqr_dist)
+				continue;
+			// insert into sorted arrays
+			Cnt l = nr_found < k ? nr_found++ : k - 1;
+			while (l > 0 && sqr_dists[l - 1] > d) {
+				sqr_dists[l] = sqr_dists[l - 1];
+				indices[l] = indices[l - 1];
+				--l;
+			}
+			sqr_dists[l] = d;
+			indices[l] = point_indices[j];
+			if (nr_found == k)
+				max_sqr_dist = sqr_dists[k - 1];
+		}
+	}
+	return nr_found;
+}
+
+kd_tree::Idx kd_tree::find_closest(const Pnt& p, Crd* sqr_dist) const
+{
+	Idx i = -1;
+	Crd d = std::numeric_limits<Crd>::max();
+	search_k_nearest(p[0], p[1], p[2], 1, &i, &d);
+	if (sqr_dist)
+		*sqr_dist = d;
+	return i;
+}
+
+kd_tree::Cnt kd_tree::find_k_nearest(const Pnt& p, Cnt k, Idx* indices, Crd* sqr_dists) const
+{
+	if (sqr_dists)
+		return search_k_nearest(p[0], p[1], p[2], k, indices, sqr_dists);
+	std::vector<Crd> D(k);
+	return search_k_nearest(p[0], p[1], p[2], k, indices, D.data());
+}
+
+kd_tree::Cnt kd_tree::find_within_radius(const Pnt& p, Crd radius, std::vector<Idx>& indices, std::vector<Crd>* sqr_dists) const
+{
+	indices.clear();
+	if (sqr_dists)
+		sqr_dists->clear();
+	if (nodes.empty())
+		return 0;
+	Crd r2 = radius * radius;
+	Cnt stack[64];
+	int sp = 0;
+	stack[sp++] = 0;
+	while (sp > 0) {
+		const node* nd = &nodes[stack[--sp]];
+		while (nd->axis >= 0) {
+			Crd diff = p[nd->axis] - nd->split;
+			if (diff * diff <= r2)
+				stack[sp++] = diff < 0 ? nd->right : nd->left;
+			nd = &nodes[diff < 0 ? nd->left : nd->right];
+		}
+		for (Cnt j = nd->begin; j < nd->end; ++j) {
+			Crd dx = x[j] - p[0], dy = y[j] - p[1], dz = z[j] - p[2];
+			Crd d = dx * dx + dy * dy + dz * dz;
+			if (d <= r2) {
+				indices.push_back(point_indices[j]);
+				if (sqr_dists)
+					sqr_dists->push_back(d);
+			}
+		}
+	}
+	return Cnt(indices.size());
+}
+
+void kd_tree::extract_neighbors(Idx i, Idx k, std::vector<Idx>& N) const
+{
+	std::vector<Crd> D(k + 1);
+	N.resize(k + 1);
+	const Pnt& p = pc->pnt(i);
+	Cnt n = search_k_nearest(p[0], p[1], p[2], k + 1, N.data(), D.data());
+	N.resize(n);
+	// remove the query point, which need not come first in case of duplicate points
+	auto iter = std::find(N.begin(), N.end(), i);
+	if (iter != N.end())
+		N.erase(iter);
+	if (N.size() > size_t(k))
+		N.resize(k);
+}
+
+void kd_tree::find_k_nearest(const Pnt* points, Cnt nr_points, Cnt k, Idx* indices, Crd* sqr_dists, unsigned nr_threads) const
+{
+	for_each_block(nr_points, nr_threads, [&](Cnt begin, Cnt end, Cnt) {
+		std::vector<Crd> D(sqr_dists ? 0 : k);
+		for (Cnt i = begin; i < end; ++i) {
+			Idx* I_i = indices + size_t(i) * k;
+			Crd* D_i = sqr_dists ? sqr_dists + size_t(i) * k : D.data();
+			Cnt n = search_k_nearest(points[i][0], points[i][1], points[i][2], k, I_i, D_i);
+			std::fill(I_i + n, I_i + k, Idx(-1));
+			std::fill(D_i + n, D_i + k, std::numeric_limits<Crd>::max());
+		}
+	});
+}
+
+void kd_tree::find_within_radius(const Pnt* points, Cnt nr_points, Crd radius, std::vector<Cnt>& offsets, std::vector<Idx>& indices, std::vector<Crd>* sqr_dists, unsigned nr_threads) const
+{
+	// collect results per block and concatenate them in block order afterwards
+	Cnt nr_blocks = (nr_points + block_size - 1) / block_size;
+	std::vector<std::vector<Idx> > block_indices(nr_blocks);
+	std::vector<std::vector<Crd> > block_dists(sqr_dists ? nr_blocks : 0);
+	offsets.resize(nr_points + 1);
+	offsets[0] = 0;
+	for_each_block(nr_points, nr_threads, [&](Cnt begin, Cnt end, Cnt b) {
+		std::vector<Idx> I;
+		std::vector<Crd> D;
+		for (Cnt i = begin; i < end; ++i) {
+			find_within_radius(points[i], radius, I, sqr_dists ? &D : 0);
+			offsets[i + 1] = Cnt(I.size());
+			block_indices[b].insert(block_indices[b].end(), I.begin(), I.end());
+			if (sqr_dists)
+				block_dists[b].insert(block_dists[b].end(), D.begin(), D.end());
+		}
+	});
+	for (Cnt i = 0; i < nr_points; ++i)
+		offsets[i + 1] += offsets[i];
+	indices.resize(offsets[nr_points]);
+	if (sqr_dists)
+		sqr_dists->resize(offsets[nr_points]);
+	for (Cnt b = 0; b < nr_blocks; ++b) {
+		Cnt o = offsets[b * block_size];
+		std::copy(block_indices[b].begin(), block_indices[b].end(), indices.begin() + o);
+		if (sqr_dists)
+			std::copy(block_dists[b].begin(), block_dists[b].end(), sqr_dists->begin() + o);
+	}
+}
+
+void kd_tree::find_neighbors(Cnt k, Idx* indices, Crd* sqr_dists, unsigned nr_threads) const
+{
+	// queries in tree order visit the same leafs one after another
+	for_each_block(get_nr_points(), nr_threads, [&](Cnt begin, Cnt end, Cnt) {
+		std::vector<Idx> I(k + 1);
+		std::vector<Crd> D(k + 1);
+		for (Cnt j = begin; j < end; ++j) {
+			Idx pi = point_indices[j];
+			Cnt n = search_k_nearest(x[j], y[j], z[j], k + 1, I.data(), D.data());
+			// drop the query point or the farthest one in case of more than k duplicates
+			Cnt l = Cnt(std::find(I.begin(), I.begin() + n, pi) - I.begin());
+			if (l == n && n > 0)
+				l = n - 1;
+			if (l < n) {
+				std::copy(I.begin() + l + 1, I.begin() + n, I.begin() + l);
+				std::copy(D.begin() + l + 1, D.begin() + n, D.begin() + l);
+				--n;
+			}
+			n = std::min(n, k);
+			Idx* I_pi = indices + size_t(pi) * k;
+			std::copy(I.begin(), I.begin() + n, I_pi);
+			std::fill(I_pi + n, I_pi + k, Idx(-1));
+			if (sqr_dists) {
+				Crd* D_pi = sqr_dists + size_t(pi) * k;
+				std::copy(D.begin(), D.begin() + n, D_pi);
+				std::fill(D_pi + n, D_pi + k, std::numeric_limits<Crd>::max());
+			}
+		}
+	});
+}
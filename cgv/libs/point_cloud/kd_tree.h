@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include "point_cloud.h"
+
+#include "lib_begin.h"
+
+/** bucketed kd-tree over the positions of a point cloud that answers closest point, k nearest neighbor and radius
+	queries. Positions are copied in tree order into separate coordinate arrays, such that leafs are contiguous in
+	memory. Queries do not modify the tree and can be issued from several threads at once. The batched queries
+	distribute blocks of query points over the tasks of the cgv::os::task_scheduler and write their results into flat arrays.
+	In contrast to ann_tree all returned indices are point indices of the point cloud, also for trees built
+	from a subset of components. */
+class CGV_API kd_tree : public point_cloud_types
+{
+public:
+	/// maximum number of points stored in a leaf
+	static const Cnt bucket_size = 8;
+protected:
+	/// inner nodes split at split along axis, leafs have axis -1 and store the tree positions [begin,end)
+	struct node {
+		Crd split;
+		int axis;
+		Cnt begin, end;
+		Cnt left, right;
+	};
+	std::vector<node> nodes;
+	/// coordinates in tree order
+	std::vector<Crd> x, y, z;
+	/// point index for each tree position
+	std::vector<Idx> point_indices;
+	const point_cloud* pc;
+	/// recursively split range of point_indices and return node index
+	Cnt build_node(Cnt begin, Cnt end);
+	/// build tree over the current point_indices
+	void build_tree();
+	/// k nearest neighbor search into sorted arrays of size k, returns number of found points
+	Cnt search_k_nearest(Crd qx, Crd qy, Crd qz, Cnt k, Idx* indices, Crd* sqr_dists) const;
+public:
+	/// construct
+	kd_tree();
+	/// clear the used memory
+	void clear();
+	/// check whether the tree has been built
+	bool is_empty() const;
+	/// return number of points in the tree
+	Cnt get_nr_points() const { return Cnt(point_indices.size()); }
+	/// build from complete point cloud
+	void build(const point_cloud& pc);
+	/// build from given components
+	void build(const point_cloud& pc, const std::vector<Idx>& component_indices);
+
+	/**@name single queries*/
+	//@{
+	/// return index of closest point or -1 if tree is empty, optionally return squared distance
+	Idx find_closest(const Pnt& p, Crd* sqr_dist = 0) const;
+	/// find the k nearest points sorted by distance and return their number, which is smaller than k only if the tree has less points
+	Cnt find_k_nearest(const Pnt& p, Cnt k, Idx* indices, Crd* sqr_dists = 0) const;
+	/// replace content of indices by all points within radius in no particular order and return their number
+	Cnt find_within_radius(const Pnt& p, Crd radius, std::vector<Idx>& indices, std::vector<Crd>* sqr_dists = 0) const;
+	/// provide necessary method for building a neighbor graph, finds the k nearest points other than point i
+	void extract_neighbors(Idx i, Idx k, std::vector<Idx>& N) const;
+	//@}
+
+	/**@name batched queries, nr_threads of 0 uses all hardware threads*/
+	//@{
+	/// find k nearest points for each query point, where results of query i are stored at offset i*k and unused entries are set to -1
+	void find_k_nearest(const Pnt* points, Cnt nr_points, Cnt k, Idx* indices, Crd* sqr_dists = 0, unsigned nr_threads = 0) const;
+	/// find points within radius for each query point in compressed row format, where results of query i range from offsets[i] to offsets[i+1]
+	void find_within_radius(const Pnt* points, Cnt nr_points, Crd radius, std::vector<Cnt>& offsets, std::vector<Idx>& indices, std::vector<Crd>* sqr_dists = 0, unsigned nr_threads = 0) const;
+	/// for each point pi in the tree find the k nearest other points and store them at offset pi*k in arrays that have space for all points of the point cloud
+	void find_neighbors(Cnt k, Idx* indices, Crd* sqr_dists = 0, unsigned nr_threads = 0) const;
+	//@}
+};
+
+#include <cgv/config/lib_end.h>
@@ -0,0 +1,167 @@
+#include "linear_octree.h"
+#include "morton.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <cmath>
+#include <cgv/utils/trace_profiler.h>
+
+linear_octree::linear_octree() : pc(0), cell_margin(0)
+{
+}
+
+void linear_octree::clear()
+{
+	nodes.clear();
+	pc = 0;
+}
+
+bool linear_octree::build(const point_cloud& _pc, const std::vector<uint64_t>& morton_codes, Idx ci, Cnt max_nr_points_per_leaf)
+{
+	CGV_PROFILE_ZONE("linear_octree::build");
+	clear();
+	if (morton_codes.size() != _pc.get_nr_points()) {
+		std::cerr << "linear_octree::build: number of morton codes does not match number of points" << std::endl;
+		return false;
+	}
+	Cnt begin = 0, end = _pc.get_nr_points();
+	if (ci != -1 && _pc.has_components()) {
+		begin = Cnt(_pc.component_point_range(ci).index_of_first_point);
+		end = begin + Cnt(_pc.component_point_range(ci).nr_points);
+	}
+	if (!std::is_sorted(morton_codes.begin() + begin, morton_codes.begin() + end)) {
+		std::cerr << "linear_octree::build: points are not sorted by morton codes" << std::endl;
+		return false;
+	}
+	pc = &_pc;
+	cube = pc->compute_morton_cube();
+	Crd max_abs_crd = 0;
+	for (int c = 0; c < 3; ++c)
+		max_abs_crd = std::max(max_abs_crd, std::max(std::abs(cube.get_min_pnt()[c]), std::abs(cube.get_max_pnt()[c])));
+	cell_margin = 4 * std::numeric_limits<Crd>::epsilon() * max_abs_crd;
+	node root = { 0, begin, end, 0, 0, 0 };
+	nodes.push_back(root);
+	// nodes are split in breadth first order, such that children of a node are appended consecutively
+	for (Cnt ni = 0; ni < Cnt(nodes.size()); ++ni) {
+		node nd = nodes[ni];
+		if (nd.end - nd.begin <= max_nr_points_per_leaf || nd.level == max_level)
+			continue;
+		unsigned shift = 3 * (max_level - 1 - nd.level);
+		nodes[ni].first_child = Cnt(nodes.size());
+		Cnt child_begin = nd.begin;
+		for (uint64_t octant = 0; octant < 8; ++octant) {
+			// codes are sorted, such that the octants of the node form consecutive subranges
+			Cnt child_end = Cnt(std::partition_point(morton_codes.begin() + child_begin, morton_codes.begin() + nd.end,
+				[&](uint64_t code) { return ((code >> shift) & 7) <= octant; }) - morton_codes.begin());
+			if (child_end > child_begin) {
+				node child = { (nd.prefix << 3) | octant, child_begin, child_end, 0, 0, uint8_t(nd.level + 1) };
+				nodes.push_back(child);
+				++nodes[ni].nr_children;
+			}
+			child_begin = child_end;
+		}
+	}
+	return true;
+}
+
+linear_octree::Box linear_octree::get_cell(Cnt ni) const
+{
+	const node& nd = nodes[ni];
+	unsigned x, y, z;
+	cgv::pointcloud::morton_decode_magicbits(nd.prefix, x, y, z);
+	Crd size = cube.get_extent()[0] / Crd(1 << nd.level);
+	Pnt min_pnt = cube.get_min_pnt() + size * Dir(Crd(x), Crd(y), Crd(z));
+	return Box(min_pnt, min_pnt + Dir(size));
+}
+
+unsigned linear_octree::get_depth() const
+{
+	return nodes.empty() ? 0 : nodes.back().level;
+}
+
+bool linear_octree::classify(Cnt ni, const Box& query, bool& contained) const
+{
+	Box cell = get_cell(ni);
+	cell.ref_min_pnt() -= Dir(cell_margin);
+	cell.ref_max_pnt() += Dir(cell_margin);
+	contained = true;
+	for (int c = 0; c < 3; ++c) {
+		if (cell.get_max_pnt()[c] < query.get_min_pnt()[c] || cell.get_min_pnt()[c] > query.get_max_pnt()[c])
+			return false;
+		if (cell.get_min_pnt()[c] < query.get_min_pnt()[c] || cell.get_max_pnt()[c] > query.get_max_pnt()[c])
+			contained = false;
+	}
+	return true;
+}
+
+void linear_octree::find_in_box(const Box& query, std::vector<Idx>& indices) const
+{
+	indices.clear();
+	if (nodes.empty())
+		return;
+	std::vector<Cnt> stack(1, 0);
+	while (!stack.empty()) {
+		const node& nd = nodes[stack.back()];
+		bool contained;
+		bool intersects = classify(stack.back(), query, contained);
+		stack.pop_back();
+		if (!intersects)
+			continue;
+		if (contained) {
+			for (Cnt i = nd.begin; i < nd.end; ++i)
+				indices.push_back(Idx(i));
+		}
+		else if (nd.is_leaf()) {
+			for (Cnt i = nd.begin; i < nd.end; ++i)
+				if (query.inside(pc->pnt(i)))
+					indices.push_back(Idx(i));
+		}
+		else {
+			// push children in reverse order to report points in ascending order
+			for (Cnt c = nd.nr_children; c > 0; --c)
+				stack.push_back(nd.first_child + c - 1);
+		}
+	}
+}
+
+void linear_octree::find_within_radius(const Pnt& p, Crd radius, std::vector<Idx>& indices) const
+{
+	indices.clear();
+	if (nodes.empty())
+		return;
+	Crd r2 = radius * radius;
+	std::vector<Cnt> stack(1, 0);
+	while (!stack.empty()) {
+		const node& nd = nodes[stack.back()];
+		Box cell = get_cell(stack.back());
+		cell.ref_min_pnt() -= Dir(cell_margin);
+		cell.ref_max_pnt() += Dir(cell_margin);
+		stack.pop_back();
+		// squared distances to closest and farthest point of cell
+		Crd d_min = 0, d_max = 0;
+		for (int c = 0; c < 3; ++c) {
+			Crd d_lo = p[c] - cell.get_min_pnt()[c], d_hi = cell.get_max_pnt()[c] - p[c];
+			if (d_lo < 0)
+				d_min += d_lo * d_lo;
+			else if (d_hi < 0)
+				d_min += d_hi * d_hi;
+			Crd d_far = std::max(std::abs(d_lo), std::abs(d_hi));
+			d_max += d_far * d_far;
+		}
+		if (d_min > r2)
+			continue;
+		if (d_max <= r2) {
+			for (Cnt i = nd.begin; i < nd.end; ++i)
+				indices.push_back(Idx(i));
+		}
+		else if (nd.is_leaf()) {
+			for (Cnt i = nd.begin; i < nd.end; ++i)
+				if (sqr_length(pc->pnt(i) - p) <= r2)
+					indices.push_back(Idx(i));
+		}
+		else {
+			for (Cnt c = nd.nr_children; c > 0; --c)
+				stack.push_back(nd.first_child + c - 1);
+		}
+	}
+}
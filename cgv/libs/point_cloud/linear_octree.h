@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "point_cloud.h"
+
+#include "lib_begin.h"
+
+/** compact octree over a range of morton sorted points as produced by point_cloud::sort_morton. Each node
+	covers a contiguous range of points, such that the tree only stores point offsets and no point indices.
+	Nodes are stored breadth first with the children of a node stored consecutively. Cells are defined by the
+	morton cube of the point cloud, in which the root cell is the whole cube and a node on level l is a cell of
+	edge length extent/2^l. Range queries report complete point ranges of cells contained in the query. */
+class CGV_API linear_octree : public point_cloud_types
+{
+public:
+	/// maximum depth given by the 21 bits per axis of the morton codes
+	static const unsigned max_level = 21;
+	/// octree node
+	struct node {
+		/// morton code prefix of the cell consisting of 3*level bits
+		uint64_t prefix;
+		/// range of points [begin,end) in the sorted point cloud
+		Cnt begin, end;
+		/// index of first child, children are stored consecutively
+		Cnt first_child;
+		/// number of children, which is zero for leafs
+		uint8_t nr_children;
+		/// level of node, which is zero for the root
+		uint8_t level;
+		/// check for leaf
+		bool is_leaf() const { return nr_children == 0; }
+	};
+protected:
+	std::vector<node> nodes;
+	const point_cloud* pc;
+	/// cube used to compute the morton codes
+	Box cube;
+	/// cells are enlarged by this margin in queries to account for rounding in the quantization of points
+	Crd cell_margin;
+	/// check whether the enlarged cell of node ni intersects the box and whether it is contained in it
+	bool classify(Cnt ni, const Box& query, bool& contained) const;
+public:
+	/// construct empty octree
+	linear_octree();
+	/// clear the used memory
+	void clear();
+	/// build over the points of given component or all points if component_index is -1, where the points must be sorted with the given morton codes. Return false if the codes do not fit the point cloud
+	bool build(const point_cloud& pc, const std::vector<uint64_t>& morton_codes, Idx component_index = -1, Cnt max_nr_points_per_leaf = 32);
+	/// return number of nodes
+	Cnt get_nr_nodes() const { return Cnt(nodes.size()); }
+	/// return the ni-th node, where the root has index 0
+	const node& get_node(Cnt ni) const { return nodes[ni]; }
+	/// compute the cell of the ni-th node
+	Box get_cell(Cnt ni) const;
+	/// return the maximum level of all nodes
+	unsigned get_depth() const;
+
+	/**@name range queries that replace the content of the index vector and report point indices sorted ascendingly*/
+	//@{
+	/// find all points inside the box
+	void find_in_box(const Box& query, std::vector<Idx>& indices) const;
+	/// find all points within radius around p
+	void find_within_radius(const Pnt& p, Crd radius, std::vector<Idx>& indices) const;
+	//@}
+};
+
+#include <cgv/config/lib_end.h>
@@ -146,5 +146,22 @@ inline uint64_t morton_encode_magicbits(unsigned int x, unsigned int y, unsigned
 	return answer;
 }
 
+// inverse of splitBy3, collects every third bit starting at bit 0
+inline unsigned int compactBy3(uint64_t x) {
+	x &= 0x1249249249249249;
+	x = (x ^ (x >> 2)) & 0x10c30c30c30c30c3;
+	x = (x ^ (x >> 4)) & 0x100f00f00f00f00f;
+	x = (x ^ (x >> 8)) & 0x1f0000ff0000ff;
+	x = (x ^ (x >> 16)) & 0x1f00000000ffff;
+	x = (x ^ (x >> 32)) & 0x1fffff;
+	return (unsigned int)x;
+}
+
+inline void morton_decode_magicbits(uint64_t code, unsigned int& x, unsigned int& y, unsigned int& z) {
+	x = compactBy3(code);
+	y = compactBy3(code >> 1);
+	z = compactBy3(code >> 2);
+}
+
 	}
 }
\ No newline at end of file
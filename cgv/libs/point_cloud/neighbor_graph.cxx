@@ -1,6 +1,8 @@
 #include "neighbor_graph.h"
-#include <cgv/utils/progression.h>
+#include <cgv/os/task_scheduler.h>
 #include <algorithm>
+#include <atomic>
+#include <cgv/utils/trace_profiler.h>
 
 using namespace std;
 
@@ -79,18 +81,170 @@ bool neighbor_graph::is_directed_edge(Idx vi, Idx vj) const
 	return std::find(at(vi).begin(), at(vi).end(),vj) != at(vi).end();
 }
 
-void neighbor_graph::symmetrize()
+void neighbor_graph::build_from_knn(Cnt n, Cnt k, const Idx* knn_indices, cgv::utils::statistics* he_stats, unsigned nr_threads)
 {
-	cgv::utils::progression prog("symmetrize neighbor graph", (unsigned)size(), 10);
-	for (Idx i = 0; i < (Idx) size(); ++i) {
-		prog.step();
-		vector<Idx>& ni = at(i);
-		for (Idx j = 0; j < (Idx)ni.size(); ++j) {
-			vector<Idx>& nj = at(ni[j]);
-			if (std::find(nj.begin(),nj.end(),i) == nj.end()) {
-				nj.push_back(i);
-				++nr_half_edges;
-			}
+	CGV_PROFILE_ZONE("neighbor_graph::build_from_knn");
+	clear();
+	resize(n);
+	cgv::os::parallel_for(0, n, [&](size_t begin, size_t end) {
+		for (Cnt i = Cnt(begin); i < end; ++i) {
+			const Idx* N = knn_indices + size_t(i) * k;
+			std::vector<Idx>& Ni = at(i);
+			Ni.reserve(k);
+			for (Cnt j = 0; j < k && N[j] != -1; ++j)
+				Ni.push_back(N[j]);
 		}
+	}, compact_neighbor_graph::parallel_block_size, nr_threads);
+	if (he_stats)
+		he_stats->init();
+	for (Idx i = 0; i < (Idx)n; ++i) {
+		if (he_stats)
+			he_stats->update(double(at(i).size()));
+		nr_half_edges += Cnt(at(i).size());
 	}
 }
+
+void neighbor_graph::assign(const compact_neighbor_graph& cng, unsigned nr_threads)
+{
+	clear();
+	resize(cng.size());
+	cgv::os::parallel_for(0, cng.size(), [&](size_t begin, size_t end) {
+		for (Cnt i = Cnt(begin); i < end; ++i)
+			at(i).assign(cng.at(i).begin(), cng.at(i).end());
+	}, compact_neighbor_graph::parallel_block_size, nr_threads);
+	nr_half_edges = cng.get_nr_half_edges();
+}
+
+void neighbor_graph::symmetrize(unsigned nr_threads)
+{
+	compact_neighbor_graph cng;
+	cng.build(*this, nr_threads);
+	cng.symmetrize(nr_threads);
+	// reverse edges are appended to the neighborhoods, such that only the tails need to be copied
+	cgv::os::parallel_for(0, size(), [&](size_t begin, size_t end) {
+		for (Cnt i = Cnt(begin); i < end; ++i) {
+			std::vector<Idx>& Ni = at(i);
+			compact_neighbor_graph::neighbor_range R = cng.at(i);
+			Ni.insert(Ni.end(), R.begin() + Ni.size(), R.end());
+		}
+	}, compact_neighbor_graph::parallel_block_size, nr_threads);
+	nr_half_edges = cng.get_nr_half_edges();
+}
+
+compact_neighbor_graph::compact_neighbor_graph()
+{
+}
+
+void compact_neighbor_graph::clear()
+{
+	offsets.clear();
+	indices.clear();
+}
+
+int compact_neighbor_graph::find(Idx vi, Idx vj) const
+{
+	neighbor_range Ni = at(vi);
+	const Idx* iter = std::find(Ni.begin(), Ni.end(), vj);
+	return iter == Ni.end() ? -1 : int(iter - Ni.begin());
+}
+
+bool compact_neighbor_graph::is_directed_edge(Idx vi, Idx vj) const
+{
+	return find(vi, vj) != -1;
+}
+
+void compact_neighbor_graph::build_from_knn(Cnt n, Cnt k, const Idx* knn_indices, unsigned nr_threads)
+{
+	CGV_PROFILE_ZONE("compact_neighbor_graph::build_from_knn");
+	clear();
+	offsets.resize(n + 1);
+	offsets[0] = 0;
+	cgv::os::parallel_for(0, n, [&](size_t begin, size_t end) {
+		for (Cnt i = Cnt(begin); i < end; ++i) {
+			const Idx* N = knn_indices + size_t(i) * k;
+			Cnt j = 0;
+			while (j < k && N[j] != -1)
+				++j;
+			offsets[i + 1] = j;
+		}
+	}, parallel_block_size, nr_threads);
+	for (Cnt i = 0; i < n; ++i)
+		offsets[i + 1] += offsets[i];
+	indices.resize(offsets[n]);
+	cgv::os::parallel_for(0, n, [&](size_t begin, size_t end) {
+		for (Cnt i = Cnt(begin); i < end; ++i)
+			std::copy(knn_indices + size_t(i) * k, knn_indices + size_t(i) * k + (offsets[i + 1] - offsets[i]), indices.begin() + offsets[i]);
+	}, parallel_block_size, nr_threads);
+}
+
+void compact_neighbor_graph::build(const neighbor_graph& ng, unsigned nr_threads)
+{
+	CGV_PROFILE_ZONE("compact_neighbor_graph::build");
+	clear();
+	Cnt n = Cnt(ng.size());
+	offsets.resize(n + 1);
+	offsets[0] = 0;
+	for (Cnt i = 0; i < n; ++i)
+		offsets[i + 1] = offsets[i] + Cnt(ng[i].size());
+	indices.resize(offsets[n]);
+	cgv::os::parallel_for(0, n, [&](size_t begin, size_t end) {
+		for (Cnt i = Cnt(begin); i < end; ++i)
+			std::copy(ng[i].begin(), ng[i].end(), indices.begin() + offsets[i]);
+	}, parallel_block_size, nr_threads);
+}
+
+void compact_neighbor_graph::symmetrize(unsigned nr_threads)
+{
+	Cnt n = Cnt(size());
+	if (n == 0)
+		return;
+	// sort all edges by target and source, where the key of edge i->j is j*2^b+i
+	unsigned b = 1;
+	while (b < 32 && (Cnt(1) << b) < n)
+		++b;
+	std::vector<uint64_t> edges(indices.size());
+	cgv::os::parallel_for(0, n, [&](size_t begin, size_t end) {
+		for (Cnt i = Cnt(begin); i < end; ++i)
+			for (Cnt j = offsets[i]; j < offsets[i + 1]; ++j)
+				edges[j] = (uint64_t(indices[j]) << b) | i;
+	}, parallel_block_size, nr_threads);
+	cgv::os::parallel_radix_sort(edges, 2 * b, cgv::os::choose_nr_chunks(edges.size(), nr_threads));
+	std::vector<Cnt> reverse_offsets(n + 1, 0);
+	for (uint64_t e : edges)
+		++reverse_offsets[(e >> b) + 1];
+	for (Cnt i = 0; i < n; ++i)
+		reverse_offsets[i + 1] += reverse_offsets[i];
+	// keep the sources of reverse edges that are not yet neighbors at the front of each bucket
+	const uint64_t source_mask = (uint64_t(1) << b) - 1;
+	std::vector<Cnt> new_offsets(n + 1);
+	new_offsets[0] = 0;
+	cgv::os::parallel_for(0, n, [&](size_t begin, size_t end) {
+		for (Cnt i = Cnt(begin); i < end; ++i) {
+			neighbor_range Ni = at(Idx(i));
+			Cnt nr_kept = 0;
+			for (Cnt j = reverse_offsets[i]; j < reverse_offsets[i + 1]; ++j) {
+				Idx source = Idx(edges[j] & source_mask);
+				if (j > reverse_offsets[i] && edges[j] == edges[j - 1])
+					continue;
+				if (std::find(Ni.begin(), Ni.end(), source) == Ni.end())
+					edges[reverse_offsets[i] + nr_kept++] = uint64_t(source);
+			}
+			new_offsets[i + 1] = Cnt(Ni.size()) + nr_kept;
+		}
+	}, parallel_block_size, nr_threads);
+	for (Cnt i = 0; i < n; ++i)
+		new_offsets[i + 1] += new_offsets[i];
+	// merge original neighbors with the missing reverse edges
+	std::vector<Idx> new_indices(new_offsets[n]);
+	cgv::os::parallel_for(0, n, [&](size_t begin, size_t end) {
+		for (Cnt i = Cnt(begin); i < end; ++i) {
+			Cnt o = new_offsets[i];
+			for (Cnt j = offsets[i]; j < offsets[i + 1]; ++j)
+				new_indices[o++] = indices[j];
+			for (Cnt j = reverse_offsets[i]; o < new_offsets[i + 1]; ++j)
+				new_indices[o++] = Idx(edges[j]);
+		}
+	}, parallel_block_size, nr_threads);
+	offsets.swap(new_offsets);
+	indices.swap(new_indices);
+}
@@ -2,8 +2,12 @@
 
 #include <vector>
 #include <iostream>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
 #include <cgv/utils/statistics.h>
 #include <cgv/type/standard_types.h>
+#include <cgv/os/task_scheduler.h>
 
 #include "lib_begin.h"
 
@@ -27,6 +31,8 @@ struct graph_location
 	}
 };
 
+struct compact_neighbor_graph;
+
 /** Data structure used to store a knn-neighbor graph. */
 struct CGV_API neighbor_graph : public std::vector<std::vector<graph_location::Idx> >
 {
@@ -84,9 +90,88 @@ struct CGV_API neighbor_graph : public std::vector<std::vector<graph_location::I
 			nr_half_edges += k;
 		}
 	}
-	/// ensure the neighbor graph to be symmetric
-	void symmetrize();
+	/// build a knn neighbor graph for n points from k neighbor indices per point stored at offset i*k, where entries of -1 are skipped, in parallel on nr_threads or all cores if 0
+	void build_from_knn(Cnt n, Cnt k, const Idx* knn_indices, cgv::utils::statistics* he_stats = 0, unsigned nr_threads = 0);
+	/// copy a compact neighbor graph into editable neighborhoods
+	void assign(const compact_neighbor_graph& cng, unsigned nr_threads = 0);
+	/// ensure the neighbor graph to be symmetric by appending missing reverse edges in ascending order, which is done in parallel via compact_neighbor_graph::symmetrize
+	void symmetrize(unsigned nr_threads = 0);
+	//@}
+};
+
+/** knn-neighbor graph in compressed sparse row format, where the neighbors of vertex vi are stored in
+	indices[offsets[vi]] to indices[offsets[vi+1]-1]. Compared to neighbor_graph this avoids one allocation per
+	vertex and needs about half of the memory. Construction and symmetrization run in parallel but the
+	neighborhoods cannot be edited, such that algorithms that filter edges need a neighbor_graph (see neighbor_graph::assign). */
+struct CGV_API compact_neighbor_graph
+{
+	/// index type
+	typedef graph_location::Idx Idx;
+	/// count type
+	typedef graph_location::Cnt Cnt;
+	/// read only view of the neighbors of a vertex with the interface of a const std::vector
+	struct neighbor_range
+	{
+		const Idx* first;
+		const Idx* last;
+		const Idx* begin() const { return first; }
+		const Idx* end() const { return last; }
+		size_t size() const { return size_t(last - first); }
+		bool empty() const { return first == last; }
+		const Idx& operator [] (size_t j) const { return first[j]; }
+	};
+	/// n+1 offsets into the index vector
+	std::vector<Cnt> offsets;
+	/// concatenated neighbor indices of all vertices
+	std::vector<Idx> indices;
+	/// construct empty neighbor graph
+	compact_neighbor_graph();
+	/// clear the used memory
+	void clear();
+
+	/**@name queries*/
+	//@{
+	/// return number of vertices
+	size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+	/// check for empty graph
+	bool empty() const { return size() == 0; }
+	/// return number of directed edges
+	Cnt get_nr_half_edges() const { return Cnt(indices.size()); }
+	/// return the neighbors of vertex vi
+	neighbor_range at(Idx vi) const { neighbor_range r = { indices.data() + offsets[vi], indices.data() + offsets[vi + 1] }; return r; }
+	/// return the neighbors of vertex vi
+	neighbor_range operator [] (Idx vi) const { return at(vi); }
+	/// find index of vj in neighbors of  vi and return -1 if not found
+	int find(Idx vi, Idx vj) const;
+	/// check if the directed edge from  vi to vj is contained in the neighbor graph
+	bool is_directed_edge(Idx vi, Idx vj) const;
+	//@}
+
+	/**@name construction, where nr_threads=0 uses all cores */
+	//@{
+	/// build from a data structure that provides a thread safe method extract_neighbors(i, k, vector<Idx>&) like kd_tree
+	template <typename knn_info>
+	void build(Cnt n, Cnt k, const knn_info& knn, unsigned nr_threads = 0) {
+		std::vector<Idx> knn_indices(size_t(n) * k, Idx(-1));
+		cgv::os::parallel_for(0, n, [&](size_t begin, size_t end) {
+			std::vector<Idx> N;
+			for (Cnt i = Cnt(begin); i < end; ++i) {
+				knn.extract_neighbors(Idx(i), Idx(k), N);
+				std::copy(N.begin(), N.begin() + std::min(N.size(), size_t(k)), knn_indices.begin() + size_t(i) * k);
+			}
+		}, parallel_block_size, nr_threads);
+		build_from_knn(n, k, knn_indices.data(), nr_threads);
+	}
+	/// build for n points from k neighbor indices per point stored at offset i*k, where entries of -1 are skipped
+	void build_from_knn(Cnt n, Cnt k, const Idx* knn_indices, unsigned nr_threads = 0);
+	/// copy the neighborhoods of a neighbor_graph
+	void build(const neighbor_graph& ng, unsigned nr_threads = 0);
+	/// ensure the graph to be symmetric with the same result as neighbor_graph::symmetrize, where reverse edges are gathered with a parallel radix sort and merged per vertex
+	void symmetrize(unsigned nr_threads = 0);
 	//@}
+
+	/// number of vertices per block of cgv::os::parallel_for, where blocks are assigned dynamically as neighborhoods differ in size after symmetrization
+	static const Cnt parallel_block_size = 4096;
 };
 
 #include <cgv/config/lib_end.h>
@@ -3,6 +3,7 @@
 #include <cmath>
 #include <cgv/math/functions.h>
 #include <algorithm>
+#include <cgv/utils/trace_profiler.h>
 
 normal_estimator::normal_estimator(point_cloud& _pc, neighbor_graph& _ng) : pc(_pc), ng(_ng) 
 {
@@ -50,6 +51,7 @@ normal_estimator::Crd normal_estimator::estimate_scale(Idx vi) const
 /// compute normals from neighbor graph and distance and normal weights
 void normal_estimator::smooth_normals()
 {
+	CGV_PROFILE_ZONE("normal_estimator::smooth_normals");
 	if (!pc.has_normals())
 		compute_weighted_normals(false);
 
@@ -134,6 +136,7 @@ void normal_estimator::compute_weights(Idx vi, std::vector<Crd>& weights, std::v
 /// recompute normals from neighbor graph and distance and normal weights
 void normal_estimator::compute_weighted_normals(bool reorient, float* means, float* eig_vals, float* eig_vecs)
 {
+	CGV_PROFILE_ZONE("normal_estimator::compute_weighted_normals");
 	if (!pc.has_normals()) {
 		pc.create_normals();
 		reorient = false;
@@ -191,6 +194,7 @@ void normal_estimator::compute_bilateral_weights(Idx vi, std::vector<Crd>& weigh
 /// recompute normals from neighbor graph and distance and normal weights
 void normal_estimator::compute_bilateral_weighted_normals(bool reorient, float* means, float* eig_vals, float* eig_vecs)
 {
+	CGV_PROFILE_ZONE("normal_estimator::compute_bilateral_weighted_normals");
 	if (!pc.has_normals())
 		compute_weighted_normals(reorient);
 
@@ -229,6 +233,7 @@ void normal_estimator::compute_bilateral_weighted_normals(bool reorient, float*
 void normal_estimator::compute_plane_bilateral_weighted_normals(bool reorient, float* means, float* eig_vals,
 																float* eig_vecs)
 {
+	CGV_PROFILE_ZONE("normal_estimator::compute_plane_bilateral_weighted_normals");
 	if (!pc.has_normals())
 		compute_weighted_normals(reorient);
 
@@ -322,6 +327,7 @@ struct weighted_edge_info
 /// orient normals towards given point
 void normal_estimator::orient_normals(const Pnt& view_point)
 {
+	CGV_PROFILE_ZONE("normal_estimator::orient_normals");
 	if (!pc.has_normals())
 		compute_weighted_normals(false);
 
@@ -335,6 +341,7 @@ void normal_estimator::orient_normals(const Pnt& view_point)
 /// recompute normals from neighbor graph and distance and normal weights
 void normal_estimator::orient_normals()
 {
+	CGV_PROFILE_ZONE("normal_estimator::orient_normals");
 	if (!pc.has_normals())
 		compute_weighted_normals(false);
 	std::cout << "orienting normals\n=================" << std::endl;
@@ -4,6 +4,14 @@ namespace cgv {
 namespace pointcloud {
 namespace octree {
 
+bool seek_file(FILE* fp, int64_t offset)
+{
+#ifdef _WIN32
+	return _fseeki64(fp, offset, SEEK_SET) == 0;
+#else
+	return fseeko64(fp, offset, SEEK_SET) == 0;
+#endif
+}
 
 std::vector<std::vector<int64_t>> createSumPyramid(std::vector<int64_t>& grid, int gridSize)
 {
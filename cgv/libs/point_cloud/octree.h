@@ -17,6 +17,11 @@
 #include <sstream>
 #include <exception>
 #include <typeinfo>
+#include <cstdio>
+#include <cstring>
+#include <list>
+
+#include <cgv/utils/file.h>
 
 #include "concurrency.h"
 #include "morton.h"
@@ -152,10 +157,12 @@ namespace pointcloud {
 		std::shared_ptr<ChunkPointCloud<point_t>> pc_data;
 		std::string id;
 
-		ChunkNode(std::string node_id, int numPoints) {
+		/// in out-of-core mode chunks are not allocated on construction but loaded from their temporary file
+		ChunkNode(std::string node_id, int numPoints, bool allocate = true) {
 			this->numPoints = numPoints;
 			this->id = node_id;
-			this->pc_data = std::make_shared<ChunkPointCloud<point_t>>(numPoints);
+			if (allocate)
+				this->pc_data = std::make_shared<ChunkPointCloud<point_t>>(numPoints);
 		}
 
 	};
@@ -175,6 +182,119 @@ namespace pointcloud {
 		virtual void sample(std::shared_ptr<IndexNode<point_t>> node, double baseSpacing, std::function<void(IndexNode<point_t>*)> callbackNodeCompleted) = 0;
 	};
 
+	/**@name out-of-core processing*/
+	//@{
+	/// settings of the out-of-core mode of octree_lod_generator
+	struct OutOfCoreSettings {
+		/// approximate upper bound in bytes for point data held in memory at once, which determines batch, buffer and chunk sizes
+		size_t memory_budget = size_t(1) << 30;
+		/// size of a page of the output file in bytes
+		size_t page_size = size_t(1) << 20;
+		/// directory for temporary chunk files, which defaults to the directory of the output file
+		std::string temp_directory;
+	};
+
+	/// source of points read in batches by the out-of-core mode, which reads the input three times
+	template <typename point_t>
+	struct PointSource {
+		virtual ~PointSource() {}
+		/// restart reading at the first point and return false on failure
+		virtual bool rewind() = 0;
+		/// read up to max_nr_points into buffer and return the number of read points, which is 0 at the end of the input
+		virtual size_t read(point_t* buffer, size_t max_nr_points) = 0;
+	};
+
+	/// point source reading from an array in memory, mainly useful for testing
+	template <typename point_t>
+	struct ArrayPointSource : public PointSource<point_t> {
+		const point_t* points;
+		size_t nr_points;
+		size_t position = 0;
+		ArrayPointSource(const point_t* _points, size_t _nr_points) : points(_points), nr_points(_nr_points) {}
+		bool rewind() override { position = 0; return true; }
+		size_t read(point_t* buffer, size_t max_nr_points) override {
+			size_t n = std::min(max_nr_points, nr_points - position);
+			std::copy(points + position, points + position + n, buffer);
+			position += n;
+			return n;
+		}
+	};
+
+	/// point source reading a binary file that contains a plain array of point_t
+	template <typename point_t>
+	struct FilePointSource : public PointSource<point_t> {
+		std::string file_name;
+		FILE* fp = nullptr;
+		FilePointSource(const std::string& _file_name) : file_name(_file_name) {}
+		~FilePointSource() { if (fp) fclose(fp); }
+		bool rewind() override {
+			if (fp)
+				fclose(fp);
+			fp = fopen(file_name.c_str(), "rb");
+			return fp != nullptr;
+		}
+		size_t read(point_t* buffer, size_t max_nr_points) override {
+			return fp ? fread(buffer, sizeof(point_t), max_nr_points, fp) : 0;
+		}
+	};
+
+	/// seek to an absolute 64 bit byte offset and return whether this succeeded
+	CGV_API bool seek_file(FILE* fp, int64_t offset);
+
+	/// header of the paged lod file, which is followed by the pages of points and the node table
+	struct PagedLODHeader {
+		char magic[8] = { 'C', 'G', 'V', 'L', 'O', 'D', 'P', '\0' };
+		uint32_t version = 1;
+		/// size of one point in bytes
+		uint32_t point_size = 0;
+		uint64_t nr_points = 0;
+		uint64_t nr_nodes = 0;
+		/// number of points per page, pages start right after the header
+		uint64_t points_per_page = 0;
+		/// byte offset of the node table
+		uint64_t node_table_offset = 0;
+		/// cube of the root node
+		float min[3] = { 0, 0, 0 }, max[3] = { 0, 0, 0 };
+	};
+
+	/// entry of the node table, which is stored with the name length and the name characters following the fixed size part
+	struct PagedLODNode {
+		/// index of first point, the points of a node are stored consecutively but may span several pages
+		uint64_t first_point = 0;
+		uint64_t nr_points = 0;
+		float min[3] = { 0, 0, 0 }, max[3] = { 0, 0, 0 };
+		/// node name as in IndexNode, where the number of digits after the leading 'r' is the level
+		std::string name;
+		int level() const { return int(name.size()) - 1; }
+	};
+
+	/// read access to a paged lod file with a least recently used page cache bounded by a memory budget
+	template <typename point_t>
+	class PagedLODFile {
+		FILE* fp = nullptr;
+		PagedLODHeader header;
+		std::vector<PagedLODNode> nodes;
+		size_t max_nr_cached_pages = 1;
+		/// cached pages in order of last use, most recent first
+		std::list<std::pair<uint64_t, std::vector<point_t>>> pages;
+		std::unordered_map<uint64_t, typename std::list<std::pair<uint64_t, std::vector<point_t>>>::iterator> page_lut;
+	public:
+		PagedLODFile() {}
+		~PagedLODFile() { close(); }
+		/// open file, read header and node table and return false if the file does not fit point_t
+		bool open(const std::string& file_name, size_t cache_budget = size_t(64) << 20);
+		void close();
+		const PagedLODHeader& get_header() const { return header; }
+		const std::vector<PagedLODNode>& get_nodes() const { return nodes; }
+		/// return the page with given index, which stays valid until the next call
+		const std::vector<point_t>& get_page(uint64_t page_index);
+		/// replace the content of points by the points of the ni-th node
+		bool read_node(size_t ni, std::vector<point_t>& points);
+		/// append all points in the order of the file
+		bool read_all(std::vector<point_t>& points);
+	};
+	//@}
+
 /// generates octree based lods for point clouds, 
 /// @param type point_t should provide two position() and level() methods like GenericLODPoint, these are used to read the point position and write the LOD
 template <typename point_t>
@@ -223,6 +343,95 @@ class octree_lod_generator {
 				node.points = nullptr;
 			}
 		};
+
+		// this indexer writes nodes to a paged lod file, such that only the current page is held in memory
+		struct PagedIndexer : public Indexer {
+			FILE* fp = nullptr;
+			bool failed = false;
+			PagedLODHeader header;
+			std::vector<PagedLODNode> nodes;
+			std::vector<point_t> page;
+			std::mutex mtx_write;
+
+			~PagedIndexer() {
+				if (fp)
+					fclose(fp);
+			}
+			// create file and reserve space for the header, which is written on close
+			bool open(const std::string& file_name, size_t points_per_page, const cgv::vec3& min, const cgv::vec3& max) {
+				fp = fopen(file_name.c_str(), "wb");
+				if (!fp)
+					return false;
+				header.point_size = sizeof(point_t);
+				header.points_per_page = points_per_page;
+				for (int c = 0; c < 3; ++c) {
+					header.min[c] = min[c];
+					header.max[c] = max[c];
+				}
+				page.reserve(points_per_page);
+				return fwrite(&header, sizeof(PagedLODHeader), 1, fp) == 1;
+			}
+			// append points with the given level to the pages, where full pages are written immediately
+			void write_points(const point_t* points, size_t nr_points, int level) {
+				for (size_t i = 0; i < nr_points; ++i) {
+					page.push_back(points[i]);
+					page.back().level() = level;
+					if (page.size() == header.points_per_page)
+						flush_page();
+				}
+				header.nr_points += nr_points;
+			}
+			void flush_page() {
+				if (!page.empty() && fwrite(page.data(), sizeof(point_t), page.size(), fp) != page.size())
+					failed = true;
+				page.clear();
+			}
+			// add a node consisting of all points written since first_point
+			void add_node(const std::string& name, const cgv::vec3& min, const cgv::vec3& max, uint64_t first_point) {
+				PagedLODNode entry;
+				entry.first_point = first_point;
+				entry.nr_points = header.nr_points - first_point;
+				for (int c = 0; c < 3; ++c) {
+					entry.min[c] = min[c];
+					entry.max[c] = max[c];
+				}
+				entry.name = name;
+				nodes.push_back(entry);
+			}
+			// lock and write node to the pages
+			void finish_node(IndexNode<point_t>& node) override {
+				assert(node.sampled);
+				std::lock_guard<std::mutex> lock(mtx_write);
+				uint64_t first_point = header.nr_points;
+				write_points(node.points->data(), node.points->size(), int(node.level()));
+				add_node(node.name, node.min, node.max, first_point);
+				node.points = nullptr;
+			}
+			// write the last page, the node table and the header and close the file
+			bool close() {
+				if (!fp)
+					return false;
+				flush_page();
+				header.nr_nodes = nodes.size();
+				header.node_table_offset = sizeof(PagedLODHeader) + header.nr_points * sizeof(point_t);
+				for (const auto& entry : nodes) {
+					uint32_t name_length = uint32_t(entry.name.size());
+					if (fwrite(&entry.first_point, sizeof(uint64_t), 1, fp) != 1 ||
+						fwrite(&entry.nr_points, sizeof(uint64_t), 1, fp) != 1 ||
+						fwrite(entry.min, sizeof(float), 3, fp) != 3 ||
+						fwrite(entry.max, sizeof(float), 3, fp) != 3 ||
+						fwrite(&name_length, sizeof(uint32_t), 1, fp) != 1 ||
+						fwrite(entry.name.data(), 1, name_length, fp) != name_length)
+						failed = true;
+				}
+				if (!seek_file(fp, 0) || fwrite(&header, sizeof(PagedLODHeader), 1, fp) != 1)
+					failed = true;
+				if (fclose(fp) != 0)
+					failed = true;
+				fp = nullptr;
+				return !failed;
+			}
+		};
 		
 		int max_points_per_chunk = -1;
 
@@ -257,12 +466,12 @@ class octree_lod_generator {
 		inline void lod_counting_core(std::function<void(int64_t first_point, int64_t num_points)>& processor, const int64_t num_points);
 
 
-		inline NodeLUT lod_createLUT(std::vector<std::atomic_int32_t>& grid, int64_t grid_size,std::vector<ChunkNode<point_t>>& nodes);
+		inline NodeLUT lod_createLUT(std::vector<std::atomic_int32_t>& grid, int64_t grid_size,std::vector<ChunkNode<point_t>>& nodes, bool allocate_chunks = true);
 			
 		//create chunk nodes
 		inline void distribute_points(cgv::vec3 min, cgv::vec3 max, float cube_size, int64_t grid_size, NodeLUT& lut, const point_t* vertices, const int64_t num_points, const std::vector<ChunkNode<point_t>>& nodes);
-		//inout chunks
-		inline void indexing(Chunks<point_t>& chunks, Indexer& indexer, Sampler<point_t>& sampler);
+		//inout chunks, if load_chunk is given it is called before a chunk is processed and the chunk data is released afterwards
+		inline void indexing(Chunks<point_t>& chunks, Indexer& indexer, Sampler<point_t>& sampler, std::function<void(ChunkNode<point_t>&)> load_chunk = nullptr);
 			
 		void build_hierarchy(Indexer* indexer, IndexNode<point_t>* node, std::shared_ptr<std::vector<point_t>> points, int64_t numPoints, int64_t depth = 0, int max_points_per_index_node = 10000);
 			
@@ -281,6 +490,10 @@ class octree_lod_generator {
 		/// generate points with lod information out of the given vertices
 		inline std::vector<point_t> generate_lods(const std::vector<point_t>& points);
 
+		/// generate lods like generate_lods but read the points in batches from the source, spill chunks to temporary files and write the result to a paged lod file,
+		/// such that the used memory is bounded by the memory budget of the settings apart from the sampled points of chunk roots. Return false on i/o errors
+		inline bool generate_lods_out_of_core(PointSource<point_t>& source, const std::string& file_name, const OutOfCoreSettings& settings = OutOfCoreSettings());
+
 		//creates a octree structure out of IndexNodes and returns a shared pointer to the root
 		inline std::shared_ptr<IndexNode<point_t>> build_octree(const std::vector<point_t>& points);
 		
@@ -784,7 +997,7 @@ struct SamplerRandom : public Sampler<point_t> {
 	}
 
 	template <typename point_t>
-	NodeLUT octree_lod_generator<point_t>::lod_createLUT(std::vector<std::atomic_int32_t>& grid, int64_t grid_size, std::vector<ChunkNode<point_t>>& nodes)
+	NodeLUT octree_lod_generator<point_t>::lod_createLUT(std::vector<std::atomic_int32_t>& grid, int64_t grid_size, std::vector<ChunkNode<point_t>>& nodes, bool allocate_chunks)
 	{
 		nodes.clear();
 
@@ -821,7 +1034,7 @@ struct SamplerRandom : public Sampler<point_t> {
 			// grid_high
 
 			// loop through all cells of the lower detail target grid, and for each cell through the 8 enclosed cells of the higher level grid
-			for_xyz(gridSize_low, [this, &nodes, &grid_low, &grid_high, gridSize_low, gridSize_high, level_low, level_high, level_max](int64_t x, int64_t y, int64_t z) {
+			for_xyz(gridSize_low, [this, &nodes, &grid_low, &grid_high, gridSize_low, gridSize_high, level_low, level_high, level_max, allocate_chunks](int64_t x, int64_t y, int64_t z) {
 
 				int64_t index_low = x + y * gridSize_low + z * gridSize_low * gridSize_low;
 
@@ -870,7 +1083,7 @@ struct SamplerRandom : public Sampler<point_t> {
 
 						if (value > 0) {
 							std::string node_id = to_node_id(level_high, gridSize_high, nx, ny, nz);
-							nodes.emplace_back(node_id, value);
+							nodes.emplace_back(node_id, value, allocate_chunks);
 							ChunkNode<point_t>& node = nodes.back();
 
 							node.x = nx;
@@ -947,7 +1160,7 @@ struct SamplerRandom : public Sampler<point_t> {
 	}
 
 	template <typename point_t>
-	void octree_lod_generator<point_t>::indexing(Chunks<point_t>& chunks, Indexer& indexer, Sampler<point_t>& sampler)
+	void octree_lod_generator<point_t>::indexing(Chunks<point_t>& chunks, Indexer& indexer, Sampler<point_t>& sampler, std::function<void(ChunkNode<point_t>&)> load_chunk)
 	{
 		struct Task {
 			ChunkNode<point_t>* chunk = nullptr;
@@ -988,9 +1201,11 @@ struct SamplerRandom : public Sampler<point_t> {
 		indexer.spacing = (chunks.max - chunks.min).x() / 128.0;
 
 		//builds node hierachy
-		tasks.func = [this, &indexer, &sampler, &nodes, &mtx_nodes](Task* task) {
+		tasks.func = [this, &indexer, &sampler, &nodes, &mtx_nodes, &load_chunk](Task* task) {
 			static constexpr float Infinity = std::numeric_limits<float>::infinity();
 			ChunkNode<point_t>* chunk = task->chunk;
+			if (load_chunk)
+				load_chunk(*chunk);
 
 			cgv::vec3 min(Infinity), max(-Infinity);
 
@@ -1025,6 +1240,10 @@ struct SamplerRandom : public Sampler<point_t> {
 				indexer.root->add_descendant(chunk_root);
 			}
 
+			// points not taken over by the hierarchy are released with the chunk data
+			if (load_chunk)
+				chunk->pc_data = nullptr;
+
 			std::lock_guard<std::mutex> lock(mtx_nodes);
 
 			nodes.push_back(chunk_root);
@@ -1351,6 +1570,290 @@ struct SamplerRandom : public Sampler<point_t> {
 		}
 		return out;
 	}
+
+	template <typename point_t>
+	bool octree_lod_generator<point_t>::generate_lods_out_of_core(PointSource<point_t>& source, const std::string& file_name, const OutOfCoreSettings& settings)
+	{
+		// a batch and the distribution buffers each take a quarter of the budget
+		size_t batch_size = std::max<size_t>(settings.memory_budget / (4 * sizeof(point_t)), 1024);
+		size_t points_per_page = std::max<size_t>(settings.page_size / sizeof(point_t), 1);
+		std::vector<point_t> batch(batch_size);
+		size_t n;
+
+		//find min, max
+		static constexpr float Infinity = std::numeric_limits<float>::infinity();
+		cgv::vec3 min = { Infinity , Infinity , Infinity };
+		cgv::vec3 max = { -Infinity , -Infinity , -Infinity };
+		int64_t num_points = 0;
+		if (!source.rewind())
+			return false;
+		while ((n = source.read(batch.data(), batch_size)) > 0) {
+			for (size_t i = 0; i < n; ++i) {
+				const cgv::vec3& p = batch[i].position();
+				min.x() = std::min(min.x(), p.x());
+				min.y() = std::min(min.y(), p.y());
+				min.z() = std::min(min.z(), p.z());
+
+				max.x() = std::max(max.x(), p.x());
+				max.y() = std::max(max.y(), p.y());
+				max.z() = std::max(max.z(), p.z());
+			}
+			num_points += n;
+		}
+
+		cgv::vec3 ext = max - min;
+		float cube_size = num_points > 0 ? *std::max_element(ext.begin(), ext.end()) : 0.0f;
+		PagedIndexer indexer;
+
+		//prevent some crashes caused by division by zero
+		if (cube_size == 0.f) {
+			if (!indexer.open(file_name, points_per_page, min, max) || !source.rewind())
+				return false;
+			while ((n = source.read(batch.data(), batch_size)) > 0) {
+				//all points have the same position and are assigned to the root level
+				indexer.write_points(batch.data(), allow_duplicate_elimination ? 1 : n, 0);
+				if (allow_duplicate_elimination)
+					break;
+			}
+			if (num_points > 0)
+				indexer.add_node("r", min, max, 0);
+			return indexer.close();
+		}
+		max = min + cgv::vec3(cube_size, cube_size, cube_size);
+
+		// chunks are loaded by all threads at the same time and are copied once more while building their hierarchy
+		size_t nr_threads = std::max(std::thread::hardware_concurrency(), 1u);
+		max_points_per_chunk = int(std::min<size_t>({ size_t(num_points / 20), settings.memory_budget / (3 * nr_threads * sizeof(point_t)), 10'000'000ull }));
+
+		// COUNT
+		int64_t grid_size = select_grid_size(num_points);
+		std::vector<std::atomic_int32_t> grid(grid_size * grid_size * grid_size);
+		int64_t num_counted = 0;
+		if (!source.rewind())
+			return false;
+		while ((n = source.read(batch.data(), batch_size)) > 0) {
+			const point_t* vertices = batch.data();
+			std::function<void(int64_t first_point, int64_t num_points)> processor = [this, &grid, &min, cube_size, grid_size, vertices](int64_t first_point, int64_t num_points) {
+				for (int64_t i = 0; i < num_points; i++) {
+					int64_t index = grid_index(vertices[first_point + i].position(), min, cube_size, grid_size);
+					grid[index].fetch_add(1, std::memory_order::memory_order_relaxed);
+				}
+			};
+			lod_counting_core(processor, n);
+			num_counted += n;
+		}
+		if (num_counted != num_points) {
+			std::cerr << "lod generator: point source changed between passes" << std::endl;
+			return false;
+		}
+
+		// DISTRIBUTE to temporary chunk files
+		Chunks<point_t> chunks;
+		chunks.min = min;
+		chunks.max = max;
+		NodeLUT lut = lod_createLUT(grid, grid_size, chunks.nodes, false);
+		grid.clear();
+
+		std::string temp_path = settings.temp_directory.empty() ? cgv::utils::file::get_path(file_name) : settings.temp_directory;
+		if (!temp_path.empty())
+			temp_path += "/";
+		temp_path += cgv::utils::file::get_file_name(file_name) + ".";
+		auto chunk_file_name = [&temp_path](const ChunkNode<point_t>& chunk) {
+			return temp_path + chunk.id + ".chunk";
+		};
+		auto remove_chunk_files = [&]() {
+			for (const auto& chunk : chunks.nodes)
+				cgv::utils::file::remove(chunk_file_name(chunk));
+		};
+		remove_chunk_files();
+
+		std::vector<std::vector<point_t>> buffers(chunks.nodes.size());
+		std::mutex mtx_buffers;
+		size_t num_buffered = 0;
+		auto flush_buffers = [&]() {
+			bool success = true;
+			for (size_t ci = 0; ci < buffers.size(); ++ci) {
+				if (buffers[ci].empty())
+					continue;
+				FILE* fp = fopen(chunk_file_name(chunks.nodes[ci]).c_str(), "ab");
+				if (!fp || fwrite(buffers[ci].data(), sizeof(point_t), buffers[ci].size(), fp) != buffers[ci].size())
+					success = false;
+				if (fp)
+					fclose(fp);
+				std::vector<point_t>().swap(buffers[ci]);
+			}
+			num_buffered = 0;
+			return success;
+		};
+		if (!source.rewind()) {
+			remove_chunk_files();
+			return false;
+		}
+		while ((n = source.read(batch.data(), batch_size)) > 0) {
+			const point_t* vertices = batch.data();
+			std::function<void(int64_t first_point, int64_t num_points)> processor = [this, &lut, &buffers, &mtx_buffers, &min, cube_size, grid_size, vertices](int64_t first_point, int64_t num_points) {
+				//create a bucket for each chunk
+				std::vector<std::vector<point_t>> buckets(buffers.size());
+				for (int64_t i = first_point; i < first_point + num_points; ++i)
+					buckets[lut.grid[grid_index(vertices[i].position(), min, cube_size, grid_size)]].push_back(vertices[i]);
+
+				std::lock_guard<std::mutex> lock(mtx_buffers);
+				for (size_t ci = 0; ci < buckets.size(); ++ci)
+					buffers[ci].insert(buffers[ci].end(), buckets[ci].begin(), buckets[ci].end());
+			};
+			lod_counting_core(processor, n);
+			num_buffered += n;
+			if (num_buffered >= batch_size && !flush_buffers()) {
+				remove_chunk_files();
+				return false;
+			}
+		}
+		if (!flush_buffers()) {
+			remove_chunk_files();
+			return false;
+		}
+
+		// INDEXING with chunks loaded on demand
+		if (!indexer.open(file_name, points_per_page, min, max)) {
+			remove_chunk_files();
+			return false;
+		}
+		std::atomic<bool> load_failed(false);
+		auto load_chunk = [&chunk_file_name, &load_failed](ChunkNode<point_t>& chunk) {
+			chunk.pc_data = std::make_shared<ChunkPointCloud<point_t>>(chunk.numPoints);
+			std::string chunk_file = chunk_file_name(chunk);
+			FILE* fp = fopen(chunk_file.c_str(), "rb");
+			size_t num_read = fp ? fread(chunk.pc_data->vertices.data(), sizeof(point_t), chunk.numPoints, fp) : 0;
+			if (fp)
+				fclose(fp);
+			if (num_read != size_t(chunk.numPoints)) {
+				load_failed = true;
+				chunk.pc_data->vertices.resize(num_read);
+			}
+			chunk.pc_data->numPointsWritten = int(num_read);
+			cgv::utils::file::remove(chunk_file);
+		};
+		SamplerRandom<point_t> sampler;
+		indexing(chunks, indexer, sampler, load_chunk);
+
+		bool success = indexer.close() && !load_failed;
+		if (success && indexer.header.nr_points != uint64_t(num_points)) {
+			std::cout << "lod generator: some points were eliminated!\n";
+		}
+		return success;
+	}
+
+	template <typename point_t>
+	bool PagedLODFile<point_t>::open(const std::string& file_name, size_t cache_budget)
+	{
+		close();
+		fp = fopen(file_name.c_str(), "rb");
+		if (!fp)
+			return false;
+		PagedLODHeader expected;
+		if (fread(&header, sizeof(PagedLODHeader), 1, fp) != 1 ||
+			memcmp(header.magic, expected.magic, sizeof(expected.magic)) != 0 ||
+			header.version != expected.version || header.point_size != sizeof(point_t) || header.points_per_page == 0 ||
+			!seek_file(fp, header.node_table_offset)) {
+			close();
+			return false;
+		}
+		nodes.resize(header.nr_nodes);
+		for (auto& entry : nodes) {
+			uint32_t name_length;
+			if (fread(&entry.first_point, sizeof(uint64_t), 1, fp) != 1 ||
+				fread(&entry.nr_points, sizeof(uint64_t), 1, fp) != 1 ||
+				fread(entry.min, sizeof(float), 3, fp) != 3 ||
+				fread(entry.max, sizeof(float), 3, fp) != 3 ||
+				fread(&name_length, sizeof(uint32_t), 1, fp) != 1) {
+				close();
+				return false;
+			}
+			entry.name.resize(name_length);
+			if (name_length > 0 && fread(&entry.name[0], 1, name_length, fp) != name_length) {
+				close();
+				return false;
+			}
+		}
+		max_nr_cached_pages = std::max<size_t>(cache_budget / (header.points_per_page * sizeof(point_t)), 1);
+		return true;
+	}
+
+	template <typename point_t>
+	void PagedLODFile<point_t>::close()
+	{
+		if (fp)
+			fclose(fp);
+		fp = nullptr;
+		header = PagedLODHeader();
+		nodes.clear();
+		pages.clear();
+		page_lut.clear();
+	}
+
+	template <typename point_t>
+	const std::vector<point_t>& PagedLODFile<point_t>::get_page(uint64_t page_index)
+	{
+		auto iter = page_lut.find(page_index);
+		if (iter != page_lut.end()) {
+			pages.splice(pages.begin(), pages, iter->second);
+			return pages.front().second;
+		}
+		// reuse the storage of the least recently used page
+		std::vector<point_t> page;
+		if (pages.size() >= max_nr_cached_pages) {
+			page_lut.erase(pages.back().first);
+			page.swap(pages.back().second);
+			pages.pop_back();
+		}
+		uint64_t first_point = page_index * header.points_per_page;
+		uint64_t nr_points = first_point < header.nr_points ? std::min(header.points_per_page, header.nr_points - first_point) : 0;
+		page.resize(size_t(nr_points));
+		if (nr_points > 0) {
+			if (!seek_file(fp, sizeof(PagedLODHeader) + first_point * sizeof(point_t)))
+				page.clear();
+			else
+				page.resize(fread(page.data(), sizeof(point_t), page.size(), fp));
+		}
+		pages.emplace_front(page_index, std::move(page));
+		page_lut[page_index] = pages.begin();
+		return pages.front().second;
+	}
+
+	template <typename point_t>
+	bool PagedLODFile<point_t>::read_node(size_t ni, std::vector<point_t>& points)
+	{
+		points.clear();
+		if (!fp || ni >= nodes.size())
+			return false;
+		const PagedLODNode& entry = nodes[ni];
+		uint64_t end_point = entry.first_point + entry.nr_points;
+		for (uint64_t pi = entry.first_point; pi < end_point; ) {
+			uint64_t page_index = pi / header.points_per_page;
+			uint64_t page_begin = page_index * header.points_per_page;
+			const std::vector<point_t>& page = get_page(page_index);
+			uint64_t end = std::min(end_point, page_begin + page.size());
+			if (end <= pi)
+				return false;
+			points.insert(points.end(), page.begin() + size_t(pi - page_begin), page.begin() + size_t(end - page_begin));
+			pi = end;
+		}
+		return true;
+	}
+
+	template <typename point_t>
+	bool PagedLODFile<point_t>::read_all(std::vector<point_t>& points)
+	{
+		if (!fp)
+			return false;
+		size_t nr_points_before = points.size();
+		uint64_t nr_pages = (header.nr_points + header.points_per_page - 1) / header.points_per_page;
+		for (uint64_t page_index = 0; page_index < nr_pages; ++page_index) {
+			const std::vector<point_t>& page = get_page(page_index);
+			points.insert(points.end(), page.begin(), page.end());
+		}
+		return points.size() - nr_points_before == header.nr_points;
+	}
 	
 
 
@@ -1543,6 +2046,11 @@ struct SamplerRandom : public Sampler<point_t> {
 	using cgv::pointcloud::octree::SimpleLODPoint;
 	using cgv::pointcloud::octree::GenericLODPoint;
 	using cgv::pointcloud::octree::ref_octree_lod_generator;
+	using cgv::pointcloud::octree::OutOfCoreSettings;
+	using cgv::pointcloud::octree::PointSource;
+	using cgv::pointcloud::octree::ArrayPointSource;
+	using cgv::pointcloud::octree::FilePointSource;
+	using cgv::pointcloud::octree::PagedLODFile;
 } //pointcloud namespace
 } //cgv namespace
 
@@ -1,12 +1,19 @@
 #include <cgv/math/permute.h>
 #include <cgv/math/det.h>
 #include "point_cloud.h"
+#include <cgv/os/task_scheduler.h>
+#include "morton.h"
 #include <cgv/utils/file.h>
+#include <cgv/utils/mapped_file.h>
 #include <cgv/utils/stopwatch.h>
 #include <cgv/utils/scan.h>
 #include <cgv/utils/advanced_scan.h>
 #include <cgv/media/mesh/obj_reader.h>
 #include <fstream>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <cgv/utils/trace_profiler.h>
 
 #pragma warning(disable:4996)
 
@@ -285,6 +292,63 @@ void point_cloud::permute(std::vector<Idx>& perm, bool permute_component_indices
 		cgv::math::permute_vector(I, perm);
 	if (permute_component_indices && has_components())
 		cgv::math::permute_vector(component_indices, perm);
+	if (lods.size() == P.size() && !lods.empty())
+		cgv::math::permute_vector(lods, perm);
+	if (labels.size() == P.size() && !labels.empty())
+		cgv::math::permute_vector(labels, perm);
+}
+
+point_cloud::Box point_cloud::compute_morton_cube() const
+{
+	Box box;
+	for (const Pnt& p : P)
+		box.add_point(p);
+	if (P.empty())
+		return box;
+	Crd extent = std::max(box.get_extent()[cgv::math::max_index(box.get_extent())], std::numeric_limits<Crd>::min());
+	return Box(box.get_min_pnt(), box.get_min_pnt() + Dir(extent));
+}
+
+void point_cloud::compute_morton_codes(std::vector<uint64_t>& morton_codes, unsigned nr_threads) const
+{
+	morton_codes.resize(get_nr_points());
+	Box cube = compute_morton_cube();
+	const Pnt origin = cube.get_min_pnt();
+	// cells of level l have edge length extent/2^l, such that the maximum coordinate is clamped into the last cell
+	const Crd max_crd = Crd((1 << 21) - 1);
+	const Crd scale = Crd(1 << 21) / cube.get_extent()[0];
+	cgv::os::parallel_chunks(get_nr_points(), cgv::os::choose_nr_chunks(get_nr_points(), nr_threads), [&](unsigned, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			Pnt q = scale * (P[i] - origin);
+			morton_codes[i] = cgv::pointcloud::morton_encode_magicbits(
+				unsigned(std::min(q[0], max_crd)), unsigned(std::min(q[1], max_crd)), unsigned(std::min(q[2], max_crd)));
+		}
+	});
+}
+
+void point_cloud::sort_morton(std::vector<uint64_t>* morton_codes, unsigned nr_threads)
+{
+	size_t n = get_nr_points();
+	std::vector<uint64_t> codes_local;
+	std::vector<uint64_t>& codes = morton_codes ? *morton_codes : codes_local;
+	compute_morton_codes(codes, nr_threads);
+	std::vector<Idx> order(n), order_tmp(n);
+	std::vector<uint64_t> codes_tmp(n);
+	for (size_t i = 0; i < n; ++i)
+		order[i] = Idx(i);
+	// sort each component range separately, such that points stay in their component
+	Idx nr_ranges = has_components() ? Idx(get_nr_components()) : 1;
+	for (Idx ci = 0; ci < nr_ranges; ++ci) {
+		size_t begin = begin_index(has_components() ? ci : -1), end = end_index(has_components() ? ci : -1);
+		if (end - begin < 2)
+			continue;
+		cgv::os::parallel_radix_sort(end - begin, &codes[begin], &order[begin], &codes_tmp[begin], &order_tmp[begin], 64, cgv::os::choose_nr_chunks(end - begin, nr_threads));
+	}
+	// permute moves point i to position perm[i]
+	std::vector<Idx>& perm = order_tmp;
+	for (size_t j = 0; j < n; ++j)
+		perm[order[j]] = Idx(j);
+	permute(perm, false);
 }
 
 /// translate by direction
@@ -465,6 +529,7 @@ void point_cloud::resize(size_t nr_points)
 
 bool point_cloud::read(const string& _file_name)
 {
+	CGV_PROFILE_ZONE("point_cloud::read");
 	string ext = to_lower(get_extension(_file_name));
 	bool success = false;
 	if (ext == "bpc")
@@ -634,6 +699,7 @@ bool point_cloud::read_component_transformations(const std::string& file_name)
 
 bool point_cloud::write(const string& _file_name)
 {
+	CGV_PROFILE_ZONE("point_cloud::write");
 	string ext = to_lower(get_extension(_file_name));
 	if (ext == "bpc")
 		return write_bin(_file_name);
@@ -734,38 +800,22 @@ bool point_cloud::read_xyz(const std::string& file_name)
 	split_to_lines(content, lines);
 	std::cout << "split data into " << lines.size() << " lines. ";	watch.add_time();
 
-	bool do_parse = false;
-	unsigned i;
-	for (i = 0; i<lines.size(); ++i) {
+	for (unsigned i = 0; i < lines.size(); ++i) {
 		if (lines[i].empty())
 			continue;
-
-		if (true) {
-			Pnt p;
-			int c[3], I;
-			char tmp = lines[i].end[0];
-			content[lines[i].end - content.c_str()] = 0;
-			sscanf(lines[i].begin, "%f %f %f %d %d %d %d", &p[0], &p[1], &p[2], c, c + 1, c + 2, &I);
-			content[lines[i].end - content.c_str()] = tmp;
-			P.push_back(p);
-			C.push_back(Clr(byte_to_color_component(c[0]), byte_to_color_component(c[1]), byte_to_color_component(c[2])));
-		}
-		else {
-
-			vector<token> numbers;
-			tokenizer(lines[i]).bite_all(numbers);
-			double values[7];
-			unsigned n = min(7, (int)numbers.size());
-			unsigned j;
-			for (j = 0; j < n; ++j) {
-				if (!is_double(numbers[j].begin, numbers[j].end, values[j]))
-					break;
-			}
-			if (j >= 3)
-				P.push_back(Pnt((Crd)values[0], (Crd)values[1], (Crd)values[2]));
-			if (j >= 6)
-				C.push_back(Clr(float_to_color_component(values[3]), float_to_color_component(values[4]), float_to_color_component(values[5])));
+		float values[7];
+		size_t n = parse_floats(lines[i].begin, lines[i].end, values, 7);
+		if (n < 3)
+			continue;
+		P.push_back(Pnt(values[0], values[1], values[2]));
+		// once a line specifies a color, points without color are white such that colors stay aligned with points
+		if (n >= 6) {
+			C.resize(P.size() - 1, Clr(byte_to_color_component(255)));
+			C.push_back(Clr(byte_to_color_component(int(values[3])), byte_to_color_component(int(values[4])), 
+				byte_to_color_component(int(values[5]))));
 		}
+		else if (!C.empty())
+			C.push_back(Clr(byte_to_color_component(255)));
 		if ((P.size() % 100000) == 0)
 			cout << "read " << P.size() << " points" << endl;
 	}
@@ -786,45 +836,21 @@ bool point_cloud::read_txt(const std::string& file_name)
 	split_to_lines(content, lines);
 	std::cout << "split data into " << lines.size() << " lines. ";	watch.add_time();
 
-	bool do_parse = false;
-	unsigned i;
-	for (i = 0; i < lines.size(); ++i) {
+	for (unsigned i = 0; i < lines.size(); ++i) {
 		if (lines[i].empty())
 			continue;
-
-		if (true) {
-			Pnt p;
-			int icol[3], iint;
-			double dcol[3];
-			char tmp = lines[i].end[0];
-			content[lines[i].end - content.c_str()] = 0;
-			if (sscanf(lines[i].begin, "%f %f %f %d %d %d %d", &p[0], &p[1], &p[2], &iint, icol, icol + 1, icol + 2) == 7) 
-			{
-				P.push_back(p);
-				C.push_back(Clr(byte_to_color_component(icol[0]), byte_to_color_component(icol[1]),
-								byte_to_color_component(icol[2])));
-			}
-			else if (sscanf(lines[i].begin, "%f %f %f %lf %lf %lf", &p[0], &p[1], &p[2], dcol, dcol + 1, dcol + 2) == 6) {
-				P.push_back(p);
-				C.push_back(Clr(float_to_color_component(dcol[0]), float_to_color_component(dcol[1]),
-								float_to_color_component(dcol[2])));
-			}
-			content[lines[i].end - content.c_str()] = tmp;
+		// either x y z I r g b with byte colors or x y z r g b with float colors
+		float values[7];
+		size_t n = parse_floats(lines[i].begin, lines[i].end, values, 7);
+		if (n == 7) {
+			P.push_back(Pnt(values[0], values[1], values[2]));
+			C.push_back(Clr(byte_to_color_component(int(values[4])), byte_to_color_component(int(values[5])),
+							byte_to_color_component(int(values[6]))));
 		}
-		else {
-			vector<token> numbers;
-			tokenizer(lines[i]).bite_all(numbers);
-			double values[7];
-			unsigned n = min(7, (int)numbers.size());
-			unsigned j;
-			for (j = 0; j < n; ++j) {
-				if (!is_double(numbers[j].begin, numbers[j].end, values[j]))
-					break;
-			}
-			if (j >= 3)
-				P.push_back(Pnt((Crd)values[0], (Crd)values[1], (Crd)values[2]));
-			if (j >= 6)
-				C.push_back(Clr(float_to_color_component(values[3]), float_to_color_component(values[4]), float_to_color_component(values[5])));
+		else if (n == 6) {
+			P.push_back(Pnt(values[0], values[1], values[2]));
+			C.push_back(Clr(float_to_color_component(values[3]), float_to_color_component(values[4]),
+							float_to_color_component(values[5])));
 		}
 		if ((P.size() % 100000) == 0)
 			cout << "read " << P.size() << " points" << endl;
@@ -1087,21 +1113,22 @@ bool point_cloud::write_lpc(const std::string& file_name) {
 
 bool point_cloud::read_bin(const string& file_name)
 {
-	FILE* fp = fopen(file_name.c_str(), "rb");
-	if (!fp)
+	mapped_file mf(file_name);
+	if (!mf.is_open())
 		return false;
+	mf.advise(mapped_file::SEQUENTIAL);
 	Cnt n, m;
 	cgv::type::uint32_type flags = 0;
 
 	bool success =
-		fread(&n,sizeof(Cnt),1,fp) == 1 &&
-		fread(&m,sizeof(Cnt),1,fp) == 1;
+		mf.read(n) &&
+		mf.read(m);
 
 	if (success) {
 		clear();
 		if (n == 0) {
 			n = m;
-			success = fread(&flags, sizeof(flags), 1, fp) == 1;
+			success = mf.read(flags);
 		}
 		else {
 			flags += (m >= 2 * n) ? BPC_HAS_CLRS : 0;
@@ -1114,10 +1141,10 @@ bool point_cloud::read_bin(const string& file_name)
 
 	if (success) {
 		P.resize(n);
-		success = fread(&P[0][0], sizeof(Pnt), n, fp) == n;
+		success = mf.read_array(&P[0], n);
 		if (flags & BPC_HAS_NMLS) {
 			N.resize(m);
-			success = success && (fread(&N[0][0], sizeof(Nml), m, fp) == m);
+			success = success && mf.read_array(&N[0], m);
 		}
 		if (flags & BPC_HAS_CLRS) {
 			bool byte_colors_in_file = !((flags & BPC_HAS_BYTE_CLRS) != 0);
@@ -1128,12 +1155,12 @@ bool point_cloud::read_bin(const string& file_name)
 #endif
 			C.resize(n);
 			if (byte_colors_in_file == byte_colors_in_pc)
-				success = success && fread(&C[0][0], sizeof(Clr), n, fp) == n;
+				success = success && mf.read_array(&C[0], n);
 			else {
 				if (byte_colors_in_file) {
 					std::vector<cgv::media::color<cgv::type::uint8_type> > tmp;
 					tmp.resize(n);
-					success = success && fread(&tmp[0][0], sizeof(cgv::media::color<cgv::type::uint8_type>), n, fp) == n;
+					success = success && mf.read_array(&tmp[0], n);
 					if (success) {
 						for (size_t i = 0; i < n; ++i)
 							C[i] = Clr(byte_to_color_component(tmp[i][0]), byte_to_color_component(tmp[i][1]), byte_to_color_component(tmp[i][2]));
@@ -1142,8 +1169,7 @@ bool point_cloud::read_bin(const string& file_name)
 				else {
 					std::vector<cgv::media::color<float> > tmp;
 					tmp.resize(n);
-					size_t cnt = fread(&tmp[0][0], sizeof(cgv::media::color<float>), n, fp);
-					success = success && cnt == n;
+					success = success && mf.read_array(&tmp[0], n);
 					if (success) {
 						for (size_t i = 0; i < n; ++i)
 							C[i] = Clr(float_to_color_component(tmp[i][0]), float_to_color_component(tmp[i][1]), float_to_color_component(tmp[i][2]));
@@ -1154,36 +1180,36 @@ bool point_cloud::read_bin(const string& file_name)
 		}
 		if (flags & BPC_HAS_TCS) {
 			T.resize(n);
-			success = success && fread(&T[0][0], sizeof(TexCrd), n, fp) == n;
+			success = success && mf.read_array(&T[0], n);
 		}
 		if (flags & BPC_HAS_PIXCRDS) {
 			I.resize(n);
-			success = success && fread(&I[0][0], sizeof(PixCrd), n, fp) == n;
+			success = success && mf.read_array(&I[0], n);
 		}
 		if (flags & BPC_HAS_COMPS) {
 			cgv::type::uint32_type nr_comps;
-			success = success && fread(&nr_comps, sizeof(nr_comps), 1, fp) == 1;
+			success = success && mf.read(nr_comps);
 			if (success) {
 				components.resize(nr_comps);
-				success = success && fread(&components[0], sizeof(component_info), nr_comps, fp) == nr_comps;
+				success = success && mf.read_array(&components[0], nr_comps);
 				component_indices.resize(n);
 				for (unsigned i = 0; i < nr_comps; ++i)
 					for (unsigned j = unsigned(components[i].index_of_first_point); j < components[i].index_of_first_point + components[i].nr_points; ++j)
 						component_indices[j] = i;
 				if (flags & BPC_HAS_COMP_CLRS) {
 					component_colors.resize(nr_comps);
-					success = success && fread(&component_colors[0], sizeof(RGBA), nr_comps, fp) == nr_comps;
+					success = success && mf.read_array(&component_colors[0], nr_comps);
 				}
 				if (flags & BPC_HAS_COMP_TRANS) {
 					component_rotations.resize(nr_comps);
 					component_translations.resize(nr_comps);
-					success = success && fread(&component_rotations[0], sizeof(Qat), nr_comps, fp) == nr_comps;
-					success = success && fread(&component_translations[0], sizeof(Dir), nr_comps, fp) == nr_comps;
+					success = success && mf.read_array(&component_rotations[0], nr_comps);
+					success = success && mf.read_array(&component_translations[0], nr_comps);
 				}
 			}
 		}
 	}
-	return fclose(fp) == 0 && success;
+	return success;
 }
 
 bool point_cloud::read_obj(const string& _file_name) 
@@ -1388,25 +1414,25 @@ bool point_cloud::write_e57(const std::string& file_name) const
 
 bool point_cloud::read_ascii(const string& file_name)
 {
-	ifstream is(file_name.c_str());
-	if (is.fail()) 
+	string content;
+	if (!cgv::utils::file::read(file_name, content, true))
 		return false;
 	clear();
-	while (!is.eof()) {
-		char buffer[4096];
-		is.getline(buffer,4096);
-		float x, y, z, nx, ny, nz, r, g, b;
-		unsigned int n = sscanf(buffer, "%f %f %f %f %f %f %f %f %f", &x, &y, &z, &nx, &ny, &nz, &r, &g, &b);
+	vector<line> lines;
+	split_to_lines(content, lines);
+	for (const auto& l : lines) {
+		float v[9];
+		size_t n = parse_floats(l.begin, l.end, v, 9);
 		if (n == 3 || n == 6 || n == 9)
-			P.push_back(Pnt(x,y,z));
+			P.push_back(Pnt(v[0], v[1], v[2]));
 		if (n == 6) {
 			if (no_normals_contained)
-				C.push_back(Clr(float_to_color_component(nx), float_to_color_component(ny), float_to_color_component(nz)));
+				C.push_back(Clr(float_to_color_component(v[3]), float_to_color_component(v[4]), float_to_color_component(v[5])));
 			else
-				N.push_back(Nml(nx,ny,nz));
+				N.push_back(Nml(v[3], v[4], v[5]));
 		}
 		if (n == 9)
-			C.push_back(Clr(float_to_color_component(r), float_to_color_component(g), float_to_color_component(b)));
+			C.push_back(Clr(float_to_color_component(v[6]), float_to_color_component(v[7]), float_to_color_component(v[8])));
 	}
 	return true;
 }
@@ -1884,6 +1910,7 @@ point_cloud::Cnt point_cloud::collect_valid_image_neighbors(size_t pi, const ind
 
 void point_cloud::estimate_normals(const index_image& img, Crd distance_threshold, Idx ci, int* nr_isolated, int* nr_iterations, int* nr_left_over)
 {
+	CGV_PROFILE_ZONE("point_cloud::estimate_normals");
 	if (!has_pixel_coordinates())
 		return;
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
 #include <cgv/utils/statistics.h>
 #include <cgv/math/fvec.h>
 #include <cgv/math/fmat.h>
@@ -256,6 +257,12 @@ protected:
 	void clip(const Box clip_box);
 	/// permute points
 	void permute(std::vector<Idx>& perm, bool permute_component_indices);
+	/// return the cube around the untransformed points that is quantized to 21 bits per axis to compute morton codes
+	Box compute_morton_cube() const;
+	/// compute one 63 bit morton code per point with respect to the morton cube, nr_threads of 0 uses all hardware threads
+	void compute_morton_codes(std::vector<uint64_t>& morton_codes, unsigned nr_threads = 0) const;
+	/// reorder the points of each component along the z-order curve with a parallel radix sort, such that component ranges stay valid, optionally return the sorted morton codes
+	void sort_morton(std::vector<uint64_t>* morton_codes = 0, unsigned nr_threads = 0);
 	/// translate by adding direction vector dir to point positions and update bounding box
 	void translate(const Dir& dir, Idx component_index = -1);
 	/// rotate points and normals with quaternion
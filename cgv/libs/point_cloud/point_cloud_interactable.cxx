@@ -2,7 +2,7 @@
 #include "point_cloud_interactable.h"
 #include <cgv/gui/trigger.h>
 #include <cgv/gui/key_event.h>
-#include <libs/point_cloud/ann_tree.h>
+#include <libs/point_cloud/kd_tree.h>
 #include <cgv/base/find_action.h>
 #include <cgv/signal/rebind.h>
 #include <cgv/base/import.h>
@@ -145,7 +145,7 @@ void point_cloud_interactable::ensure_tree_ds()
 	if (tree_ds_out_of_date) {
 		if (tree_ds)
 			delete tree_ds;
-		tree_ds = new ann_tree;
+		tree_ds = new kd_tree;
 		tree_ds->build(pc);
 		tree_ds_out_of_date = false;
 	}
@@ -161,7 +161,9 @@ void point_cloud_interactable::build_neighbor_graph()
 	ng.clear();
 	ensure_tree_ds();
 	cgv::utils::statistics he_stats;
-	ng.build(pc.get_nr_points(), k, *tree_ds, &he_stats);
+	std::vector<Idx> knn(size_t(pc.get_nr_points()) * k);
+	tree_ds->find_neighbors(k, knn.data());
+	ng.build_from_knn(Cnt(pc.get_nr_points()), k, knn.data(), &he_stats);
 	if (do_symmetrize)
 		ng.symmetrize();
 	on_point_cloud_change_callback(PCC_NEIGHBORGRAPH_CREATE);
@@ -174,47 +176,23 @@ void point_cloud_interactable::build_neighbor_graph()
 
 void point_cloud_interactable::build_neighbor_graph_componentwise()
 {
-	// prepare neighbor graph data structure
-	ng.clear();
-	ng.resize(pc.get_nr_points());
-
-	// iterate components
+	// iterate components, kd_tree returns point indices such that rows of knn can be filled per component
+	std::vector<Idx> knn(size_t(pc.get_nr_points()) * k, Idx(-1));
 	std::cout << "build_neighbor_graph_componentwise(" << pc.get_nr_components() << "):"; std::cout.flush();
 	for (Idx ci = 0; ci < (Idx)pc.get_nr_components(); ++ci) {
-		std::cout << " " << ci << ":"; std::cout.flush();
-		ann_tree* T = new ann_tree;
+		std::cout << " " << ci; std::cout.flush();
+		kd_tree T;
 		std::vector<Idx> C(1, Idx(ci));
-		T->build(pc, C);
-		Idx n = Idx(pc.component_point_range(ci).nr_points);
-		Idx offset = Idx(pc.component_point_range(ci).index_of_first_point);
-		for (Idx l = 0; l < n; ++l) {
-			Idx i = l + offset;
-			std::vector<Idx>& Ni = ng[i];
-			T->extract_neighbors(i, k, Ni);
-			for (auto& ni : Ni) 
-				ni += offset;
-			ng.nr_half_edges += k;
-		}
-		delete T;
-		std::cout << "*"; std::cout.flush();
-
-		if (do_symmetrize) {
-			for (Idx l = 0; l < n; ++l) {
-				Idx i = l + offset;
-				std::vector<Idx>& Ni = ng[i];
-				for (size_t o = 0; o < Ni.size(); ++o) {
-					std::vector<Idx>& Nj = ng[Ni[o]];
-					if (std::find(Nj.begin(), Nj.end(), i) == Nj.end()) {
-						Nj.push_back(i);
-						++ng.nr_half_edges;
-					}
-				}
-			}
-			std::cout << "s"; std::cout.flush();
-		}
+		T.build(pc, C);
+		T.find_neighbors(k, knn.data());
 	}
 	std::cout << std::endl;
 
+	// edges do not cross components, such that the graph can be built and symmetrized for all components at once
+	ng.build_from_knn(Cnt(pc.get_nr_points()), k, knn.data());
+	if (do_symmetrize)
+		ng.symmetrize();
+
 	on_point_cloud_change_callback(PCC_NEIGHBORGRAPH_CREATE);
 }
 
@@ -6,7 +6,7 @@
 #include <cgv/gui/trigger.h>
 #include <cgv/base/register.h>
 #include "gl_point_cloud_drawable.h"
-#include "ann_tree.h"
+#include "kd_tree.h"
 #include "neighbor_graph.h"
 #include "normal_estimator.h"
 
@@ -117,13 +117,13 @@ protected:
 	} interact_state;
 	//@}
 
-	/**@name ann tree, neighbor graph and picking*/
+	/**@name kd tree, neighbor graph and picking*/
 	//@{
-	/// whether ann tree needs rebuild
+	/// whether kd tree needs rebuild
 	bool tree_ds_out_of_date;
-	/// the ann tree is used for nearest neighbor queries
-	ann_tree* tree_ds;
-	/// ensure that ann tree is built and current
+	/// the kd tree is used for nearest neighbor queries
+	kd_tree* tree_ds;
+	/// ensure that kd tree is built and current
 	void ensure_tree_ds();
 	/// k parameter for building neighbor graph
 	unsigned k;
@@ -137,7 +137,7 @@ protected:
 	void build_neighbor_graph_componentwise();
 	/// normal estimation member
 	normal_estimator ne;
-	/// whether to use ann_tree to acceleration picking
+	/// whether to use kd tree to acceleration picking
 	bool accelerate_picking;
 	/// return the point closest to ray through given mouse position
 	bool get_picked_point(int x, int y, unsigned& index);
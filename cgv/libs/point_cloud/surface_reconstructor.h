@@ -243,8 +243,10 @@ struct CGV_API surface_reconstructor : public point_cloud_types
 	/// whether to print debug information on grow events
 	bool debug_events;
 	double valid_length_scale;
+	/// type of priority queue of grow events
+	typedef cgv::data::dynamic_priority_queue<grow_event> grow_queue;
 	/// store all grow events
-	cgv::data::dynamic_priority_queue<grow_event> grow_events;
+	grow_queue grow_events;
 	/// store for each vertex the index of its first grow event or -1 if non present
 	std::vector<int> first_grow_event;
 	/// statistics over the quality of the grow event triangles
@@ -261,17 +263,19 @@ struct CGV_API surface_reconstructor : public point_cloud_types
 	bool is_valid_corner_grow_event(const grow_event& ge, unsigned int& nr_insert, unsigned int& nr_remove) const;
 	bool is_valid_edge_grow_event(const grow_event& ge, unsigned int& nr_insert, unsigned int& nr_remove) const;
 	bool validate_event(grow_event& ge) const;
-	void add_grow_event(const grow_event& ge);
+	void add_grow_event(const grow_event& ge, grow_queue& queue);
 	/// check corner grow event and insert to queue
-	bool consider_corner_grow_event(unsigned int vi,unsigned int j, unsigned int k);
+	bool consider_corner_grow_event(unsigned int vi,unsigned int j, unsigned int k, grow_queue& queue);
 	/// check edge grow event and insert to queue
-	bool consider_edge_grow_event(unsigned int vi,unsigned int j, unsigned int k, Direction dir);
+	bool consider_edge_grow_event(unsigned int vi,unsigned int j, unsigned int k, Direction dir, grow_queue& queue);
 	/// determine all grow events of the given vi
-	void consider_grow_events(unsigned int vi);
+	void consider_grow_events(unsigned int vi, grow_queue& queue);
 	/// build priority queue of events
 	void build_grow_queue(const std::vector<unsigned int>& T);
 	/// remove the grow events of a given vertex
-	void remove_grow_events(unsigned int vi);
+	void remove_grow_events(unsigned int vi, grow_queue& queue);
+	/// remove the top event from the queue and from the event list of its vertex
+	void drop_top_grow_event(grow_queue& queue);
 	///
 	unsigned int insert_directed_edge(unsigned int vi, unsigned int vj);
 	///
@@ -282,8 +286,18 @@ struct CGV_API surface_reconstructor : public point_cloud_types
 	void connect_to_fan(unsigned int vi,unsigned int vj, unsigned int vk);
 	/// perform grow event
 	void perform_next_grow_event(std::vector<unsigned int>& T);
+	/// perform the best valid event of the given queue; if vertex_region is given, events of vertices whose 3-ring leaves their region are dropped and the vertices are marked in deferred
+	void perform_next_grow_event(std::vector<unsigned int>& T, grow_queue& queue, const std::vector<unsigned int>* vertex_region = 0, std::vector<unsigned char>* deferred = 0);
+	/// check if all vertices in the depth-ring of vi belong to the region of vi, where the 3-ring includes all data read or written by performing an event of vi
+	bool is_inside_region(unsigned int vi, const std::vector<unsigned int>& vertex_region, unsigned int depth = 3) const;
 	/// perform grow events till no more events are left and add the generated triangles to T
 	unsigned int grow_all(std::vector<unsigned int>& T);
+	/** perform the events of the grow queue built with build_grow_queue() in nr_regions spatially separated regions of
+	    about equal point count in parallel on nr_threads threads, where zero selects the number of cores. Events
+		 close to region borders are deferred and performed serially afterwards, such that seams are closed with the
+		 same manifold checks as in grow_all(). The result only depends on the number of regions. Return the number
+		 of performed events. */
+	unsigned int grow_all_parallel(std::vector<unsigned int>& T, unsigned int nr_regions = 0, unsigned int nr_threads = 0);
 	//@}
 
 
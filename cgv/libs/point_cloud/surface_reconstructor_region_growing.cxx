@@ -4,8 +4,10 @@
 #include <algorithm>
 #include <set>
 #include "surface_reconstructor.h"
+#include <cgv/os/task_scheduler.h>
 #include <cgv/math/functions.h>
 #include <cgv/utils/progression.h>
+#include <cgv/utils/trace_profiler.h>
 
 /*
 std::ostream& operator << (std::ostream& os, const grow_event& ge)
@@ -288,43 +290,43 @@ bool surface_reconstructor::validate_event(grow_event& ge) const
 	return true;
 }
 
-void surface_reconstructor::add_grow_event(const grow_event& ge)
+void surface_reconstructor::add_grow_event(const grow_event& ge, grow_queue& queue)
 {
 	if (debug_events) {
 		std::cout << "add event " << ge << std::endl;
 	}
-	unsigned int gi = grow_events.insert(ge);
-	if (ge.vi != grow_events[gi].vi) {
-		std::cout << "ups add event of wrong vertex " << grow_events[gi].vi << " instead of " << ge.vi << std::endl;
+	unsigned int gi = queue.insert(ge);
+	if (ge.vi != queue[gi].vi) {
+		std::cout << "ups add event of wrong vertex " << queue[gi].vi << " instead of " << ge.vi << std::endl;
 	}
-	if (first_grow_event[ge.vi] != -1 && ge.vi != grow_events[first_grow_event[ge.vi]].vi) {
-		std::cout << "ups add event of wrong vertex " << grow_events[first_grow_event[ge.vi]].vi << " instead of " << ge.vi << std::endl;
+	if (first_grow_event[ge.vi] != -1 && ge.vi != queue[first_grow_event[ge.vi]].vi) {
+		std::cout << "ups add event of wrong vertex " << queue[first_grow_event[ge.vi]].vi << " instead of " << ge.vi << std::endl;
 	}
-	grow_events[gi].next_grow_event_of_vertex = first_grow_event[ge.vi];
+	queue[gi].next_grow_event_of_vertex = first_grow_event[ge.vi];
 	first_grow_event[ge.vi] = gi;
 }
 
 /// check corner grow event and insert to queue
 bool surface_reconstructor::consider_corner_grow_event(
-	unsigned int vi,unsigned int j, unsigned int k)
+	unsigned int vi,unsigned int j, unsigned int k, grow_queue& queue)
 {
 	grow_event ge(vi,j,k,CORNER_GROW_EVENT);
 	if (validate_event(ge))
-		add_grow_event(ge);
+		add_grow_event(ge, queue);
 	return true;
 }
 
 /// check edge grow event and insert to queue
 bool surface_reconstructor::consider_edge_grow_event(
-	unsigned int vi,unsigned int j, unsigned int k, Direction dir)
+	unsigned int vi,unsigned int j, unsigned int k, Direction dir, grow_queue& queue)
 {
 	grow_event ge(vi,j,k,EDGE_GROW_EVENT,dir);
 	if (validate_event(ge))
-		add_grow_event(ge);
+		add_grow_event(ge, queue);
 	return true;
 }
 
-void surface_reconstructor::consider_grow_events(unsigned int vi)
+void surface_reconstructor::consider_grow_events(unsigned int vi, grow_queue& queue)
 {
 	unsigned int vj, j;
 	neighbor_graph& NG = *ng;
@@ -347,7 +349,7 @@ void surface_reconstructor::consider_grow_events(unsigned int vi)
 	do {
 		if (is_face_corner(vi,j)) {
 			if (!last_is_face_corner) {
-				consider_corner_grow_event(vi,block_end,j);
+				consider_corner_grow_event(vi,block_end,j,queue);
 				// check backward if we also have to consider an edge event
 				if (j != (block_end+1)%n) {
 					// check forward if we also have to consider an edge event
@@ -355,7 +357,7 @@ void surface_reconstructor::consider_grow_events(unsigned int vi)
 					unsigned int k = (j+n-1)%n;
 					int jk = NG.find(vj,Ni[k]);
 					if (jk == -1 || !is_face_corner(vj,jk))
-						consider_edge_grow_event(vi,k,j,BACKWARD);
+						consider_edge_grow_event(vi,k,j,BACKWARD,queue);
 				}
 			}
 			block_end = (j+1)%n;
@@ -372,7 +374,7 @@ void surface_reconstructor::consider_grow_events(unsigned int vi)
 					unsigned int nj = (unsigned int) Nj.size();
 					int jk = NG.find(vj,Ni[k]);
 					if (jk == -1 || !is_face_corner(vj,(jk+nj-1)%nj))
-						consider_edge_grow_event(vi,j,k,FORWARD);
+						consider_edge_grow_event(vi,j,k,FORWARD,queue);
 				}
 			}
 			last_is_face_corner = false;
@@ -403,7 +405,7 @@ void surface_reconstructor::build_grow_queue(const std::vector<unsigned int>& T)
 	cgv::utils::progression prog("build grow queue         ", n, 10);
 	for (unsigned int vi=0; vi<n; ++vi) {
 		prog.step();
-		consider_grow_events(vi);
+		consider_grow_events(vi, grow_events);
 	}
 
 	geqs.init();
@@ -413,7 +415,7 @@ void surface_reconstructor::build_grow_queue(const std::vector<unsigned int>& T)
 
 
 /// remove the grow events of a given vertex
-void surface_reconstructor::remove_grow_events(unsigned int vi)
+void surface_reconstructor::remove_grow_events(unsigned int vi, grow_queue& queue)
 {
 	if (debug_events)
 		std::cout << "remove " << vi << " events:";
@@ -421,14 +423,14 @@ void surface_reconstructor::remove_grow_events(unsigned int vi)
 	int nr = 0;
 	while (gi != -1) {
 		int gj = gi;
-		gi = grow_events[gi].next_grow_event_of_vertex;
-		if (vi != grow_events[gj].vi) {
-			std::cout << "ups removed event of wrong vertex " << grow_events[gj].vi << " instead of " << vi << std::endl;
+		gi = queue[gi].next_grow_event_of_vertex;
+		if (vi != queue[gj].vi) {
+			std::cout << "ups removed event of wrong vertex " << queue[gj].vi << " instead of " << vi << std::endl;
 		}
 		if (debug_events) {
-			std::cout << " " << grow_events[gj];
+			std::cout << " " << queue[gj];
 		}
-		grow_events.remove(gj);
+		queue.remove(gj);
 	}
 	if (debug_events)
 		std::cout << std::endl;
@@ -543,45 +545,77 @@ void surface_reconstructor::connect_to_fan(unsigned int vi,unsigned int vj, unsi
 	remove_directed_edges(vi, (j+1)%n, k);
 }
 
+/// remove the top event from the queue and from the event list of its vertex
+void surface_reconstructor::drop_top_grow_event(grow_queue& queue)
+{
+	const grow_event& ge = queue[queue.top()];
+	int* ge_idx_ref = &first_grow_event[ge.vi];
+	bool found = false;
+	while (*ge_idx_ref != -1) {
+		if (*ge_idx_ref == queue.top()) {
+			*ge_idx_ref = ge.next_grow_event_of_vertex;
+			found = true;
+			break;
+		}
+		else {
+			ge_idx_ref = &queue[*ge_idx_ref].next_grow_event_of_vertex;
+		}
+	}
+	if (!found) {
+		std::cout << "UPS could not find top event" << std::endl;
+	}
+	queue.pop();
+}
+
+/// check if all vertices in the 3-ring of vi belong to the region of vi
+bool surface_reconstructor::is_inside_region(unsigned int vi, const std::vector<unsigned int>& vertex_region, unsigned int depth) const
+{
+	// the neighborhood of a vertex is only read after the vertex has been found inside the region, as other regions modify their neighborhoods concurrently
+	const std::vector<Idx>& Ni = ng->at(vi);
+	for (unsigned int l = 0; l < Ni.size(); ++l) {
+		if (vertex_region[Ni[l]] != vertex_region[vi])
+			return false;
+		if (depth > 1 && !is_inside_region(Ni[l], vertex_region, depth - 1))
+			return false;
+	}
+	return true;
+}
+
 /// perform grow event
 void surface_reconstructor::perform_next_grow_event(std::vector<unsigned int>& T)
 {
-	if (grow_events.is_empty(grow_events.top())) {
+	perform_next_grow_event(T, grow_events);
+}
+
+/// perform the best valid event of the given queue
+void surface_reconstructor::perform_next_grow_event(std::vector<unsigned int>& T, grow_queue& queue, const std::vector<unsigned int>* vertex_region, std::vector<unsigned char>* deferred)
+{
+	if (queue.is_empty(queue.top())) {
 		std::cout << "ATTEMPT TO PERFORM EMPTY GROW EVENT" << std::endl;
 	}
 
 	while (true) {
-		grow_event& ge = grow_events[grow_events.top()];
+		grow_event& ge = queue[queue.top()];
+		if (vertex_region && !is_inside_region(ge.vi, *vertex_region)) {
+			(*deferred)[ge.vi] = 1;
+			drop_top_grow_event(queue);
+			if (queue.empty())
+				return;
+			continue;
+		}
 		if (!validate_event(ge) || 
 			 ( perform_intersection_tests &&
 				  !can_create_triangle_without_self_intersections(
 				  ge.vi,ng->at(ge.vi)[ge.j],ng->at(ge.vi)[ge.k]) ) ) {
-		   // ensure that we remove top event from the event list of its vertex
-			unsigned int vi = ge.vi;
-			int* ge_idx_ref = &first_grow_event[vi];
-			bool found = false;
-			while (*ge_idx_ref != -1) {
-				if (*ge_idx_ref == grow_events.top()) {
-					*ge_idx_ref = ge.next_grow_event_of_vertex;
-					found = true;
-					break;
-				}
-				else {
-					ge_idx_ref = &grow_events[*ge_idx_ref].next_grow_event_of_vertex;
-				}
-			}
-			if (!found) {
-				std::cout << "UPS could not find top event" << std::endl;
-			}
-			// before poping it
-			grow_events.pop();
-			if (grow_events.empty())
+		   // ensure that we remove top event from the event list of its vertex before poping it
+			drop_top_grow_event(queue);
+			if (queue.empty())
 				return;
 		}
 		else
 			break;
 	}
-	const grow_event& ge = grow_events[grow_events.top()];
+	const grow_event& ge = queue[queue.top()];
 	neighbor_graph& NG = *ng;
 	unsigned int vi = ge.vi;
 	const std::vector<Idx> &Ni = NG[vi];
@@ -632,8 +666,8 @@ void surface_reconstructor::perform_next_grow_event(std::vector<unsigned int>& T
 	// update priority queue
 	for (std::set<unsigned int>::const_iterator iter = VI.begin(); iter != VI.end(); ++iter) {
 		unsigned int vi = *iter;
-		remove_grow_events(vi);
-		consider_grow_events(vi);
+		remove_grow_events(vi, queue);
+		consider_grow_events(vi, queue);
 	}
 	// add new triangle
 	T.push_back(vi);
@@ -644,6 +678,7 @@ void surface_reconstructor::perform_next_grow_event(std::vector<unsigned int>& T
 /// perform grow events till no more events are left and add the generated triangles to T
 unsigned int surface_reconstructor::grow_all(std::vector<unsigned int>& T)
 {
+	CGV_PROFILE_ZONE("surface_reconstructor::grow_all");
 	int iter = 0;
 	while (!grow_events.empty()) {
 		perform_next_grow_event(T);
@@ -651,3 +686,81 @@ unsigned int surface_reconstructor::grow_all(std::vector<unsigned int>& T)
 	}
 	return iter;
 }
+
+namespace {
+	/// assign region indices [first_region, first_region+nr_regions) to the points in [begin,end) by recursive median splits along the longest extent
+	void split_into_regions(const point_cloud& pc, std::vector<unsigned int>::iterator begin, std::vector<unsigned int>::iterator end,
+		unsigned int first_region, unsigned int nr_regions, std::vector<unsigned int>& vertex_region)
+	{
+		if (nr_regions == 1 || end - begin < 2) {
+			for (auto iter = begin; iter != end; ++iter)
+				vertex_region[*iter] = first_region;
+			return;
+		}
+		point_cloud::Box box;
+		box.invalidate();
+		for (auto iter = begin; iter != end; ++iter)
+			box.add_point(pc.pnt(*iter));
+		int axis = box.get_max_extent_coord_index();
+		unsigned int nr_left = nr_regions / 2;
+		auto mid = begin + (end - begin) * nr_left / nr_regions;
+		std::nth_element(begin, mid, end, [&](unsigned int i, unsigned int j) { return pc.pnt(i)[axis] < pc.pnt(j)[axis]; });
+		split_into_regions(pc, begin, mid, first_region, nr_left, vertex_region);
+		split_into_regions(pc, mid, end, first_region + nr_left, nr_regions - nr_left, vertex_region);
+	}
+}
+
+/// perform grow events in spatially separated regions in parallel followed by a serial pass over the seams
+unsigned int surface_reconstructor::grow_all_parallel(std::vector<unsigned int>& T, unsigned int nr_regions, unsigned int nr_threads)
+{
+	CGV_PROFILE_ZONE("surface_reconstructor::grow_all_parallel");
+	if (!ng || !pc || grow_events.empty())
+		return 0;
+	if (nr_threads == 0)
+		nr_threads = cgv::os::task_scheduler::get().get_concurrency();
+	if (nr_regions == 0)
+		nr_regions = nr_threads;
+	if (nr_regions == 1)
+		return grow_all(T);
+	nr_threads = std::min(nr_threads, nr_regions);
+	unsigned int n = (unsigned int) ng->size();
+	std::vector<unsigned int> vertex_region(n), indices(n);
+	for (unsigned int vi = 0; vi < n; ++vi)
+		indices[vi] = vi;
+	split_into_regions(*pc, indices.begin(), indices.end(), 0, nr_regions, vertex_region);
+
+	// move the events into the queues of the regions of their vertices
+	std::vector<grow_queue> queues(nr_regions);
+	std::fill(first_grow_event.begin(), first_grow_event.end(), -1);
+	while (!grow_events.empty()) {
+		const grow_event& ge = grow_events[grow_events.top()];
+		add_grow_event(ge, queues[vertex_region[ge.vi]]);
+		grow_events.pop();
+	}
+
+	// a region only performs events whose 3-ring lies inside the region, such that regions read and write disjoint vertex data
+	bool tmp_debug_events = debug_events;
+	debug_events = false;
+	std::vector<std::vector<unsigned int> > region_triangles(nr_regions);
+	std::vector<unsigned int> nr_events(nr_regions, 0);
+	std::vector<unsigned char> deferred(n, 0);
+	cgv::os::parallel_for(0, nr_regions, [&](size_t ri, size_t) {
+		while (!queues[ri].empty()) {
+			perform_next_grow_event(region_triangles[ri], queues[ri], &vertex_region, &deferred);
+			++nr_events[ri];
+		}
+	}, 1, nr_threads);
+	debug_events = tmp_debug_events;
+	unsigned int iter = 0;
+	for (unsigned int ri = 0; ri < nr_regions; ++ri) {
+		T.insert(T.end(), region_triangles[ri].begin(), region_triangles[ri].end());
+		iter += nr_events[ri];
+	}
+
+	// the region queues were exhausted, such that only deferred vertices close to the seams can have valid events, which are performed serially
+	std::fill(first_grow_event.begin(), first_grow_event.end(), -1);
+	for (unsigned int vi = 0; vi < n; ++vi)
+		if (deferred[vi])
+			consider_grow_events(vi, grow_events);
+	return iter + grow_all(T);
+}
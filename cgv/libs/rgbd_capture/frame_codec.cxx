@@ -0,0 +1,463 @@
+#include "frame_codec.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <setjmp.h>
+#include <stdio.h>
+#include <png.h>
+#include <jpeglib.h>
+
+using namespace std;
+
+namespace rgbd {
+	namespace {
+		/// append bits to a byte vector in least significant bit first order
+		class bit_writer
+		{
+			vector<char>& data;
+			uint64_t acc;
+			unsigned nr_bits;
+		public:
+			bit_writer(vector<char>& _data) : data(_data), acc(0), nr_bits(0) {}
+			/// append the n <= 32 lower bits of value
+			void write(uint32_t value, unsigned n)
+			{
+				acc |= uint64_t(value) << nr_bits;
+				nr_bits += n;
+				while (nr_bits >= 8) {
+					data.push_back(char(acc & 255));
+					acc >>= 8;
+					nr_bits -= 8;
+				}
+			}
+			/// write remaining bits padded with zeros
+			void flush()
+			{
+				if (nr_bits > 0)
+					data.push_back(char(acc & 255));
+				acc = 0;
+				nr_bits = 0;
+			}
+		};
+		/// read bits written with bit_writer, where reading beyond the end yields zero bits and sets the overrun flag
+		class bit_reader
+		{
+			const unsigned char* ptr;
+			const unsigned char* end;
+			uint64_t acc;
+			unsigned nr_bits;
+			unsigned nr_padded_bytes;
+			void refill()
+			{
+				while (nr_bits <= 56) {
+					if (ptr < end)
+						acc |= uint64_t(*ptr++) << nr_bits;
+					else
+						++nr_padded_bytes;
+					nr_bits += 8;
+				}
+			}
+		public:
+			bit_reader(const char* data, size_t size) : ptr(reinterpret_cast<const unsigned char*>(data)), end(ptr + size), acc(0), nr_bits(0), nr_padded_bytes(0) {}
+			/// count up to limit one bits and consume them together with the terminating zero bit if present
+			unsigned read_unary(unsigned limit)
+			{
+				refill();
+				unsigned q = 0;
+				while (q < limit && ((acc >> q) & 1) != 0)
+					++q;
+				unsigned n = q < limit ? q + 1 : limit;
+				acc >>= n;
+				nr_bits -= n;
+				return q;
+			}
+			/// read n <= 32 bits
+			uint32_t read(unsigned n)
+			{
+				refill();
+				uint32_t value = uint32_t(acc & ((uint64_t(1) << n) - 1));
+				acc >>= n;
+				nr_bits -= n;
+				return value;
+			}
+			/// check whether more bits have been read than available
+			bool overrun() const { return 8 * nr_padded_bytes > nr_bits; }
+		};
+
+		/// residuals with a quotient of at least this are stored unencoded
+		const unsigned rice_limit = 24;
+
+		/// adaptive choice of rice parameter from the running mean A/N of the coded values
+		struct rice_context
+		{
+			uint32_t A, N;
+			rice_context() : A(16), N(1) {}
+			unsigned get_k() const
+			{
+				unsigned k = 0;
+				while ((N << k) < A && k < 16)
+					++k;
+				return k;
+			}
+			void update(uint32_t u)
+			{
+				A += u;
+				if (++N == 64) {
+					A >>= 1;
+					N >>= 1;
+				}
+			}
+		};
+
+		/// median edge detector of LOCO-I predicting a pixel from its left, upper and upper left neighbors
+		inline int predict(int a, int b, int c)
+		{
+			if (c >= std::max(a, b))
+				return std::min(a, b);
+			if (c <= std::min(a, b))
+				return std::max(a, b);
+			return a + b - c;
+		}
+
+		/// return predictor of pixel (x,y) in an image with 16 bit pixels
+		inline int predict(const uint16_t* P, int x, int y, int w)
+		{
+			if (y == 0)
+				return x == 0 ? 0 : P[x - 1];
+			const uint16_t* row = P + size_t(y) * w;
+			if (x == 0)
+				return row[x - w];
+			return predict(row[x - 1], row[x - w], row[x - w - 1]);
+		}
+
+		void encode_delta_rice(const frame_type& frame, vector<char>& data)
+		{
+			const uint16_t* P = reinterpret_cast<const uint16_t*>(&frame.frame_data.front());
+			bit_writer bw(data);
+			rice_context ctx;
+			for (int y = 0; y < frame.height; ++y) {
+				for (int x = 0; x < frame.width; ++x) {
+					int16_t e = int16_t(uint16_t(P[size_t(y) * frame.width + x] - predict(P, x, y, frame.width)));
+					uint32_t u = uint16_t((e << 1) ^ (e >> 15));
+					unsigned k = ctx.get_k();
+					uint32_t q = u >> k;
+					if (q < rice_limit) {
+						bw.write((1u << q) - 1, q + 1);
+						bw.write(u & ((1u << k) - 1), k);
+					}
+					else {
+						bw.write((1u << rice_limit) - 1, rice_limit);
+						bw.write(u, 16);
+					}
+					ctx.update(u);
+				}
+			}
+			bw.flush();
+		}
+
+		bool decode_delta_rice(const char* data, size_t size, frame_type& frame)
+		{
+			uint16_t* P = reinterpret_cast<uint16_t*>(&frame.frame_data.front());
+			bit_reader br(data, size);
+			rice_context ctx;
+			for (int y = 0; y < frame.height; ++y) {
+				for (int x = 0; x < frame.width; ++x) {
+					unsigned k = ctx.get_k();
+					uint32_t q = br.read_unary(rice_limit);
+					uint32_t u = q < rice_limit ? ((q << k) | br.read(k)) : br.read(16);
+					int16_t e = int16_t((u >> 1) ^ (0u - (u & 1)));
+					P[size_t(y) * frame.width + x] = uint16_t(predict(P, x, y, frame.width) + e);
+					ctx.update(u);
+				}
+			}
+			return !br.overrun();
+		}
+
+		bool is_color_format(const frame_format& ff)
+		{
+			switch (ff.pixel_format) {
+			case PF_RGB:
+			case PF_BGR:
+			case PF_RGBA:
+			case PF_BGRA:
+				return ff.nr_bits_per_pixel == 24 || ff.nr_bits_per_pixel == 32;
+			default:
+				return false;
+			}
+		}
+
+		bool has_fixed_size(const frame_format& ff)
+		{
+			return ff.pixel_format != PF_POINTS_AND_TRIANGLES && ff.width > 0 && ff.height > 0 &&
+				ff.buffer_size == unsigned(ff.width * ff.height) * ff.get_nr_bytes_per_pixel();
+		}
+
+		bool encode_png(const frame_type& frame, vector<char>& data)
+		{
+			png_image image;
+			memset(&image, 0, sizeof(image));
+			image.version = PNG_IMAGE_VERSION;
+			image.width = frame.width;
+			image.height = frame.height;
+			unsigned bpp = frame.get_nr_bytes_per_pixel();
+			image.format = bpp == 1 ? PNG_FORMAT_GRAY : (bpp == 3 ? PNG_FORMAT_RGB : PNG_FORMAT_RGBA);
+			image.flags = PNG_IMAGE_FLAG_FAST;
+			png_alloc_size_t size = 0;
+			if (!png_image_write_get_memory_size(image, size, 0, &frame.frame_data.front(), 0, 0))
+				return false;
+			data.resize(size);
+			if (!png_image_write_to_memory(&image, &data.front(), &size, 0, &frame.frame_data.front(), 0, 0))
+				return false;
+			data.resize(size);
+			return true;
+		}
+
+		bool decode_png(const char* data, size_t size, frame_type& frame)
+		{
+			png_image image;
+			memset(&image, 0, sizeof(image));
+			image.version = PNG_IMAGE_VERSION;
+			if (!png_image_begin_read_from_memory(&image, data, size))
+				return false;
+			unsigned bpp = frame.get_nr_bytes_per_pixel();
+			image.format = bpp == 1 ? PNG_FORMAT_GRAY : (bpp == 3 ? PNG_FORMAT_RGB : PNG_FORMAT_RGBA);
+			if (image.width != png_uint_32(frame.width) || image.height != png_uint_32(frame.height)) {
+				png_image_free(&image);
+				return false;
+			}
+			return png_image_finish_read(&image, 0, &frame.frame_data.front(), 0, 0) != 0;
+		}
+
+		struct jpeg_error_handler
+		{
+			struct jpeg_error_mgr pub;
+			jmp_buf setjmp_buffer;
+		};
+
+		void jpeg_error_exit(j_common_ptr cinfo)
+		{
+			longjmp(reinterpret_cast<jpeg_error_handler*>(cinfo->err)->setjmp_buffer, 1);
+		}
+
+		/// jpeg destination that appends to a byte vector
+		struct jpeg_vector_destination
+		{
+			struct jpeg_destination_mgr pub;
+			vector<char>* data;
+			JOCTET buffer[4096];
+		};
+
+		void jpeg_init_destination(j_compress_ptr cinfo)
+		{
+			jpeg_vector_destination* dest = reinterpret_cast<jpeg_vector_destination*>(cinfo->dest);
+			dest->pub.next_output_byte = dest->buffer;
+			dest->pub.free_in_buffer = sizeof(dest->buffer);
+		}
+
+		boolean jpeg_empty_output_buffer(j_compress_ptr cinfo)
+		{
+			jpeg_vector_destination* dest = reinterpret_cast<jpeg_vector_destination*>(cinfo->dest);
+			dest->data->insert(dest->data->end(), dest->buffer, dest->buffer + sizeof(dest->buffer));
+			jpeg_init_destination(cinfo);
+			return TRUE;
+		}
+
+		void jpeg_term_destination(j_compress_ptr cinfo)
+		{
+			jpeg_vector_destination* dest = reinterpret_cast<jpeg_vector_destination*>(cinfo->dest);
+			dest->data->insert(dest->data->end(), dest->buffer, dest->buffer + sizeof(dest->buffer) - dest->pub.free_in_buffer);
+		}
+
+		/// jpeg source reading from memory, where an end of image marker is inserted if data is truncated
+		void jpeg_init_source(j_decompress_ptr) {}
+		boolean jpeg_fill_input_buffer(j_decompress_ptr cinfo)
+		{
+			static const JOCTET eoi[2] = { 0xFF, JPEG_EOI };
+			cinfo->src->next_input_byte = eoi;
+			cinfo->src->bytes_in_buffer = 2;
+			return TRUE;
+		}
+		void jpeg_skip_input_data(j_decompress_ptr cinfo, long nr_bytes)
+		{
+			if (nr_bytes <= 0)
+				return;
+			if (size_t(nr_bytes) > cinfo->src->bytes_in_buffer)
+				jpeg_fill_input_buffer(cinfo);
+			else {
+				cinfo->src->next_input_byte += nr_bytes;
+				cinfo->src->bytes_in_buffer -= nr_bytes;
+			}
+		}
+		void jpeg_term_source(j_decompress_ptr) {}
+
+		/// return byte offsets of red and blue channel within a pixel of the frame
+		void get_red_blue_offsets(const frame_format& ff, unsigned& r, unsigned& b)
+		{
+			bool bgr = ff.pixel_format == PF_BGR || ff.pixel_format == PF_BGRA;
+			r = bgr ? 2 : 0;
+			b = bgr ? 0 : 2;
+		}
+
+		bool encode_jpeg(const frame_type& frame, vector<char>& data, int quality)
+		{
+			unsigned bpp = frame.get_nr_bytes_per_pixel(), r, b;
+			get_red_blue_offsets(frame, r, b);
+			vector<JSAMPLE> row(3 * frame.width);
+			struct jpeg_compress_struct cinfo;
+			jpeg_error_handler jerr;
+			jpeg_vector_destination dest;
+			cinfo.err = jpeg_std_error(&jerr.pub);
+			jerr.pub.error_exit = jpeg_error_exit;
+			if (setjmp(jerr.setjmp_buffer)) {
+				jpeg_destroy_compress(&cinfo);
+				return false;
+			}
+			jpeg_create_compress(&cinfo);
+			dest.pub.init_destination = jpeg_init_destination;
+			dest.pub.empty_output_buffer = jpeg_empty_output_buffer;
+			dest.pub.term_destination = jpeg_term_destination;
+			dest.data = &data;
+			cinfo.dest = &dest.pub;
+			cinfo.image_width = frame.width;
+			cinfo.image_height = frame.height;
+			cinfo.input_components = 3;
+			cinfo.in_color_space = JCS_RGB;
+			jpeg_set_defaults(&cinfo);
+			jpeg_set_quality(&cinfo, quality, TRUE);
+			cinfo.dct_method = JDCT_IFAST;
+			jpeg_start_compress(&cinfo, TRUE);
+			JSAMPROW row_pointer[1] = { &row.front() };
+			while (cinfo.next_scanline < cinfo.image_height) {
+				const unsigned char* src = reinterpret_cast<const unsigned char*>(&frame.frame_data.front()) + size_t(cinfo.next_scanline) * frame.width * bpp;
+				for (int x = 0; x < frame.width; ++x, src += bpp) {
+					row[3 * x] = src[r];
+					row[3 * x + 1] = src[1];
+					row[3 * x + 2] = src[b];
+				}
+				jpeg_write_scanlines(&cinfo, row_pointer, 1);
+			}
+			jpeg_finish_compress(&cinfo);
+			jpeg_destroy_compress(&cinfo);
+			return true;
+		}
+
+		bool decode_jpeg(const char* data, size_t size, frame_type& frame)
+		{
+			unsigned bpp = frame.get_nr_bytes_per_pixel(), r, b;
+			get_red_blue_offsets(frame, r, b);
+			vector<JSAMPLE> row(3 * frame.width);
+			struct jpeg_decompress_struct cinfo;
+			jpeg_error_handler jerr;
+			struct jpeg_source_mgr src;
+			cinfo.err = jpeg_std_error(&jerr.pub);
+			jerr.pub.error_exit = jpeg_error_exit;
+			if (setjmp(jerr.setjmp_buffer)) {
+				jpeg_destroy_decompress(&cinfo);
+				return false;
+			}
+			jpeg_create_decompress(&cinfo);
+			src.init_source = jpeg_init_source;
+			src.fill_input_buffer = jpeg_fill_input_buffer;
+			src.skip_input_data = jpeg_skip_input_data;
+			src.resync_to_restart = jpeg_resync_to_restart;
+			src.term_source = jpeg_term_source;
+			src.next_input_byte = reinterpret_cast<const JOCTET*>(data);
+			src.bytes_in_buffer = size;
+			cinfo.src = &src;
+			jpeg_read_header(&cinfo, TRUE);
+			cinfo.out_color_space = JCS_RGB;
+			cinfo.dct_method = JDCT_IFAST;
+			jpeg_start_decompress(&cinfo);
+			if (cinfo.output_width != JDIMENSION(frame.width) || cinfo.output_height != JDIMENSION(frame.height) || cinfo.output_components != 3) {
+				jpeg_destroy_decompress(&cinfo);
+				return false;
+			}
+			JSAMPROW row_pointer[1] = { &row.front() };
+			while (cinfo.output_scanline < cinfo.output_height) {
+				unsigned char* dst = reinterpret_cast<unsigned char*>(&frame.frame_data.front()) + size_t(cinfo.output_scanline) * frame.width * bpp;
+				jpeg_read_scanlines(&cinfo, row_pointer, 1);
+				for (int x = 0; x < frame.width; ++x, dst += bpp) {
+					dst[r] = row[3 * x];
+					dst[1] = row[3 * x + 1];
+					dst[b] = row[3 * x + 2];
+					if (bpp == 4)
+						dst[3] = 255;
+				}
+			}
+			jpeg_finish_decompress(&cinfo);
+			jpeg_destroy_decompress(&cinfo);
+			return true;
+		}
+	}
+
+	bool is_codec_supported(FrameCodec codec, const frame_format& ff)
+	{
+		switch (codec) {
+		case FC_RAW:
+			return true;
+		case FC_DELTA_RICE:
+			return has_fixed_size(ff) && ff.nr_bits_per_pixel == 16;
+		case FC_PNG:
+			return has_fixed_size(ff) && (ff.nr_bits_per_pixel == 8 || is_color_format(ff));
+		case FC_JPEG:
+			return has_fixed_size(ff) && is_color_format(ff);
+		}
+		return false;
+	}
+
+	FrameCodec choose_codec(const frame_format& ff, bool lossless_color)
+	{
+		if (is_codec_supported(FC_DELTA_RICE, ff))
+			return FC_DELTA_RICE;
+		if (is_color_format(ff) && !lossless_color && is_codec_supported(FC_JPEG, ff))
+			return FC_JPEG;
+		if (is_codec_supported(FC_PNG, ff))
+			return FC_PNG;
+		return FC_RAW;
+	}
+
+	bool encode_frame(const frame_type& frame, FrameCodec codec, vector<char>& data, int quality)
+	{
+		data.clear();
+		if (!is_codec_supported(codec, frame) || frame.frame_data.size() != frame.buffer_size)
+			return false;
+		if (frame.frame_data.empty())
+			return true;
+		switch (codec) {
+		case FC_RAW:
+			data = frame.frame_data;
+			return true;
+		case FC_DELTA_RICE:
+			encode_delta_rice(frame, data);
+			return true;
+		case FC_PNG:
+			return encode_png(frame, data);
+		case FC_JPEG:
+			return encode_jpeg(frame, data, quality);
+		}
+		return false;
+	}
+
+	bool decode_frame(const char* data, size_t size, FrameCodec codec, frame_type& frame)
+	{
+		if (!is_codec_supported(codec, frame))
+			return false;
+		if (codec == FC_RAW) {
+			// raw frames of dynamic size like meshes define the buffer size by their data
+			frame.buffer_size = unsigned(size);
+			frame.frame_data.assign(data, data + size);
+			return true;
+		}
+		frame.frame_data.resize(frame.buffer_size);
+		switch (codec) {
+		case FC_DELTA_RICE:
+			return decode_delta_rice(data, size, frame);
+		case FC_PNG:
+			return decode_png(data, size, frame);
+		case FC_JPEG:
+			return decode_jpeg(data, size, frame);
+		default:
+			return false;
+		}
+	}
+}
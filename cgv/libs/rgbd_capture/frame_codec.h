@@ -0,0 +1,25 @@
+#pragma once
+
+#include "frame.h"
+
+#include "lib_begin.h"
+
+namespace rgbd {
+	/// codecs used to compress the frame data in recordings
+	enum FrameCodec {
+		FC_RAW,        /// uncompressed frame data
+		FC_DELTA_RICE, /// lossless compression of 16 bit frames by spatial prediction and adaptive Golomb-Rice coding of the residuals
+		FC_PNG,        /// lossless png compression of 8 bit color, infrared and bayer frames
+		FC_JPEG        /// lossy jpeg compression of 24 and 32 bit color frames, where the fourth channel is not stored
+	};
+	/// return whether the codec can compress frames of the given format
+	extern CGV_API bool is_codec_supported(FrameCodec codec, const frame_format& ff);
+	/// return the preferred codec, which is delta rice for 16 bit frames and png or jpeg for color frames
+	extern CGV_API FrameCodec choose_codec(const frame_format& ff, bool lossless_color = false);
+	/// compress the data of the frame with the given codec into data, quality in [0,100] is only used by jpeg; return false if codec does not support frame
+	extern CGV_API bool encode_frame(const frame_type& frame, FrameCodec codec, std::vector<char>& data, int quality = 90);
+	/// decompress data into the frame, whose format must be set before; return false if data is corrupt or does not match the format
+	extern CGV_API bool decode_frame(const char* data, size_t size, FrameCodec codec, frame_type& frame);
+}
+
+#include <cgv/config/lib_end.h>
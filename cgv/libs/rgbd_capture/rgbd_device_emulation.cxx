@@ -35,16 +35,76 @@ namespace rgbd {
 		return false;
 	}
 
+	//assign the formats of recorded streams to the emulated streams based on their pixel formats
+	void assign_recorded_stream_formats(const vector<stream_format>& streams,
+		stream_format& color_stream, stream_format& depth_stream, stream_format& ir_stream, stream_format& mesh_stream,
+		bool& has_color_stream, bool& has_depth_stream, bool& has_ir_stream, bool& has_mesh_stream)
+	{
+		has_color_stream = has_depth_stream = has_ir_stream = has_mesh_stream = false;
+		for (const stream_format& stream : streams) {
+			switch (stream.pixel_format) {
+			case PF_RGB:
+			case PF_BGR:
+			case PF_RGBA:
+			case PF_BGRA:
+			case PF_BAYER:
+				color_stream = stream;
+				has_color_stream = true;
+				break;
+			case PF_DEPTH:
+			case PF_DEPTH_AND_PLAYER:
+				depth_stream = stream;
+				has_depth_stream = true;
+				break;
+			case PF_I:
+				ir_stream = stream;
+				has_ir_stream = true;
+				break;
+			case PF_POINTS_AND_TRIANGLES:
+				mesh_stream = stream;
+				has_mesh_stream = true;
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
 	rgbd_emulation::rgbd_emulation(const std::string& fn):device_is_running(false)
 	{
 		path_name = fn;
 		flags = idx = 0;
+		warped_position = -1;
 		//init frame timers
 		last_color_frame_time = 0;
 		last_depth_frame_time = 0;
 		last_ir_frame_time = 0;
 		last_mesh_frame_time = 0;
 
+		//find camera parameters
+		static emulator_parameters default_intrinsics;
+		static bool initialized_default_parameters = false;
+		if (!initialized_default_parameters){
+			default_intrinsics.intrinsics = { 5.9421434211923247e+02, 5.9104053696870778e+02,
+					3.3930780975300314e+02,2.4273913761751615e+02,0.0 };
+			default_intrinsics.depth_scale = 1.0;
+			initialized_default_parameters = true;
+		}
+
+		//replay from recording file
+		if (is_recording_file(fn)) {
+			if (!recording.open(fn))
+				cerr << "rgbd_emulation::rgbd_emulation: could not read recording file " << fn << endl;
+			assign_recorded_stream_formats(recording.get_stream_formats(), color_stream, depth_stream, ir_stream, mesh_stream,
+				has_color_stream, has_depth_stream, has_ir_stream, has_mesh_stream);
+			number_of_files = 0;
+			for (unsigned is : { IS_COLOR, IS_DEPTH, IS_INFRARED, IS_MESH })
+				number_of_files = std::max(number_of_files, recording.get_nr_frames(is));
+			if (!recording.get_emulator_parameters(parameters))
+				parameters = default_intrinsics;
+			return;
+		}
+
 		//list of supported extensions
 		static vector<string> color_exts = {"rgb", "bgr", "rgba", "bgra", "byr"};
 		static vector<string> depth_exts = {"dep", "d_p"};
@@ -68,16 +128,6 @@ namespace rgbd {
 			file = cgv::utils::file::find_next(file);
 		}
 		number_of_files = file_count;
-		
-		//find camera parameters
-		static emulator_parameters default_intrinsics;
-		static bool initialized_default_parameters = false;
-		if (!initialized_default_parameters){
-			default_intrinsics.intrinsics = { 5.9421434211923247e+02, 5.9104053696870778e+02,
-					3.3930780975300314e+02,2.4273913761751615e+02,0.0 };
-			default_intrinsics.depth_scale = 1.0;
-			initialized_default_parameters = true;
-		}
 
 		string data;
 		string emulator_parameters_file_name = path_name + "/emulator_parameters";
@@ -108,6 +158,7 @@ namespace rgbd {
 	bool rgbd_emulation::detach()
 	{
 		path_name = "";
+		recording.close();
 		return true;
 	}
 	
@@ -312,6 +363,31 @@ namespace rgbd {
 		}
 		*last_frame_time = current_frame_time;
 
+		if (recording.is_open()) {
+			size_t nr_frames = recording.get_nr_frames(is);
+			if (nr_frames == 0)
+				return false;
+			size_t& position = recording_positions[is];
+			if (position >= nr_frames)
+				position = 0;
+			if (!recording.read_frame(is, position, frame)) {
+				cerr << "rgbd_emulation: could not read frame " << position << " from recording " << path_name << '\n';
+				return false;
+			}
+			// the warped color frame is recorded with the time of the color frame
+			if (is == IS_COLOR) {
+				double recorded_time = recording.get_index_entry(is, position).time;
+				size_t warped = recording.find_frame(RS_WARPED_COLOR, recorded_time);
+				warped_position = -1;
+				if (warped < recording.get_nr_frames(RS_WARPED_COLOR) && recording.get_index_entry(RS_WARPED_COLOR, warped).time == recorded_time)
+					warped_position = int(warped);
+			}
+			frame.frame_index = unsigned(position);
+			frame.time = current_frame_time;
+			++position;
+			return true;
+		}
+
 		//check index
 		if (idx >= number_of_files) idx = 0;
 		frame.frame_index = idx;
@@ -352,6 +428,11 @@ namespace rgbd {
 	void rgbd_emulation::map_color_to_depth(const frame_type& depth_frame, const frame_type& color_frame,
 		frame_type& warped_color_frame) const
 	{
+		if (recording.is_open()) {
+			if (warped_position == -1 || !recording.read_frame(RS_WARPED_COLOR, warped_position, warped_color_frame))
+				std::cerr << "map_color_to_depth() no warped frame recorded" << std::endl;
+			return;
+		}
 		if (next_warped_file_name.empty()) {
 			std::cerr << "map_color_to_depth() no warped frames saved" << std::endl;
 			return;
@@ -376,6 +457,22 @@ namespace rgbd {
 		memcpy(&warped_color_frame.frame_data.front(), &data.front(), std::min(warped_color_frame.frame_data.size(), data.size()));
 	}
 
+	size_t rgbd_emulation::get_nr_recorded_frames(InputStreams is) const
+	{
+		return recording.get_nr_frames(is);
+	}
+
+	bool rgbd_emulation::seek_frame(InputStreams is, size_t i)
+	{
+		if (i >= recording.get_nr_frames(is))
+			return false;
+		double time = recording.get_index_entry(is, i).time;
+		for (unsigned s : { IS_COLOR, IS_DEPTH, IS_INFRARED, IS_MESH })
+			recording_positions[s] = s == unsigned(is) ? i : recording.find_frame(s, time);
+		warped_position = -1;
+		return true;
+	}
+
 	bool rgbd_emulation::map_depth_to_point(int x, int y, int depth, float* point_ptr) const
 	{
 		// assuming kinect
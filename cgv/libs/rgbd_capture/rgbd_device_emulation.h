@@ -1,21 +1,22 @@
 #include "rgbd_device.h"
+#include "rgbd_recording.h"
 #include <chrono>
 
 namespace rgbd {
 
-/// The rgdb device emulator uses protocols created by rgbd_input for replay
+/// The rgdb device emulator uses protocols or recording files created by rgbd_input for replay
 class rgbd_emulation : public rgbd_device
 {
 public:
 	std::string path_name;
-	mutable string next_warped_file_name;
+	mutable std::string next_warped_file_name;
 	unsigned idx;
 	unsigned flags;
 
 
 	/*fn : filename prefix of the files used to create an instance of the emulator
 		   fn needs to be a path e.g D:\kinect\kinect_ where D:\kinect\ is the directory 
-		   and kinect_ the prefix used for the files.*/
+		   and kinect_ the prefix used for the files. Alternatively fn can be a recording file.*/
 	rgbd_emulation(const std::string& fn);
 
 	bool attach(const std::string& fn);
@@ -44,6 +45,10 @@ public:
 		frame_type& warped_color_frame) const;
 	bool map_depth_to_point(int x, int y, int depth, float* point_ptr) const;
 
+	/// return the number of frames of a stream in the replayed recording file or 0 if a protocol directory is replayed
+	size_t get_nr_recorded_frames(InputStreams is) const;
+	/// continue replay of a recording file at the i-th frame of the given stream, where the other streams continue with the first frame not older than it
+	bool seek_frame(InputStreams is, size_t i);
 private:
 	bool get_frame_sync(InputStreams is, frame_type& frame, int timeOut);
 
@@ -54,6 +59,12 @@ private:
 	//frame_type next_color_frame, next_depth_frame, next_ir_frame,next_mesh_frame;
 	size_t number_of_files;
 	emulator_parameters parameters;
+	/// reader of replayed recording file
+	mutable recording_reader recording;
+	/// position of next frame per stream in recording file
+	std::map<unsigned, size_t> recording_positions;
+	/// position of the warped color frame recorded for the last color frame or -1 if there is none
+	mutable int warped_position;
 };
 
 }
\ No newline at end of file
@@ -95,6 +95,8 @@ rgbd_input::rgbd_input()
 	protocol_write_async = true;
 	protocol_idx = 0;
 	protocol_flags = 0;
+	recorder = 0;
+	record_warped_frame = false;
 }
 
 rgbd_input::~rgbd_input()
@@ -103,12 +105,18 @@ rgbd_input::~rgbd_input()
 		stop();
 	if (is_attached())
 		detach();
+	disable_recording();
 }
 
 rgbd_input::rgbd_input(const string& serial)
 {
 	rgbd = 0;
 	started = false;
+	protocol_write_async = true;
+	protocol_idx = 0;
+	protocol_flags = 0;
+	recorder = 0;
+	record_warped_frame = false;
 	attach(serial);
 }
 
@@ -236,6 +244,60 @@ void rgbd_input::disable_protocol()
 	protocol_flags = 0;
 }
 
+void rgbd_input::write_recording_header()
+{
+	recorder->set_stream_formats(streams);
+	emulator_parameters parameters;
+	if (rgbd->get_emulator_configuration(parameters))
+		recorder->set_emulator_parameters(parameters);
+}
+
+bool rgbd_input::enable_recording(const std::string& file_name, const recording_settings& settings)
+{
+	disable_recording();
+	recorder = new recording_writer();
+	if (!recorder->open(file_name, settings)) {
+		cerr << "rgbd_input::enable_recording: could not create recording file " << file_name << endl;
+		delete recorder;
+		recorder = 0;
+		return false;
+	}
+	record_warped_frame = false;
+	if (is_started())
+		write_recording_header();
+	return true;
+}
+
+bool rgbd_input::disable_recording()
+{
+	if (!recorder)
+		return true;
+	bool success = recorder->close();
+	if (recorder->get_nr_dropped_frames() > 0)
+		cerr << "rgbd_input::disable_recording: dropped " << recorder->get_nr_dropped_frames() << " frames" << endl;
+	delete recorder;
+	recorder = 0;
+	record_warped_frame = false;
+	return success;
+}
+
+bool rgbd_input::is_recording() const
+{
+	return recorder != 0;
+}
+
+size_t rgbd_input::get_nr_recorded_frames(InputStreams is) const
+{
+	const rgbd_emulation* emulation = dynamic_cast<const rgbd_emulation*>(rgbd);
+	return emulation ? emulation->get_nr_recorded_frames(is) : 0;
+}
+
+bool rgbd_input::seek_recording(InputStreams is, size_t i)
+{
+	rgbd_emulation* emulation = dynamic_cast<rgbd_emulation*>(rgbd);
+	return emulation ? emulation->seek_frame(is, i) : false;
+}
+
 void rgbd::rgbd_input::clear_protocol(const string& path)
 {
 	cout << "rgbd::rgbd_input::clear_protocol: removing old protocol\n";
@@ -336,6 +398,8 @@ bool rgbd_input::start(InputStreams is, std::vector<stream_format>& stream_forma
 		return true;
 	started = rgbd->start_device(is, stream_formats);
 	streams = stream_formats;
+	if (recorder)
+		write_recording_header();
 	if (!protocol_path.empty()) {
 		write_protocol_headers(streams, protocol_path);
 		//write camera parameters
@@ -372,6 +436,8 @@ bool rgbd_input::start(const std::vector<stream_format>& stream_formats)
 		return true;
 	started = rgbd->start_device(stream_formats);
 	streams = stream_formats;
+	if (recorder)
+		write_recording_header();
 	if (!protocol_path.empty()) {
 		write_protocol_headers(streams, protocol_path);
 	}
@@ -387,6 +453,8 @@ bool rgbd_input::start(const std::vector<stream_format>& stream_formats, int32_t
 		return true;
 	started = rgbd->start_device(stream_formats,delay_to_master);
 	streams = stream_formats;
+	if (recorder)
+		write_recording_header();
 	if (!protocol_path.empty()) {
 		write_protocol_headers(streams, protocol_path);
 	}
@@ -461,6 +529,14 @@ bool rgbd_input::get_frame(InputStreams is, frame_type& frame, int timeOut)
 			else
 				++protocol_idx;
 		}
+		if (recorder) {
+			if (!recorder->write_frame(is, frame))
+				std::cerr << "rgbd_input::get_frame: could not record frame " << frame.frame_index << std::endl;
+			else if (is == IS_COLOR) {
+				record_warped_frame = true;
+				last_color_frame_info = frame;
+			}
+		}
 		return true;
 	}
 	return false;
@@ -480,6 +556,11 @@ void rgbd_input::map_color_to_depth(const frame_type& depth_frame, const frame_t
 			std::cerr << "rgbd_input::map_color_to_depth: could not protocol frame to " << next_warped_file_name << std::endl;
 		next_warped_file_name.clear();
 	}
+	if (recorder && record_warped_frame) {
+		if (!recorder->write_frame(RS_WARPED_COLOR, warped_color_frame, &last_color_frame_info))
+			std::cerr << "rgbd_input::map_color_to_depth: could not record warped frame" << std::endl;
+		record_warped_frame = false;
+	}
 }
 
 /// map a depth value together with pixel indices to a 3D point with coordinates in meters; point_ptr needs to provide space for 3 floats
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "rgbd_driver.h"
+#include "rgbd_recording.h"
 
 #include "lib_begin.h"
 
@@ -59,7 +60,7 @@ public:
 	static bool read_frame(const std::string& file_name, frame_type& frame);
 	/// write a frame to a file
 	static bool write_frame(const std::string& file_name, const frame_type& frame);
-	/// attach to a directory that contains saved frames
+	/// attach to a directory that contains saved frames or to a recording file
 	bool attach_path(const std::string& path);
 	/// enable protocolation of all frames acquired by the attached rgbd input device
 	void enable_protocol(const std::string& path);
@@ -67,6 +68,16 @@ public:
 	void disable_protocol();
 	/// delete recorded protocol
 	void clear_protocol(const std::string& path);
+	/// enable recording of all frames acquired by the attached rgbd input device into a single recording file
+	bool enable_recording(const std::string& file_name, const recording_settings& settings = recording_settings());
+	/// finish writing queued frames and close the recording file; return whether all frames have been written
+	bool disable_recording();
+	/// check whether frames are recorded
+	bool is_recording() const;
+	/// return the number of frames of the given stream, if attached to a recording file
+	size_t get_nr_recorded_frames(InputStreams is) const;
+	/// continue replay of a recording file at the i-th frame of the given stream
+	bool seek_recording(InputStreams is, size_t i);
 	//@}
 
 	/**@name base control*/
@@ -151,6 +162,14 @@ protected:
 	mutable std::string next_warped_file_name;
 	/// helper function to write protocol frame asynchronously
 	bool write_protocol_frame_async(const std::string& fn, const frame_type& frame) const;
+	/// writer of recording file
+	recording_writer* recorder;
+	/// whether the next warped color frame should be recorded
+	mutable bool record_warped_frame;
+	/// info of last recorded color frame, which is stored with the warped color frame to associate them
+	frame_info last_color_frame_info;
+	/// store stream formats and emulator parameters in recording
+	void write_recording_header();
 	/// cached stream formats
 	std::vector<stream_format> streams;
 };
@@ -0,0 +1,370 @@
+#include "rgbd_point_cloud.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <cmath>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RGBD_POINT_CLOUD_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace rgbd {
+
+	namespace {
+		/// process bands of rows in parallel by handing out band indices to worker threads
+		template <typename F>
+		void process_bands(size_t nr_bands, unsigned nr_threads, F f)
+		{
+			nr_threads = (unsigned)std::min(size_t(nr_threads), nr_bands);
+			std::atomic<size_t> next_band(0);
+			auto worker = [&]() {
+				size_t bi;
+				while ((bi = next_band++) < nr_bands)
+					f(bi);
+			};
+			std::vector<std::thread> threads;
+			for (unsigned i = 1; i < nr_threads; ++i)
+				threads.push_back(std::thread(worker));
+			worker();
+			for (auto& t : threads)
+				t.join();
+		}
+
+		/// number of rows per band
+		const unsigned band_height = 16;
+
+		/// count pixels of a row with valid depth
+		unsigned count_row(const uint16_t* D, const float* RZ, unsigned w)
+		{
+			unsigned count = 0, x = 0;
+#ifdef RGBD_POINT_CLOUD_SSE2
+			const __m128i zero_i = _mm_setzero_si128();
+			const __m128 zero = _mm_setzero_ps();
+			for (; x + 4 <= w; x += 4) {
+				__m128 d = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(D + x)), zero_i));
+				int mask = _mm_movemask_ps(_mm_cmpgt_ps(_mm_mul_ps(d, _mm_loadu_ps(RZ + x)), zero));
+				count += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+			}
+#endif
+			for (; x < w; ++x)
+				if (float(D[x]) * RZ[x] > 0.0f)
+					++count;
+			return count;
+		}
+
+		/// convert pixels of a row with valid depth to points and store their x coordinates in X
+		void convert_row(const uint16_t* D, const float* RX, const float* RY, const float* RZ, unsigned w,
+			cgv::math::fvec<float, 3>* P, uint32_t* X)
+		{
+			unsigned x = 0;
+#ifdef RGBD_POINT_CLOUD_SSE2
+			const __m128i zero_i = _mm_setzero_si128();
+			const __m128 zero = _mm_setzero_ps();
+			float px[4], py[4], pz[4];
+			for (; x + 4 <= w; x += 4) {
+				__m128 d = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(D + x)), zero_i));
+				__m128 z = _mm_mul_ps(d, _mm_loadu_ps(RZ + x));
+				int mask = _mm_movemask_ps(_mm_cmpgt_ps(z, zero));
+				if (mask == 0)
+					continue;
+				_mm_storeu_ps(px, _mm_mul_ps(d, _mm_loadu_ps(RX + x)));
+				_mm_storeu_ps(py, _mm_mul_ps(d, _mm_loadu_ps(RY + x)));
+				_mm_storeu_ps(pz, z);
+				for (unsigned l = 0; l < 4; ++l) {
+					if ((mask & (1 << l)) == 0)
+						continue;
+					*P++ = cgv::math::fvec<float, 3>(px[l], py[l], pz[l]);
+					*X++ = x + l;
+				}
+			}
+#endif
+			for (; x < w; ++x) {
+				float d = float(D[x]);
+				float z = d * RZ[x];
+				if (z > 0.0f) {
+					*P++ = cgv::math::fvec<float, 3>(d * RX[x], d * RY[x], z);
+					*X++ = x;
+				}
+			}
+		}
+
+		/// convert all pixels of a row, where rays and depth of invalid pixels are zero such that no masking is necessary
+		void convert_row_dense(const uint16_t* D, const float* RX, const float* RY, const float* RZ, unsigned w, float* P)
+		{
+			unsigned x = 0;
+#ifdef RGBD_POINT_CLOUD_SSE2
+			const __m128i zero_i = _mm_setzero_si128();
+			for (; x + 4 <= w; x += 4, P += 12) {
+				__m128 d = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(D + x)), zero_i));
+				__m128 px = _mm_mul_ps(d, _mm_loadu_ps(RX + x));
+				__m128 py = _mm_mul_ps(d, _mm_loadu_ps(RY + x));
+				__m128 pz = _mm_mul_ps(d, _mm_loadu_ps(RZ + x));
+				// transpose from structure of arrays to interleaved x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+				__m128 xy01 = _mm_unpacklo_ps(px, py);
+				__m128 xy23 = _mm_unpackhi_ps(px, py);
+				__m128 t0 = _mm_shuffle_ps(pz, xy01, _MM_SHUFFLE(2, 2, 0, 0));
+				__m128 t1 = _mm_shuffle_ps(xy01, pz, _MM_SHUFFLE(1, 1, 3, 3));
+				__m128 t2 = _mm_shuffle_ps(pz, xy23, _MM_SHUFFLE(2, 2, 2, 2));
+				__m128 t3 = _mm_shuffle_ps(xy23, pz, _MM_SHUFFLE(3, 3, 3, 3));
+				_mm_storeu_ps(P, _mm_shuffle_ps(xy01, t0, _MM_SHUFFLE(2, 0, 1, 0)));
+				_mm_storeu_ps(P + 4, _mm_shuffle_ps(t1, xy23, _MM_SHUFFLE(1, 0, 2, 0)));
+				_mm_storeu_ps(P + 8, _mm_shuffle_ps(t2, t3, _MM_SHUFFLE(2, 0, 2, 0)));
+			}
+#endif
+			for (; x < w; ++x, P += 3) {
+				float d = float(D[x]);
+				P[0] = d * RX[x];
+				P[1] = d * RY[x];
+				P[2] = d * RZ[x];
+			}
+		}
+
+		/// single precision version of the projection to the color camera and its distortion model
+		struct color_projection
+		{
+			float R[9], t[3], dc[2], k[6], p[2], s[2], c[2], skew, max_rd2, eps, w, h;
+			unsigned width, bpp;
+			color_projection(const rgbd_calibration& calib, const frame_type& color_frame)
+			{
+				const cgv::math::fmat<double, 3, 3>& O = pose_orientation(calib.color.pose);
+				const cgv::math::fvec<double, 3>& T = pose_position(calib.color.pose);
+				for (unsigned i = 0; i < 3; ++i) {
+					for (unsigned j = 0; j < 3; ++j)
+						R[3 * i + j] = float(O(i, j));
+					t[i] = float(calib.depth_scale * T[i]);
+				}
+				for (unsigned i = 0; i < 6; ++i)
+					k[i] = float(calib.color.k[i]);
+				for (unsigned i = 0; i < 2; ++i) {
+					dc[i] = float(calib.color.dc[i]);
+					p[i] = float(calib.color.p[i]);
+					s[i] = float(calib.color.s[i]);
+					c[i] = float(calib.color.c[i]);
+				}
+				skew = float(calib.color.skew);
+				max_rd2 = float(calib.color.max_radius_for_projection * calib.color.max_radius_for_projection);
+				eps = cgv::math::distortion_inversion_epsilon<float>();
+				w = float(std::min(int(calib.color.w), color_frame.width));
+				h = float(std::min(int(calib.color.h), color_frame.height));
+				width = color_frame.width;
+				bpp = color_frame.get_nr_bytes_per_pixel();
+			}
+			/// compute the byte offsets of the color pixels of n points or -1 for points projecting outside of the color frame
+			void project(const cgv::math::fvec<float, 3>* P, unsigned n, int64_t* O) const
+			{
+				unsigned i = 0;
+#ifdef RGBD_POINT_CLOUD_SSE2
+				const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), three = _mm_set1_ps(3.0f), zero = _mm_setzero_ps();
+				const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+				float px[4], py[4];
+				for (; i + 4 <= n; i += 4) {
+					__m128 qx = _mm_add_ps(_mm_set_ps(P[i + 3][0], P[i + 2][0], P[i + 1][0], P[i][0]), _mm_set1_ps(t[0]));
+					__m128 qy = _mm_add_ps(_mm_set_ps(P[i + 3][1], P[i + 2][1], P[i + 1][1], P[i][1]), _mm_set1_ps(t[1]));
+					__m128 qz = _mm_add_ps(_mm_set_ps(P[i + 3][2], P[i + 2][2], P[i + 1][2], P[i][2]), _mm_set1_ps(t[2]));
+					__m128 X = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, _mm_set1_ps(R[0])), _mm_mul_ps(qy, _mm_set1_ps(R[3]))), _mm_mul_ps(qz, _mm_set1_ps(R[6])));
+					__m128 Y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, _mm_set1_ps(R[1])), _mm_mul_ps(qy, _mm_set1_ps(R[4]))), _mm_mul_ps(qz, _mm_set1_ps(R[7])));
+					__m128 Z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, _mm_set1_ps(R[2])), _mm_mul_ps(qy, _mm_set1_ps(R[5]))), _mm_mul_ps(qz, _mm_set1_ps(R[8])));
+					__m128 ox = _mm_sub_ps(_mm_div_ps(X, Z), _mm_set1_ps(dc[0]));
+					__m128 oy = _mm_sub_ps(_mm_div_ps(Y, Z), _mm_set1_ps(dc[1]));
+					__m128 xd2 = _mm_mul_ps(ox, ox), yd2 = _mm_mul_ps(oy, oy), xyd = _mm_mul_ps(ox, oy);
+					__m128 rd2 = _mm_add_ps(xd2, yd2);
+					__m128 v = _mm_add_ps(one, _mm_mul_ps(rd2, _mm_add_ps(_mm_set1_ps(k[3]), _mm_mul_ps(rd2, _mm_add_ps(_mm_set1_ps(k[4]), _mm_mul_ps(rd2, _mm_set1_ps(k[5])))))));
+					__m128 u = _mm_add_ps(one, _mm_mul_ps(rd2, _mm_add_ps(_mm_set1_ps(k[0]), _mm_mul_ps(rd2, _mm_add_ps(_mm_set1_ps(k[1]), _mm_mul_ps(rd2, _mm_set1_ps(k[2])))))));
+					__m128 ok = _mm_and_ps(_mm_cmple_ps(rd2, _mm_set1_ps(max_rd2)),
+						_mm_cmpge_ps(_mm_and_ps(v, abs_mask), _mm_mul_ps(_mm_set1_ps(eps), _mm_and_ps(u, abs_mask))));
+					__m128 f = _mm_div_ps(u, v);
+					__m128 xu = _mm_add_ps(_mm_add_ps(_mm_mul_ps(f, ox), _mm_mul_ps(_mm_mul_ps(two, xyd), _mm_set1_ps(p[0]))), _mm_mul_ps(_mm_add_ps(_mm_mul_ps(three, xd2), yd2), _mm_set1_ps(p[1])));
+					__m128 yu = _mm_add_ps(_mm_add_ps(_mm_mul_ps(f, oy), _mm_mul_ps(_mm_mul_ps(two, xyd), _mm_set1_ps(p[1]))), _mm_mul_ps(_mm_add_ps(xd2, _mm_mul_ps(three, yd2)), _mm_set1_ps(p[0])));
+					__m128 X_pix = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(s[0]), xu), _mm_mul_ps(_mm_set1_ps(skew), yu)), _mm_set1_ps(c[0]));
+					__m128 Y_pix = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(s[1]), yu), _mm_set1_ps(c[1]));
+					ok = _mm_and_ps(ok, _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(X_pix, zero), _mm_cmpge_ps(Y_pix, zero)),
+						_mm_and_ps(_mm_cmplt_ps(X_pix, _mm_set1_ps(w)), _mm_cmplt_ps(Y_pix, _mm_set1_ps(h)))));
+					_mm_storeu_ps(px, X_pix);
+					_mm_storeu_ps(py, Y_pix);
+					int mask = _mm_movemask_ps(ok);
+					for (unsigned l = 0; l < 4; ++l)
+						O[i + l] = ((mask >> l) & 1) ? int64_t(size_t(unsigned(py[l])) * width + unsigned(px[l])) * bpp : -1;
+				}
+#endif
+				for (; i < n; ++i) {
+					float qx = P[i][0] + t[0], qy = P[i][1] + t[1], qz = P[i][2] + t[2];
+					float X = qx * R[0] + qy * R[3] + qz * R[6];
+					float Y = qx * R[1] + qy * R[4] + qz * R[7];
+					float Z = qx * R[2] + qy * R[5] + qz * R[8];
+					float ox = X / Z - dc[0], oy = Y / Z - dc[1];
+					float xd2 = ox * ox, yd2 = oy * oy, xyd = ox * oy;
+					float rd2 = xd2 + yd2;
+					float v = 1.0f + rd2 * (k[3] + rd2 * (k[4] + rd2 * k[5]));
+					float u = 1.0f + rd2 * (k[0] + rd2 * (k[1] + rd2 * k[2]));
+					bool ok = rd2 <= max_rd2 && std::abs(v) >= eps * std::abs(u);
+					float f = u / v;
+					float xu = f * ox + 2.0f * xyd * p[0] + (3.0f * xd2 + yd2) * p[1];
+					float yu = f * oy + 2.0f * xyd * p[1] + (xd2 + 3.0f * yd2) * p[0];
+					float X_pix = s[0] * xu + skew * yu + c[0];
+					float Y_pix = s[1] * yu + c[1];
+					ok = ok && X_pix >= 0.0f && Y_pix >= 0.0f && X_pix < w && Y_pix < h;
+					O[i] = ok ? int64_t(size_t(unsigned(Y_pix)) * width + unsigned(X_pix)) * bpp : -1;
+				}
+			}
+		};
+	}
+
+	point_cloud_builder::point_cloud_builder() : width(0), height(0), nr_threads(0)
+	{
+	}
+
+	void point_cloud_builder::build(const rgbd_calibration& _calib, double eps, unsigned max_nr_iterations, double slow_down)
+	{
+		std::vector<cgv::math::fvec<float, 2>> undistortion_map;
+		compute_distortion_map(_calib, undistortion_map, 1, cgv::math::fvec<float, 2>(-10000.0f), eps, max_nr_iterations, slow_down);
+		build(_calib, undistortion_map);
+	}
+
+	void point_cloud_builder::build(const rgbd_calibration& _calib, const std::vector<cgv::math::fvec<float, 2>>& undistortion_map)
+	{
+		calib = _calib;
+		width = calib.depth.w;
+		height = calib.depth.h;
+		size_t n = size_t(width) * height;
+		ray_x.resize(n);
+		ray_y.resize(n);
+		ray_z.resize(n);
+		float scale = float(calib.depth_scale);
+		for (size_t i = 0; i < n; ++i) {
+			const cgv::math::fvec<float, 2>& xd = undistortion_map[i];
+			bool valid = xd[0] >= -1000.0f;
+			ray_x[i] = valid ? scale * xd[0] : 0.0f;
+			ray_y[i] = valid ? scale * xd[1] : 0.0f;
+			ray_z[i] = valid ? scale : 0.0f;
+		}
+	}
+
+	size_t point_cloud_builder::construct_point_cloud(const frame_type& depth_frame, std::vector<vec3>& P,
+		std::vector<rgb8>* C, const frame_type* color_frame, std::vector<uint32_t>* I) const
+	{
+		P.clear();
+		if (C)
+			C->clear();
+		if (I)
+			I->clear();
+		if (!is_built() || depth_frame.width != int(width) || depth_frame.height != int(height) ||
+			depth_frame.get_nr_bytes_per_pixel() != 2 || depth_frame.frame_data.size() < ray_z.size() * 2)
+			return 0;
+		if (C && (!color_frame || color_frame->get_nr_bytes_per_pixel() < 3))
+			C = 0;
+		bool color_is_warped = C && color_frame->width == depth_frame.width && color_frame->height == depth_frame.height;
+		const uint16_t* D = reinterpret_cast<const uint16_t*>(&depth_frame.frame_data.front());
+		unsigned nr = nr_threads == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : nr_threads;
+		size_t nr_bands = (height + band_height - 1) / band_height;
+
+		// count valid pixels per row to determine output offsets
+		std::vector<size_t> row_offsets(height + 1, 0);
+		process_bands(nr_bands, nr, [&](size_t bi) {
+			unsigned y_end = std::min(unsigned(bi + 1) * band_height, height);
+			for (unsigned y = unsigned(bi) * band_height; y < y_end; ++y)
+				row_offsets[y + 1] = count_row(D + size_t(y) * width, &ray_z[size_t(y) * width], width);
+		});
+		for (unsigned y = 0; y < height; ++y)
+			row_offsets[y + 1] += row_offsets[y];
+		size_t n = row_offsets[height];
+		P.resize(n);
+		if (C)
+			C->resize(n);
+		if (I)
+			I->resize(n);
+
+		std::unique_ptr<color_projection> projection;
+		if (C && !color_is_warped)
+			projection.reset(new color_projection(calib, *color_frame));
+		process_bands(nr_bands, nr, [&](size_t bi) {
+			std::vector<uint32_t> X(width);
+			std::vector<int64_t> O(projection ? width : 0);
+			unsigned y_end = std::min(unsigned(bi + 1) * band_height, height);
+			for (unsigned y = unsigned(bi) * band_height; y < y_end; ++y) {
+				size_t row = size_t(y) * width, offset = row_offsets[y], count = row_offsets[y + 1] - offset;
+				if (count == 0)
+					continue;
+				convert_row(D + row, &ray_x[row], &ray_y[row], &ray_z[row], width, &P[offset], &X.front());
+				if (I) {
+					for (size_t i = 0; i < count; ++i)
+						(*I)[offset + i] = uint32_t(row + X[i]);
+				}
+				if (C) {
+					unsigned bpp = color_frame->get_nr_bytes_per_pixel();
+					const uint8_t* color_ptr = reinterpret_cast<const uint8_t*>(&color_frame->frame_data.front());
+					if (projection)
+						projection->project(&P[offset], unsigned(count), &O.front());
+					for (size_t i = 0; i < count; ++i) {
+						const uint8_t* pixel_ptr;
+						if (color_is_warped)
+							pixel_ptr = color_ptr + (row + X[i]) * bpp;
+						else if (O[i] >= 0)
+							pixel_ptr = color_ptr + O[i];
+						else {
+							(*C)[offset + i] = rgb8(0, 0, 0);
+							continue;
+						}
+						(*C)[offset + i] = rgb8(pixel_ptr[2], pixel_ptr[1], pixel_ptr[0]);
+					}
+				}
+			}
+		});
+		return n;
+	}
+
+	bool point_cloud_builder::construct_points(const frame_type& depth_frame, vec3* P) const
+	{
+		if (!is_built() || depth_frame.width != int(width) || depth_frame.height != int(height) ||
+			depth_frame.get_nr_bytes_per_pixel() != 2 || depth_frame.frame_data.size() < ray_z.size() * 2)
+			return false;
+		const uint16_t* D = reinterpret_cast<const uint16_t*>(&depth_frame.frame_data.front());
+		unsigned nr = nr_threads == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : nr_threads;
+		process_bands((height + band_height - 1) / band_height, nr, [&](size_t bi) {
+			unsigned y_end = std::min(unsigned(bi + 1) * band_height, height);
+			for (unsigned y = unsigned(bi) * band_height; y < y_end; ++y) {
+				size_t row = size_t(y) * width;
+				convert_row_dense(D + row, &ray_x[row], &ray_y[row], &ray_z[row], width, &P[row][0]);
+			}
+		});
+		return true;
+	}
+
+	bool point_cloud_builder::map_color_to_depth(const frame_type& depth_frame, const frame_type& color_frame, frame_type& warped_color_frame) const
+	{
+		if (!is_built() || depth_frame.width != int(width) || depth_frame.height != int(height) ||
+			depth_frame.get_nr_bytes_per_pixel() != 2 || color_frame.get_nr_bytes_per_pixel() < 3)
+			return false;
+		static_cast<frame_format&>(warped_color_frame) = color_frame;
+		static_cast<frame_size&>(warped_color_frame) = depth_frame;
+		warped_color_frame.compute_buffer_size();
+		warped_color_frame.frame_data.assign(warped_color_frame.buffer_size, 0);
+		warped_color_frame.frame_index = color_frame.frame_index;
+		warped_color_frame.time = color_frame.time;
+		warped_color_frame.system_time_stamp = color_frame.system_time_stamp;
+		warped_color_frame.device_time_stamp = color_frame.device_time_stamp;
+		const uint16_t* D = reinterpret_cast<const uint16_t*>(&depth_frame.frame_data.front());
+		unsigned bpp = color_frame.get_nr_bytes_per_pixel();
+		const uint8_t* color_ptr = reinterpret_cast<const uint8_t*>(&color_frame.frame_data.front());
+		color_projection projection(calib, color_frame);
+		unsigned nr = nr_threads == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : nr_threads;
+		process_bands((height + band_height - 1) / band_height, nr, [&](size_t bi) {
+			std::vector<vec3> P(width);
+			std::vector<uint32_t> X(width);
+			std::vector<int64_t> O(width);
+			unsigned y_end = std::min(unsigned(bi + 1) * band_height, height);
+			for (unsigned y = unsigned(bi) * band_height; y < y_end; ++y) {
+				size_t row = size_t(y) * width;
+				unsigned count = count_row(D + row, &ray_z[row], width);
+				convert_row(D + row, &ray_x[row], &ray_y[row], &ray_z[row], width, &P.front(), &X.front());
+				projection.project(&P.front(), count, &O.front());
+				for (unsigned i = 0; i < count; ++i)
+					if (O[i] >= 0)
+						memcpy(&warped_color_frame.frame_data[(row + X[i]) * bpp], color_ptr + O[i], bpp);
+			}
+		});
+		return true;
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include "rgbd_calibration.h"
+
+#include "lib_begin.h"
+
+namespace rgbd {
+
+	/** fast conversion of depth frames to point clouds. For each pixel of the depth camera the ray of the undistorted
+	    image coordinates scaled by the depth scale is precomputed, such that a point results from a multiplication
+		 of the ray with the depth value. Rows are converted with SSE2 if enabled for the build and distributed over
+		 bands of rows processed in parallel. Also the projection to the color camera is vectorized in single precision.
+		 The results correspond to construct_point_cloud() with an undistortion map up to rounding and are independent
+		 of the number of threads. */
+	class CGV_API point_cloud_builder
+	{
+	public:
+		typedef cgv::math::fvec<float, 3> vec3;
+		typedef cgv::media::color<uint8_t, cgv::media::RGB> rgb8;
+	protected:
+		rgbd_calibration calib;
+		unsigned width, height;
+		/// per pixel ray table in structure of array layout, where rays of pixels without valid undistortion are zero
+		std::vector<float> ray_x, ray_y, ray_z;
+		unsigned nr_threads;
+	public:
+		/// construct builder without ray table
+		point_cloud_builder();
+		/// precompute the ray table by inverting the distortion model of the depth camera for each pixel
+		void build(const rgbd_calibration& _calib,
+			double eps = cgv::math::distortion_inversion_epsilon<double>(),
+			unsigned max_nr_iterations = cgv::math::camera<double>::get_standard_max_nr_iterations(),
+			double slow_down = cgv::math::camera<double>::get_standard_slow_down());
+		/// precompute the ray table from an undistortion map computed with compute_distortion_map()
+		void build(const rgbd_calibration& _calib, const std::vector<cgv::math::fvec<float, 2>>& undistortion_map);
+		/// check whether ray table has been computed
+		bool is_built() const { return !ray_z.empty(); }
+		/// return calibration used to build ray table
+		const rgbd_calibration& get_calibration() const { return calib; }
+		/// set the number of threads used for conversion, where 0 uses all hardware threads
+		void set_nr_threads(unsigned _nr_threads) { nr_threads = _nr_threads; }
+		/// return number of threads
+		unsigned get_nr_threads() const { return nr_threads; }
+		//! construct points of all pixels with valid depth in row major order and return their number
+		/*! If C is given, colors are looked up in the color frame, which is interpreted as warped color frame if it
+		    has the size of the depth frame, and pixels projecting outside of an unwarped color frame get black.
+			 If I is given, the pixel indices of the points are stored. Returns 0 if depth frame does not match
+			 the calibration or is not a 16 bit frame. */
+		size_t construct_point_cloud(const frame_type& depth_frame, std::vector<vec3>& P,
+			std::vector<rgb8>* C = 0, const frame_type* color_frame = 0, std::vector<uint32_t>* I = 0) const;
+		/// construct one point per pixel into P, which needs space for width*height points, where pixels without valid depth yield the origin
+		bool construct_points(const frame_type& depth_frame, vec3* P) const;
+		/// map a color frame to the image coordinates of the depth frame, where pixels without depth or color are black
+		bool map_color_to_depth(const frame_type& depth_frame, const frame_type& color_frame, frame_type& warped_color_frame) const;
+	};
+}
+
+#include <cgv/config/lib_end.h>
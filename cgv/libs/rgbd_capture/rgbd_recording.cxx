@@ -0,0 +1,394 @@
+#include "rgbd_recording.h"
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+using namespace std;
+
+namespace rgbd {
+	namespace {
+		const char file_magic[8] = { 'C', 'G', 'V', 'R', 'G', 'B', 'D', 0 };
+		const uint32_t file_version = 1;
+		const char chunk_tag[4] = { 'C', 'H', 'N', 'K' };
+		const char trailer_tag[4] = { 'T', 'R', 'L', 'R' };
+
+		/// file header, where trailer_offset is zero as long as the recording has not been closed
+		struct recording_file_header
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t reserved;
+			uint64_t trailer_offset;
+		};
+
+		bool seek64(FILE* fp, uint64_t offset)
+		{
+#ifdef _WIN32
+			return _fseeki64(fp, int64_t(offset), SEEK_SET) == 0;
+#else
+			return fseeko(fp, off_t(offset), SEEK_SET) == 0;
+#endif
+		}
+
+		template <typename T>
+		bool read_value(FILE* fp, T& value)
+		{
+			return fread(&value, sizeof(T), 1, fp) == 1;
+		}
+	}
+
+	recording_writer::recording_writer() : fp(0), file_offset(0), has_parameters(false),
+		first_seq(0), next_encode_seq(0), stop_request(false), write_failed(false), nr_dropped_frames(0)
+	{
+	}
+
+	recording_writer::~recording_writer()
+	{
+		close();
+	}
+
+	bool recording_writer::write_bytes(const void* data, size_t size)
+	{
+		if (size > 0 && fwrite(data, 1, size, fp) != size)
+			return false;
+		file_offset += size;
+		return true;
+	}
+
+	bool recording_writer::open(const string& file_name, const recording_settings& _settings)
+	{
+		close();
+		fp = fopen(file_name.c_str(), "wb");
+		if (!fp)
+			return false;
+		settings = _settings;
+		file_offset = 0;
+		recording_file_header header;
+		memcpy(header.magic, file_magic, sizeof(file_magic));
+		header.version = file_version;
+		header.reserved = 0;
+		header.trailer_offset = 0;
+		if (!write_bytes(&header, sizeof(header))) {
+			fclose(fp);
+			fp = 0;
+			return false;
+		}
+		stream_formats.clear();
+		has_parameters = false;
+		parameters = emulator_parameters();
+		index.clear();
+		first_seq = next_encode_seq = 0;
+		stop_request = write_failed = false;
+		nr_dropped_frames = 0;
+		unsigned nr_threads = settings.nr_encoder_threads;
+		if (nr_threads == 0)
+			nr_threads = max(thread::hardware_concurrency(), 2u) - 1;
+		for (unsigned i = 0; i < nr_threads; ++i)
+			threads.push_back(thread(&recording_writer::encoder_kernel, this));
+		threads.push_back(thread(&recording_writer::writer_kernel, this));
+		return true;
+	}
+
+	void recording_writer::set_stream_formats(const vector<stream_format>& _stream_formats)
+	{
+		lock_guard<mutex> lock(queue_mutex);
+		stream_formats = _stream_formats;
+	}
+
+	void recording_writer::set_emulator_parameters(const emulator_parameters& _parameters)
+	{
+		lock_guard<mutex> lock(queue_mutex);
+		parameters = _parameters;
+		has_parameters = true;
+	}
+
+	bool recording_writer::write_frame(unsigned stream, const frame_type& frame, const frame_info* info)
+	{
+		if (!fp)
+			return false;
+		unique_ptr<job> j(new job);
+		j->stream = stream;
+		j->frame = frame;
+		j->info = frame;
+		if (info) {
+			j->info.frame_index = info->frame_index;
+			j->info.time = info->time;
+			j->info.system_time_stamp = info->system_time_stamp;
+			j->info.device_time_stamp = info->device_time_stamp;
+		}
+		j->codec = choose_codec(frame, settings.lossless_color);
+		j->done = false;
+		unique_lock<mutex> lock(queue_mutex);
+		while (!write_failed && jobs.size() >= max(settings.max_nr_queued_frames, 1u)) {
+			if (settings.drop_frames_when_full) {
+				++nr_dropped_frames;
+				return false;
+			}
+			job_removed.wait(lock);
+		}
+		if (write_failed)
+			return false;
+		jobs.push_back(move(j));
+		job_added.notify_all();
+		return true;
+	}
+
+	void recording_writer::encoder_kernel()
+	{
+		unique_lock<mutex> lock(queue_mutex);
+		for (;;) {
+			while (next_encode_seq == first_seq + jobs.size() && !stop_request)
+				job_added.wait(lock);
+			if (next_encode_seq == first_seq + jobs.size())
+				return;
+			job* j = jobs[size_t(next_encode_seq - first_seq)].get();
+			++next_encode_seq;
+			lock.unlock();
+			// store incompressible frames uncompressed
+			if (!encode_frame(j->frame, j->codec, j->data, settings.jpeg_quality) || j->data.size() > j->frame.frame_data.size()) {
+				j->codec = FC_RAW;
+				j->data = j->frame.frame_data;
+			}
+			// release frame data as soon as possible to bound memory consumption
+			vector<char>().swap(j->frame.frame_data);
+			lock.lock();
+			j->done = true;
+			job_done.notify_all();
+		}
+	}
+
+	void recording_writer::writer_kernel()
+	{
+		unique_lock<mutex> lock(queue_mutex);
+		for (;;) {
+			while (!(!jobs.empty() && jobs.front()->done) && !(jobs.empty() && stop_request))
+				job_done.wait(lock);
+			if (jobs.empty())
+				return;
+			unique_ptr<job> j = move(jobs.front());
+			jobs.pop_front();
+			++first_seq;
+			job_removed.notify_all();
+			lock.unlock();
+			recording_index_entry entry = {};
+			entry.offset = file_offset;
+			entry.frame_index = j->info.frame_index;
+			entry.time = j->info.time;
+			recording_chunk_header ch;
+			memset(&ch, 0, sizeof(ch));
+			ch.stream = j->stream;
+			ch.codec = j->codec;
+			ch.data_size = j->data.size();
+			ch.info = j->info;
+			bool success = !write_failed &&
+				write_bytes(chunk_tag, sizeof(chunk_tag)) &&
+				write_bytes(&ch, sizeof(ch)) &&
+				write_bytes(j->data.data(), j->data.size());
+			lock.lock();
+			if (success)
+				index[j->stream].push_back(entry);
+			else {
+				write_failed = true;
+				job_removed.notify_all();
+			}
+		}
+	}
+
+	bool recording_writer::close()
+	{
+		if (!fp)
+			return false;
+		{
+			lock_guard<mutex> lock(queue_mutex);
+			stop_request = true;
+			job_added.notify_all();
+			job_done.notify_all();
+		}
+		for (auto& t : threads)
+			t.join();
+		threads.clear();
+
+		bool success = !write_failed;
+		uint64_t trailer_offset = file_offset;
+		uint32_t nr_streams = uint32_t(stream_formats.size());
+		uint32_t has_params = has_parameters ? 1 : 0;
+		uint32_t nr_index_streams = uint32_t(index.size());
+		success = success &&
+			write_bytes(trailer_tag, sizeof(trailer_tag)) &&
+			write_bytes(&nr_streams, sizeof(nr_streams)) &&
+			write_bytes(stream_formats.data(), stream_formats.size() * sizeof(stream_format)) &&
+			write_bytes(&has_params, sizeof(has_params)) &&
+			write_bytes(&parameters, sizeof(parameters)) &&
+			write_bytes(&nr_index_streams, sizeof(nr_index_streams));
+		for (const auto& si : index) {
+			uint64_t nr_entries = si.second.size();
+			success = success &&
+				write_bytes(&si.first, sizeof(si.first)) &&
+				write_bytes(&nr_entries, sizeof(nr_entries)) &&
+				write_bytes(si.second.data(), si.second.size() * sizeof(recording_index_entry));
+		}
+		// reference trailer in header only after it has been written completely
+		if (success) {
+			fflush(fp);
+			success = seek64(fp, offsetof(recording_file_header, trailer_offset)) &&
+				fwrite(&trailer_offset, sizeof(trailer_offset), 1, fp) == 1;
+		}
+		if (fclose(fp) != 0)
+			success = false;
+		fp = 0;
+		jobs.clear();
+		index.clear();
+		return success;
+	}
+
+	recording_reader::recording_reader() : fp(0), has_parameters(false)
+	{
+	}
+
+	recording_reader::~recording_reader()
+	{
+		close();
+	}
+
+	bool recording_reader::read_trailer(uint64_t offset)
+	{
+		char tag[4];
+		uint32_t nr_streams, has_params, nr_index_streams;
+		if (!seek64(fp, offset) || fread(tag, 1, 4, fp) != 4 || memcmp(tag, trailer_tag, 4) != 0 || !read_value(fp, nr_streams))
+			return false;
+		stream_formats.resize(nr_streams);
+		if (nr_streams > 0 && fread(stream_formats.data(), sizeof(stream_format), nr_streams, fp) != nr_streams)
+			return false;
+		if (!read_value(fp, has_params) || !read_value(fp, parameters) || !read_value(fp, nr_index_streams))
+			return false;
+		has_parameters = has_params != 0;
+		for (uint32_t i = 0; i < nr_index_streams; ++i) {
+			uint32_t stream;
+			uint64_t nr_entries;
+			if (!read_value(fp, stream) || !read_value(fp, nr_entries))
+				return false;
+			vector<recording_index_entry>& entries = index[stream];
+			entries.resize(size_t(nr_entries));
+			if (nr_entries > 0 && fread(entries.data(), sizeof(recording_index_entry), entries.size(), fp) != entries.size())
+				return false;
+		}
+		return true;
+	}
+
+	bool recording_reader::scan_chunks()
+	{
+		uint64_t offset = sizeof(recording_file_header);
+		for (;;) {
+			char tag[4];
+			recording_chunk_header ch;
+			if (!seek64(fp, offset) || fread(tag, 1, 4, fp) != 4 || memcmp(tag, chunk_tag, 4) != 0 || !read_value(fp, ch))
+				break;
+			uint64_t next_offset = offset + sizeof(tag) + sizeof(ch) + ch.data_size;
+			// skip truncated chunk at the end of an interrupted recording
+			if (!seek64(fp, next_offset - 1) || fgetc(fp) == EOF)
+				break;
+			recording_index_entry entry = {};
+			entry.offset = offset;
+			entry.frame_index = ch.info.frame_index;
+			entry.time = ch.info.time;
+			index[ch.stream].push_back(entry);
+			// without trailer stream formats are derived from the first frames with a default frame rate
+			if (index[ch.stream].size() == 1 && ch.stream != RS_WARPED_COLOR) {
+				stream_format sf(ch.info.width, ch.info.height, ch.info.pixel_format, 30, ch.info.nr_bits_per_pixel, ch.info.buffer_size);
+				stream_formats.push_back(sf);
+			}
+			offset = next_offset;
+		}
+		return !index.empty();
+	}
+
+	bool recording_reader::open(const string& file_name)
+	{
+		close();
+		fp = fopen(file_name.c_str(), "rb");
+		if (!fp)
+			return false;
+		recording_file_header header;
+		if (!read_value(fp, header) || memcmp(header.magic, file_magic, sizeof(file_magic)) != 0 || header.version != file_version) {
+			close();
+			return false;
+		}
+		if (header.trailer_offset != 0 && read_trailer(header.trailer_offset))
+			return true;
+		stream_formats.clear();
+		has_parameters = false;
+		index.clear();
+		if (!scan_chunks()) {
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void recording_reader::close()
+	{
+		if (fp) {
+			fclose(fp);
+			fp = 0;
+		}
+		stream_formats.clear();
+		has_parameters = false;
+		index.clear();
+	}
+
+	bool recording_reader::get_emulator_parameters(emulator_parameters& _parameters) const
+	{
+		if (!has_parameters)
+			return false;
+		_parameters = parameters;
+		return true;
+	}
+
+	size_t recording_reader::get_nr_frames(unsigned stream) const
+	{
+		auto iter = index.find(stream);
+		return iter == index.end() ? 0 : iter->second.size();
+	}
+
+	const recording_index_entry& recording_reader::get_index_entry(unsigned stream, size_t i) const
+	{
+		return index.find(stream)->second[i];
+	}
+
+	size_t recording_reader::find_frame(unsigned stream, double time) const
+	{
+		auto iter = index.find(stream);
+		if (iter == index.end())
+			return 0;
+		const vector<recording_index_entry>& entries = iter->second;
+		return lower_bound(entries.begin(), entries.end(), time,
+			[](const recording_index_entry& e, double t) { return e.time < t; }) - entries.begin();
+	}
+
+	bool recording_reader::read_frame(unsigned stream, size_t i, frame_type& frame)
+	{
+		if (!fp || i >= get_nr_frames(stream))
+			return false;
+		char tag[4];
+		recording_chunk_header ch;
+		if (!seek64(fp, get_index_entry(stream, i).offset) || fread(tag, 1, 4, fp) != 4 ||
+			memcmp(tag, chunk_tag, 4) != 0 || !read_value(fp, ch) || ch.stream != stream)
+			return false;
+		data.resize(size_t(ch.data_size));
+		if (!data.empty() && fread(data.data(), 1, data.size(), fp) != data.size())
+			return false;
+		static_cast<frame_info&>(frame) = ch.info;
+		return decode_frame(data.data(), data.size(), FrameCodec(ch.codec), frame);
+	}
+
+	bool is_recording_file(const string& file_name)
+	{
+		FILE* fp = fopen(file_name.c_str(), "rb");
+		if (!fp)
+			return false;
+		char magic[8];
+		bool result = fread(magic, 1, 8, fp) == 8 && memcmp(magic, file_magic, 8) == 0;
+		fclose(fp);
+		return result;
+	}
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <map>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "frame_codec.h"
+#include "rgbd_device.h"
+
+#include "lib_begin.h"
+
+namespace rgbd {
+
+	/// stream identifier of color frames warped to the depth image, which are recorded next to the InputStreams
+	const unsigned RS_WARPED_COLOR = 128;
+
+	/// header of each frame chunk in a recording file, which is followed by the encoded frame data
+	struct recording_chunk_header
+	{
+		/// stream of frame given by InputStreams or RS_WARPED_COLOR
+		uint32_t stream;
+		/// codec of encoded frame data
+		uint32_t codec;
+		/// size of encoded frame data in bytes
+		uint64_t data_size;
+		/// format, index and time stamps of frame
+		frame_info info;
+	};
+
+	/// entry of the frame index of a recording
+	struct recording_index_entry
+	{
+		/// file offset of the chunk header
+		uint64_t offset;
+		/// frame index and time as provided by the device
+		uint32_t frame_index;
+		double time;
+	};
+
+	/// settings of recording_writer
+	struct recording_settings
+	{
+		/// number of threads encoding frames, where 0 selects the number of cores minus one
+		unsigned nr_encoder_threads = 0;
+		/// maximum number of frames waiting to be encoded or written
+		unsigned max_nr_queued_frames = 16;
+		/// if the queue is full, frames are dropped instead of blocking the caller of write_frame
+		bool drop_frames_when_full = false;
+		/// whether to compress color frames lossless with png instead of jpeg
+		bool lossless_color = false;
+		/// jpeg quality in [0,100]
+		int jpeg_quality = 90;
+	};
+
+	/** single file container to record rgbd frames of several streams. The file starts with a header and is
+	    followed by chunks of a recording_chunk_header and the encoded frame data. 16 bit frames are compressed
+		 lossless by FC_DELTA_RICE and color frames by FC_JPEG or FC_PNG. On close, a trailer with the stream formats,
+		 the emulator parameters and the frame index is appended and referenced by the header. Frames are encoded by a
+		 pool of threads and written in the order of write_frame() calls by a separate writer thread. */
+	class CGV_API recording_writer
+	{
+	protected:
+		/// frame in the queue
+		struct job
+		{
+			uint32_t stream;
+			frame_type frame;
+			frame_info info;
+			FrameCodec codec;
+			std::vector<char> data;
+			bool done;
+		};
+		recording_settings settings;
+		FILE* fp;
+		uint64_t file_offset;
+		std::vector<stream_format> stream_formats;
+		bool has_parameters;
+		emulator_parameters parameters;
+		std::map<uint32_t, std::vector<recording_index_entry> > index;
+		/// queue of frames in order of write_frame() calls, where job of sequence number s is jobs[s-first_seq]
+		std::deque<std::unique_ptr<job> > jobs;
+		uint64_t first_seq, next_encode_seq;
+		bool stop_request, write_failed;
+		size_t nr_dropped_frames;
+		std::mutex queue_mutex;
+		std::condition_variable job_added, job_done, job_removed;
+		std::vector<std::thread> threads;
+		void encoder_kernel();
+		void writer_kernel();
+		bool write_bytes(const void* data, size_t size);
+	public:
+		/// construct closed writer
+		recording_writer();
+		/// closes the file if necessary
+		~recording_writer();
+		/// create a new recording file and start encoder threads
+		bool open(const std::string& file_name, const recording_settings& _settings = recording_settings());
+		/// check whether file is open
+		bool is_open() const { return fp != 0; }
+		/// set the stream formats stored in the trailer
+		void set_stream_formats(const std::vector<stream_format>& _stream_formats);
+		/// set the emulator parameters stored in the trailer
+		void set_emulator_parameters(const emulator_parameters& _parameters);
+		/// queue a copy of the frame for encoding, which blocks while the queue is full unless frames should be dropped; return false if frame was dropped or writing failed; if given, index and time stamps are taken from info
+		bool write_frame(unsigned stream, const frame_type& frame, const frame_info* info = 0);
+		/// return the number of dropped frames
+		size_t get_nr_dropped_frames() const { return nr_dropped_frames; }
+		/// wait for all queued frames, write the trailer and close the file; return false if writing failed
+		bool close();
+	};
+
+	/// random access to the frames of a recording file, where the index is rebuilt by scanning the chunks if the recording has not been closed
+	class CGV_API recording_reader
+	{
+	protected:
+		FILE* fp;
+		std::vector<stream_format> stream_formats;
+		bool has_parameters;
+		emulator_parameters parameters;
+		std::map<uint32_t, std::vector<recording_index_entry> > index;
+		std::vector<char> data;
+		bool read_trailer(uint64_t offset);
+		bool scan_chunks();
+	public:
+		/// construct closed reader
+		recording_reader();
+		/// closes the file
+		~recording_reader();
+		/// open a recording file and read or rebuild its index
+		bool open(const std::string& file_name);
+		/// check whether file is open
+		bool is_open() const { return fp != 0; }
+		/// close file
+		void close();
+		/// return the formats of the recorded streams
+		const std::vector<stream_format>& get_stream_formats() const { return stream_formats; }
+		/// copy emulator parameters if they have been recorded
+		bool get_emulator_parameters(emulator_parameters& _parameters) const;
+		/// return the number of frames of a stream given by InputStreams or RS_WARPED_COLOR
+		size_t get_nr_frames(unsigned stream) const;
+		/// return the index entry of the i-th frame of a stream
+		const recording_index_entry& get_index_entry(unsigned stream, size_t i) const;
+		/// return the position of the first frame of the stream with a time not smaller than the given one or the number of frames if there is none
+		size_t find_frame(unsigned stream, double time) const;
+		/// read and decode the i-th frame of a stream
+		bool read_frame(unsigned stream, size_t i, frame_type& frame);
+	};
+	/// check whether a file starts with the magic of recording files
+	extern CGV_API bool is_recording_file(const std::string& file_name);
+}
+
+#include <cgv/config/lib_end.h>
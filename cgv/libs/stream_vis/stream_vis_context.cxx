@@ -234,9 +234,12 @@ namespace stream_vis {
 		last_use_vbo = use_vbo = false;
 		plot_attributes_initialized = false;
 		aabb_mode = last_aabb_mode = AM_BRUTE_FORCE;
+		ingestion_queue = 0;
+		nr_reported_drops = 0;
 	}
 	stream_vis_context::~stream_vis_context()
 	{
+		delete ingestion_queue;
 		for (auto& tsp : typed_time_series)
 			delete tsp;
 	}
@@ -448,6 +451,46 @@ namespace stream_vis {
 			--nr_uninitialized_offsets;
 		}
 	}
+	void stream_vis_context::enable_value_ingestion(size_t capacity, uint16_t max_nr_values)
+	{
+		delete ingestion_queue;
+		ingestion_queue = new value_ingestion_queue(capacity, max_nr_values);
+		nr_reported_drops = 0;
+	}
+	bool stream_vis_context::ingest_values(uint16_t num_values, const indexed_value* values, double timestamp)
+	{
+		return ingestion_queue && ingestion_queue->push(num_values, values, timestamp);
+	}
+	size_t stream_vis_context::process_ingested_values(size_t max_nr_samples)
+	{
+		if (!ingestion_queue)
+			return 0;
+		ingestion_val_idx_from_ts_idx.resize(typed_time_series.size(), uint16_t(-1));
+		uint16_t* val_idx_from_ts_idx = ingestion_val_idx_from_ts_idx.data();
+		size_t nr_samples = ingestion_queue->consume([&](const value_ingestion_queue::sample& smp) {
+			for (uint16_t i = 0; i < smp.num_values; ++i)
+				if (smp.values[i].index < ingestion_val_idx_from_ts_idx.size())
+					val_idx_from_ts_idx[smp.values[i].index] = i;
+			announce_values(smp.num_values, smp.values, smp.timestamp, val_idx_from_ts_idx);
+			for (auto* ts_ptr : typed_time_series)
+				ts_ptr->set_new_value(ts_ptr->extract_from_values(smp.num_values, smp.values, smp.timestamp, val_idx_from_ts_idx));
+			for (uint16_t i = 0; i < smp.num_values; ++i)
+				if (smp.values[i].index < ingestion_val_idx_from_ts_idx.size())
+					val_idx_from_ts_idx[smp.values[i].index] = uint16_t(-1);
+		}, max_nr_samples);
+		if (nr_samples > 0)
+			outofdate = true;
+		size_t nr_dropped = ingestion_queue->get_nr_dropped_samples();
+		if (nr_dropped > nr_reported_drops) {
+			std::cerr << get_name() << ": dropped " << nr_dropped - nr_reported_drops << " samples due to full ingestion queue" << std::endl;
+			nr_reported_drops = nr_dropped;
+		}
+		return nr_samples;
+	}
+	size_t stream_vis_context::get_nr_dropped_samples() const
+	{
+		return ingestion_queue ? ingestion_queue->get_nr_dropped_samples() : 0;
+	}
 	void stream_vis_context::show_plots() const
 	{
 		for (const auto& pl : plot_pool) {
@@ -792,6 +835,8 @@ namespace stream_vis {
 //		else {
 //			if (view_ptr->get_y_extent_at_focus() )
 //		}
+		if (ingestion_queue)
+			process_ingested_values();
 		update_plot_samples(ctx);
 		update_plot_domains();
 		for (auto& pl : plot_pool)
@@ -6,6 +6,7 @@
 #include "view_overlay.h"
 #include "streaming_time_series.h"
 #include "streaming_aabb.h"
+#include "value_ingestion_queue.h"
 #include <cgv/base/node.h>
 #include <cgv/os/thread.h>
 #include <cgv/os/mutex.h>
@@ -66,6 +67,13 @@ namespace stream_vis {
 		/// vector of all layouts
 //		std::vector<layout_info> layouts;
 
+		/// queue of samples handed over from producer threads, which is only allocated if enabled
+		value_ingestion_queue* ingestion_queue;
+		/// number of dropped samples that has already been reported
+		size_t nr_reported_drops;
+		/// per time series index of its value in the currently processed sample or -1
+		std::vector<uint16_t> ingestion_val_idx_from_ts_idx;
+
 		bool paused;
 		unsigned sleep_ms;
 
@@ -92,6 +100,14 @@ namespace stream_vis {
 		~stream_vis_context();
 		virtual size_t get_first_composed_index() const = 0;
 		void announce_values(uint16_t num_values, indexed_value* values, double timestamp, const uint16_t* val_idx_from_ts_idx);
+		/// allocate the queue used by ingest_values() with at least the given number of slots for samples of up to max_nr_values values
+		void enable_value_ingestion(size_t capacity = 4096, uint16_t max_nr_values = 64);
+		/// hand over a sample from any thread without blocking, where value indices refer to time series; returns false if sample was dropped
+		bool ingest_values(uint16_t num_values, const indexed_value* values, double timestamp);
+		/// move up to max_nr_samples queued samples into the time series and return their number; called from init_frame() if ingestion is enabled
+		size_t process_ingested_values(size_t max_nr_samples = size_t(-1));
+		/// return the number of samples dropped by ingest_values()
+		size_t get_nr_dropped_samples() const;
 		void on_set(void* member_ptr);
 		std::string get_type_name() const { return "stream_vis_context"; }
 		virtual void extract_time_series() = 0;
@@ -0,0 +1,60 @@
+#include "value_ingestion_queue.h"
+#include <algorithm>
+#include <cstring>
+
+namespace stream_vis {
+
+	value_ingestion_queue::value_ingestion_queue(size_t min_capacity, uint16_t _max_nr_values)
+		: capacity(2), max_nr_values(_max_nr_values), tail(0), nr_dropped(0), head(0)
+	{
+		while (capacity < min_capacity)
+			capacity *= 2;
+		mask = capacity - 1;
+		slots = std::vector<slot>(capacity);
+		for (size_t i = 0; i < capacity; ++i)
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		value_storage.resize(capacity * max_nr_values);
+	}
+	bool value_ingestion_queue::push(uint16_t num_values, const indexed_value* values, double timestamp)
+	{
+		if (num_values > max_nr_values) {
+			nr_dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		size_t pos = tail.load(std::memory_order_relaxed);
+		slot* s;
+		for (;;) {
+			s = &slots[pos & mask];
+			size_t seq = s->sequence.load(std::memory_order_acquire);
+			std::ptrdiff_t dif = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+			if (dif == 0) {
+				if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			// slot still holds a sample not yet consumed
+			else if (dif < 0) {
+				nr_dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			else
+				pos = tail.load(std::memory_order_relaxed);
+		}
+		s->timestamp = timestamp;
+		s->num_values = num_values;
+		if (num_values > 0)
+			std::memcpy(&value_storage[(pos & mask) * max_nr_values], values, num_values * sizeof(indexed_value));
+		s->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+	size_t value_ingestion_queue::get_nr_queued_samples() const
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		size_t t = tail.load(std::memory_order_relaxed);
+		return t > h ? t - h : 0;
+	}
+	bool value_ingestion_queue::empty() const
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		return slots[h & mask].sequence.load(std::memory_order_acquire) != h + 1;
+	}
+}
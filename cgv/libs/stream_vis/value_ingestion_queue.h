@@ -0,0 +1,80 @@
+#pragma once
+
+#include "streaming_time_series.h"
+#include <atomic>
+#include <vector>
+
+#include "lib_begin.h"
+
+namespace stream_vis {
+
+	/** Bounded lock-free queue that allows several producer threads to hand over samples of indexed values to a single
+	    consumer, typically the thread that updates the time series of a stream_vis_context. Each slot of the ring
+		 buffer stores a timestamp and up to a fixed number of indexed values in preallocated storage, such that
+		 push() neither allocates nor blocks. Samples that do not fit into the queue or into a slot are dropped and
+		 counted. Slots are claimed with a compare and swap on the tail position and published through per slot
+		 sequence numbers. */
+	class CGV_API value_ingestion_queue
+	{
+	public:
+		/// sample view passed to the consumer
+		struct sample
+		{
+			double timestamp;
+			uint16_t num_values;
+			indexed_value* values;
+		};
+	protected:
+		struct slot
+		{
+			std::atomic<size_t> sequence;
+			double timestamp;
+			uint16_t num_values;
+		};
+		size_t capacity, mask;
+		uint16_t max_nr_values;
+		std::vector<slot> slots;
+		std::vector<indexed_value> value_storage;
+		/// position of next slot to be claimed by a producer
+		alignas(64) std::atomic<size_t> tail;
+		/// number of dropped samples
+		alignas(64) std::atomic<size_t> nr_dropped;
+		/// position of next slot read by the consumer, which is only written by the consumer and atomic such that producers can estimate the queue length
+		alignas(64) std::atomic<size_t> head;
+	public:
+		/// construct queue with at least the given number of slots, which is rounded up to a power of two, and the maximum number of values per sample
+		value_ingestion_queue(size_t min_capacity = 4096, uint16_t _max_nr_values = 64);
+		/// return number of slots
+		size_t get_capacity() const { return capacity; }
+		/// return maximum number of values per sample
+		uint16_t get_max_nr_values() const { return max_nr_values; }
+		/// try to append a sample from any thread without blocking; returns false and counts the sample as dropped if the queue is full or the sample has too many values
+		bool push(uint16_t num_values, const indexed_value* values, double timestamp);
+		/// return number of samples dropped so far
+		size_t get_nr_dropped_samples() const { return nr_dropped.load(std::memory_order_relaxed); }
+		/// return an estimate of the number of queued samples, which can be called from any thread
+		size_t get_nr_queued_samples() const;
+		/// return whether there is no published sample to be consumed; must only be called by the consumer
+		bool empty() const;
+		/// pass up to max_nr_samples queued samples in order of their publication to f(const sample&) and return their number; must only be called by the consumer
+		template <typename F>
+		size_t consume(F f, size_t max_nr_samples = size_t(-1))
+		{
+			size_t n = 0;
+			size_t h = head.load(std::memory_order_relaxed);
+			while (n < max_nr_samples) {
+				slot& s = slots[h & mask];
+				if (s.sequence.load(std::memory_order_acquire) != h + 1)
+					break;
+				sample smp = { s.timestamp, s.num_values, &value_storage[(h & mask) * max_nr_values] };
+				f(static_cast<const sample&>(smp));
+				s.sequence.store(h + capacity, std::memory_order_release);
+				head.store(++h, std::memory_order_relaxed);
+				++n;
+			}
+			return n;
+		}
+	};
+}
+
+#include <cgv/config/lib_end.h>
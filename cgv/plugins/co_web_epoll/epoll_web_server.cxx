@@ -0,0 +1,647 @@
+#include "epoll_web_server.h"
+
+#include <cgv/os/task_scheduler.h>
+#include <cgv/utils/convert.h>
+#include <cgv/utils/scan.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// event loop and worker pool of one web server instance
+class epoll_web_server
+{
+protected:
+	typedef std::chrono::steady_clock clock;
+	/// epoll user data of the listening socket and the event used to signal finished requests, connections use larger ids
+	enum { LISTEN_ID = 0, EVENT_ID = 1 };
+	/// state of a client connection, which is only accessed by the event loop
+	struct connection
+	{
+		int fd;
+		uint64_t id;
+		/// received data that has not been consumed by a request yet
+		std::string input;
+		/// response data that has not been sent yet
+		std::string output;
+		size_t output_offset = 0;
+		/// file that is sent after the output or -1
+		int file_fd = -1;
+		off_t file_offset = 0;
+		off_t file_end = 0;
+		/// whether the connection is kept open after the current response
+		bool keep_alive = true;
+		/// whether a request of this connection is handled by a worker
+		bool busy = false;
+		/// whether a complete request waits for the number of pending requests to drop
+		bool stalled = false;
+		/// whether the peer hung up while a worker handled a request, such that the socket is no longer watched by epoll
+		bool hung_up = false;
+		/// whether the peer shut down its sending side, such that the connection is closed after the received requests are answered
+		bool read_closed = false;
+		/// currently registered epoll events
+		uint32_t events = EPOLLIN | EPOLLRDHUP;
+		clock::time_point last_activity;
+		/// check whether response data has not been sent completely
+		bool has_output() const { return output_offset < output.size() || file_fd >= 0; }
+	};
+	/// response prepared by a worker thread
+	struct response
+	{
+		uint64_t connection_id;
+		std::string data;
+		int file_fd;
+		off_t file_size;
+		bool keep_alive;
+	};
+	cgv::os::web_server* instance;
+	epoll_web_server_configuration configuration;
+	int listen_fd, epoll_fd, event_fd;
+	bool accepting;
+	std::atomic<bool> stop_request;
+	std::unordered_map<uint64_t, std::unique_ptr<connection> > connections;
+	uint64_t next_connection_id;
+	/// ids of connections with stalled requests in the order of arrival
+	std::deque<uint64_t> stalled;
+	/// number of requests submitted to the workers whose responses have not been processed yet
+	unsigned nr_pending;
+	/// responses finished by workers
+	std::mutex responses_mutex;
+	std::vector<response> responses;
+	std::unique_ptr<cgv::os::task_scheduler> workers;
+
+	static std::string get_date()
+	{
+		char buffer[64];
+		time_t t = time(0);
+		tm gmt;
+		gmtime_r(&t, &gmt);
+		strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
+		return buffer;
+	}
+	static std::string compose_header(const std::string& status_lines, const std::string& content_type, size_t content_length, bool keep_alive)
+	{
+		std::string h = "HTTP/1.1 " + status_lines + "\r\n";
+		h += "Date: " + get_date() + "\r\n";
+		h += "Server: cgv web server\r\n";
+		h += keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+		h += "Content-Type: " + (content_type.empty() ? std::string("text/html; charset=ISO-8859-1") : content_type) + "\r\n";
+		h += "Content-Length: " + std::to_string(content_length) + "\r\n\r\n";
+		return h;
+	}
+	/// replace + and %xy in url parameter values
+	static std::string decode_url(const std::string& s)
+	{
+		std::string d;
+		for (size_t i = 0; i < s.size(); ++i) {
+			if (s[i] == '+')
+				d += ' ';
+			else if (s[i] == '%' && i + 2 < s.size() && isxdigit(s[i + 1]) && isxdigit(s[i + 2])) {
+				d += char(std::stoi(s.substr(i + 1, 2), 0, 16));
+				i += 2;
+			}
+			else
+				d += s[i];
+		}
+		return d;
+	}
+	/// split request target into path and parameters
+	static void split_target(const std::string& target, std::string& path, std::map<std::string, std::string>& params)
+	{
+		size_t qm = target.find('?');
+		path = target.substr(0, qm);
+		if (qm == std::string::npos)
+			return;
+		size_t pos = qm + 1;
+		while (pos <= target.size()) {
+			size_t amp = target.find('&', pos);
+			if (amp == std::string::npos)
+				amp = target.size();
+			std::string name_value = target.substr(pos, amp - pos);
+			size_t eq = name_value.find('=');
+			params.insert(std::make_pair(name_value.substr(0, eq), eq == std::string::npos ? std::string() : decode_url(name_value.substr(eq + 1))));
+			pos = amp + 1;
+		}
+	}
+	/// change registered events of a connection if necessary
+	void set_events(connection& c, uint32_t events)
+	{
+		if (c.events == events)
+			return;
+		epoll_event ev;
+		ev.events = events;
+		ev.data.u64 = c.id;
+		epoll_ctl(epoll_fd, EPOLL_CTL_MOD, c.fd, &ev);
+		c.events = events;
+	}
+	/// wait for writability while output is pending and read only if a new request can be handled and the peer can still send
+	void update_events(connection& c)
+	{
+		if (c.has_output())
+			set_events(c, EPOLLOUT);
+		else
+			set_events(c, (c.busy || c.stalled || c.read_closed) ? 0 : uint32_t(EPOLLIN | EPOLLRDHUP));
+	}
+	void enable_accepting(bool enable)
+	{
+		if (accepting == enable)
+			return;
+		epoll_event ev;
+		ev.events = enable ? uint32_t(EPOLLIN) : 0;
+		ev.data.u64 = LISTEN_ID;
+		epoll_ctl(epoll_fd, EPOLL_CTL_MOD, listen_fd, &ev);
+		accepting = enable;
+	}
+	void close_connection(connection& c)
+	{
+		epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c.fd, 0);
+		close(c.fd);
+		if (c.file_fd >= 0)
+			close(c.file_fd);
+		uint64_t id = c.id;
+		connections.erase(id);
+		enable_accepting(true);
+	}
+	void accept_connections()
+	{
+		while (connections.size() < configuration.max_connections) {
+			int fd = accept4(listen_fd, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if (fd < 0) {
+				if (errno == EINTR || errno == ECONNABORTED)
+					continue;
+				// out of file descriptors, retry once a connection is closed
+				if (errno == EMFILE || errno == ENFILE)
+					enable_accepting(false);
+				return;
+			}
+			int one = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+			std::unique_ptr<connection> c(new connection());
+			c->fd = fd;
+			c->id = next_connection_id++;
+			c->last_activity = clock::now();
+			epoll_event ev;
+			ev.events = c->events;
+			ev.data.u64 = c->id;
+			if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+				close(fd);
+				continue;
+			}
+			connections[c->id] = std::move(c);
+		}
+		enable_accepting(false);
+	}
+	/// send error response and close connection afterwards
+	bool send_error(connection& c, const std::string& status)
+	{
+		c.input.clear();
+		c.keep_alive = false;
+		c.output = compose_header(status, "", 0, false);
+		c.output_offset = 0;
+		return flush(c);
+	}
+	/// read available data and return false if the connection has been closed
+	bool receive(connection& c)
+	{
+		char buffer[65536];
+		while (true) {
+			ssize_t n = recv(c.fd, buffer, sizeof(buffer), 0);
+			if (n > 0) {
+				c.input.append(buffer, size_t(n));
+				if (c.input.size() > configuration.max_header_size + configuration.max_body_size)
+					break;
+				continue;
+			}
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+				break;
+			// half-close of the peer, which still waits for the responses to the received requests
+			if (n == 0) {
+				c.read_closed = true;
+				break;
+			}
+			close_connection(c);
+			return false;
+		}
+		c.last_activity = clock::now();
+		return dispatch(c);
+	}
+	/// wait for more input of an incomplete request or close the connection if the peer does not send anymore
+	bool wait_for_input(connection& c)
+	{
+		if (c.read_closed) {
+			close_connection(c);
+			return false;
+		}
+		update_events(c);
+		return true;
+	}
+	/// send pending output and return false if the connection has been closed
+	bool flush(connection& c)
+	{
+		while (c.output_offset < c.output.size()) {
+			ssize_t n = send(c.fd, c.output.data() + c.output_offset, c.output.size() - c.output_offset,
+				MSG_NOSIGNAL | (c.file_fd >= 0 ? MSG_MORE : 0));
+			if (n >= 0) {
+				c.output_offset += size_t(n);
+				continue;
+			}
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				update_events(c);
+				return true;
+			}
+			close_connection(c);
+			return false;
+		}
+		c.output.clear();
+		c.output_offset = 0;
+		while (c.file_fd >= 0 && c.file_offset < c.file_end) {
+			ssize_t n = sendfile(c.fd, c.file_fd, &c.file_offset, size_t(c.file_end - c.file_offset));
+			if (n > 0 || (n < 0 && errno == EINTR))
+				continue;
+			if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+				update_events(c);
+				return true;
+			}
+			// file was truncated or connection failed
+			close_connection(c);
+			return false;
+		}
+		if (c.file_fd >= 0) {
+			close(c.file_fd);
+			c.file_fd = -1;
+		}
+		if (!c.keep_alive) {
+			close_connection(c);
+			return false;
+		}
+		c.last_activity = clock::now();
+		// handle pipelined request
+		return dispatch(c);
+	}
+	/// parse next request from the input of a connection and submit it to the workers if it is complete
+	bool dispatch(connection& c)
+	{
+		if (c.busy || c.stalled || c.has_output()) {
+			update_events(c);
+			return true;
+		}
+		size_t header_end = c.input.find("\r\n\r\n");
+		if (header_end == std::string::npos) {
+			if (c.input.size() > configuration.max_header_size)
+				return send_error(c, "431 Request Header Fields Too Large");
+			return wait_for_input(c);
+		}
+		if (header_end > configuration.max_header_size)
+			return send_error(c, "431 Request Header Fields Too Large");
+		if (nr_pending >= configuration.max_pending_requests) {
+			c.stalled = true;
+			stalled.push_back(c.id);
+			update_events(c);
+			return true;
+		}
+		std::shared_ptr<cgv::os::http_request> req(new cgv::os::http_request());
+		req->authentication_given = false;
+		req->status = "202 OK";
+		size_t line_end = c.input.find("\r\n");
+		std::string request_line = c.input.substr(0, line_end);
+		size_t sp1 = request_line.find(' ');
+		size_t sp2 = sp1 == std::string::npos ? sp1 : request_line.find(' ', sp1 + 1);
+		if (sp2 == std::string::npos)
+			return send_error(c, "400 Bad Request");
+		req->method = request_line.substr(0, sp1);
+		split_target(request_line.substr(sp1 + 1, sp2 - sp1 - 1), req->path, req->params);
+		std::string version = request_line.substr(sp2 + 1);
+		std::string connection_header;
+		size_t content_length = 0;
+		for (size_t pos = line_end + 2; pos < header_end + 2; ) {
+			size_t end = c.input.find("\r\n", pos);
+			std::string line = c.input.substr(pos, end - pos);
+			pos = end + 2;
+			size_t colon = line.find(':');
+			if (colon == std::string::npos)
+				continue;
+			std::string name = cgv::utils::to_lower(line.substr(0, colon));
+			std::string value = line.substr(colon + 1);
+			cgv::utils::trim(value);
+			if (name == "authorization" && cgv::utils::to_lower(value.substr(0, 6)) == "basic ") {
+				req->authentication_given = true;
+				std::string decoded = cgv::utils::decode_base64(value.substr(6));
+				size_t pos_colon = decoded.find(':');
+				req->username = decoded.substr(0, pos_colon);
+				req->password = pos_colon == std::string::npos ? std::string() : decoded.substr(pos_colon + 1);
+			}
+			else if (name == "accept")
+				req->accept = value;
+			else if (name == "accept-language")
+				req->accept_language = value;
+			else if (name == "accept-encoding")
+				req->accept_encoding = value;
+			else if (name == "user-agent")
+				req->user_agent = value;
+			else if (name == "connection")
+				connection_header = cgv::utils::to_lower(value);
+			else if (name == "content-length") {
+				char* value_end;
+				unsigned long long l = strtoull(value.c_str(), &value_end, 10);
+				if (value.empty() || *value_end != 0)
+					return send_error(c, "400 Bad Request");
+				if (l > configuration.max_body_size)
+					return send_error(c, "413 Payload Too Large");
+				content_length = size_t(l);
+			}
+			else if (name == "transfer-encoding")
+				return send_error(c, "501 Not Implemented");
+		}
+		size_t request_size = header_end + 4 + content_length;
+		if (c.input.size() < request_size)
+			return wait_for_input(c);
+		req->request = c.input.substr(0, request_size);
+		c.input.erase(0, request_size);
+		if (version == "HTTP/1.0")
+			c.keep_alive = connection_header == "keep-alive";
+		else
+			c.keep_alive = connection_header != "close";
+		c.busy = true;
+		++nr_pending;
+		update_events(c);
+		uint64_t id = c.id;
+		bool keep_alive = c.keep_alive;
+		workers->submit(cgv::os::task_scheduler::task{ [this, req, id, keep_alive]() { handle(*req, id, keep_alive); }, 0 });
+		return true;
+	}
+	/// called by workers to handle a request and queue the response
+	void handle(cgv::os::http_request& req, uint64_t id, bool keep_alive)
+	{
+		try {
+			instance->handle_request(req);
+		}
+		catch (...) {
+			req.status = "500 Internal Server Error";
+			req.auth_realm.clear();
+			req.answer.clear();
+			req.file_path.clear();
+		}
+		response r;
+		r.connection_id = id;
+		r.file_fd = -1;
+		r.file_size = 0;
+		r.keep_alive = keep_alive;
+		if (!req.file_path.empty()) {
+			req.answer.clear();
+			r.file_fd = open(req.file_path.c_str(), O_RDONLY | O_CLOEXEC);
+			struct stat st;
+			if (r.file_fd >= 0 && fstat(r.file_fd, &st) == 0 && S_ISREG(st.st_mode))
+				r.file_size = st.st_size;
+			else {
+				if (r.file_fd >= 0)
+					close(r.file_fd);
+				r.file_fd = -1;
+				req.status = "404 Not Found";
+			}
+		}
+		std::string status_lines = req.status;
+		if (!req.auth_realm.empty())
+			status_lines = "401 Unauthorized\r\nWWW-Authenticate: Basic Realm=\"" + req.auth_realm + "\"";
+		r.data = compose_header(status_lines, req.content_type, r.file_fd >= 0 ? size_t(r.file_size) : req.answer.size(), keep_alive);
+		r.data += req.answer;
+		bool was_empty;
+		{
+			std::lock_guard<std::mutex> lock(responses_mutex);
+			was_empty = responses.empty();
+			responses.push_back(std::move(r));
+		}
+		// the event loop reads the event before taking the responses, such that one notification per batch suffices
+		if (was_empty) {
+			uint64_t one = 1;
+			ssize_t n = write(event_fd, &one, sizeof(one));
+			(void)n;
+		}
+	}
+	/// send responses finished by the workers and resume stalled requests
+	void process_responses()
+	{
+		uint64_t value;
+		ssize_t n = read(event_fd, &value, sizeof(value));
+		(void)n;
+		std::vector<response> finished;
+		{
+			std::lock_guard<std::mutex> lock(responses_mutex);
+			finished.swap(responses);
+		}
+		for (response& r : finished) {
+			--nr_pending;
+			auto it = connections.find(r.connection_id);
+			if (it == connections.end()) {
+				if (r.file_fd >= 0)
+					close(r.file_fd);
+				continue;
+			}
+			connection& c = *it->second;
+			if (c.hung_up) {
+				if (r.file_fd >= 0)
+					close(r.file_fd);
+				close_connection(c);
+				continue;
+			}
+			c.busy = false;
+			c.keep_alive = r.keep_alive;
+			c.output = std::move(r.data);
+			c.output_offset = 0;
+			c.file_fd = r.file_fd;
+			c.file_offset = 0;
+			c.file_end = r.file_size;
+			flush(c);
+		}
+		while (nr_pending < configuration.max_pending_requests && !stalled.empty()) {
+			auto it = connections.find(stalled.front());
+			stalled.pop_front();
+			if (it != connections.end()) {
+				it->second->stalled = false;
+				dispatch(*it->second);
+			}
+		}
+	}
+	/// close keep-alive connections that did not send a new request in time
+	void close_idle_connections()
+	{
+		clock::time_point limit = clock::now() - std::chrono::seconds(configuration.keep_alive_timeout);
+		std::vector<connection*> idle;
+		for (auto& c : connections)
+			if (!c.second->busy && !c.second->stalled && !c.second->has_output() && c.second->last_activity < limit)
+				idle.push_back(c.second.get());
+		for (connection* c : idle)
+			close_connection(*c);
+	}
+public:
+	epoll_web_server(cgv::os::web_server* _instance, const epoll_web_server_configuration& _configuration) :
+		instance(_instance), configuration(_configuration), listen_fd(-1), epoll_fd(-1), event_fd(-1),
+		accepting(true), stop_request(false), next_connection_id(2), nr_pending(0)
+	{
+		workers.reset(new cgv::os::task_scheduler(std::max(configuration.nr_workers, 1u)));
+	}
+	~epoll_web_server()
+	{
+		// finish requests before closing the event used by the workers
+		workers.reset();
+		for (auto& c : connections) {
+			close(c.second->fd);
+			if (c.second->file_fd >= 0)
+				close(c.second->file_fd);
+		}
+		for (response& r : responses)
+			if (r.file_fd >= 0)
+				close(r.file_fd);
+		for (int fd : { listen_fd, epoll_fd, event_fd })
+			if (fd >= 0)
+				close(fd);
+	}
+	/// create listening socket, epoll instance and event and print error if this fails
+	bool listen(unsigned int port)
+	{
+		listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+		event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (listen_fd < 0 || epoll_fd < 0 || event_fd < 0) {
+			std::cerr << "epoll web server: " << strerror(errno) << std::endl;
+			return false;
+		}
+		int one = 1;
+		setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+		sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_ANY);
+		addr.sin_port = htons(uint16_t(port));
+		if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listen_fd, configuration.listen_backlog) != 0) {
+			std::cerr << "epoll web server could not listen to port " << port << ": " << strerror(errno) << std::endl;
+			return false;
+		}
+		epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.u64 = LISTEN_ID;
+		epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+		ev.data.u64 = EVENT_ID;
+		epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event_fd, &ev);
+		return true;
+	}
+	/// run event loop until stop() is called
+	void run()
+	{
+		std::vector<epoll_event> events(256);
+		clock::time_point last_idle_check = clock::now();
+		while (!stop_request) {
+			int n = epoll_wait(epoll_fd, events.data(), int(events.size()), 1000);
+			if (n < 0) {
+				if (errno == EINTR)
+					continue;
+				std::cerr << "epoll web server: " << strerror(errno) << std::endl;
+				break;
+			}
+			for (int i = 0; i < n; ++i) {
+				uint64_t id = events[i].data.u64;
+				uint32_t e = events[i].events;
+				if (id == LISTEN_ID) {
+					accept_connections();
+					continue;
+				}
+				if (id == EVENT_ID) {
+					process_responses();
+					continue;
+				}
+				// connection can have been closed by an earlier event of this iteration
+				auto it = connections.find(id);
+				if (it == connections.end())
+					continue;
+				connection& c = *it->second;
+				if (e & EPOLLERR) {
+					close_connection(c);
+					continue;
+				}
+				if ((e & (EPOLLIN | EPOLLRDHUP)) && !receive(c))
+					continue;
+				if ((e & EPOLLOUT) && !flush(c))
+					continue;
+				if (e & EPOLLHUP) {
+					if (!c.busy)
+						close_connection(c);
+					// hang up is reported independent of the registered events, so stop watching the socket until the response is finished
+					else if (!c.hung_up) {
+						epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c.fd, 0);
+						c.hung_up = true;
+					}
+				}
+			}
+			if (clock::now() - last_idle_check > std::chrono::seconds(1)) {
+				close_idle_connections();
+				last_idle_check = clock::now();
+			}
+		}
+		// wait for handlers that are still running
+		workers.reset();
+	}
+	/// request the event loop to stop, which can be called from any thread
+	void stop()
+	{
+		stop_request = true;
+		uint64_t one = 1;
+		ssize_t n = write(event_fd, &one, sizeof(one));
+		(void)n;
+	}
+};
+
+void epoll_web_server_provider::start_web_server(cgv::os::web_server* instance)
+{
+	std::shared_ptr<epoll_web_server> server(new epoll_web_server(instance, configuration));
+	if (!server->listen(instance->get_port()))
+		return;
+	{
+		std::lock_guard<std::mutex> lock(servers_mutex);
+		servers[instance] = server;
+		ref_user_data(instance) = server.get();
+	}
+	server->run();
+	std::lock_guard<std::mutex> lock(servers_mutex);
+	auto it = servers.find(instance);
+	if (it != servers.end() && it->second == server) {
+		servers.erase(it);
+		ref_user_data(instance) = 0;
+	}
+}
+
+void epoll_web_server_provider::stop_web_server(cgv::os::web_server* instance)
+{
+	std::shared_ptr<epoll_web_server> server;
+	{
+		std::lock_guard<std::mutex> lock(servers_mutex);
+		auto it = servers.find(instance);
+		if (it == servers.end())
+			return;
+		server = it->second;
+		servers.erase(it);
+		ref_user_data(instance) = 0;
+	}
+	server->stop();
+}
+
+cgv::os::web_server_provider_registration<epoll_web_server_provider> epoll_web_server_registration;
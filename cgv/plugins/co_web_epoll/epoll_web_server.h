@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cgv/os/web_server.h>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "lib_begin.h"
+
+/// parameters of the epoll based web server
+struct CGV_API epoll_web_server_configuration
+{
+	/// number of worker threads that call web_server::handle_request
+	unsigned nr_workers = 4;
+	/// number of requests that are queued or handled at the same time, further requests are not read until one finishes
+	unsigned max_pending_requests = 256;
+	/// number of open connections, further connections are not accepted until one is closed
+	unsigned max_connections = 4096;
+	/// maximum size of the request line and the headers in bytes
+	size_t max_header_size = 65536;
+	/// maximum size of a request body in bytes
+	size_t max_body_size = 16 * 1024 * 1024;
+	/// seconds after which idle keep-alive connections are closed
+	unsigned keep_alive_timeout = 15;
+	/// length of the queue of connections that have not been accepted yet
+	int listen_backlog = 512;
+};
+
+class epoll_web_server;
+
+/** Web server provider for Linux based on non-blocking sockets and epoll. A single thread, i.e. the one calling
+    web_server::start(), accepts connections, parses requests and sends responses, while requests are handled
+	by a bounded pool of worker threads. Connections are kept alive according to HTTP/1.1 and each connection
+	handles one request at a time, such that pipelined requests are answered in order. If the maximum number of
+	pending requests or connections is reached, no further data is read or no further connections are accepted,
+	which leaves it to TCP flow control to slow down the clients. Responses that set http_request::file_path are
+	sent with sendfile. */
+class CGV_API epoll_web_server_provider : public cgv::os::web_server_provider
+{
+protected:
+	std::mutex servers_mutex;
+	std::map<cgv::os::web_server*, std::shared_ptr<epoll_web_server> > servers;
+public:
+	/// configuration used for web servers started afterwards
+	epoll_web_server_configuration configuration;
+	/// run the event loop of a web server until it is stopped
+	void start_web_server(cgv::os::web_server* instance);
+	/// stop the event loop of a web server from a different thread
+	void stop_web_server(cgv::os::web_server* instance);
+};
+
+#include <cgv/config/lib_end.h>
@@ -0,0 +1,8 @@
+#if defined(CGV_OS_FORCE_STATIC)
+#	define CGV_FORCE_STATIC_LIB
+#endif
+#ifdef CGV_OS_WEB_EPOLL_EXPORTS
+#	define CGV_EXPORTS
+#endif
+
+#include <cgv/config/lib_begin.h>
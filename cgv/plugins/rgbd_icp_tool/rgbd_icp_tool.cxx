@@ -238,6 +238,7 @@ void rgbd_icp_tool::create_gui()
 	add_decorator("Go-ICP", "heading", "level=2");
 	add_member_control(this, "Go-ICP MSE Threshold", goicp.mse_threshhold, "value_slider", "min=0.000001;max=1.0;log=true;ticks=false");
 	add_member_control(this, "Distance Transform size", goicp.distance_transform_size, "value_slider", "min=50;max=1000;ticks=false");
+	add_member_control(this, "Go-ICP Threads", goicp.nr_threads, "value_slider", "min=0;max=64;ticks=false");
 
 	add_member_control(this, "Distance Computaion Mode", (DummyEnum&)goicp_distance_computation_mode, "dropdown", "enums='DISTANCE_TRANSFORM,ANN_TREE'");
 
@@ -535,16 +536,16 @@ void rgbd_icp_tool::on_estimate_normals()
 {
 	
 	if (source_pc.get_nr_points() > 0) {
-		tree_source = std::make_shared<ann_tree>();
+		tree_source = std::make_shared<kd_tree>();
 		tree_source->build(this->source_pc);
-		n_graph.build<ann_tree>(this->source_pc.get_nr_points(), 10, *tree_source);
+		n_graph.build<kd_tree>(this->source_pc.get_nr_points(), 10, *tree_source);
 		n_estimator = new normal_estimator(this->source_pc, this->n_graph);
 		n_estimator->compute_bilateral_weighted_normals(false);
 	}
 	if (target_pc.get_nr_points() > 0) {
-		tree_target = std::make_shared<ann_tree>();
+		tree_target = std::make_shared<kd_tree>();
 		tree_target->build(this->target_pc);
-		n_graph.build<ann_tree>(this->target_pc.get_nr_points(), 10, *tree_target);
+		n_graph.build<kd_tree>(this->target_pc.get_nr_points(), 10, *tree_target);
 		n_estimator = new normal_estimator(this->target_pc, this->n_graph);
 		n_estimator->compute_bilateral_weighted_normals(false);
 	}
@@ -110,7 +110,7 @@ public:
 	cgv::pointcloud::SICP::ComputationMode sicp_computation_mode;
 	normal_estimator* n_estimator;
 	neighbor_graph n_graph;
-	std::shared_ptr<ann_tree> tree_source, tree_target;
+	std::shared_ptr<kd_tree> tree_source, tree_target;
 };
 
 #include <cgv/config/lib_end.h>
\ No newline at end of file
@@ -1077,7 +1077,7 @@ class vr_rgbd : public cgv::base::node,
 		copy_pointcloud(intermediate_pc, source_pc);
 		if (!target_pc.has_normals()) {
 			static constexpr int k = 15;
-			ann_tree neighborhood;
+			kd_tree neighborhood;
 			neighborhood.build(target_pc);
 			neighbor_graph graph;
 			graph.build(target_pc.get_nr_points(), k, neighborhood);
@@ -1087,7 +1087,7 @@ class vr_rgbd : public cgv::base::node,
 		}
 		if (!source_pc.has_normals()) {
 			static constexpr int k = 15;
-			ann_tree neighborhood;
+			kd_tree neighborhood;
 			neighborhood.build(source_pc);
 			neighbor_graph graph;
 			graph.build(source_pc.get_nr_points(), k, neighborhood);
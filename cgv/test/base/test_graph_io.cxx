@@ -0,0 +1,187 @@
+#include <cgv/base/graph_io.h>
+#include <cgv/base/register.h>
+#include <cgv/utils/file.h>
+#include <iostream>
+#include <cstring>
+
+using namespace cgv::base;
+using namespace cgv::reflect;
+
+struct graph_io_leaf : public named
+{
+	/// members reflected by a later version of the class
+	bool extended = false;
+	int count = 0;
+	float weight = 1.0f;
+	std::string label;
+	std::vector<std::string> tags;
+	double position[3] = { 0, 0, 0 };
+	short extra = 0;
+	unsigned nr_on_set = 0;
+	graph_io_leaf(const std::string& name = "", bool _extended = false) : named(name), extended(_extended) {}
+	std::string get_type_name() const { return "graph_io_leaf"; }
+	bool self_reflect(reflection_handler& rh)
+	{
+		// version with extension changed type of count and replaced weight by extra
+		if (extended)
+			return
+				rh.reflect_member("count", extra) &&
+				rh.reflect_member("label", label) &&
+				rh.reflect_member("tags", tags) &&
+				rh.reflect_member("position", position) &&
+				rh.reflect_member("extra", extra);
+		return
+			rh.reflect_member("count", count) &&
+			rh.reflect_member("weight", weight) &&
+			rh.reflect_member("label", label) &&
+			rh.reflect_member("tags", tags) &&
+			rh.reflect_member("position", position);
+	}
+	void on_set(void*) { ++nr_on_set; }
+};
+
+struct graph_io_group : public group
+{
+	std::vector<float> samples;
+	std::string title;
+	graph_io_group(const std::string& name = "") : group(name) {}
+	std::string get_type_name() const { return "graph_io_group"; }
+	bool self_reflect(reflection_handler& rh)
+	{
+		return
+			rh.reflect_member("samples", samples) &&
+			rh.reflect_member("title", title);
+	}
+};
+
+base_ptr construct_graph_io_object(const std::string& type_name)
+{
+	if (type_name == "graph_io_group")
+		return new graph_io_group();
+	if (type_name == "graph_io_leaf")
+		return new graph_io_leaf();
+	return base_ptr();
+}
+
+/// build a root group with nr_children children, where every third child is a group with a leaf
+group_ptr build_graph_io_scene(unsigned nr_children, unsigned nr_samples)
+{
+	graph_io_group* root = new graph_io_group("root");
+	root->title = "scene";
+	for (unsigned i = 0; i < nr_samples; ++i)
+		root->samples.push_back(0.5f * i);
+	for (unsigned i = 0; i < nr_children; ++i) {
+		graph_io_leaf* leaf = new graph_io_leaf(std::string("leaf_") + std::to_string(i));
+		leaf->count = int(i);
+		leaf->weight = 0.25f * i;
+		leaf->label = std::string(i, 'x');
+		leaf->tags = { "a", std::to_string(i) };
+		leaf->position[2] = double(i);
+		if (i % 3 == 2) {
+			graph_io_group* g = new graph_io_group(std::string("group_") + std::to_string(i));
+			g->samples = { float(i) };
+			g->append_child(leaf);
+			root->append_child(g);
+		}
+		else
+			root->append_child(leaf);
+	}
+	return group_ptr(root);
+}
+
+bool test_graph_io()
+{
+	group_ptr scene = build_graph_io_scene(6, 100);
+	std::vector<char> buffer;
+	TEST_ASSERT(write_object_graph(buffer, scene, "graph_io_test", 2))
+	TEST_ASSERT_EQ(buffer.size() % 8, 0u)
+
+	// restore into newly constructed objects
+	base_ptr restored;
+	unsigned file_version = 0;
+	TEST_ASSERT(read_object_graph(&buffer[0], buffer.size(), restored, "graph_io_test", 2, construct_graph_io_object, &file_version))
+	TEST_ASSERT_EQ(file_version, 2u)
+	graph_io_group* root = restored->get_interface<graph_io_group>();
+	TEST_ASSERT(root != 0)
+	TEST_ASSERT_EQ(root->get_name(), "root")
+	TEST_ASSERT_EQ(root->title, "scene")
+	TEST_ASSERT_EQ(root->samples.size(), 100u)
+	TEST_ASSERT_EQ(root->samples[99], 49.5f)
+	TEST_ASSERT_EQ(root->get_nr_children(), 6u)
+	graph_io_leaf* leaf = root->get_child(1)->get_interface<graph_io_leaf>();
+	TEST_ASSERT(leaf != 0)
+	TEST_ASSERT_EQ(leaf->get_name(), "leaf_1")
+	TEST_ASSERT_EQ(leaf->count, 1)
+	TEST_ASSERT_EQ(leaf->weight, 0.25f)
+	TEST_ASSERT_EQ(leaf->label, "x")
+	TEST_ASSERT_EQ(leaf->tags.size(), 2u)
+	TEST_ASSERT_EQ(leaf->tags[1], "1")
+	TEST_ASSERT_EQ(leaf->position[2], 1.0)
+	TEST_ASSERT(leaf->nr_on_set > 0)
+	group_ptr sub_group = root->get_child(5)->cast<group>();
+	TEST_ASSERT(!sub_group.empty())
+	TEST_ASSERT_EQ(sub_group->get_name(), "group_5")
+	TEST_ASSERT_EQ(sub_group->get_nr_children(), 1u)
+	TEST_ASSERT_EQ(sub_group->get_child(0)->get_interface<graph_io_leaf>()->label, "xxxxx")
+
+	// restore into existing graph, where missing children are constructed
+	group_ptr existing = build_graph_io_scene(2, 3);
+	base_ptr existing_base(existing);
+	TEST_ASSERT(read_object_graph(&buffer[0], buffer.size(), existing_base, "graph_io_test", 2, construct_graph_io_object))
+	TEST_ASSERT(existing_base == base_ptr(existing))
+	TEST_ASSERT_EQ(existing->get_nr_children(), 6u)
+	TEST_ASSERT_EQ(existing->get_interface<graph_io_group>()->samples.size(), 100u)
+	TEST_ASSERT_EQ(existing->get_child(4)->get_interface<graph_io_leaf>()->count, 4)
+
+	// content and version checks
+	TEST_ASSERT(!read_object_graph(&buffer[0], buffer.size(), restored, "other_content", 2, construct_graph_io_object))
+	TEST_ASSERT(!read_object_graph(&buffer[0], buffer.size(), restored, "graph_io_test", 1, construct_graph_io_object))
+	TEST_ASSERT(!read_object_graph(&buffer[0], buffer.size() / 2, restored, "graph_io_test", 2, construct_graph_io_object))
+	base_ptr no_factory;
+	TEST_ASSERT(!read_object_graph(&buffer[0], buffer.size(), no_factory, "graph_io_test", 2))
+	// object count in the header that cannot fit into the file
+	auto corrupt = buffer;
+	memset(&corrupt[20], 0xFF, 4);
+	TEST_ASSERT(!read_object_graph(&corrupt[0], corrupt.size(), restored, "graph_io_test", 2, construct_graph_io_object))
+
+	// evolved class keeps values of new members, converts changed types and ignores removed members
+	base_ptr extended(new graph_io_leaf("extended", true));
+	extended->get_interface<graph_io_leaf>()->extra = 7;
+	base_ptr old_leaf(root->get_child(4));
+	std::vector<char> leaf_buffer;
+	TEST_ASSERT(write_object_graph(leaf_buffer, old_leaf, "graph_io_test", 1))
+	TEST_ASSERT(read_object_graph(&leaf_buffer[0], leaf_buffer.size(), extended, "graph_io_test", 2))
+	graph_io_leaf* ext = extended->get_interface<graph_io_leaf>();
+	TEST_ASSERT_EQ(ext->extra, 4)
+	TEST_ASSERT_EQ(ext->label, "xxxx")
+	TEST_ASSERT_EQ(ext->position[2], 4.0)
+
+	// file round trip
+	std::string file_name = "graph_io_test.cgr";
+	TEST_ASSERT(write_object_graph(file_name, scene, "graph_io_test", 2))
+	base_ptr from_file;
+	TEST_ASSERT(read_object_graph(file_name, from_file, "graph_io_test", 2, construct_graph_io_object))
+	TEST_ASSERT_EQ(from_file->get_interface<graph_io_group>()->get_nr_children(), 6u)
+	cgv::utils::file::remove(file_name);
+	return true;
+}
+
+/// write and read a scene of 3000 objects with 1M samples in the root
+bool benchmark_graph_io(benchmark_state& state)
+{
+	group_ptr scene = build_graph_io_scene(3000, 1000000);
+	std::vector<char> buffer;
+	bool success = true;
+	state.set_work(4.0e6 + 3000 * 64, "bytes");
+	state.measure([&]() {
+		success = write_object_graph(buffer, scene, "graph_io_benchmark", 1) && success;
+		base_ptr restored;
+		success = read_object_graph(&buffer[0], buffer.size(), restored, "graph_io_benchmark", 1, construct_graph_io_object) && success;
+	});
+	return success;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_graph_io_reg("cgv::base::graph_io", test_graph_io);
+extern CGV_API benchmark_registration benchmark_graph_io_reg("object graph write and read", benchmark_graph_io);
@@ -0,0 +1,169 @@
+#include <cgv/signal/lock_free_signal.h>
+#include <cgv/signal/signal.h>
+#include <cgv/base/register.h>
+#include <atomic>
+#include <string>
+#include <thread>
+
+using namespace cgv::base;
+using namespace cgv::signal;
+
+static int lock_free_signal_sum = 0;
+
+void lock_free_signal_add(int i)
+{
+	lock_free_signal_sum += i;
+}
+
+struct lock_free_signal_listener : public tacker
+{
+	int sum = 0;
+	void add(int i) { sum += i; }
+};
+
+bool test_lock_free_signal()
+{
+	lock_free_signal<int> sig;
+	lock_free_signal_listener l;
+	TEST_ASSERT(small_function<int>::is_stored_locally<void(*)(int)>())
+	size_t fid = connect(sig, lock_free_signal_add);
+	size_t mid = connect(sig, &l, &lock_free_signal_listener::add);
+	int lambda_sum = 0;
+	size_t lid = sig.connect([&lambda_sum](int i) { lambda_sum += 2 * i; });
+	TEST_ASSERT_EQ(sig.get_nr_slots(), 3u)
+	sig(3);
+	TEST_ASSERT_EQ(lock_free_signal_sum, 3)
+	TEST_ASSERT_EQ(l.sum, 3)
+	TEST_ASSERT_EQ(lambda_sum, 6)
+	TEST_ASSERT(sig.disconnect(mid))
+	TEST_ASSERT(!sig.disconnect(mid))
+	sig(1);
+	TEST_ASSERT_EQ(l.sum, 3)
+	TEST_ASSERT_EQ(lock_free_signal_sum, 4)
+
+	// callables that do not fit into the small buffer are copied to the heap
+	std::string big(100, 'x');
+	size_t big_length = 0;
+	struct { char data[200]; } payload = {};
+	payload.data[0] = 5;
+	sig.connect([big, payload, &big_length](int i) { big_length = big.size() + payload.data[0] + i; });
+	TEST_ASSERT(!small_function<int>::is_stored_locally<decltype(payload)>())
+	sig(1);
+	TEST_ASSERT_EQ(big_length, 106u)
+
+	// slots that modify the signal during emission take effect with the next emission
+	int nr_self_calls = 0;
+	size_t self_id = 0;
+	self_id = sig.connect([&](int) { ++nr_self_calls; sig.disconnect(self_id); sig.disconnect(lid); });
+	sig(0);
+	sig(0);
+	TEST_ASSERT_EQ(nr_self_calls, 1)
+	TEST_ASSERT_EQ(sig.get_nr_slots(), 2u)
+	TEST_ASSERT(sig.disconnect(fid))
+	sig.disconnect_all();
+	TEST_ASSERT_EQ(sig.get_nr_slots(), 0u)
+	sig(7);
+
+	// emit from several threads while slots are connected and disconnected
+	lock_free_signal<int> mt_sig;
+	std::atomic<int> mt_sum(0);
+	connect(mt_sig, [&mt_sum](int i) { mt_sum += i; });
+	std::atomic<bool> stop(false);
+	std::vector<std::thread> emitters;
+	for (int t = 0; t < 2; ++t)
+		emitters.push_back(std::thread([&]() {
+			while (!stop)
+				mt_sig(1);
+		}));
+	// make sure that the emitters run before slots are connected and disconnected, also on a single core
+	while (mt_sum == 0)
+		std::this_thread::yield();
+	for (int i = 0; i < 2000; ++i) {
+		size_t id = mt_sig.connect([](int) {});
+		TEST_ASSERT(mt_sig.disconnect(id))
+	}
+	stop = true;
+	for (auto& t : emitters)
+		t.join();
+	TEST_ASSERT_EQ(mt_sig.get_nr_slots(), 1u)
+	TEST_ASSERT(mt_sum > 0)
+
+	// replaced slot lists are deleted while emissions overlap, such that the signal is never idle
+	lock_free_signal<int> held_sig;
+	std::atomic<bool> entered[3], released[3];
+	for (int i = 0; i < 3; ++i)
+		entered[i] = released[i] = false;
+	connect(held_sig, [&](int i) {
+		entered[i] = true;
+		while (!released[i])
+			std::this_thread::yield();
+	});
+	// each connect and disconnect replaces the slot list
+	const int nr_replacements = 200;
+	auto modify = [&]() {
+		for (int i = 0; i < nr_replacements; i += 2)
+			held_sig.disconnect(held_sig.connect([](int) {}));
+	};
+	std::vector<std::thread> holders;
+	for (int t = 0; t < 3; ++t) {
+		holders.push_back(std::thread([&held_sig, t]() { held_sig(t); }));
+		while (!entered[t])
+			std::this_thread::yield();
+		if (t > 0) {
+			released[t - 1] = true;
+			holders[t - 1].join();
+		}
+		modify();
+	}
+	// only the lists replaced since the start of the oldest emission in progress are kept
+	TEST_ASSERT(held_sig.get_nr_retired_slot_lists() < size_t(2 * nr_replacements))
+	released[2] = true;
+	holders[2].join();
+	modify();
+	TEST_ASSERT_EQ(held_sig.get_nr_retired_slot_lists(), 0u)
+	return true;
+}
+
+const unsigned nr_signal_benchmark_emits = 100000;
+
+/// emit signals with nr_listeners listeners
+template <unsigned nr_listeners>
+bool benchmark_lock_free_signal_emit(benchmark_state& state)
+{
+	lock_free_signal<int> sig;
+	std::vector<lock_free_signal_listener> listeners(nr_listeners);
+	for (auto& l : listeners)
+		connect(sig, &l, &lock_free_signal_listener::add);
+	state.set_work(nr_signal_benchmark_emits, "emits");
+	state.measure([&]() {
+		for (unsigned i = 0; i < nr_signal_benchmark_emits; ++i)
+			sig(1);
+	});
+	return listeners[0].sum > 0;
+}
+
+/// emit signals with nr_listeners listeners for comparison with cgv::signal::signal
+template <unsigned nr_listeners>
+bool benchmark_signal_emit(benchmark_state& state)
+{
+	cgv::signal::signal<int> sig;
+	std::vector<lock_free_signal_listener> listeners(nr_listeners);
+	for (auto& l : listeners)
+		connect(sig, &l, &lock_free_signal_listener::add);
+	state.set_work(nr_signal_benchmark_emits, "emits");
+	state.measure([&]() {
+		for (unsigned i = 0; i < nr_signal_benchmark_emits; ++i)
+			sig(1);
+	});
+	return listeners[0].sum > 0;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_lock_free_signal_reg("cgv::signal::lock_free_signal", test_lock_free_signal);
+extern CGV_API benchmark_registration benchmark_lock_free_signal_emit_1_reg("lock_free_signal emit with 1 listener", benchmark_lock_free_signal_emit<1>);
+extern CGV_API benchmark_registration benchmark_signal_emit_1_reg("signal emit with 1 listener", benchmark_signal_emit<1>);
+extern CGV_API benchmark_registration benchmark_lock_free_signal_emit_16_reg("lock_free_signal emit with 16 listeners", benchmark_lock_free_signal_emit<16>);
+extern CGV_API benchmark_registration benchmark_signal_emit_16_reg("signal emit with 16 listeners", benchmark_signal_emit<16>);
+extern CGV_API benchmark_registration benchmark_lock_free_signal_emit_256_reg("lock_free_signal emit with 256 listeners", benchmark_lock_free_signal_emit<256>);
+extern CGV_API benchmark_registration benchmark_signal_emit_256_reg("signal emit with 256 listeners", benchmark_signal_emit<256>);
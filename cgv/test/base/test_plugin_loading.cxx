@@ -0,0 +1,77 @@
+#include <cgv/base/register.h>
+#include <cgv/base/named.h>
+
+using namespace cgv::base;
+
+/// object that counts its constructions to check that construction is deferred
+struct lazy_test_object : public named
+{
+	static int nr_constructed;
+	lazy_test_object() : named("lazy_test_object") { ++nr_constructed; }
+	std::string get_type_name() const { return "lazy_test_object"; }
+};
+
+int lazy_test_object::nr_constructed = 0;
+
+/// second lazily constructed type that is found by name
+struct lazy_named_test_object : public named
+{
+	static int nr_constructed;
+	lazy_named_test_object() : named("lazy_named_test_object_instance") { ++nr_constructed; }
+	std::string get_type_name() const { return "lazy_named_test_object"; }
+};
+
+int lazy_named_test_object::nr_constructed = 0;
+
+bool test_plugin_loading()
+{
+	bool enabled = is_registration_enabled();
+	define_lazy_construction("lazy_test_object");
+	TEST_ASSERT(process_command("lazy:lazy_named_test_object(lazy_named_test_object_instance)"))
+
+	// objects registered while registration is disabled, as done during plugin loading, are constructed on demand
+	unsigned nr_lazy = get_nr_lazy_objects();
+	disable_registration();
+	object_registration<lazy_test_object> r1("");
+	object_registration<lazy_named_test_object> r2("");
+	enable_registration();
+	TEST_ASSERT_EQ(lazy_test_object::nr_constructed, 0)
+	TEST_ASSERT_EQ(lazy_named_test_object::nr_constructed, 0)
+	TEST_ASSERT_EQ(get_nr_lazy_objects(), nr_lazy + 2)
+
+	// an unknown name only constructs the objects whose name is not declared
+	TEST_ASSERT(find_object_by_name("lazy_unknown_name").empty())
+	TEST_ASSERT_EQ(lazy_test_object::nr_constructed, 1)
+	TEST_ASSERT_EQ(lazy_named_test_object::nr_constructed, 0)
+
+	base_ptr bp = find_object_by_type("lazy_test_object");
+	TEST_ASSERT(!bp.empty())
+	TEST_ASSERT_EQ(lazy_test_object::nr_constructed, 1)
+	TEST_ASSERT_EQ(lazy_named_test_object::nr_constructed, 0)
+	TEST_ASSERT(find_object_by_type("lazy_test_object") == bp)
+	TEST_ASSERT_EQ(lazy_test_object::nr_constructed, 1)
+
+	named_ptr np = find_object_by_name("lazy_named_test_object_instance");
+	TEST_ASSERT(!np.empty())
+	TEST_ASSERT_EQ(lazy_named_test_object::nr_constructed, 1)
+	TEST_ASSERT_EQ(get_nr_lazy_objects(), nr_lazy)
+	unregister_object(bp);
+	unregister_object(np);
+	if (!enabled)
+		disable_registration();
+
+	// every plugin gets a load info also if it could not be loaded
+	size_t nr_infos = get_plugin_load_infos().size();
+	std::vector<void*> handles = load_plugins({ "cgv_test_missing_plugin_a", "cgv_test_missing_plugin_b", "cgv_test_missing_plugin_c" });
+	TEST_ASSERT_EQ(handles.size(), 3u)
+	TEST_ASSERT(handles[0] == 0 && handles[1] == 0 && handles[2] == 0)
+	TEST_ASSERT_EQ(get_plugin_load_infos().size(), nr_infos + 3)
+	TEST_ASSERT_EQ(get_plugin_load_infos()[nr_infos + 1].name, "cgv_test_missing_plugin_b")
+	TEST_ASSERT(get_plugin_load_infos()[nr_infos + 1].file_name.empty())
+	TEST_ASSERT_EQ(is_registration_enabled(), enabled)
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_plugin_loading_reg("cgv::base::load_plugins", test_plugin_loading);
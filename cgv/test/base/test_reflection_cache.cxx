@@ -0,0 +1,164 @@
+#include <cgv/base/named.h>
+#include <cgv/base/register.h>
+#include <cgv/reflect/reflection_cache.h>
+#include <cgv/utils/file.h>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <typeinfo>
+
+using namespace cgv::base;
+using namespace cgv::reflect;
+
+struct reflection_cache_test_object : public base
+{
+	int n = 1;
+	std::string s = "hello";
+	double d = 1.5;
+	float arr[3] = { 0, 0, 0 };
+	std::vector<int> v = { 1, 2 };
+	int tmp_value = 7;
+	std::string get_type_name() const { return "reflection_cache_test_object"; }
+	bool use_reflection_cache() const { return true; }
+	bool self_reflect(reflection_handler& rh)
+	{
+		return
+			rh.reflect_member("n", n) &&
+			rh.reflect_member("s", s) &&
+			rh.reflect_member("d", d) &&
+			rh.reflect_member("arr", arr) &&
+			rh.reflect_member("v", v) &&
+			// duplicate names are resolved to the first reflected member
+			rh.reflect_member("n", tmp_value);
+	}
+};
+
+/// reflects a temporary in addition and therefore must not use the cache
+struct reflection_cache_test_object_uncached : public reflection_cache_test_object
+{
+	bool use_reflection_cache() const { return false; }
+	bool self_reflect(reflection_handler& rh)
+	{
+		int tmp = tmp_value;
+		bool res = reflection_cache_test_object::self_reflect(rh) && rh.reflect_member("tmp", tmp);
+		tmp_value = tmp;
+		return res;
+	}
+};
+
+bool test_reflection_cache()
+{
+	reflection_cache_test_object o1, o2;
+	reflection_cache_test_object_uncached u;
+	const reflection_cache& rc = reflection_cache::get(typeid(o1), static_cast<base&>(o1));
+	TEST_ASSERT(rc.find("n") != 0)
+	TEST_ASSERT(rc.find("d") != 0)
+	TEST_ASSERT(rc.find("v") == 0)
+	TEST_ASSERT(rc.find("missing") == 0)
+	TEST_ASSERT(!reflection_cache::is_plain_member_name("arr[1]"))
+	TEST_ASSERT(reflection_cache::is_plain_member_name("arr"))
+
+	// cached and uncached lookups agree
+	for (base* b : { static_cast<base*>(&o1), static_cast<base*>(&u) }) {
+		b->set("n", 4);
+		TEST_ASSERT_EQ(b->get<int>("n"), 4)
+		b->set("d", std::string("2.25"));
+		TEST_ASSERT_EQ(b->get<double>("d"), 2.25)
+		b->set("s", "world");
+		TEST_ASSERT_EQ(b->get<std::string>("s"), "world")
+		b->set("arr[1]", 3.0f);
+		TEST_ASSERT_EQ(b->get<float>("arr[1]"), 3.0f)
+		b->multi_set("n=5;d=0.5;s='abc'", true);
+		TEST_ASSERT_EQ(b->get<int>("n"), 5)
+		TEST_ASSERT_EQ(b->get<double>("d"), 0.5)
+		TEST_ASSERT_EQ(b->get<std::string>("s"), "abc")
+		std::string type_name;
+		TEST_ASSERT(b->find_member_ptr("d", &type_name) != 0)
+		TEST_ASSERT_EQ(type_name, "flt64")
+		TEST_ASSERT(!b->set_void("missing", "int32", &type_name))
+	}
+	TEST_ASSERT_EQ(o1.n, 5)
+	TEST_ASSERT_EQ(o1.tmp_value, 7)
+	u.set("tmp", 11);
+	TEST_ASSERT_EQ(u.get<int>("tmp"), 11)
+	TEST_ASSERT_EQ(u.tmp_value, 11)
+	TEST_ASSERT_EQ(o1.arr[1], 3.0f)
+	TEST_ASSERT(o1.find_member_ptr("d") == &o1.d)
+
+	// offsets are applied to other instances of the same type
+	o2.set("n", 9);
+	TEST_ASSERT_EQ(o2.n, 9)
+	TEST_ASSERT_EQ(o1.n, 5)
+	TEST_ASSERT(o2.find_member_ptr("s") == &o2.s)
+	return true;
+}
+
+/// named object with many properties as found in the configuration of large scenes
+struct many_properties_object : public named
+{
+	static const unsigned nr_values = 256;
+	bool cached;
+	float values[nr_values];
+	std::string label;
+	many_properties_object(const std::string& name, bool _cached) : named(name), cached(_cached)
+	{
+		std::fill(values, values + nr_values, 0.0f);
+	}
+	std::string get_type_name() const { return "many_properties_object"; }
+	bool use_reflection_cache() const { return cached; }
+	bool self_reflect(reflection_handler& rh)
+	{
+		for (unsigned i = 0; i < nr_values; ++i)
+			if (!rh.reflect_member(std::string("value_") + std::to_string(i), values[i]))
+				return false;
+		return rh.reflect_member("label", label);
+	}
+};
+
+/// process a config file with 64 lines, each assigning all 257 properties of an object
+bool benchmark_config_file(benchmark_state& state, bool cached)
+{
+	std::string name = cached ? "config_benchmark_cached" : "config_benchmark_uncached";
+	base_ptr object(new many_properties_object(name, cached));
+	register_object(object);
+	const unsigned nr_lines = 64;
+	std::stringstream ss;
+	for (unsigned l = 0; l < nr_lines; ++l) {
+		ss << "name(" << name << "):";
+		for (unsigned i = 0; i < many_properties_object::nr_values; ++i)
+			ss << "value_" << i << "=" << 0.5 * (i + l) << ";";
+		ss << "label='line " << l << "'\n";
+	}
+	std::string file_name = (std::filesystem::temp_directory_path() / (name + ".cfg")).string();
+	if (!cgv::utils::file::write(file_name, ss.str(), true))
+		return false;
+	bool success = true;
+	state.set_work(double(nr_lines * (many_properties_object::nr_values + 1)), "properties");
+	// suppress the echo of processed commands
+	std::ostringstream null_stream;
+	std::streambuf* cout_buf = std::cout.rdbuf(null_stream.rdbuf());
+	state.measure([&]() {
+		null_stream.str(std::string());
+		success = process_config_file(file_name) && success;
+	});
+	std::cout.rdbuf(cout_buf);
+	cgv::utils::file::remove(file_name);
+	unregister_object(object);
+	return success && object->get<float>("value_1") == 0.5f * nr_lines;
+}
+
+bool benchmark_config_file_cached(benchmark_state& state)
+{
+	return benchmark_config_file(state, true);
+}
+
+bool benchmark_config_file_uncached(benchmark_state& state)
+{
+	return benchmark_config_file(state, false);
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_reflection_cache_reg("cgv::reflect::reflection_cache", test_reflection_cache);
+extern CGV_API benchmark_registration benchmark_config_file_cached_reg("config file with reflection cache", benchmark_config_file_cached);
+extern CGV_API benchmark_registration benchmark_config_file_uncached_reg("config file without reflection cache", benchmark_config_file_uncached);
@@ -66,6 +66,8 @@ public:
 			rh.reflect_member("srs", srs) &&
 			rh.reflect_member("brs", brs);
 	}
+	// all reflected members belong to this class, so config files can use the reflection cache
+	bool use_reflection_cache() const { return true; }
 	bool init(cgv::render::context& ctx)
 	{
 		auto& br = cgv::render::ref_box_renderer(ctx, 1);
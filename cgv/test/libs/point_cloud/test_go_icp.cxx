@@ -0,0 +1,128 @@
+#include <cgv/base/register.h>
+#include <point_cloud/GoICP.h>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <random>
+
+using namespace cgv::base;
+using namespace cgv::pointcloud;
+
+typedef point_cloud::Pnt Pnt;
+typedef point_cloud::Dir Dir;
+typedef point_cloud::Mat Mat;
+
+/// sample the surface of three spheres of different size placed asymmetrically inside [-0.5,0.5]^3
+void construct_blobs(point_cloud& pc, unsigned n)
+{
+	const Pnt centers[3] = { Pnt(-0.2f, -0.1f, 0.0f), Pnt(0.2f, -0.1f, 0.05f), Pnt(0.0f, 0.25f, -0.1f) };
+	const float radii[3] = { 0.25f, 0.15f, 0.1f };
+	std::default_random_engine rng(n);
+	std::normal_distribution<float> d;
+	pc.resize(n);
+	for (unsigned i = 0; i < n; ++i) {
+		unsigned j = i % 3;
+		Dir v(d(rng), d(rng), d(rng));
+		pc.pnt(i) = centers[j] + radii[j] * normalize(v);
+	}
+}
+
+/// map every k-th point of target by the inverse of the given transformation into source
+void construct_source(const point_cloud& target, unsigned k, const Mat& R, const Dir& t, point_cloud& source)
+{
+	source.resize(target.get_nr_points() / k);
+	Mat R_inv = transpose(R);
+	for (unsigned i = 0; i < source.get_nr_points(); ++i)
+		source.pnt(i) = R_inv * (target.pnt(i * k) - t);
+}
+
+/// rotation about axis (0,1,1) by the given angle in degrees
+Mat construct_go_icp_rotation(float angle)
+{
+	Mat R;
+	float c = std::cos(angle * 3.14159265f / 180), s = std::sin(angle * 3.14159265f / 180), h = std::sqrt(0.5f);
+	R(0, 0) = c;      R(0, 1) = -s * h;          R(0, 2) = s * h;
+	R(1, 0) = s * h;  R(1, 1) = c + (1 - c) / 2; R(1, 2) = (1 - c) / 2;
+	R(2, 0) = -s * h; R(2, 1) = (1 - c) / 2;     R(2, 2) = c + (1 - c) / 2;
+	return R;
+}
+
+/// run registration with given number of threads and return time in seconds
+double register_clouds(GoICP& go_icp, const point_cloud& source, unsigned nr_threads)
+{
+	go_icp.nr_threads = nr_threads;
+	go_icp.initializeRegistration(source);
+	auto start = std::chrono::steady_clock::now();
+	go_icp.registerPointcloud();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool test_go_icp()
+{
+	point_cloud target, source;
+	construct_blobs(target, 3000);
+	Mat R_true = construct_go_icp_rotation(120);
+	Dir t_true(0.1f, -0.05f, 0.05f);
+	construct_source(target, 100, R_true, t_true, source);
+
+	GoICP go_icp;
+	go_icp.mse_threshhold = 0.0002f;
+	go_icp.distance_transform_size = 100;
+	go_icp.setDistanceComputationMode(GoICP::DCM_DISTANCE_TRANSFORM);
+	go_icp.initializeDistanceComputation(target);
+
+	// local icp from the identity does not find the rotation by 120 degrees, the global search does
+	register_clouds(go_icp, source, 1);
+	float optimal_error = go_icp.optimal_error;
+	TEST_ASSERT(optimal_error < go_icp.sse_threshhold)
+	TEST_ASSERT((go_icp.optimal_translation - t_true).length() < 0.01f)
+	for (int u = 0; u < 3; ++u)
+		for (int v = 0; v < 3; ++v)
+			TEST_ASSERT(std::abs(go_icp.optimal_rotation(u, v) - R_true(u, v)) < 0.02f)
+
+	// the parallel search stays globally optimal
+	for (unsigned nr_threads : { 2u, 4u }) {
+		register_clouds(go_icp, source, nr_threads);
+		TEST_ASSERT(std::abs(go_icp.optimal_error - optimal_error) <= go_icp.sse_threshhold)
+		TEST_ASSERT((go_icp.optimal_translation - t_true).length() < 0.01f)
+	}
+
+	// trimming ignores outliers in the search, only the final icp refinement is biased by them
+	point_cloud noisy_source(source);
+	for (unsigned i = 0; i < 2; ++i)
+		noisy_source.pnt(i) += Dir(0.0f, 0.0f, 0.3f);
+	go_icp.do_trim = true;
+	go_icp.trim_fraction = 0.1f;
+	register_clouds(go_icp, noisy_source, 2);
+	TEST_ASSERT((go_icp.optimal_translation - t_true).length() < 0.02f)
+	return true;
+}
+
+/// report registration time for 1 to N threads
+bool test_go_icp_throughput()
+{
+	point_cloud target, source;
+	construct_blobs(target, 20000);
+	construct_source(target, 40, construct_go_icp_rotation(150), Dir(-0.1f, 0.1f, 0.0f), source);
+	GoICP go_icp;
+	go_icp.mse_threshhold = 0.00005f;
+	go_icp.setDistanceComputationMode(GoICP::DCM_DISTANCE_TRANSFORM);
+	go_icp.initializeDistanceComputation(target);
+	unsigned max_nr_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	std::cout << "\n  " << source.get_nr_points() << " source points:";
+	double time_1 = 0;
+	for (unsigned nr_threads = 1; nr_threads <= max_nr_threads; nr_threads *= 2) {
+		double time = register_clouds(go_icp, source, nr_threads);
+		if (nr_threads == 1)
+			time_1 = time;
+		std::cout << " " << nr_threads << " threads " << time << " s (speedup " << time_1 / time << ")";
+	}
+	std::cout << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_go_icp_reg("cgv::pointcloud::GoICP", test_go_icp);
+extern CGV_API test_registration test_go_icp_throughput_reg("cgv::pointcloud::GoICP throughput", test_go_icp_throughput);
@@ -0,0 +1,183 @@
+#include <cgv/base/register.h>
+#include <point_cloud/icp_engine.h>
+#include <iostream>
+#include <cmath>
+#include <random>
+#include <thread>
+
+using namespace cgv::base;
+using namespace cgv::pointcloud;
+
+typedef point_cloud::Pnt Pnt;
+typedef point_cloud::Nml Nml;
+typedef point_cloud::Dir Dir;
+typedef point_cloud::Mat Mat;
+
+/// sample a bumpy height field over [-1,1]^2 on a regular grid with given offset in grid cells, optionally add uniformly distributed outliers
+void construct_scan(point_cloud& pc, unsigned res, float offset, float outlier_fraction = 0)
+{
+	unsigned nr_outliers = unsigned(outlier_fraction * res * res);
+	pc.resize(res * res + nr_outliers);
+	pc.create_normals();
+	for (unsigned i = 0; i < res; ++i)
+		for (unsigned j = 0; j < res; ++j) {
+			float x = 2 * (i + offset) / res - 1, y = 2 * (j + offset) / res - 1;
+			float z = 0.2f * std::sin(3 * x) * std::cos(2 * y) + 0.1f * x * y;
+			Nml n(-0.6f * std::cos(3 * x) * std::cos(2 * y) - 0.1f * y, 0.4f * std::sin(3 * x) * std::sin(2 * y) - 0.1f * x, 1.0f);
+			pc.pnt(i * res + j) = Pnt(x, y, z);
+			pc.nml(i * res + j) = normalize(n);
+		}
+	std::default_random_engine rng(res);
+	std::uniform_real_distribution<float> d(-1.0f, 1.0f);
+	for (unsigned k = 0; k < nr_outliers; ++k) {
+		pc.pnt(res * res + k) = Pnt(d(rng), d(rng), 0.5f + 0.5f * d(rng));
+		pc.nml(res * res + k) = Nml(0, 0, 1);
+	}
+}
+
+/// rotation about a fixed axis by the given angle in degrees
+Mat construct_rotation(float angle)
+{
+	Mat R;
+	R.identity();
+	Dir a = normalize(Dir(1, 2, 3));
+	float c = std::cos(angle * 3.14159265f / 180), s = std::sin(angle * 3.14159265f / 180);
+	for (int u = 0; u < 3; ++u)
+		for (int v = 0; v < 3; ++v)
+			R(u, v) = (1 - c) * a[u] * a[v] + (u == v ? c : 0);
+	R(0, 1) -= s * a[2]; R(1, 0) += s * a[2];
+	R(0, 2) += s * a[1]; R(2, 0) -= s * a[1];
+	R(1, 2) -= s * a[0]; R(2, 1) += s * a[0];
+	return R;
+}
+
+/// move points of cloud by the inverse of the given transformation such that registration needs to find it
+void inverse_transform(point_cloud& pc, const Mat& R, const Dir& t)
+{
+	Mat R_inv = transpose(R);
+	for (unsigned i = 0; i < pc.get_nr_points(); ++i)
+		pc.pnt(i) = R_inv * (pc.pnt(i) - t);
+}
+
+/// return maximum deviation of registration result from the true transformation
+float registration_error(const Mat& R, const Dir& t, const Mat& R_true, const Dir& t_true)
+{
+	float e = (t - t_true).length();
+	for (int u = 0; u < 3; ++u)
+		for (int v = 0; v < 3; ++v)
+			e = std::max(e, std::abs(R(u, v) - R_true(u, v)));
+	return e;
+}
+
+bool test_icp_engine()
+{
+	// point to point matching suffers from grid aliasing such that only small motions of identically sampled scans are recovered
+	point_cloud target, exact_source, source, noisy_source;
+	construct_scan(target, 200, 0);
+	construct_scan(exact_source, 200, 0);
+	construct_scan(source, 200, 0.5f);
+	construct_scan(noisy_source, 200, 0.5f, 0.1f);
+	Mat R_small = construct_rotation(0.2f);
+	Dir t_small(0.002f, -0.001f, 0.001f);
+	inverse_transform(exact_source, R_small, t_small);
+	Mat R_true = construct_rotation(4);
+	Dir t_true(0.03f, -0.02f, 0.01f);
+	inverse_transform(source, R_true, t_true);
+	inverse_transform(noisy_source, R_true, t_true);
+
+	icp_engine icp;
+	icp.set_target_cloud(target);
+	Mat R;
+	Dir t;
+	for (unsigned nr_threads : { 1u, 4u }) {
+		icp.parameters.nr_threads = nr_threads;
+		icp.set_source_cloud(exact_source);
+		for (auto metric : { icp_engine::EM_POINT_TO_POINT, icp_engine::EM_POINT_TO_PLANE }) {
+			icp.parameters.metric = metric;
+			R.identity();
+			t = Dir(0.0f);
+			TEST_ASSERT(icp.align(R, t))
+			TEST_ASSERT(icp.get_statistics().converged)
+			TEST_ASSERT(registration_error(R, t, R_small, t_small) < 1e-4f)
+			TEST_ASSERT_EQ(icp.get_statistics().nr_correspondences, exact_source.get_nr_points())
+		}
+		// point to plane slides along the surface and recovers larger motions between differently sampled scans
+		icp.set_source_cloud(source);
+		R.identity();
+		t = Dir(0.0f);
+		TEST_ASSERT(icp.align(R, t))
+		TEST_ASSERT(icp.get_statistics().converged)
+		TEST_ASSERT(icp.get_statistics().nr_iterations < 10)
+		TEST_ASSERT(registration_error(R, t, R_true, t_true) < 1e-3f)
+	}
+
+	// robust kernels suppress outliers, which bias least squares
+	icp.set_source_cloud(noisy_source);
+	icp.parameters.nr_threads = 0;
+	float errors[3];
+	for (auto kernel : { icp_engine::RK_NONE, icp_engine::RK_HUBER, icp_engine::RK_TUKEY }) {
+		icp.parameters.kernel = kernel;
+		R.identity();
+		t = Dir(0.0f);
+		TEST_ASSERT(icp.align(R, t))
+		errors[kernel] = registration_error(R, t, R_true, t_true);
+	}
+	TEST_ASSERT(errors[icp_engine::RK_HUBER] < errors[icp_engine::RK_NONE])
+	TEST_ASSERT(errors[icp_engine::RK_TUKEY] < 2e-3f)
+	// rejection by distance and subsampling
+	icp.parameters.kernel = icp_engine::RK_NONE;
+	icp.parameters.max_correspondence_distance = 0.1f;
+	icp.parameters.nr_samples = 10000;
+	R.identity();
+	t = Dir(0.0f);
+	TEST_ASSERT(icp.align(R, t))
+	TEST_ASSERT(icp.get_statistics().nr_correspondences < 10000)
+	TEST_ASSERT(registration_error(R, t, R_true, t_true) < 5e-3f)
+
+	// point to plane needs target normals
+	point_cloud target_without_normals;
+	target_without_normals.resize(10);
+	icp.set_target_cloud(target_without_normals);
+	TEST_ASSERT(!icp.align(R, t))
+	return true;
+}
+
+/// report milliseconds per iteration for registration of 1M point scans
+bool test_icp_engine_throughput()
+{
+	point_cloud target, source;
+	construct_scan(target, 1000, 0);
+	construct_scan(source, 1000, 0.5f);
+	inverse_transform(source, construct_rotation(2), Dir(0.01f, 0.0f, 0.0f));
+	icp_engine icp;
+	icp.set_target_cloud(target);
+	icp.set_source_cloud(source);
+	icp.parameters.max_iterations = 5;
+	icp.parameters.min_relative_error_change = 0;
+	icp.parameters.min_rotation_change = icp.parameters.min_translation_change = 0;
+	unsigned max_nr_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	std::cout << "\n";
+	for (auto metric : { icp_engine::EM_POINT_TO_POINT, icp_engine::EM_POINT_TO_PLANE }) {
+		icp.parameters.metric = metric;
+		for (auto kernel : { icp_engine::RK_NONE, icp_engine::RK_TUKEY }) {
+			icp.parameters.kernel = kernel;
+			std::cout << "  " << (metric == icp_engine::EM_POINT_TO_POINT ? "point to point" : "point to plane")
+					  << (kernel == icp_engine::RK_TUKEY ? ", tukey" : "") << ":";
+			for (unsigned nr_threads = 1; nr_threads <= max_nr_threads; nr_threads *= 2) {
+				icp.parameters.nr_threads = nr_threads;
+				Mat R;
+				R.identity();
+				Dir t(0.0f);
+				icp.align(R, t);
+				std::cout << " " << nr_threads << " threads " << icp.get_statistics().ms_per_iteration << " ms/iteration";
+			}
+			std::cout << std::endl;
+		}
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_icp_engine_reg("cgv::pointcloud::icp_engine", test_icp_engine);
+extern CGV_API test_registration test_icp_engine_throughput_reg("cgv::pointcloud::icp_engine throughput", test_icp_engine_throughput);
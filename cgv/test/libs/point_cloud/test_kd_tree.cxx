@@ -0,0 +1,181 @@
+#include <cgv/base/register.h>
+#include <point_cloud/kd_tree.h>
+#include <point_cloud/ann_tree.h>
+#include <point_cloud/neighbor_graph.h>
+#include <iostream>
+#include <algorithm>
+#include <random>
+
+using namespace cgv::base;
+
+typedef point_cloud::Pnt Pnt;
+typedef point_cloud::Crd Crd;
+typedef point_cloud::Idx Idx;
+typedef point_cloud::Cnt Cnt;
+
+/// fill point cloud with n random points in the unit cube, where every 10th point duplicates its predecessor
+void construct_random_points(point_cloud& pc, unsigned n, unsigned seed)
+{
+	std::default_random_engine rng(seed);
+	std::uniform_real_distribution<float> d(0.0f, 1.0f);
+	pc.resize(n);
+	for (unsigned i = 0; i < n; ++i)
+		pc.pnt(i) = (i % 10 == 9) ? pc.pnt(i - 1) : Pnt(d(rng), d(rng), d(rng));
+}
+
+/// return squared distances of all points to p in ascending order
+std::vector<Crd> sorted_sqr_distances(const point_cloud& pc, const Pnt& p)
+{
+	std::vector<Crd> D(pc.get_nr_points());
+	for (Cnt i = 0; i < pc.get_nr_points(); ++i)
+		D[i] = sqr_length(pc.pnt(i) - p);
+	std::sort(D.begin(), D.end());
+	return D;
+}
+
+bool test_kd_tree()
+{
+	point_cloud pc;
+	construct_random_points(pc, 5000, 1);
+	kd_tree T;
+	TEST_ASSERT(T.is_empty())
+	T.build(pc);
+	TEST_ASSERT_EQ(T.get_nr_points(), pc.get_nr_points())
+
+	// single queries agree with brute force, where ties between duplicates are resolved by distances only
+	const Cnt k = 12;
+	const Crd radius = 0.08f;
+	std::vector<Pnt> queries;
+	std::default_random_engine rng(2);
+	std::uniform_real_distribution<float> d(-0.1f, 1.1f);
+	for (unsigned i = 0; i < 200; ++i)
+		queries.push_back(Pnt(d(rng), d(rng), d(rng)));
+	Idx I[k];
+	Crd D[k];
+	std::vector<Idx> R;
+	std::vector<Crd> RD;
+	for (const Pnt& q : queries) {
+		std::vector<Crd> D_true = sorted_sqr_distances(pc, q);
+		Crd sqr_dist;
+		Idx i = T.find_closest(q, &sqr_dist);
+		TEST_ASSERT_EQ(sqr_dist, D_true[0])
+		TEST_ASSERT_EQ(sqr_length(pc.pnt(i) - q), D_true[0])
+		TEST_ASSERT_EQ(T.find_k_nearest(q, k, I, D), k)
+		for (Cnt j = 0; j < k; ++j) {
+			TEST_ASSERT_EQ(D[j], D_true[j])
+			TEST_ASSERT_EQ(sqr_length(pc.pnt(I[j]) - q), D[j])
+		}
+		Cnt nr_within = Cnt(std::upper_bound(D_true.begin(), D_true.end(), radius * radius) - D_true.begin());
+		TEST_ASSERT_EQ(T.find_within_radius(q, radius, R, &RD), nr_within)
+		for (size_t j = 0; j < R.size(); ++j)
+			TEST_ASSERT(sqr_length(pc.pnt(R[j]) - q) <= radius * radius)
+	}
+
+	// batched queries produce the same results independent of the number of threads
+	Cnt n = Cnt(queries.size());
+	std::vector<Idx> I1(n * k), I4(n * k);
+	std::vector<Crd> D1(n * k), D4(n * k);
+	T.find_k_nearest(queries.data(), n, k, I1.data(), D1.data(), 1);
+	T.find_k_nearest(queries.data(), n, k, I4.data(), D4.data(), 4);
+	TEST_ASSERT(D1 == D4)
+	for (Cnt i = 0; i < n; ++i) {
+		T.find_k_nearest(queries[i], k, I, D);
+		TEST_ASSERT(std::equal(D, D + k, D1.begin() + i * k))
+	}
+	std::vector<Cnt> offsets;
+	std::vector<Idx> indices;
+	T.find_within_radius(queries.data(), n, radius, offsets, indices, 0, 4);
+	TEST_ASSERT_EQ(offsets.size(), size_t(n + 1))
+	for (Cnt i = 0; i < n; ++i) {
+		T.find_within_radius(queries[i], radius, R);
+		std::vector<Idx> R_batch(indices.begin() + offsets[i], indices.begin() + offsets[i + 1]);
+		std::sort(R.begin(), R.end());
+		std::sort(R_batch.begin(), R_batch.end());
+		TEST_ASSERT(R == R_batch)
+	}
+
+	// neighbors of all points exclude the point itself but contain its duplicate
+	std::vector<Idx> knn(pc.get_nr_points() * k);
+	T.find_neighbors(k, knn.data(), 0, 4);
+	std::vector<Idx> N;
+	for (Cnt i = 0; i < pc.get_nr_points(); ++i) {
+		const Idx* knn_i = &knn[i * k];
+		TEST_ASSERT(std::find(knn_i, knn_i + k, Idx(i)) == knn_i + k)
+		if (i % 10 == 9)
+			TEST_ASSERT(std::find(knn_i, knn_i + k, Idx(i - 1)) != knn_i + k)
+		T.extract_neighbors(i, k, N);
+		TEST_ASSERT_EQ(N.size(), size_t(k))
+		TEST_ASSERT(std::find(N.begin(), N.end(), Idx(i)) == N.end())
+		TEST_ASSERT_EQ(sqr_length(pc.pnt(N.back()) - pc.pnt(i)), sqr_length(pc.pnt(knn_i[k - 1]) - pc.pnt(i)))
+	}
+	neighbor_graph ng;
+	ng.build_from_knn(pc.get_nr_points(), k, knn.data());
+	TEST_ASSERT_EQ(ng.size(), size_t(pc.get_nr_points()))
+	TEST_ASSERT_EQ(ng.nr_half_edges, pc.get_nr_points() * k)
+
+	// trees over a subset of components report point indices of the whole cloud
+	point_cloud pc2;
+	pc2.create_components();
+	Idx ci = pc2.add_component();
+	for (unsigned i = 0; i < 100; ++i)
+		pc2.add_point(Pnt(float(i), 0.0f, 0.0f));
+	ci = pc2.add_component();
+	for (unsigned i = 0; i < 100; ++i)
+		pc2.add_point(Pnt(float(i), 1.0f, 0.0f));
+	T.build(pc2, std::vector<Idx>(1, ci));
+	TEST_ASSERT_EQ(T.get_nr_points(), Cnt(100))
+	TEST_ASSERT_EQ(T.find_closest(Pnt(10.2f, 0.0f, 0.0f)), Idx(pc2.component_point_range(ci).index_of_first_point + 10))
+	T.clear();
+	TEST_ASSERT(T.is_empty())
+	return true;
+}
+
+/// build a kd_tree over one million random points
+bool benchmark_kd_tree_build(benchmark_state& state)
+{
+	point_cloud pc;
+	construct_random_points(pc, 1000000, 3);
+	kd_tree T;
+	state.set_work(double(pc.get_nr_points()), "points");
+	state.measure([&]() { T.build(pc); });
+	return !T.is_empty();
+}
+
+/// query the 10 nearest neighbors of all points of a kd_tree over one million random points
+bool benchmark_kd_tree_knn(benchmark_state& state)
+{
+	point_cloud pc;
+	construct_random_points(pc, 1000000, 3);
+	const Cnt k = 10;
+	std::vector<Idx> knn(size_t(pc.get_nr_points()) * k);
+	kd_tree T;
+	T.build(pc);
+	state.set_work(double(pc.get_nr_points()), "queries");
+	state.measure([&]() { T.find_neighbors(k, knn.data()); });
+	return true;
+}
+
+/// query the 10 nearest neighbors of 100000 points with the ann_tree for comparison
+bool benchmark_ann_tree_knn(benchmark_state& state)
+{
+	point_cloud pc;
+	construct_random_points(pc, 1000000, 3);
+	const Cnt k = 10;
+	const Idx n = 100000;
+	ann_tree A;
+	A.build(pc);
+	std::vector<Idx> N;
+	state.set_work(double(n), "queries");
+	state.measure([&]() {
+		for (Idx i = 0; i < n; ++i)
+			A.extract_neighbors(i, k, N);
+	});
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_kd_tree_reg("kd_tree", test_kd_tree);
+extern CGV_API benchmark_registration benchmark_kd_tree_build_reg("kd_tree build", benchmark_kd_tree_build);
+extern CGV_API benchmark_registration benchmark_kd_tree_knn_reg("kd_tree knn", benchmark_kd_tree_knn);
+extern CGV_API benchmark_registration benchmark_ann_tree_knn_reg("ann_tree knn", benchmark_ann_tree_knn);
@@ -0,0 +1,190 @@
+#include <cgv/base/register.h>
+#include <point_cloud/linear_octree.h>
+#include <point_cloud/kd_tree.h>
+#include <point_cloud/normal_estimator.h>
+#include <point_cloud/morton.h>
+#include <cgv/utils/stopwatch.h>
+#include <iostream>
+#include <algorithm>
+#include <random>
+
+using namespace cgv::base;
+
+typedef point_cloud::Pnt Pnt;
+typedef point_cloud::Nml Nml;
+typedef point_cloud::Box Box;
+typedef point_cloud::Crd Crd;
+typedef point_cloud::Idx Idx;
+typedef point_cloud::Cnt Cnt;
+
+/// sample n points on the unit sphere in random order and store the position also as normal
+void construct_sphere(point_cloud& pc, unsigned n, unsigned seed)
+{
+	std::default_random_engine rng(seed);
+	std::normal_distribution<float> d;
+	pc.resize(n);
+	pc.create_normals();
+	for (unsigned i = 0; i < n; ++i) {
+		pc.pnt(i) = normalize(Pnt(d(rng), d(rng), d(rng)));
+		pc.nml(i) = pc.pnt(i);
+	}
+}
+
+/// check that points are sorted with consistent normals and that the morton codes fit the positions
+bool check_sorted(const point_cloud& pc, const std::vector<uint64_t>& codes, Idx begin, Idx end)
+{
+	std::vector<uint64_t> recomputed;
+	pc.compute_morton_codes(recomputed);
+	for (Idx i = begin; i < end; ++i) {
+		if (pc.nml(i) != pc.pnt(i) || codes[i] != recomputed[i])
+			return false;
+		if (i > begin && codes[i - 1] > codes[i])
+			return false;
+	}
+	return true;
+}
+
+bool test_morton()
+{
+	// decoding inverts encoding on 21 bits per axis
+	unsigned x, y, z;
+	cgv::pointcloud::morton_decode_magicbits(cgv::pointcloud::morton_encode_magicbits(0x1fffff, 12345, 7), x, y, z);
+	TEST_ASSERT_EQ(x, 0x1fffffu)
+	TEST_ASSERT_EQ(y, 12345u)
+	TEST_ASSERT_EQ(z, 7u)
+
+	// sorting permutes all attributes and gives the same order independent of the number of threads
+	point_cloud pc, pc_parallel;
+	construct_sphere(pc, 300000, 1);
+	pc_parallel = pc;
+	std::vector<Pnt> P_before(&pc.pnt(0), &pc.pnt(0) + pc.get_nr_points());
+	std::vector<uint64_t> codes, codes_parallel;
+	pc.sort_morton(&codes, 1);
+	pc_parallel.sort_morton(&codes_parallel, 4);
+	TEST_ASSERT(check_sorted(pc, codes, 0, pc.get_nr_points()))
+	TEST_ASSERT(codes == codes_parallel)
+	TEST_ASSERT(std::equal(&pc.pnt(0), &pc.pnt(0) + pc.get_nr_points(), &pc_parallel.pnt(0)))
+	std::vector<Pnt> P_after(&pc.pnt(0), &pc.pnt(0) + pc.get_nr_points());
+	auto less = [](const Pnt& p, const Pnt& q) { return std::lexicographical_compare(p.begin(), p.end(), q.begin(), q.end()); };
+	std::sort(P_before.begin(), P_before.end(), less);
+	std::sort(P_after.begin(), P_after.end(), less);
+	TEST_ASSERT(P_before == P_after)
+
+	// linear octree nodes partition the point ranges of their parents
+	linear_octree T;
+	TEST_ASSERT(T.build(pc, codes, -1, 16))
+	TEST_ASSERT_EQ(T.get_node(0).end - T.get_node(0).begin, pc.get_nr_points())
+	Cnt nr_leaf_points = 0;
+	for (Cnt ni = 0; ni < T.get_nr_nodes(); ++ni) {
+		const linear_octree::node& nd = T.get_node(ni);
+		if (nd.is_leaf()) {
+			nr_leaf_points += nd.end - nd.begin;
+			TEST_ASSERT(nd.end - nd.begin <= 16 || nd.level == linear_octree::max_level)
+			continue;
+		}
+		TEST_ASSERT_EQ(T.get_node(nd.first_child).begin, nd.begin)
+		TEST_ASSERT_EQ(T.get_node(nd.first_child + nd.nr_children - 1).end, nd.end)
+		for (Cnt c = 0; c < nd.nr_children; ++c) {
+			TEST_ASSERT_EQ(T.get_node(nd.first_child + c).level, nd.level + 1)
+			if (c > 0)
+				TEST_ASSERT_EQ(T.get_node(nd.first_child + c).begin, T.get_node(nd.first_child + c - 1).end)
+		}
+		Box cell = T.get_cell(ni);
+		for (Cnt i = nd.begin; i < nd.end; i += 97)
+			TEST_ASSERT(sqr_length(cell.get_center() - pc.pnt(i)) <= 0.26f * sqr_length(cell.get_extent()))
+	}
+	TEST_ASSERT_EQ(nr_leaf_points, pc.get_nr_points())
+
+	// range queries agree with brute force
+	std::default_random_engine rng(2);
+	std::uniform_real_distribution<float> d(-1.0f, 1.0f);
+	std::vector<Idx> result, expected;
+	for (unsigned q = 0; q < 20; ++q) {
+		Pnt p(d(rng), d(rng), d(rng));
+		Box box(p, p + Pnt(0.3f, 0.2f, 0.4f));
+		T.find_in_box(box, result);
+		expected.clear();
+		for (Idx i = 0; i < Idx(pc.get_nr_points()); ++i)
+			if (box.inside(pc.pnt(i)))
+				expected.push_back(i);
+		TEST_ASSERT(result == expected)
+		T.find_within_radius(p, 0.25f, result);
+		expected.clear();
+		for (Idx i = 0; i < Idx(pc.get_nr_points()); ++i)
+			if (sqr_length(pc.pnt(i) - p) <= 0.25f * 0.25f)
+				expected.push_back(i);
+		TEST_ASSERT(result == expected)
+	}
+	std::swap(codes[0], codes[1000]);
+	TEST_ASSERT(!T.build(pc, codes))
+	codes.pop_back();
+	TEST_ASSERT(!T.build(pc, codes))
+
+	// components are sorted individually and keep their point ranges
+	point_cloud pc2;
+	pc2.create_normals();
+	pc2.create_components();
+	std::uniform_real_distribution<float> u(0.0f, 1.0f);
+	for (unsigned ci = 0; ci < 3; ++ci) {
+		pc2.add_component();
+		for (unsigned i = 0; i < 1000; ++i) {
+			pc2.add_point(Pnt(u(rng), float(ci), u(rng)));
+			pc2.nml(pc2.get_nr_points() - 1) = pc2.pnt(pc2.get_nr_points() - 1);
+		}
+	}
+	pc2.sort_morton(&codes);
+	for (Idx ci = 0; ci < Idx(pc2.get_nr_components()); ++ci) {
+		Idx begin = Idx(pc2.component_point_range(ci).index_of_first_point);
+		Idx end = begin + Idx(pc2.component_point_range(ci).nr_points);
+		TEST_ASSERT(check_sorted(pc2, codes, begin, end))
+		for (Idx i = begin; i < end; ++i)
+			TEST_ASSERT_EQ(pc2.pnt(i)[1], float(ci - 1))
+		if (end > begin) {
+			TEST_ASSERT(T.build(pc2, codes, ci))
+			TEST_ASSERT_EQ(Idx(T.get_node(0).begin), begin)
+		}
+	}
+	return true;
+}
+
+/// report times of nearest neighbor queries and normal estimation for 1M points in random and in morton order
+bool test_morton_throughput()
+{
+	point_cloud pc;
+	construct_sphere(pc, 1000000, 3);
+	const Cnt k = 10;
+	std::vector<Idx> knn(size_t(pc.get_nr_points()) * k);
+	std::cout << "\n";
+	double t_sort = 0;
+	for (int pass = 0; pass < 2; ++pass) {
+		if (pass == 1) {
+			cgv::utils::stopwatch s(&t_sort, false);
+			pc.sort_morton(0, 1);
+		}
+		double t_knn = 0, t_normals = 0;
+		kd_tree T;
+		T.build(pc);
+		{
+			cgv::utils::stopwatch s(&t_knn, false);
+			T.find_k_nearest(&pc.pnt(0), pc.get_nr_points(), k, knn.data(), 0, 1);
+		}
+		T.find_neighbors(k, knn.data(), 0, 1);
+		neighbor_graph ng;
+		ng.build_from_knn(pc.get_nr_points(), k, knn.data());
+		normal_estimator ne(pc, ng);
+		{
+			cgv::utils::stopwatch s(&t_normals, false);
+			ne.compute_weighted_normals(false);
+		}
+		std::cout << "  " << (pass == 0 ? "random order: " : "morton order: ") << "knn " << t_knn << " s, normals " << t_normals << " s";
+		if (pass == 1)
+			std::cout << ", sort " << t_sort << " s";
+		std::cout << std::endl;
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_morton_reg("point_cloud::sort_morton", test_morton);
+extern CGV_API test_registration test_morton_throughput_reg("point_cloud::sort_morton throughput", test_morton_throughput);
@@ -0,0 +1,154 @@
+#include <cgv/base/register.h>
+#include <point_cloud/neighbor_graph.h>
+#include <point_cloud/kd_tree.h>
+#include <cgv/utils/stopwatch.h>
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <thread>
+
+using namespace cgv::base;
+
+typedef point_cloud::Pnt Pnt;
+typedef point_cloud::Idx Idx;
+typedef point_cloud::Cnt Cnt;
+
+/// fill point cloud with n random points in the unit cube
+void construct_uniform_points(point_cloud& pc, unsigned n, unsigned seed)
+{
+	std::default_random_engine rng(seed);
+	std::uniform_real_distribution<float> d(0.0f, 1.0f);
+	pc.resize(n);
+	for (unsigned i = 0; i < n; ++i)
+		pc.pnt(i) = Pnt(d(rng), d(rng), d(rng));
+}
+
+/// sequential symmetrization as reference
+void symmetrize_sequentially(neighbor_graph& ng)
+{
+	for (Idx i = 0; i < Idx(ng.size()); ++i) {
+		for (size_t j = 0; j < ng[i].size(); ++j) {
+			std::vector<Idx>& Nj = ng[ng[i][j]];
+			if (std::find(Nj.begin(), Nj.end(), i) == Nj.end()) {
+				Nj.push_back(i);
+				++ng.nr_half_edges;
+			}
+		}
+	}
+}
+
+bool equal_graphs(const neighbor_graph& ng, const compact_neighbor_graph& cng)
+{
+	if (ng.size() != cng.size() || ng.nr_half_edges != cng.get_nr_half_edges())
+		return false;
+	for (Idx i = 0; i < Idx(ng.size()); ++i)
+		if (ng[i].size() != cng[i].size() || !std::equal(ng[i].begin(), ng[i].end(), cng[i].begin()))
+			return false;
+	return true;
+}
+
+bool test_neighbor_graph()
+{
+	point_cloud pc;
+	construct_uniform_points(pc, 20000, 1);
+	kd_tree T;
+	T.build(pc);
+	const Cnt k = 8;
+	std::vector<Idx> knn(size_t(pc.get_nr_points()) * k);
+	T.find_neighbors(k, knn.data());
+	// truncated rows are skipped at the first -1
+	knn[5 * k + 3] = -1;
+
+	neighbor_graph ng, ng_reference;
+	ng_reference.build_from_knn(pc.get_nr_points(), k, knn.data(), 0, 1);
+	ng.build_from_knn(pc.get_nr_points(), k, knn.data(), 0, 4);
+	TEST_ASSERT(ng == ng_reference)
+	TEST_ASSERT_EQ(ng[5].size(), size_t(3))
+	TEST_ASSERT_EQ(ng.nr_half_edges, pc.get_nr_points() * k - 5)
+
+	// compact graphs agree with neighbor graphs independent of the number of threads
+	compact_neighbor_graph cng;
+	cng.build_from_knn(pc.get_nr_points(), k, knn.data(), 4);
+	TEST_ASSERT(equal_graphs(ng_reference, cng))
+	TEST_ASSERT_EQ(cng.find(0, ng_reference[0][2]), 2)
+	TEST_ASSERT_EQ(cng[5].size(), size_t(3))
+
+	symmetrize_sequentially(ng_reference);
+	for (unsigned nr_threads = 1; nr_threads <= 4; nr_threads *= 2) {
+		compact_neighbor_graph C;
+		C.build_from_knn(pc.get_nr_points(), k, knn.data(), nr_threads);
+		C.symmetrize(nr_threads);
+		TEST_ASSERT(equal_graphs(ng_reference, C))
+	}
+	ng.symmetrize(4);
+	TEST_ASSERT(ng == ng_reference)
+	TEST_ASSERT_EQ(ng.nr_half_edges, ng_reference.nr_half_edges)
+	for (Idx i = 0; i < Idx(ng.size()); ++i)
+		for (Idx j : ng[i])
+			TEST_ASSERT(ng.is_directed_edge(j, i))
+
+	// gathering from a thread safe knn structure and converting back
+	compact_neighbor_graph cng2;
+	cng2.build(pc.get_nr_points(), k, T, 4);
+	neighbor_graph ng2;
+	ng2.assign(cng2);
+	TEST_ASSERT(equal_graphs(ng2, cng2))
+	for (Idx i = 0; i < Idx(ng2.size()); i += 101) {
+		std::vector<Idx> N;
+		T.extract_neighbors(i, k, N);
+		TEST_ASSERT(ng2[i] == N)
+	}
+	cng2.clear();
+	TEST_ASSERT(cng2.empty())
+	return true;
+}
+
+/// report time and memory of building and symmetrizing neighbor graphs of 1M points
+bool test_neighbor_graph_throughput()
+{
+	point_cloud pc;
+	construct_uniform_points(pc, 1000000, 3);
+	kd_tree T;
+	T.build(pc);
+	const Cnt k = 10;
+	std::vector<Idx> knn(size_t(pc.get_nr_points()) * k);
+	T.find_neighbors(k, knn.data());
+	std::cout << "\n";
+	{
+		double t_build = 0, t_sym = 0;
+		neighbor_graph ng;
+		{
+			cgv::utils::stopwatch s(&t_build, false);
+			ng.build_from_knn(pc.get_nr_points(), k, knn.data(), 0, 1);
+		}
+		{
+			cgv::utils::stopwatch s(&t_sym, false);
+			symmetrize_sequentially(ng);
+		}
+		size_t bytes = ng.size() * sizeof(std::vector<Idx>);
+		for (const auto& Ni : ng)
+			bytes += Ni.capacity() * sizeof(Idx);
+		std::cout << "  neighbor_graph sequential: build " << t_build << " s, symmetrize " << t_sym << " s, " << (bytes >> 20) << " MB without allocation overhead" << std::endl;
+	}
+	unsigned max_nr_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	for (unsigned nr_threads = 1; nr_threads <= max_nr_threads; nr_threads *= 2) {
+		double t_build = 0, t_sym = 0;
+		compact_neighbor_graph cng;
+		{
+			cgv::utils::stopwatch s(&t_build, false);
+			cng.build_from_knn(pc.get_nr_points(), k, knn.data(), nr_threads);
+		}
+		{
+			cgv::utils::stopwatch s(&t_sym, false);
+			cng.symmetrize(nr_threads);
+		}
+		size_t bytes = cng.offsets.capacity() * sizeof(Cnt) + cng.indices.capacity() * sizeof(Idx);
+		std::cout << "  compact_neighbor_graph " << nr_threads << " threads: build " << t_build << " s, symmetrize " << t_sym << " s, " << (bytes >> 20) << " MB" << std::endl;
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_neighbor_graph_reg("neighbor_graph", test_neighbor_graph);
+extern CGV_API test_registration test_neighbor_graph_throughput_reg("neighbor_graph throughput", test_neighbor_graph_throughput);
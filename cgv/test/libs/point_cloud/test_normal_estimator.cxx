@@ -0,0 +1,79 @@
+#include <cgv/base/register.h>
+#include <point_cloud/kd_tree.h>
+#include <point_cloud/neighbor_graph.h>
+#include <point_cloud/normal_estimator.h>
+#include <iostream>
+#include <cmath>
+#include <random>
+
+using namespace cgv::base;
+
+typedef point_cloud::Pnt Pnt;
+typedef point_cloud::Nml Nml;
+typedef point_cloud::Crd Crd;
+typedef point_cloud::Idx Idx;
+typedef point_cloud::Cnt Cnt;
+
+/// fill point cloud with n points uniformly distributed on the unit sphere
+void construct_sphere_points(point_cloud& pc, unsigned n, unsigned seed)
+{
+	std::default_random_engine rng(seed);
+	std::normal_distribution<float> d(0.0f, 1.0f);
+	pc.resize(n);
+	for (unsigned i = 0; i < n; ++i) {
+		Pnt p(d(rng), d(rng), d(rng));
+		pc.pnt(i) = p / length(p);
+	}
+}
+
+/// build neighbor graph of the k nearest neighbors with a kd_tree
+void construct_neighbor_graph(const point_cloud& pc, Cnt k, neighbor_graph& ng)
+{
+	kd_tree T;
+	T.build(pc);
+	std::vector<Idx> knn(size_t(pc.get_nr_points()) * k);
+	T.find_neighbors(k, knn.data());
+	ng.build_from_knn(pc.get_nr_points(), k, knn.data());
+}
+
+bool test_normal_estimator()
+{
+	point_cloud pc;
+	construct_sphere_points(pc, 20000, 5);
+	neighbor_graph ng;
+	construct_neighbor_graph(pc, 10, ng);
+	normal_estimator ne(pc, ng);
+	ne.compute_weighted_normals(false);
+	TEST_ASSERT(pc.has_normals())
+	// estimated normals are parallel to the radial direction
+	Crd min_abs_dot = 1;
+	for (Idx i = 0; i < Idx(pc.get_nr_points()); ++i)
+		min_abs_dot = std::min(min_abs_dot, std::abs(dot(pc.nml(i), pc.pnt(i))));
+	TEST_ASSERT(min_abs_dot > 0.95f)
+	// orientation towards the center yields consistently oriented normals
+	ne.orient_normals(Pnt(0.0f));
+	Idx nr_inward = 0;
+	for (Idx i = 0; i < Idx(pc.get_nr_points()); ++i)
+		if (dot(pc.nml(i), pc.pnt(i)) < 0)
+			++nr_inward;
+	TEST_ASSERT(nr_inward == 0 || nr_inward == Idx(pc.get_nr_points()))
+	return true;
+}
+
+/// estimate weighted least squares normals of 200000 points on a sphere from their 10 nearest neighbors
+bool benchmark_normal_estimator(benchmark_state& state)
+{
+	point_cloud pc;
+	construct_sphere_points(pc, 200000, 7);
+	neighbor_graph ng;
+	construct_neighbor_graph(pc, 10, ng);
+	normal_estimator ne(pc, ng);
+	state.set_work(double(pc.get_nr_points()), "points");
+	state.measure([&]() { ne.compute_weighted_normals(false); });
+	return pc.has_normals();
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_normal_estimator_reg("normal_estimator", test_normal_estimator);
+extern CGV_API benchmark_registration benchmark_normal_estimator_reg("normal_estimator weighted normals", benchmark_normal_estimator);
@@ -0,0 +1,146 @@
+#include <cgv/base/register.h>
+#include <point_cloud/octree.h>
+#include <cgv/utils/file.h>
+#include <cgv/utils/stopwatch.h>
+#include <iostream>
+#include <algorithm>
+#include <random>
+
+using namespace cgv::base;
+
+typedef cgv::pointcloud::SimpleLODPoint LODPoint;
+
+/// create n points in the unit cube with a dense cluster, where the color encodes the point index
+std::vector<LODPoint> construct_lod_points(unsigned n, unsigned seed)
+{
+	std::default_random_engine rng(seed);
+	std::uniform_real_distribution<float> d(0.0f, 1.0f);
+	std::vector<LODPoint> points(n);
+	for (unsigned i = 0; i < n; ++i) {
+		float s = (i % 4 == 0) ? 0.05f : 1.0f;
+		points[i].position() = cgv::vec3(s * d(rng), s * d(rng), s * d(rng));
+		points[i].color() = cgv::rgb8(i & 255, (i >> 8) & 255, (i >> 16) & 255);
+		points[i].level() = 255;
+	}
+	return points;
+}
+
+unsigned point_index(const LODPoint& p)
+{
+	return p.color()[0] + (unsigned(p.color()[1]) << 8) + (unsigned(p.color()[2]) << 16);
+}
+
+bool test_octree_lod()
+{
+	const unsigned n = 200000;
+	std::vector<LODPoint> points = construct_lod_points(n, 1);
+	const std::string file_name = "test_octree_lod.lod";
+
+	// a budget of an eighth of the input forces many batches, spills and chunks
+	cgv::pointcloud::octree_lod_generator<LODPoint> generator;
+	cgv::pointcloud::OutOfCoreSettings settings;
+	settings.memory_budget = n * sizeof(LODPoint) / 8;
+	settings.page_size = 4096;
+	cgv::pointcloud::ArrayPointSource<LODPoint> source(points.data(), points.size());
+	TEST_ASSERT(generator.generate_lods_out_of_core(source, file_name, settings))
+
+	cgv::pointcloud::PagedLODFile<LODPoint> lod_file;
+	TEST_ASSERT(lod_file.open(file_name))
+	const auto& header = lod_file.get_header();
+	TEST_ASSERT_EQ(header.nr_points, uint64_t(n))
+	TEST_ASSERT_EQ(header.points_per_page, uint64_t(4096 / sizeof(LODPoint)))
+	TEST_ASSERT(lod_file.get_nodes().size() > 1)
+
+	// every input point is stored exactly once within the box and with the level of its node
+	std::vector<unsigned> counts(n, 0);
+	std::vector<LODPoint> node_points;
+	uint64_t next_point = 0;
+	int max_level = 0;
+	for (size_t ni = 0; ni < lod_file.get_nodes().size(); ++ni) {
+		const auto& node = lod_file.get_nodes()[ni];
+		TEST_ASSERT_EQ(node.first_point, next_point)
+		next_point += node.nr_points;
+		max_level = std::max(max_level, node.level());
+		TEST_ASSERT(lod_file.read_node(ni, node_points))
+		TEST_ASSERT_EQ(node_points.size(), size_t(node.nr_points))
+		for (const auto& p : node_points) {
+			unsigned i = point_index(p);
+			TEST_ASSERT(i < n)
+			if (i >= n)
+				continue;
+			++counts[i];
+			TEST_ASSERT(p.position() == points[i].position())
+			TEST_ASSERT_EQ(int(p.level()), node.level())
+			for (int c = 0; c < 3; ++c)
+				TEST_ASSERT(p.position()[c] >= node.min[c] - 1e-5f && p.position()[c] <= node.max[c] + 1e-5f)
+		}
+	}
+	TEST_ASSERT_EQ(next_point, uint64_t(n))
+	TEST_ASSERT(max_level > 1)
+	TEST_ASSERT(std::count(counts.begin(), counts.end(), 1u) == std::ptrdiff_t(n))
+
+	// a cache of a single page gives the same points
+	std::vector<LODPoint> all_points;
+	TEST_ASSERT(lod_file.read_all(all_points))
+	TEST_ASSERT(lod_file.open(file_name, 1))
+	for (size_t ni = 0; ni < lod_file.get_nodes().size(); ni += 7) {
+		const auto& node = lod_file.get_nodes()[ni];
+		TEST_ASSERT(lod_file.read_node(ni, node_points))
+		for (size_t j = 0; j < node_points.size(); ++j)
+			TEST_ASSERT_EQ(point_index(node_points[j]), point_index(all_points[size_t(node.first_point) + j]))
+	}
+	lod_file.close();
+
+	// points can be read from a file and coincident points are reduced to one
+	FILE* fp = fopen(file_name.c_str(), "wb");
+	TEST_ASSERT(fp != 0)
+	if (fp) {
+		std::vector<LODPoint> coincident(1000, points[0]);
+		fwrite(coincident.data(), sizeof(LODPoint), coincident.size(), fp);
+		fclose(fp);
+	}
+	const std::string coincident_file_name = "test_octree_lod_coincident.lod";
+	{
+		cgv::pointcloud::FilePointSource<LODPoint> file_source(file_name);
+		TEST_ASSERT(generator.generate_lods_out_of_core(file_source, coincident_file_name, settings))
+	}
+	TEST_ASSERT(lod_file.open(coincident_file_name))
+	TEST_ASSERT_EQ(lod_file.get_header().nr_points, uint64_t(1))
+	TEST_ASSERT_EQ(lod_file.get_nodes().size(), size_t(1))
+	lod_file.close();
+
+	// files of other point types are rejected
+	cgv::pointcloud::PagedLODFile<cgv::vec3> wrong_file;
+	TEST_ASSERT(!wrong_file.open(coincident_file_name))
+	cgv::utils::file::remove(file_name);
+	cgv::utils::file::remove(coincident_file_name);
+	return true;
+}
+
+/// report times of in-core and out-of-core lod generation for 4M points
+bool test_octree_lod_throughput()
+{
+	std::vector<LODPoint> points = construct_lod_points(4000000, 3);
+	cgv::pointcloud::octree_lod_generator<LODPoint> generator;
+	double t_in_core = 0, t_out_of_core = 0;
+	{
+		cgv::utils::stopwatch s(&t_in_core, false);
+		generator.generate_lods(points);
+	}
+	const std::string file_name = "test_octree_lod_throughput.lod";
+	cgv::pointcloud::OutOfCoreSettings settings;
+	settings.memory_budget = 16 << 20;
+	cgv::pointcloud::ArrayPointSource<LODPoint> source(points.data(), points.size());
+	{
+		cgv::utils::stopwatch s(&t_out_of_core, false);
+		generator.generate_lods_out_of_core(source, file_name, settings);
+	}
+	cgv::utils::file::remove(file_name);
+	std::cout << "\n  in-core " << t_in_core << " s, out-of-core with 16MB budget " << t_out_of_core << " s" << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_octree_lod_reg("octree_lod_generator out-of-core", test_octree_lod);
+extern CGV_API test_registration test_octree_lod_throughput_reg("octree_lod_generator out-of-core throughput", test_octree_lod_throughput);
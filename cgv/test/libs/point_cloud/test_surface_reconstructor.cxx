@@ -0,0 +1,190 @@
+#include <cgv/base/register.h>
+#include <point_cloud/surface_reconstructor.h>
+#include <point_cloud/kd_tree.h>
+#include <point_cloud/normal_estimator.h>
+#include <cgv/utils/stopwatch.h>
+#include <cgv/utils/file.h>
+#include <cgv/utils/convert.h>
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <map>
+#include <cstdlib>
+#include <cmath>
+
+using namespace cgv::base;
+
+typedef point_cloud::Pnt Pnt;
+typedef point_cloud::Nml Nml;
+typedef point_cloud::Idx Idx;
+typedef point_cloud::Cnt Cnt;
+
+/// sample n points on a torus with major radius 1 and minor radius 0.4 including exact normals
+void construct_torus(point_cloud& pc, unsigned n, unsigned seed)
+{
+	std::default_random_engine rng(seed);
+	std::uniform_real_distribution<float> d(0.0f, 2 * 3.14159265f);
+	pc.resize(n);
+	pc.create_normals();
+	for (unsigned i = 0; i < n; ++i) {
+		float u = d(rng), v = d(rng);
+		Nml nml(cos(u) * cos(v), sin(u) * cos(v), sin(v));
+		pc.pnt(i) = Pnt(cos(u), sin(u), 0.0f) + 0.4f * nml;
+		pc.nml(i) = nml;
+	}
+}
+
+/// read the vertices of an obj file and estimate oriented normals
+bool read_points(const std::string& file_name, point_cloud& pc)
+{
+	point_cloud obj;
+	if (!cgv::utils::file::exists(file_name) || !obj.read(file_name) || obj.get_nr_points() == 0)
+		return false;
+	pc.resize(0);
+	for (Idx i = 0; i < Idx(obj.get_nr_points()); ++i)
+		pc.add_point(obj.pnt(i));
+	pc.create_normals();
+	kd_tree K;
+	K.build(pc);
+	const Cnt k = 12;
+	std::vector<Idx> knn(size_t(pc.get_nr_points()) * k);
+	K.find_neighbors(k, knn.data());
+	neighbor_graph ng;
+	ng.build_from_knn(pc.get_nr_points(), k, knn.data());
+	normal_estimator ne(pc, ng);
+	ne.compute_weighted_normals(false);
+	ne.orient_normals();
+	return true;
+}
+
+/// statistics of a reconstructed triangle mesh
+struct mesh_quality
+{
+	unsigned nr_triangles;
+	/// number of edges with more than two incident triangles
+	unsigned nr_non_manifold_edges;
+	/// mean and minimum of the smallest triangle angles in degrees
+	double mean_min_angle, min_angle;
+};
+
+mesh_quality analyze_mesh(const point_cloud& pc, const std::vector<unsigned>& T)
+{
+	mesh_quality q = { unsigned(T.size() / 3), 0, 0, 180 };
+	std::map<std::pair<unsigned, unsigned>, unsigned> edge_counts;
+	for (size_t ti = 0; ti < T.size(); ti += 3) {
+		double min_angle = 180;
+		for (int c = 0; c < 3; ++c) {
+			unsigned vi = T[ti + c], vj = T[ti + (c + 1) % 3], vk = T[ti + (c + 2) % 3];
+			++edge_counts[std::make_pair(std::min(vi, vj), std::max(vi, vj))];
+			Pnt a = normalize(pc.pnt(vj) - pc.pnt(vi)), b = normalize(pc.pnt(vk) - pc.pnt(vi));
+			min_angle = std::min(min_angle, acos(std::max(-1.0, std::min(1.0, double(dot(a, b))))) * 180 / 3.14159265);
+		}
+		q.mean_min_angle += min_angle;
+		q.min_angle = std::min(q.min_angle, min_angle);
+	}
+	if (q.nr_triangles > 0)
+		q.mean_min_angle /= q.nr_triangles;
+	for (const auto& ec : edge_counts)
+		if (ec.second > 2)
+			++q.nr_non_manifold_edges;
+	return q;
+}
+
+/// run the region growing pipeline and return the time spent in growing, where nr_regions zero selects the serial grow_all and the number of consistent seed triangles is optionally returned
+double reconstruct(point_cloud& pc, unsigned nr_regions, unsigned nr_threads, std::vector<unsigned>& T, size_t* nr_seed_triangles = 0)
+{
+	kd_tree K;
+	K.build(pc);
+	const Cnt k = 12;
+	std::vector<Idx> knn(size_t(pc.get_nr_points()) * k);
+	K.find_neighbors(k, knn.data());
+	neighbor_graph ng;
+	ng.build_from_knn(pc.get_nr_points(), k, knn.data());
+	ng.symmetrize();
+
+	surface_reconstructor sr;
+	sr.pc = &pc;
+	sr.ng = &ng;
+	sr.sort_by_tangential_angle();
+	sr.delaunay_fan_neighbor_graph_filter();
+	std::vector<unsigned> C[3];
+	sr.find_consistent_triangles(C);
+	sr.mark_triangular_faces(C[0]);
+	sr.build_grow_queue(C[0]);
+	T = C[0];
+	if (nr_seed_triangles)
+		*nr_seed_triangles = T.size() / 3;
+	double t_grow = 0;
+	{
+		cgv::utils::stopwatch s(&t_grow, false);
+		if (nr_regions == 0)
+			sr.grow_all(T);
+		else
+			sr.grow_all_parallel(T, nr_regions, nr_threads);
+	}
+	return t_grow;
+}
+
+bool test_surface_reconstructor()
+{
+	point_cloud pc;
+	construct_torus(pc, 20000, 1);
+	std::vector<unsigned> T_serial, T_regions, T_parallel;
+	reconstruct(pc, 0, 1, T_serial);
+	reconstruct(pc, 4, 1, T_regions);
+	reconstruct(pc, 4, 4, T_parallel);
+
+	// the result does not depend on the number of threads
+	TEST_ASSERT(T_regions == T_parallel)
+
+	// parallel growing is manifold and of comparable quality
+	mesh_quality q_serial = analyze_mesh(pc, T_serial);
+	mesh_quality q_parallel = analyze_mesh(pc, T_parallel);
+	TEST_ASSERT(q_serial.nr_triangles > pc.get_nr_points())
+	TEST_ASSERT_EQ(q_parallel.nr_non_manifold_edges, 0u)
+	TEST_ASSERT(q_parallel.nr_triangles > 0.98 * q_serial.nr_triangles)
+	TEST_ASSERT(q_parallel.nr_triangles < 1.02 * q_serial.nr_triangles)
+	TEST_ASSERT(q_parallel.mean_min_angle > 0.95 * q_serial.mean_min_angle)
+
+	// a single region reproduces the serial result
+	std::vector<unsigned> T_single;
+	reconstruct(pc, 1, 4, T_single);
+	TEST_ASSERT(T_single == T_serial)
+	return true;
+}
+
+/// report growing times and triangle quality of serial and parallel region growing on the sample meshes of the framework or on a torus if CGV_DIR is not set
+bool test_surface_reconstructor_throughput()
+{
+	std::vector<std::string> file_names;
+	if (const char* cgv_dir = getenv("CGV_DIR")) {
+		file_names.push_back(std::string(cgv_dir) + "/plugins/examples/res/sphere.obj");
+		file_names.push_back(std::string(cgv_dir) + "/plugins/examples/res/blob.obj");
+	}
+	file_names.push_back("");
+	std::cout << "\n";
+	for (const auto& file_name : file_names) {
+		point_cloud pc;
+		if (file_name.empty())
+			construct_torus(pc, 200000, 3);
+		else if (!read_points(file_name, pc))
+			continue;
+		std::cout << "  " << (file_name.empty() ? std::string("torus") : cgv::utils::file::get_file_name(file_name)) << " with " << pc.get_nr_points() << " points" << std::endl;
+		std::vector<unsigned> T;
+		for (unsigned nr_threads = 0; nr_threads <= 8; nr_threads = std::max(2 * nr_threads, 1u)) {
+			size_t nr_seed_triangles;
+			double t = reconstruct(pc, nr_threads, nr_threads, T, &nr_seed_triangles);
+			mesh_quality q = analyze_mesh(pc, T);
+			// growing time depends on the number of triangles that are not seeds, so report both
+			std::cout << "    " << (nr_threads == 0 ? std::string("serial") : cgv::utils::to_string(nr_threads) + " regions") << ": grow "
+				<< 1000 * t << " ms, " << nr_seed_triangles << " seed and " << q.nr_triangles << " total triangles, " << q.nr_non_manifold_edges << " non manifold edges, min angle mean "
+				<< q.mean_min_angle << " min " << q.min_angle << std::endl;
+		}
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_surface_reconstructor_reg("surface_reconstructor::grow_all_parallel", test_surface_reconstructor);
+extern CGV_API test_registration test_surface_reconstructor_throughput_reg("surface_reconstructor::grow_all_parallel throughput", test_surface_reconstructor_throughput);
@@ -0,0 +1,191 @@
+#include <cgv/base/register.h>
+#include <cgv/os/task_scheduler.h>
+#include <point_cloud/concurrency.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace cgv::base;
+using namespace cgv::os;
+
+bool test_task_scheduler()
+{
+	// use several workers also on machines with few cores
+	task_scheduler& ts = task_scheduler::get();
+	unsigned nr_workers = ts.get_nr_workers();
+	ts.configure(3);
+	TEST_ASSERT_EQ(ts.get_concurrency(), 4u)
+	TEST_ASSERT_EQ(ts.get_current_worker_index(), -1)
+
+	// every index is visited exactly once, also with limited concurrency
+	const size_t n = 100000;
+	std::vector<std::atomic<int> > visits(n);
+	for (unsigned max_concurrency : { 0u, 1u, 2u }) {
+		for (auto& v : visits)
+			v = 0;
+		parallel_for(0, n, [&](size_t b, size_t e) {
+			for (size_t i = b; i < e; ++i)
+				++visits[i];
+		}, 1000, max_concurrency);
+		bool all_once = true;
+		for (auto& v : visits)
+			all_once = all_once && v == 1;
+		TEST_ASSERT(all_once)
+	}
+
+	// reductions combine blocks in order, such that results do not depend on the number of threads
+	auto map = [](size_t b, size_t e) {
+		double s = 0;
+		for (size_t i = b; i < e; ++i)
+			s += 1.0 / (i + 1);
+		return s;
+	};
+	auto sum = [](double a, double b) { return a + b; };
+	double r1 = parallel_reduce(0, n, 0.0, map, sum, 777, 1);
+	double r4 = parallel_reduce(0, n, 0.0, map, sum, 777);
+	TEST_ASSERT_EQ(r1, r4)
+	size_t count = parallel_reduce(size_t(10), size_t(1010), size_t(0), [](size_t b, size_t e) { return e - b; },
+		[](size_t a, size_t b) { return a + b; }, 7);
+	TEST_ASSERT_EQ(count, 1000u)
+
+	// nested parallelism in task groups with continuations
+	task_group group;
+	std::atomic<size_t> nr_inner(0);
+	std::atomic<int> continuation_state(0);
+	for (int t = 0; t < 8; ++t)
+		group.run([&]() {
+			parallel_for(0, 1000, [&](size_t b, size_t e) { nr_inner += e - b; }, 10);
+		});
+	group.then([&]() {
+		continuation_state = nr_inner == 8000 ? 1 : -1;
+		// continuations can run further tasks of the group
+		group.run([&]() { continuation_state += 1; });
+	});
+	group.wait();
+	TEST_ASSERT(group.is_done())
+	TEST_ASSERT_EQ(nr_inner.load(), 8000u)
+	TEST_ASSERT_EQ(continuation_state.load(), 2)
+
+	// continuation of a finished group runs immediately
+	bool late = false;
+	group.then([&]() { late = true; });
+	group.wait();
+	TEST_ASSERT(late)
+
+	// exceptions of tasks are rethrown by wait
+	task_group failing;
+	failing.run([]() { throw std::runtime_error("task failed"); });
+	failing.run([]() {});
+	bool caught = false;
+	try {
+		failing.wait();
+	}
+	catch (const std::runtime_error&) {
+		caught = true;
+	}
+	TEST_ASSERT(caught)
+
+#ifndef WIN32
+	// waiting for a long task executed by a worker blocks instead of spinning, where std::clock measures the processor time of the process
+	task_group sleeping;
+	std::atomic<bool> started(false);
+	sleeping.run([&]() {
+		started = true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(300));
+	});
+	while (!started)
+		std::this_thread::yield();
+	std::clock_t start_clock = std::clock();
+	sleeping.wait();
+	TEST_ASSERT(double(std::clock() - start_clock) / CLOCKS_PER_SEC < 0.1)
+#endif
+
+	ts.configure(nr_workers);
+	return true;
+}
+
+/// number of parallel loops per measurement, which correspond to the batched queries of point cloud algorithms
+const unsigned nr_parallel_loops = 200;
+/// number of elements per loop
+const size_t loop_size = 1 << 16;
+
+/// process one block of a parallel loop
+double process_block(size_t b, size_t e)
+{
+	double s = 0;
+	for (size_t i = b; i < e; ++i)
+		s += std::sqrt(double(i));
+	return s;
+}
+
+/// parallel loops on the shared task scheduler
+bool benchmark_task_scheduler_parallel_for(benchmark_state& state)
+{
+	std::atomic<size_t> checksum(0);
+	state.set_work(double(nr_parallel_loops), "loops");
+	state.measure([&]() {
+		for (unsigned l = 0; l < nr_parallel_loops; ++l)
+			parallel_for(0, loop_size, [&](size_t b, size_t e) { checksum += size_t(process_block(b, e)); }, 4096);
+	});
+	return checksum > 0;
+}
+
+/// parallel loops on a WorkerPool that is constructed per loop as done by the point cloud algorithms before
+bool benchmark_worker_pool_parallel_for(benchmark_state& state)
+{
+	std::atomic<size_t> checksum(0);
+	unsigned nr_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	state.set_work(double(nr_parallel_loops), "loops");
+	state.measure([&]() {
+		for (unsigned l = 0; l < nr_parallel_loops; ++l) {
+			std::atomic<size_t> next_block(0);
+			auto worker = [&](int) {
+				for (size_t b = next_block++; b * 4096 < loop_size; b = next_block++)
+					checksum += size_t(process_block(b * 4096, std::min(loop_size, (b + 1) * 4096)));
+			};
+			if (nr_threads <= 1)
+				worker(0);
+			else {
+				cgv::pointcloud::utility::WorkerPool pool(nr_threads - 1);
+				pool.run(worker);
+			}
+		}
+	});
+	return checksum > 0;
+}
+
+/// parallel loops on threads that are started per loop as done by the mesh and image algorithms before
+bool benchmark_std_thread_parallel_for(benchmark_state& state)
+{
+	std::atomic<size_t> checksum(0);
+	unsigned nr_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	state.set_work(double(nr_parallel_loops), "loops");
+	state.measure([&]() {
+		for (unsigned l = 0; l < nr_parallel_loops; ++l) {
+			std::atomic<size_t> next_block(0);
+			auto worker = [&]() {
+				for (size_t b = next_block++; b * 4096 < loop_size; b = next_block++)
+					checksum += size_t(process_block(b * 4096, std::min(loop_size, (b + 1) * 4096)));
+			};
+			std::vector<std::thread> threads;
+			for (unsigned i = 1; i < nr_threads; ++i)
+				threads.push_back(std::thread(worker));
+			worker();
+			for (auto& t : threads)
+				t.join();
+		}
+	});
+	return checksum > 0;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_task_scheduler_reg("cgv::os::task_scheduler", test_task_scheduler);
+extern CGV_API benchmark_registration benchmark_task_scheduler_parallel_for_reg("task_scheduler parallel_for", benchmark_task_scheduler_parallel_for);
+extern CGV_API benchmark_registration benchmark_worker_pool_parallel_for_reg("WorkerPool parallel_for", benchmark_worker_pool_parallel_for);
+extern CGV_API benchmark_registration benchmark_std_thread_parallel_for_reg("std::thread parallel_for", benchmark_std_thread_parallel_for);
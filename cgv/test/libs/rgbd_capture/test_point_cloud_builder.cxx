@@ -0,0 +1,243 @@
+#include <cgv/base/register.h>
+#include <rgbd_capture/rgbd_point_cloud.h>
+#include <rgbd_capture/rgbd_recording.h>
+#include <cgv/utils/file.h>
+#include <cgv/utils/stopwatch.h>
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <cmath>
+
+using namespace cgv::base;
+
+typedef rgbd::point_cloud_builder::vec3 vec3;
+typedef rgbd::point_cloud_builder::rgb8 rgb8;
+
+/// calibration resembling a time of flight depth camera next to a wide angle color camera
+rgbd::rgbd_calibration construct_calibration()
+{
+	rgbd::rgbd_calibration calib;
+	calib.depth_scale = 0.001;
+	calib.depth.w = 640;
+	calib.depth.h = 576;
+	calib.depth.s = cgv::math::fvec<double, 2>(504.0, 504.0);
+	calib.depth.c = cgv::math::fvec<double, 2>(321.5, 330.2);
+	double kd[6] = { 0.45, 0.02, 0.0, 0.78, 0.15, 0.003 };
+	std::copy(kd, kd + 6, calib.depth.k);
+	calib.color.w = 1280;
+	calib.color.h = 720;
+	calib.color.s = cgv::math::fvec<double, 2>(610.0, 610.0);
+	calib.color.c = cgv::math::fvec<double, 2>(638.4, 367.1);
+	double kc[6] = { 0.1, -0.05, 0.0, 0.0, 0.0, 0.0 };
+	std::copy(kc, kc + 6, calib.color.k);
+	calib.color.p[0] = 0.0004;
+	calib.color.p[1] = -0.0002;
+	// slightly rotated color camera 32 mm to the side
+	double a = 0.01;
+	calib.color.pose = pose_construct(cgv::math::fmat<double, 3, 3>({ 1.0, 0.0, 0.0, 0.0, cos(a), sin(a), 0.0, -sin(a), cos(a) }), cgv::math::fvec<double, 3>(-32.0, -2.0, 4.0));
+	return calib;
+}
+
+/// wavy surface at about 1.5 meters with holes and noise
+void construct_depth_frame(rgbd::frame_type& frame, unsigned w, unsigned h, unsigned t)
+{
+	frame.width = w;
+	frame.height = h;
+	frame.pixel_format = rgbd::PF_DEPTH;
+	frame.nr_bits_per_pixel = 16;
+	frame.compute_buffer_size();
+	frame.frame_data.resize(frame.buffer_size);
+	frame.frame_index = t;
+	frame.time = t / 30.0;
+	std::default_random_engine rng(t);
+	std::uniform_int_distribution<int> noise(-2, 2);
+	uint16_t* D = reinterpret_cast<uint16_t*>(&frame.frame_data.front());
+	for (unsigned y = 0; y < h; ++y)
+		for (unsigned x = 0; x < w; ++x) {
+			bool hole = ((x / 32 + y / 24 + t) % 9) == 0;
+			D[y * w + x] = hole ? 0 : uint16_t(1500 + 300 * sin(0.02 * x + 0.1 * t) + 200 * cos(0.015 * y) + noise(rng));
+		}
+}
+
+/// bgra color frame with a position dependent pattern
+void construct_color_frame(rgbd::frame_type& frame, unsigned w, unsigned h, unsigned t)
+{
+	frame.width = w;
+	frame.height = h;
+	frame.pixel_format = rgbd::PF_BGRA;
+	frame.nr_bits_per_pixel = 32;
+	frame.compute_buffer_size();
+	frame.frame_data.resize(frame.buffer_size);
+	frame.frame_index = t;
+	frame.time = t / 30.0;
+	uint8_t* C = reinterpret_cast<uint8_t*>(&frame.frame_data.front());
+	for (unsigned y = 0; y < h; ++y)
+		for (unsigned x = 0; x < w; ++x) {
+			uint8_t* c = C + 4 * (y * w + x);
+			c[0] = uint8_t(x + t);
+			c[1] = uint8_t(y);
+			c[2] = uint8_t((x ^ y) >> 2);
+			c[3] = 255;
+		}
+}
+
+bool test_point_cloud_builder()
+{
+	rgbd::rgbd_calibration calib = construct_calibration();
+	std::vector<cgv::math::fvec<float, 2>> undistortion_map;
+	rgbd::compute_distortion_map(calib, undistortion_map);
+	rgbd::frame_type depth_frame, color_frame;
+	construct_depth_frame(depth_frame, 640, 576, 1);
+	construct_color_frame(color_frame, 1280, 720, 1);
+
+	// reference of per pixel construction
+	std::vector<vec3> P_ref;
+	std::vector<rgb8> C_ref;
+	rgbd::construct_point_cloud(depth_frame, color_frame, P_ref, C_ref, calib, &undistortion_map);
+	TEST_ASSERT(P_ref.size() > 200000)
+
+	rgbd::point_cloud_builder builder;
+	builder.build(calib, undistortion_map);
+	TEST_ASSERT(builder.is_built())
+	std::vector<vec3> P1, P4;
+	std::vector<rgb8> C1, C4;
+	std::vector<uint32_t> I;
+	builder.set_nr_threads(1);
+	TEST_ASSERT_EQ(builder.construct_point_cloud(depth_frame, P1, &C1, &color_frame), P_ref.size())
+	builder.set_nr_threads(4);
+	builder.construct_point_cloud(depth_frame, P4, &C4, &color_frame, &I);
+
+	// results do not depend on the number of threads and agree with the reference up to rounding
+	TEST_ASSERT(P1 == P4)
+	TEST_ASSERT(C1 == C4)
+	size_t nr_color_mismatches = 0;
+	float max_error = 0;
+	for (size_t i = 0; i < P_ref.size(); ++i) {
+		max_error = std::max(max_error, length(P4[i] - P_ref[i]) / length(P_ref[i]));
+		if (!(C4[i] == C_ref[i]))
+			++nr_color_mismatches;
+	}
+	TEST_ASSERT(max_error < 1e-6f)
+	TEST_ASSERT(nr_color_mismatches < P_ref.size() / 1000)
+
+	// dense points agree with the point cloud at the pixel indices and are zero elsewhere
+	std::vector<vec3> P_dense(640 * 576, vec3(1.0f));
+	TEST_ASSERT(builder.construct_points(depth_frame, P_dense.data()))
+	TEST_ASSERT_EQ(I.size(), P4.size())
+	size_t nr_valid = 0;
+	for (size_t i = 0; i < P_dense.size(); ++i)
+		if (P_dense[i][2] > 0)
+			++nr_valid;
+	TEST_ASSERT_EQ(nr_valid, P4.size())
+	for (size_t i = 0; i < I.size(); ++i)
+		TEST_ASSERT(P_dense[I[i]] == P4[i])
+	TEST_ASSERT(P_dense[0] == vec3(0.0f) || reinterpret_cast<const uint16_t&>(depth_frame.frame_data[0]) != 0)
+
+	// looking up colors in the warped color frame yields the same colors
+	rgbd::frame_type warped_color_frame;
+	TEST_ASSERT(builder.map_color_to_depth(depth_frame, color_frame, warped_color_frame))
+	TEST_ASSERT_EQ(warped_color_frame.width, 640)
+	TEST_ASSERT_EQ(warped_color_frame.pixel_format, rgbd::PF_BGRA)
+	std::vector<vec3> P_warped;
+	std::vector<rgb8> C_warped;
+	builder.construct_point_cloud(depth_frame, P_warped, &C_warped, &warped_color_frame);
+	TEST_ASSERT(C_warped == C4)
+
+	// frames that do not match the calibration are rejected
+	rgbd::frame_type small_frame;
+	construct_depth_frame(small_frame, 320, 288, 1);
+	TEST_ASSERT_EQ(builder.construct_point_cloud(small_frame, P1), size_t(0))
+	TEST_ASSERT(P1.empty())
+	return true;
+}
+
+/// report frames per second of point cloud construction and of headless replay from a recording file
+bool test_point_cloud_builder_throughput()
+{
+	rgbd::rgbd_calibration calib = construct_calibration();
+	std::vector<cgv::math::fvec<float, 2>> undistortion_map;
+	rgbd::compute_distortion_map(calib, undistortion_map);
+	rgbd::frame_type depth_frame, color_frame, warped_color_frame;
+	construct_depth_frame(depth_frame, 640, 576, 2);
+	construct_color_frame(color_frame, 1280, 720, 2);
+	std::vector<vec3> P;
+	std::vector<rgb8> C;
+	const unsigned nr_frames = 20;
+	std::cout << "\n";
+	{
+		double t = 0;
+		{
+			cgv::utils::stopwatch s(&t, false);
+			for (unsigned i = 0; i < nr_frames; ++i) {
+				P.clear();
+				C.clear();
+				rgbd::construct_point_cloud(depth_frame, color_frame, P, C, calib, &undistortion_map);
+			}
+		}
+		std::cout << "  construct_point_cloud: " << nr_frames / t << " frames/s" << std::endl;
+	}
+	rgbd::point_cloud_builder builder;
+	builder.build(calib, undistortion_map);
+	std::vector<vec3> P_dense(640 * 576);
+	unsigned max_nr_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	for (unsigned nr_threads = 1; nr_threads <= max_nr_threads; nr_threads *= 2) {
+		builder.set_nr_threads(nr_threads);
+		double t_points = 0, t_dense = 0, t_color = 0, t_warp = 0;
+		{
+			cgv::utils::stopwatch s(&t_points, false);
+			for (unsigned i = 0; i < nr_frames; ++i)
+				builder.construct_point_cloud(depth_frame, P);
+		}
+		{
+			cgv::utils::stopwatch s(&t_dense, false);
+			for (unsigned i = 0; i < nr_frames; ++i)
+				builder.construct_points(depth_frame, P_dense.data());
+		}
+		{
+			cgv::utils::stopwatch s(&t_color, false);
+			for (unsigned i = 0; i < nr_frames; ++i)
+				builder.construct_point_cloud(depth_frame, P, &C, &color_frame);
+		}
+		{
+			cgv::utils::stopwatch s(&t_warp, false);
+			for (unsigned i = 0; i < nr_frames; ++i)
+				builder.map_color_to_depth(depth_frame, color_frame, warped_color_frame);
+		}
+		std::cout << "  point_cloud_builder " << nr_threads << " threads: points " << nr_frames / t_points << ", dense points "
+			<< nr_frames / t_dense << ", points with colors " << nr_frames / t_color << ", warped color " << nr_frames / t_warp << " frames/s" << std::endl;
+	}
+
+	// decode and convert depth frames of a recording without device or rendering context
+	const std::string file_name = "test_point_cloud_builder.rec";
+	rgbd::recording_writer writer;
+	if (!writer.open(file_name))
+		return false;
+	for (unsigned i = 0; i < nr_frames; ++i) {
+		construct_depth_frame(depth_frame, 640, 576, i);
+		writer.write_frame(rgbd::IS_DEPTH, depth_frame);
+	}
+	writer.close();
+	rgbd::recording_reader reader;
+	if (reader.open(file_name)) {
+		builder.set_nr_threads(0);
+		double t = 0;
+		size_t nr_points = 0;
+		{
+			cgv::utils::stopwatch s(&t, false);
+			for (size_t i = 0; i < reader.get_nr_frames(rgbd::IS_DEPTH); ++i)
+				if (reader.read_frame(rgbd::IS_DEPTH, i, depth_frame))
+					nr_points += builder.construct_point_cloud(depth_frame, P);
+		}
+		std::cout << "  replay from recording: " << reader.get_nr_frames(rgbd::IS_DEPTH) / t << " frames/s with "
+			<< nr_points / reader.get_nr_frames(rgbd::IS_DEPTH) << " points per frame" << std::endl;
+		reader.close();
+	}
+	cgv::utils::file::remove(file_name);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_point_cloud_builder_reg("rgbd::point_cloud_builder", test_point_cloud_builder);
+extern CGV_API test_registration test_point_cloud_builder_throughput_reg("rgbd::point_cloud_builder throughput", test_point_cloud_builder_throughput);
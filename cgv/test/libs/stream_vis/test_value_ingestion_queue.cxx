@@ -0,0 +1,164 @@
+#include <cgv/base/register.h>
+#include <stream_vis/value_ingestion_queue.h>
+#include <cgv/utils/stopwatch.h>
+#include <iostream>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <cstring>
+
+using namespace cgv::base;
+using namespace stream_vis;
+
+/// fill a sample of a producer with its sequence number in the first and the producer index in the second value
+void construct_sample(indexed_value* values, uint16_t producer, uint64_t sequence)
+{
+	values[0].index = 0;
+	std::memcpy(values[0].value, &sequence, 8);
+	values[1].index = 1;
+	uint64_t p = producer;
+	std::memcpy(values[1].value, &p, 8);
+}
+
+bool test_value_ingestion_queue()
+{
+	// single threaded ordering, capacity and drop counting
+	value_ingestion_queue queue(5, 2);
+	TEST_ASSERT_EQ(queue.get_capacity(), size_t(8))
+	TEST_ASSERT(queue.empty())
+	indexed_value values[3];
+	for (uint64_t i = 0; i < 10; ++i) {
+		construct_sample(values, 0, i);
+		TEST_ASSERT_EQ(queue.push(2, values, double(i)), i < 8)
+	}
+	TEST_ASSERT_EQ(queue.get_nr_dropped_samples(), size_t(2))
+	TEST_ASSERT(!queue.push(3, values, 0.0))
+	TEST_ASSERT_EQ(queue.get_nr_dropped_samples(), size_t(3))
+	TEST_ASSERT_EQ(queue.get_nr_queued_samples(), size_t(8))
+	uint64_t expected = 0;
+	TEST_ASSERT_EQ(queue.consume([&](const value_ingestion_queue::sample& s) {
+		uint64_t seq;
+		std::memcpy(&seq, s.values[0].value, 8);
+		TEST_ASSERT_EQ(s.num_values, 2)
+		TEST_ASSERT_EQ(seq, expected)
+		TEST_ASSERT_EQ(s.timestamp, double(expected))
+		++expected;
+	}, 5), size_t(5))
+	// freed slots are reused while the remaining samples stay in order
+	for (uint64_t i = 10; i < 15; ++i) {
+		construct_sample(values, 0, i);
+		TEST_ASSERT(queue.push(2, values, double(i)))
+	}
+	std::vector<uint64_t> sequence;
+	queue.consume([&](const value_ingestion_queue::sample& s) {
+		uint64_t seq;
+		std::memcpy(&seq, s.values[0].value, 8);
+		sequence.push_back(seq);
+	});
+	TEST_ASSERT(sequence == std::vector<uint64_t>({ 5, 6, 7, 10, 11, 12, 13, 14 }))
+	TEST_ASSERT(queue.empty())
+
+	// concurrent producers with a consumer running at the same time lose no published samples and keep per producer order
+	const unsigned nr_producers = 4;
+	const uint64_t nr_samples_per_producer = 20000;
+	value_ingestion_queue mpsc_queue(256, 2);
+	std::atomic<unsigned> nr_finished(0);
+	std::vector<uint64_t> nr_pushed(nr_producers, 0);
+	std::vector<std::thread> producers;
+	for (unsigned p = 0; p < nr_producers; ++p)
+		producers.push_back(std::thread([&, p]() {
+			indexed_value v[2];
+			for (uint64_t i = 0; i < nr_samples_per_producer; ++i) {
+				construct_sample(v, uint16_t(p), nr_pushed[p]);
+				if (mpsc_queue.push(2, v, 0.0))
+					++nr_pushed[p];
+				else
+					std::this_thread::yield();
+			}
+			++nr_finished;
+		}));
+	std::vector<uint64_t> next(nr_producers, 0);
+	size_t nr_consumed = 0;
+	bool in_order = true;
+	auto check = [&](const value_ingestion_queue::sample& s) {
+		uint64_t seq, p;
+		std::memcpy(&seq, s.values[0].value, 8);
+		std::memcpy(&p, s.values[1].value, 8);
+		if (p >= nr_producers || seq != next[p])
+			in_order = false;
+		else
+			++next[p];
+		++nr_consumed;
+	};
+	while (nr_finished < nr_producers)
+		if (mpsc_queue.consume(check, 64) == 0)
+			std::this_thread::yield();
+	for (auto& t : producers)
+		t.join();
+	mpsc_queue.consume(check);
+	TEST_ASSERT(in_order)
+	TEST_ASSERT(next == nr_pushed)
+	TEST_ASSERT_EQ(nr_consumed + mpsc_queue.get_nr_dropped_samples(), nr_producers * nr_samples_per_producer)
+	return true;
+}
+
+/// report samples per second handed over from several producers to float time series without rendering context
+bool test_value_ingestion_queue_throughput()
+{
+	const uint16_t nr_values = 8;
+	const size_t nr_samples_per_producer = 200000;
+	std::cout << "\n";
+	unsigned max_nr_producers = std::max(std::thread::hardware_concurrency(), 2u);
+	for (unsigned nr_producers = 1; nr_producers <= max_nr_producers; nr_producers *= 2) {
+		value_ingestion_queue queue(8192, nr_values);
+		std::vector<float_time_series*> series;
+		for (uint16_t i = 0; i < nr_values; ++i) {
+			series.push_back(new float_time_series(i));
+			series.back()->set_ringbuffer_size(4096);
+		}
+		std::vector<uint16_t> val_idx_from_ts_idx(nr_values);
+		for (uint16_t i = 0; i < nr_values; ++i)
+			val_idx_from_ts_idx[i] = i;
+		std::atomic<unsigned> nr_finished(0);
+		size_t nr_consumed = 0;
+		double t = 0;
+		{
+			cgv::utils::stopwatch s(&t, false);
+			std::vector<std::thread> producers;
+			for (unsigned p = 0; p < nr_producers; ++p)
+				producers.push_back(std::thread([&, p]() {
+					indexed_value v[nr_values];
+					for (size_t i = 0; i < nr_samples_per_producer; ++i) {
+						for (uint16_t j = 0; j < nr_values; ++j) {
+							double x = double(i + j + p);
+							v[j].index = j;
+							std::memcpy(v[j].value, &x, 8);
+						}
+						queue.push(nr_values, v, double(i));
+					}
+					++nr_finished;
+				}));
+			auto handoff = [&](const value_ingestion_queue::sample& smp) {
+				for (auto* ts : series)
+					ts->extract_from_values(smp.num_values, smp.values, smp.timestamp, &val_idx_from_ts_idx.front());
+				++nr_consumed;
+			};
+			while (nr_finished < nr_producers)
+				if (queue.consume(handoff, 1024) == 0)
+					std::this_thread::yield();
+			for (auto& th : producers)
+				th.join();
+			queue.consume(handoff);
+		}
+		std::cout << "  " << nr_producers << " producers: " << (nr_producers * nr_samples_per_producer) / t << " samples/s pushed, "
+			<< nr_consumed / t << " samples/s handed over, " << queue.get_nr_dropped_samples() << " dropped" << std::endl;
+		for (auto* ts : series)
+			delete ts;
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_value_ingestion_queue_reg("stream_vis::value_ingestion_queue", test_value_ingestion_queue);
+extern CGV_API test_registration test_value_ingestion_queue_throughput_reg("stream_vis::value_ingestion_queue throughput", test_value_ingestion_queue_throughput);
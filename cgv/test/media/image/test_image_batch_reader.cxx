@@ -0,0 +1,117 @@
+#include <cgv/base/register.h>
+#include <cgv/media/image/image_batch_reader.h>
+#include <cgv/media/image/image_reader.h>
+#include <cgv/media/image/image_writer.h>
+#include <cgv/utils/dir.h>
+#include <cgv/utils/file.h>
+#include <cgv/utils/stopwatch.h>
+#include <cgv/utils/convert_string.h>
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace cgv::base;
+using namespace cgv::data;
+using namespace cgv::media::image;
+
+/// write a numbered sequence of small constant bmp slices into a temporary directory and return their file names
+std::vector<std::string> write_test_slices(const std::string& dir_name, unsigned n)
+{
+	std::vector<std::string> file_names;
+	cgv::utils::dir::mkdir(dir_name);
+	data_format df("uint8[R,G,B]");
+	df.set_dimensions(64, 48);
+	data_view dv(&df);
+	for (unsigned i = 0; i < n; ++i) {
+		std::fill(dv.get_ptr<unsigned char>(), dv.get_ptr<unsigned char>() + df.get_nr_bytes(), (unsigned char)i);
+		std::string file_name = dir_name + "/slice_" + cgv::utils::to_string(i) + ".bmp";
+		image_writer iw(file_name);
+		if (iw.write_image(dv) && iw.close())
+			file_names.push_back(file_name);
+	}
+	return file_names;
+}
+
+bool test_image_batch_reader()
+{
+	std::vector<std::string> file_names = write_test_slices("test_image_batch_reader", 20);
+	TEST_ASSERT_EQ(file_names.size(), 20)
+	file_names.push_back("test_image_batch_reader/missing.bmp");
+
+	// decode into reader allocated views with a budget that only fits few images
+	image_batch_reader reader(4, 3 * 64 * 48 * 3);
+	std::vector<size_t> order;
+	bool content_ok = true;
+	size_t nr_read = reader.read_images(file_names, [&](size_t idx, bool success, const data_view& dv) {
+		order.push_back(idx);
+		if (success && dv.get_ptr<unsigned char>()[0] != (unsigned char)idx)
+			content_ok = false;
+	});
+	TEST_ASSERT_EQ(nr_read, 20)
+	TEST_ASSERT(content_ok)
+	TEST_ASSERT_EQ(order.size(), file_names.size())
+	for (size_t i = 0; i < order.size(); ++i)
+		TEST_ASSERT_EQ(order[i], i)
+
+	// decode into preallocated slices of one buffer
+	file_names.pop_back();
+	data_format volume_df("uint8[R,G,B]");
+	volume_df.set_dimensions(64, 48, file_names.size());
+	data_view volume_dv(&volume_df);
+	data_format slice_df("uint8[R,G,B]");
+	slice_df.set_dimensions(64, 48);
+	// data_view copies its data on copy construction, so construct the slice views in place
+	std::vector<data_view> slices;
+	slices.reserve(file_names.size());
+	for (size_t i = 0; i < file_names.size(); ++i)
+		slices.emplace_back(&slice_df, volume_dv.get_ptr<unsigned char>(i));
+	TEST_ASSERT_EQ(reader.read_images(file_names, image_batch_reader::callback_type(), &slices), file_names.size())
+	for (size_t i = 0; i < file_names.size(); ++i)
+		TEST_ASSERT_EQ(int(*volume_dv.get_ptr<unsigned char>(i)), int((unsigned char)i))
+
+	for (const auto& file_name : file_names)
+		cgv::utils::file::remove(file_name);
+	cgv::utils::dir::rmdir("test_image_batch_reader");
+	return true;
+}
+
+/// compare sequential and batch decoding of the png and jpg slices in the directory given by CGV_TEST_SLICE_DIR
+bool test_image_batch_reader_throughput()
+{
+	const char* dir_name = std::getenv("CGV_TEST_SLICE_DIR");
+	if (!dir_name) {
+		std::cout << " (set CGV_TEST_SLICE_DIR to a directory of png/jpg slices) ";
+		return true;
+	}
+	std::vector<std::string> file_names, jpg_file_names;
+	cgv::utils::dir::glob(dir_name, file_names, "*.png");
+	cgv::utils::dir::glob(dir_name, jpg_file_names, "*.jpg");
+	file_names.insert(file_names.end(), jpg_file_names.begin(), jpg_file_names.end());
+	if (file_names.empty())
+		return true;
+	size_t nr_bytes = 0;
+	double sequential_time = 0, batch_time = 0;
+	{
+		cgv::utils::stopwatch watch(&sequential_time, false);
+		for (const auto& file_name : file_names) {
+			data_format df;
+			data_view dv;
+			image_reader ir(df);
+			if (ir.read_image(file_name, dv))
+				nr_bytes += df.get_nr_bytes();
+		}
+	}
+	{
+		cgv::utils::stopwatch watch(&batch_time, false);
+		image_batch_reader reader;
+		reader.read_images(file_names, image_batch_reader::callback_type());
+	}
+	std::cout << "\n  " << file_names.size() << " files, sequential: " << nr_bytes / (1048576.0 * sequential_time)
+			  << " MB/s, batch: " << nr_bytes / (1048576.0 * batch_time) << " MB/s" << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_image_batch_reader_reg("cgv::media::image::image_batch_reader", test_image_batch_reader);
+extern CGV_API test_registration test_image_batch_reader_throughput_reg("cgv::media::image::image_batch_reader throughput", test_image_batch_reader_throughput);
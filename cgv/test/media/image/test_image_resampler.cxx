@@ -0,0 +1,71 @@
+#include <cgv/base/register.h>
+#include <cgv/media/image/image_resampler.h>
+#include <cgv/utils/stopwatch.h>
+#include <iostream>
+#include <cmath>
+
+using namespace cgv::base;
+using namespace cgv::data;
+using namespace cgv::media::image;
+
+bool test_image_resampler()
+{
+	const ResamplingFilter filters[] = { RF_BOX, RF_BILINEAR, RF_LANCZOS, RF_KAISER };
+	const char* formats[] = { "uint8[R,G,B,A]", "uint8[R,G,B]", "flt32[L]" };
+	for (const char* format : formats) {
+		data_format src_df(format);
+		src_df.set_dimensions(37, 23);
+		data_view src_dv(&src_df);
+		for (size_t i = 0; i < 37 * 23; ++i)
+			for (unsigned ci = 0; ci < src_df.get_nr_components(); ++ci)
+				src_df.set<float>(ci, src_dv.get_ptr<unsigned char>() + i * src_df.get_entry_size(), float(50 + 10 * ci));
+		for (ResamplingFilter filter : filters) {
+			// constant images need to stay constant under down- and upsampling
+			for (size_t s = 0; s < 2; ++s) {
+				data_format dst_df(format);
+				dst_df.set_dimensions(s == 0 ? 11 : 80, s == 0 ? 9 : 51);
+				data_view dst_dv(&dst_df);
+				TEST_ASSERT(resample_image(src_dv, dst_dv, filter, 3))
+				for (size_t i = 0; i < dst_df.get_width() * dst_df.get_height(); ++i)
+					for (unsigned ci = 0; ci < dst_df.get_nr_components(); ++ci)
+						TEST_ASSERT(std::abs(dst_df.get<float>(ci, dst_dv.get_ptr<unsigned char>() + i * dst_df.get_entry_size()) - float(50 + 10 * ci)) < 0.01f)
+			}
+		}
+	}
+	data_format packed_df("uint8[R:5,G:6,B:5]");
+	TEST_ASSERT(!is_resampling_supported(packed_df))
+	return true;
+}
+
+/// report the resampling throughput in mega pixels per second
+bool test_image_resampler_throughput()
+{
+	data_format src_df("uint8[R,G,B,A]");
+	src_df.set_dimensions(4096, 4096);
+	data_view src_dv(&src_df);
+	for (size_t i = 0; i < src_df.get_nr_bytes(); ++i)
+		src_dv.get_ptr<unsigned char>()[i] = (unsigned char)(i * 31);
+	data_format dst_df("uint8[R,G,B,A]");
+	dst_df.set_dimensions(2048, 2048);
+	data_view dst_dv(&dst_df);
+	const ResamplingFilter filters[] = { RF_BOX, RF_BILINEAR, RF_LANCZOS, RF_KAISER };
+	const char* names[] = { "box", "bilinear", "lanczos", "kaiser" };
+	for (unsigned fi = 0; fi < 4; ++fi) {
+		for (unsigned nr_threads : { 1u, 0u }) {
+			double time = 0;
+			{
+				cgv::utils::stopwatch watch(&time, false);
+				TEST_ASSERT(resample_image(src_dv, dst_dv, filters[fi], nr_threads))
+			}
+			std::cout << "\n  " << names[fi] << (nr_threads == 1 ? " 1 thread: " : " all threads: ")
+					  << 4096.0 * 4096.0 * 1e-6 / time << " MPix/s";
+		}
+	}
+	std::cout << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_image_resampler_reg("cgv::media::image::resample_image", test_image_resampler);
+extern CGV_API test_registration test_image_resampler_throughput_reg("cgv::media::image::resample_image throughput", test_image_resampler_throughput);
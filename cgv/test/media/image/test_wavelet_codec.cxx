@@ -0,0 +1,74 @@
+#include <cgv/base/register.h>
+#include <cgv/media/image/wavelet_codec.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace cgv::base;
+using namespace cgv::data;
+using namespace cgv::media::image;
+
+bool test_wavelet_codec_format(const char* format, size_t w, size_t h, size_t d, unsigned quantization)
+{
+	data_format df(format);
+	if (d > 1)
+		df.set_dimensions(w, h, d);
+	else
+		df.set_dimensions(w, h);
+	data_view dv(&df);
+	unsigned char* ptr = dv.get_ptr<unsigned char>();
+	for (size_t i = 0; i < df.get_nr_bytes(); ++i)
+		ptr[i] = (unsigned char)((i * 7 + (i / 97) * 13) % 251);
+
+	wavelet_codec_config config;
+	config.tile_size = 16;
+	config.nr_levels = 3;
+	config.quantization = quantization;
+	wavelet_codec codec(config);
+	std::vector<char> stream;
+	TEST_ASSERT(codec.encode(dv, stream))
+
+	data_format decoded_df;
+	data_view decoded_dv;
+	TEST_ASSERT(codec.decode(&stream.front(), stream.size(), decoded_df, decoded_dv))
+	TEST_ASSERT(decoded_df == df)
+	if (quantization == 1) {
+		TEST_ASSERT(std::memcmp(decoded_dv.get_ptr<unsigned char>(), ptr, df.get_nr_bytes()) == 0)
+	}
+	else {
+		// detail coefficients are off by at most quantization/2, which the inverse lifting of each level amplifies by at most 3/2 per axis
+		int nr_dimensions = d > 1 ? 3 : 2;
+		int max_error = int(config.nr_levels) * nr_dimensions * 3 * int(quantization) / 4;
+		const unsigned char* decoded_ptr = decoded_dv.get_ptr<unsigned char>();
+		int error = 0;
+		for (size_t i = 0; i < df.get_nr_bytes(); ++i)
+			error = std::max(error, std::abs(int(decoded_ptr[i]) - int(ptr[i])));
+		TEST_ASSERT(error > 0)
+		TEST_ASSERT(error <= max_error)
+	}
+
+	// progressive decoding only needs a prefix of the stream
+	wavelet_stream_info info;
+	TEST_ASSERT(codec.read_info(&stream.front(), stream.size(), info))
+	for (unsigned l = 1; l <= info.nr_levels; ++l) {
+		size_t prefix_size = info.get_prefix_size(l);
+		TEST_ASSERT(prefix_size < stream.size())
+		TEST_ASSERT(codec.decode(&stream.front(), prefix_size, decoded_df, decoded_dv, l))
+		TEST_ASSERT_EQ(decoded_df.get_width(), info.get_resolution(0, l))
+		TEST_ASSERT_EQ(decoded_df.get_height(), info.get_resolution(1, l))
+	}
+	return true;
+}
+
+bool test_wavelet_codec()
+{
+	TEST_ASSERT(test_wavelet_codec_format("uint8[R,G,B]", 45, 31, 1, 1))
+	TEST_ASSERT(test_wavelet_codec_format("uint16[L]", 64, 17, 1, 1))
+	TEST_ASSERT(test_wavelet_codec_format("int8[L]", 20, 19, 18, 1))
+	TEST_ASSERT(test_wavelet_codec_format("uint8[L,A]", 40, 40, 1, 4))
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_wavelet_codec_reg("cgv::media::image::wavelet_codec", test_wavelet_codec);
@@ -0,0 +1,68 @@
+#include <cgv/base/register.h>
+#include <cgv/media/mesh/marching_cubes.h>
+#include <iostream>
+#include <cmath>
+
+using namespace cgv::base;
+using namespace cgv::media::mesh;
+using cgv::math::fvec;
+using cgv::media::axis_aligned_box;
+
+/// signed distance to a sphere
+struct sphere_func : public cgv::math::v3_func<double, double>
+{
+	double radius;
+	sphere_func(double _radius) : radius(_radius) {}
+	double evaluate(const pnt_type& p) const { return std::sqrt(p(0) * p(0) + p(1) * p(1) + p(2) * p(2)) - radius; }
+};
+
+/// count vertices and triangles and track the largest deviation of vertices from the sphere
+struct counting_handler : public streaming_mesh_callback_handler
+{
+	streaming_mesh<double>* sm_ptr = 0;
+	double radius = 1, max_error = 0;
+	unsigned nr_vertices = 0, nr_triangles = 0;
+	void new_vertex(unsigned int vi)
+	{
+		max_error = std::max(max_error, std::abs(length(sm_ptr->vertex_location(vi)) - radius));
+		++nr_vertices;
+	}
+	void new_polygon(const std::vector<unsigned int>&) { ++nr_triangles; }
+	void before_drop_vertex(unsigned int) {}
+};
+
+bool test_marching_cubes()
+{
+	sphere_func f(0.8);
+	counting_handler h;
+	h.radius = 0.8;
+	marching_cubes<double, double> mc(f, &h);
+	h.sm_ptr = &mc;
+	mc.extract(0.0, axis_aligned_box<double, 3>(fvec<double, 3>(-1.0), fvec<double, 3>(1.0)), 41, 41, 41);
+	TEST_ASSERT(h.nr_triangles > 1000)
+	TEST_ASSERT_EQ(h.nr_vertices, mc.get_nr_vertices())
+	// closed triangle mesh of genus 0
+	TEST_ASSERT_EQ(2 * int(h.nr_vertices) - int(h.nr_triangles), 4)
+	TEST_ASSERT(h.max_error < 0.01)
+	return true;
+}
+
+/// extract the iso surface of a sphere on a 128^3 grid
+bool benchmark_marching_cubes(benchmark_state& state)
+{
+	const unsigned res = 128;
+	sphere_func f(0.8);
+	counting_handler h;
+	marching_cubes<double, double> mc(f, &h);
+	h.sm_ptr = &mc;
+	state.set_work(double(res) * res * res, "cells");
+	state.measure([&]() {
+		mc.extract(0.0, axis_aligned_box<double, 3>(fvec<double, 3>(-1.0), fvec<double, 3>(1.0)), res, res, res);
+	});
+	return h.nr_triangles > 0;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_marching_cubes_reg("marching_cubes", test_marching_cubes);
+extern CGV_API benchmark_registration benchmark_marching_cubes_reg("marching_cubes sphere 128^3", benchmark_marching_cubes);
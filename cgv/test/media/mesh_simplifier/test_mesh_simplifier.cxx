@@ -0,0 +1,172 @@
+#include <cgv/base/register.h>
+#include <cgv/media/mesh/mesh_simplifier.h>
+#include <cgv/utils/stopwatch.h>
+#include <iostream>
+#include <cmath>
+
+using namespace cgv::base;
+using namespace cgv::media::mesh;
+
+typedef simple_mesh<float> mesh_type;
+typedef mesh_type::vec3_type vec3;
+
+/// construct a longitude latitude sphere with unit radius and per vertex normals, where poles are single vertices
+void construct_sphere(mesh_type& M, unsigned nr_rings, unsigned nr_segments)
+{
+	M.clear();
+	const float pi = 3.14159265358979f;
+	M.new_position(vec3(0, 0, 1));
+	for (unsigned i = 1; i < nr_rings; ++i) {
+		float theta = pi * i / nr_rings;
+		for (unsigned j = 0; j < nr_segments; ++j) {
+			float phi = 2 * pi * j / nr_segments;
+			M.new_position(vec3(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)));
+		}
+	}
+	M.new_position(vec3(0, 0, -1));
+	for (unsigned pi = 0; pi < M.get_nr_positions(); ++pi)
+		M.new_normal(M.position(pi));
+	auto ring_vertex = [&](unsigned i, unsigned j) { return 1 + (i - 1) * nr_segments + j % nr_segments; };
+	auto add_triangle = [&](unsigned a, unsigned b, unsigned c) {
+		M.start_face();
+		M.new_corner(a, a);
+		M.new_corner(b, b);
+		M.new_corner(c, c);
+	};
+	unsigned south = M.get_nr_positions() - 1;
+	for (unsigned j = 0; j < nr_segments; ++j) {
+		add_triangle(0, ring_vertex(1, j), ring_vertex(1, j + 1));
+		for (unsigned i = 1; i + 1 < nr_rings; ++i) {
+			add_triangle(ring_vertex(i, j), ring_vertex(i + 1, j), ring_vertex(i + 1, j + 1));
+			add_triangle(ring_vertex(i, j), ring_vertex(i + 1, j + 1), ring_vertex(i, j + 1));
+		}
+		add_triangle(ring_vertex(nr_rings - 1, j), south, ring_vertex(nr_rings - 1, j + 1));
+	}
+}
+
+/// construct a torus around the z-axis from a regular grid of triangles with per vertex normals
+void construct_torus(mesh_type& M, unsigned nr_rings, unsigned nr_segments, float R = 1.0f, float r = 0.3f)
+{
+	M.clear();
+	const float pi = 3.14159265358979f;
+	for (unsigned i = 0; i < nr_rings; ++i) {
+		float phi = 2 * pi * i / nr_rings;
+		for (unsigned j = 0; j < nr_segments; ++j) {
+			float theta = 2 * pi * j / nr_segments;
+			vec3 nml(std::cos(theta) * std::cos(phi), std::cos(theta) * std::sin(phi), std::sin(theta));
+			M.new_position(vec3(R * std::cos(phi), R * std::sin(phi), 0.0f) + r * nml);
+			M.new_normal(nml);
+		}
+	}
+	auto vertex = [&](unsigned i, unsigned j) { return (i % nr_rings) * nr_segments + j % nr_segments; };
+	for (unsigned i = 0; i < nr_rings; ++i)
+		for (unsigned j = 0; j < nr_segments; ++j) {
+			unsigned a = vertex(i, j), b = vertex(i + 1, j), c = vertex(i + 1, j + 1), d = vertex(i, j + 1);
+			M.start_face();
+			M.new_corner(a, a);
+			M.new_corner(b, b);
+			M.new_corner(c, c);
+			M.start_face();
+			M.new_corner(a, a);
+			M.new_corner(c, c);
+			M.new_corner(d, d);
+		}
+}
+
+bool test_mesh_simplifier()
+{
+	for (unsigned nr_threads : { 1u, 4u }) {
+		// closed sphere stays a closed manifold close to the unit sphere
+		mesh_type M;
+		construct_sphere(M, 64, 128);
+		simplification_parameters params;
+		params.target_nr_faces = 1000;
+		params.nr_threads = nr_threads;
+		mesh_simplifier<float> simplifier(params);
+		TEST_ASSERT(simplifier.simplify(M))
+		TEST_ASSERT(M.get_nr_faces() <= 1000)
+		TEST_ASSERT(M.get_nr_faces() > 900)
+		TEST_ASSERT_EQ(simplifier.get_statistics().nr_triangles_after, M.get_nr_faces())
+		std::vector<mesh_type::idx_type> inv, unmatched, non_manifold;
+		M.compute_inv(inv, false, 0, 0, 0, &unmatched, &non_manifold);
+		TEST_ASSERT(unmatched.empty())
+		TEST_ASSERT(non_manifold.empty())
+		TEST_ASSERT_EQ(M.get_nr_normals(), M.get_nr_positions())
+		for (mesh_type::idx_type pi = 0; pi < M.get_nr_positions(); ++pi) {
+			TEST_ASSERT(std::abs(M.position(pi).length() - 1.0f) < 0.05f)
+			TEST_ASSERT(dot(M.normal(pi), M.position(pi)) > 0.9f)
+		}
+		// error threshold stops before the target is reached
+		construct_sphere(M, 64, 128);
+		simplifier.ref_parameters().target_nr_faces = 0;
+		simplifier.ref_parameters().max_error = 0.002;
+		TEST_ASSERT(simplifier.simplify(M))
+		TEST_ASSERT(M.get_nr_faces() > 100)
+		TEST_ASSERT(M.get_nr_faces() < 64 * 128 * 2)
+
+		// open grid keeps its boundary on the unit square and colors are carried along
+		M.clear();
+		const unsigned n = 50;
+		M.ensure_colors(cgv::media::CT_RGBA8, (n + 1) * (n + 1));
+		for (unsigned y = 0; y <= n; ++y)
+			for (unsigned x = 0; x <= n; ++x) {
+				M.set_color(M.new_position(vec3(float(x) / n, float(y) / n, 0.02f * std::sin(0.3f * x) * std::sin(0.2f * y))),
+							cgv::rgba(float(x) / n, 0.5f, 0.5f, 1.0f));
+			}
+		for (unsigned y = 0; y < n; ++y)
+			for (unsigned x = 0; x < n; ++x) {
+				M.start_face();
+				M.new_corner(y * (n + 1) + x);
+				M.new_corner(y * (n + 1) + x + 1);
+				M.new_corner((y + 1) * (n + 1) + x + 1);
+				M.new_corner((y + 1) * (n + 1) + x);
+			}
+		params.target_nr_faces = 400;
+		mesh_simplifier<float> grid_simplifier(params);
+		TEST_ASSERT(grid_simplifier.simplify(M))
+		TEST_ASSERT(M.get_nr_faces() <= 400)
+		TEST_ASSERT_EQ(M.get_nr_colors(), M.get_nr_positions())
+		for (mesh_type::idx_type pi = 0; pi < M.get_nr_positions(); ++pi) {
+			cgv::rgba col;
+			M.put_color(pi, col);
+			TEST_ASSERT(std::abs(col[0] - M.position(pi)[0]) < 0.05f)
+		}
+		M.compute_inv(inv, false, 0, 0, 0, &unmatched, &non_manifold);
+		TEST_ASSERT(non_manifold.empty())
+		for (auto ci : unmatched) {
+			const vec3& p = M.position(M.c2p(ci));
+			TEST_ASSERT(std::min(std::min(p[0], 1 - p[0]), std::min(p[1], 1 - p[1])) < 1e-3f)
+		}
+	}
+	return true;
+}
+
+/// report simplification throughput of a torus with two million triangles
+bool test_mesh_simplifier_throughput()
+{
+	for (unsigned nr_threads : { 1u, 0u }) {
+		mesh_type M;
+		construct_torus(M, 2000, 500);
+		size_t nr_triangles = M.get_nr_faces();
+		simplification_parameters params;
+		params.target_nr_faces = nr_triangles / 100;
+		params.nr_threads = nr_threads;
+		mesh_simplifier<float> simplifier(params);
+		double time = 0;
+		{
+			cgv::utils::stopwatch watch(&time, false);
+			TEST_ASSERT(simplifier.simplify(M))
+		}
+		const simplification_statistics& stats = simplifier.get_statistics();
+		std::cout << "\n  " << (nr_threads == 1 ? "1 thread: " : "all threads: ") << nr_triangles << " -> " << M.get_nr_faces()
+				  << " triangles in " << time << " s, " << nr_triangles * 1e-6 / time << " MTri/s ("
+				  << stats.nr_parallel_collapses << " parallel, " << stats.nr_sequential_collapses << " sequential collapses)";
+	}
+	std::cout << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_mesh_simplifier_reg("cgv::media::mesh::mesh_simplifier", test_mesh_simplifier);
+extern CGV_API test_registration test_mesh_simplifier_throughput_reg("cgv::media::mesh::mesh_simplifier throughput", test_mesh_simplifier_throughput);
@@ -0,0 +1,218 @@
+#include <cgv/base/register.h>
+#include <cgv/media/mesh/simple_mesh.h>
+#include <cgv/utils/stopwatch.h>
+#include <iostream>
+#include <cmath>
+#include <map>
+
+using namespace cgv::base;
+using namespace cgv::media::mesh;
+
+typedef simple_mesh<float> mesh_type;
+typedef mesh_type::idx_type idx_type;
+typedef mesh_type::vec3_type vec3;
+
+/// construct a torus from a regular grid of triangles, where an open torus leaves out the last ring of quads
+void construct_grid_torus(mesh_type& M, unsigned nr_rings, unsigned nr_segments, bool closed = true)
+{
+	M.clear();
+	const float pi = 3.14159265358979f;
+	for (unsigned i = 0; i < nr_rings; ++i)
+		for (unsigned j = 0; j < nr_segments; ++j) {
+			float phi = 2 * pi * i / nr_rings, theta = 2 * pi * j / nr_segments;
+			vec3 nml(std::cos(theta) * std::cos(phi), std::cos(theta) * std::sin(phi), std::sin(theta));
+			M.new_position(vec3(std::cos(phi), std::sin(phi), 0.0f) + 0.3f * nml);
+		}
+	auto vertex = [&](unsigned i, unsigned j) { return (i % nr_rings) * nr_segments + j % nr_segments; };
+	for (unsigned i = 0; i + (closed ? 0 : 1) < nr_rings; ++i)
+		for (unsigned j = 0; j < nr_segments; ++j) {
+			unsigned a = vertex(i, j), b = vertex(i + 1, j), c = vertex(i + 1, j + 1), d = vertex(i, j + 1);
+			M.start_face();
+			M.new_corner(a);
+			M.new_corner(b);
+			M.new_corner(c);
+			M.start_face();
+			M.new_corner(a);
+			M.new_corner(c);
+			M.new_corner(d);
+		}
+}
+
+/// check corner table against a map based matching of half-edges
+bool check_corner_table(const mesh_type& M, const mesh_type::corner_table& T)
+{
+	std::map<std::pair<idx_type, idx_type>, std::vector<idx_type>> edges;
+	for (idx_type fi = 0; fi < M.get_nr_faces(); ++fi)
+		for (idx_type ci = M.begin_corner(fi); ci < M.end_corner(fi); ++ci) {
+			idx_type cj = ci + 1 == M.end_corner(fi) ? M.begin_corner(fi) : ci + 1;
+			if (T.next[ci] != cj || T.prev[cj] != ci || T.c2f[ci] != fi)
+				return false;
+			idx_type pi = M.c2p(ci), pj = M.c2p(cj);
+			edges[std::make_pair(std::min(pi, pj), std::max(pi, pj))].push_back(ci);
+		}
+	size_t nr_edges = 0;
+	for (const auto& e : edges) {
+		const auto& C = e.second;
+		if (C.size() == 2) {
+			if (T.inv[C[0]] != C[1] || T.inv[C[1]] != C[0] || T.c2e[C[0]] != T.c2e[C[1]] || T.e2c[T.c2e[C[0]]] != std::min(C[0], C[1]))
+				return false;
+			++nr_edges;
+		}
+		else {
+			for (idx_type ci : C)
+				if (!T.is_boundary(ci) || T.e2c[T.c2e[ci]] != ci)
+					return false;
+			nr_edges += C.size();
+		}
+	}
+	if (T.get_nr_edges() != nr_edges)
+		return false;
+	// incident corners of positions
+	for (idx_type pi = 0; pi < M.get_nr_positions(); ++pi)
+		for (const idx_type* ci = T.begin_vertex_corners(pi); ci != T.end_vertex_corners(pi); ++ci)
+			if (M.c2p(*ci) != pi || (ci > T.begin_vertex_corners(pi) && ci[-1] >= *ci))
+				return false;
+	return T.v2c.size() == M.get_nr_corners();
+}
+
+/// count corners visited when rotating around the position of corner c0 in both directions
+idx_type count_one_ring(const mesh_type::corner_table& T, idx_type c0)
+{
+	idx_type n = 1, ci = c0;
+	while ((ci = T.next_around_vertex(ci)) != idx_type(-1) && ci != c0)
+		++n;
+	if (ci == c0)
+		return n;
+	ci = c0;
+	while ((ci = T.prev_around_vertex(ci)) != idx_type(-1))
+		++n;
+	return n;
+}
+
+bool test_corner_table()
+{
+	// closed torus
+	mesh_type M;
+	construct_grid_torus(M, 20, 12);
+	TEST_ASSERT(!M.has_corner_table())
+	const mesh_type::corner_table& T = M.get_corner_table();
+	TEST_ASSERT(M.has_corner_table())
+	TEST_ASSERT(check_corner_table(M, T))
+	TEST_ASSERT_EQ(T.nr_manifold_edges, M.get_nr_corners() / 2)
+	TEST_ASSERT_EQ(int(M.get_nr_positions()) - int(T.get_nr_edges()) + int(M.get_nr_faces()), 0)
+	for (idx_type pi = 0; pi < M.get_nr_positions(); ++pi) {
+		TEST_ASSERT_EQ(T.get_nr_vertex_corners(pi), 6)
+		TEST_ASSERT_EQ(count_one_ring(T, T.p2c[pi]), 6)
+	}
+
+	// edits invalidate the table
+	M.start_face();
+	TEST_ASSERT(!M.has_corner_table())
+	construct_grid_torus(M, 20, 12, false);
+	const mesh_type::corner_table& T_open = M.get_corner_table();
+	TEST_ASSERT(check_corner_table(M, T_open))
+	idx_type nr_boundary = 0;
+	for (idx_type ci = 0; ci < M.get_nr_corners(); ++ci)
+		if (T_open.is_boundary(ci))
+			++nr_boundary;
+	TEST_ASSERT_EQ(nr_boundary, 24)
+	// one-ring traversal from p2c covers all corners of boundary vertices
+	for (idx_type pi = 0; pi < M.get_nr_positions(); ++pi)
+		TEST_ASSERT_EQ(count_one_ring(T_open, T_open.p2c[pi]), T_open.get_nr_vertex_corners(pi))
+	TEST_ASSERT(T_open.is_boundary(T_open.p2c[0]))
+
+	// compute_inv agrees with the corner table and reports unmatched and non-manifold edges
+	std::vector<idx_type> inv, p2c, unmatched, non_manifold;
+	TEST_ASSERT_EQ(M.compute_inv(inv, false, &p2c), T_open.nr_manifold_edges)
+	TEST_ASSERT(inv == T_open.inv && p2c == T_open.p2c)
+	// third triangle at the interior edge between positions 12 and 25
+	M.start_face();
+	M.new_corner(12);
+	M.new_corner(25);
+	M.new_corner(100);
+	M.compute_inv(inv, true, 0, 0, 0, &unmatched, &non_manifold);
+	TEST_ASSERT(check_corner_table(M, M.get_corner_table()))
+	TEST_ASSERT_EQ(unmatched.size(), 24 + 2)
+	TEST_ASSERT_EQ(non_manifold.size(), 1)
+	idx_type c0 = non_manifold.front(), c1 = inv[c0], c2 = inv[c1];
+	TEST_ASSERT(c0 != c1 && c1 != c2 && inv[c2] == c0)
+
+	// Conway operators on the cube
+	const char* notations[] = { "C", "aC", "dC", "tC", "jC", "sC", "gC" };
+	idx_type nr_vertices[] = { 8, 12, 6, 24, 14, 24, 38 };
+	idx_type nr_faces[] = { 6, 14, 8, 14, 12, 38, 24 };
+	for (unsigned i = 0; i < 7; ++i) {
+		mesh_type C(notations[i]);
+		TEST_ASSERT_EQ(C.get_nr_positions(), nr_vertices[i])
+		TEST_ASSERT_EQ(C.get_nr_faces(), nr_faces[i])
+		const mesh_type::corner_table& T_C = C.get_corner_table();
+		TEST_ASSERT_EQ(T_C.nr_manifold_edges, C.get_nr_corners() / 2)
+	}
+
+	// parallel construction matches sequential one
+	construct_grid_torus(M, 300, 300, false);
+	mesh_type::corner_table T_seq = M.get_corner_table(1);
+	M.invalidate_corner_table();
+	const mesh_type::corner_table& T_par = M.get_corner_table(4);
+	TEST_ASSERT(T_par.inv == T_seq.inv && T_par.c2e == T_seq.c2e && T_par.e2c == T_seq.e2c && T_par.p2c == T_seq.p2c)
+	TEST_ASSERT(T_par.v2c == T_seq.v2c && T_par.v2c_begin == T_seq.v2c_begin && T_par.next == T_seq.next && T_par.c2f == T_seq.c2f)
+	TEST_ASSERT(check_corner_table(M, T_par))
+
+	// parallel vertex normals match sequential ones
+	construct_grid_torus(M, 300, 300);
+	M.compute_vertex_normals(false);
+	std::vector<vec3> normals(M.get_nr_positions());
+	for (idx_type pi = 0; pi < M.get_nr_positions(); ++pi)
+		normals[pi] = M.normal(pi);
+	M.compute_vertex_normals(true);
+	float max_deviation = 0;
+	for (idx_type pi = 0; pi < M.get_nr_positions(); ++pi)
+		max_deviation = std::max(max_deviation, (M.normal(pi) - normals[pi]).length());
+	TEST_ASSERT(max_deviation < 1e-5f)
+
+	// adding positions invalidates the table also if done through the reference to the positions
+	M.get_corner_table();
+	M.new_position(vec3(0.0f));
+	TEST_ASSERT(!M.has_corner_table())
+	TEST_ASSERT_EQ(M.get_corner_table().v2c_begin.size(), size_t(M.get_nr_positions()) + 1)
+	M.ref_positions().push_back(vec3(1.0f));
+	TEST_ASSERT_EQ(M.get_corner_table().v2c_begin.size(), size_t(M.get_nr_positions()) + 1)
+	M.compute_vertex_normals(true);
+
+	// moving a mesh moves its corner table
+	mesh_type M_moved(std::move(M));
+	TEST_ASSERT(M_moved.has_corner_table() && !M.has_corner_table())
+	return true;
+}
+
+/// measure building the corner table and algorithms that reuse the cached table
+bool test_corner_table_throughput()
+{
+	mesh_type M;
+	construct_grid_torus(M, 1000, 1000);
+	double build_time = 0, traversal_time = 0, normal_time = 0;
+	size_t sum = 0;
+	for (int i = 0; i < 3; ++i) {
+		M.invalidate_corner_table();
+		cgv::utils::stopwatch watch(&build_time, false);
+		sum += M.get_corner_table().inv[i];
+	}
+	{
+		cgv::utils::stopwatch watch(&traversal_time, false);
+		const mesh_type::corner_table& T = M.get_corner_table();
+		for (idx_type pi = 0; pi < M.get_nr_positions(); ++pi)
+			sum += count_one_ring(T, T.p2c[pi]);
+	}
+	{
+		cgv::utils::stopwatch watch(&normal_time, false);
+		M.compute_vertex_normals();
+	}
+	std::cout << "\n  " << M.get_nr_faces() << " triangles, corner table build: " << build_time / 3 << " s, one-ring traversal of all vertices: "
+			  << traversal_time << " s, vertex normals: " << normal_time << " s (" << sum % 2 << ")" << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_corner_table_reg("cgv::media::mesh::simple_mesh::corner_table", test_corner_table);
+extern CGV_API test_registration test_corner_table_throughput_reg("cgv::media::mesh::simple_mesh::corner_table throughput", test_corner_table_throughput);
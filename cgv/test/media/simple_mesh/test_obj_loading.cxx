@@ -0,0 +1,81 @@
+#include <cgv/base/register.h>
+#include <cgv/media/mesh/simple_mesh.h>
+#include <cgv/utils/file.h>
+#include <iostream>
+#include <cmath>
+
+using namespace cgv::base;
+using namespace cgv::media::mesh;
+
+typedef simple_mesh<float> mesh_type;
+typedef mesh_type::vec3_type vec3;
+
+/// construct a triangulated torus with normals and texture coordinates per vertex
+void construct_torus(mesh_type& M, unsigned nr_rings, unsigned nr_segments)
+{
+	M.clear();
+	const float pi = 3.14159265358979f;
+	for (unsigned i = 0; i < nr_rings; ++i)
+		for (unsigned j = 0; j < nr_segments; ++j) {
+			float phi = 2 * pi * i / nr_rings, theta = 2 * pi * j / nr_segments;
+			vec3 nml(std::cos(theta) * std::cos(phi), std::cos(theta) * std::sin(phi), std::sin(theta));
+			M.new_position(vec3(std::cos(phi), std::sin(phi), 0.0f) + 0.3f * nml);
+			M.new_normal(nml);
+			M.new_tex_coord(mesh_type::vec2_type(float(i) / nr_rings, float(j) / nr_segments));
+		}
+	auto vertex = [&](unsigned i, unsigned j) { return (i % nr_rings) * nr_segments + j % nr_segments; };
+	for (unsigned i = 0; i < nr_rings; ++i)
+		for (unsigned j = 0; j < nr_segments; ++j) {
+			unsigned a = vertex(i, j), b = vertex(i + 1, j), c = vertex(i + 1, j + 1), d = vertex(i, j + 1);
+			M.start_face();
+			M.new_corner(a, a, a);
+			M.new_corner(b, b, b);
+			M.new_corner(c, c, c);
+			M.start_face();
+			M.new_corner(a, a, a);
+			M.new_corner(c, c, c);
+			M.new_corner(d, d, d);
+		}
+}
+
+bool test_obj_loading()
+{
+	mesh_type M, N;
+	construct_torus(M, 40, 20);
+	const std::string file_name = "test_obj_loading.obj";
+	TEST_ASSERT(M.write(file_name))
+	TEST_ASSERT(N.read(file_name))
+	TEST_ASSERT_EQ(N.get_nr_positions(), M.get_nr_positions())
+	TEST_ASSERT_EQ(N.get_nr_faces(), M.get_nr_faces())
+	TEST_ASSERT_EQ(N.get_nr_corners(), M.get_nr_corners())
+	TEST_ASSERT(N.has_normals() && N.has_tex_coords())
+	float max_error = 0;
+	for (mesh_type::idx_type ci = 0; ci < N.get_nr_corners(); ++ci)
+		max_error = std::max(max_error, length(N.position(N.c2p(ci)) - M.position(M.c2p(ci))));
+	TEST_ASSERT(max_error < 1e-4f)
+	cgv::utils::file::remove(file_name);
+	return true;
+}
+
+/// read an obj file of a torus with 200000 triangles, positions, normals and texture coordinates
+bool benchmark_obj_loading(benchmark_state& state)
+{
+	mesh_type M;
+	construct_torus(M, 500, 200);
+	const std::string file_name = "benchmark_obj_loading.obj";
+	if (!M.write(file_name))
+		return false;
+	bool success = true;
+	state.set_work(double(M.get_nr_faces()), "triangles");
+	state.measure([&]() {
+		mesh_type N;
+		success = N.read(file_name) && N.get_nr_faces() == M.get_nr_faces() && success;
+	});
+	cgv::utils::file::remove(file_name);
+	return success;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_obj_loading_reg("simple_mesh obj loading", test_obj_loading);
+extern CGV_API benchmark_registration benchmark_obj_loading_reg("simple_mesh read obj", benchmark_obj_loading);
@@ -0,0 +1,264 @@
+#include <cgv/base/register.h>
+#include <cgv/utils/file.h>
+#include <plugins/co_web_epoll/epoll_web_server.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace cgv::base;
+
+/// web server answering with the name parameter, a file or an exception depending on the path
+struct echo_web_server : public cgv::os::web_server
+{
+	std::atomic<int> nr_requests;
+	echo_web_server(unsigned int port) : cgv::os::web_server(port), nr_requests(0) {}
+	void handle_request(cgv::os::http_request& request)
+	{
+		++nr_requests;
+		if (request.path == "/file") {
+			request.file_path = request.params["name"];
+			request.content_type = "application/octet-stream";
+		}
+		else if (request.path == "/throw")
+			throw std::runtime_error("handler failed");
+		else if (request.path == "/slow") {
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			request.answer = "slow";
+		}
+		else if (request.method == "POST")
+			request.answer = request.request.substr(request.request.find("\r\n\r\n") + 4);
+		else
+			request.answer = "hello " + request.params["name"];
+	}
+};
+
+/// runs the event loop of a web server in a separate thread
+struct epoll_web_server_runner
+{
+	epoll_web_server_provider provider;
+	echo_web_server server;
+	std::thread thread;
+	epoll_web_server_runner(unsigned int port, const epoll_web_server_configuration& configuration) : server(port)
+	{
+		provider.configuration = configuration;
+		thread = std::thread([this]() { provider.start_web_server(&server); });
+	}
+	~epoll_web_server_runner()
+	{
+		provider.stop_web_server(&server);
+		thread.join();
+	}
+};
+
+/// connect to the local port and retry until the server is listening
+int connect_web_client(unsigned int port)
+{
+	for (int i = 0; i < 200; ++i) {
+		int fd = socket(AF_INET, SOCK_STREAM, 0);
+		sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = htons(uint16_t(port));
+		if (connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0) {
+			int one = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+			return fd;
+		}
+		close(fd);
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	return -1;
+}
+
+bool send_web_request(int fd, const std::string& request)
+{
+	for (size_t offset = 0; offset < request.size(); ) {
+		ssize_t n = send(fd, request.data() + offset, request.size() - offset, MSG_NOSIGNAL);
+		if (n <= 0)
+			return false;
+		offset += size_t(n);
+	}
+	return true;
+}
+
+/// receive one response from the buffer and socket, return the status code and set body, or return 0 if the connection was closed
+int receive_web_response(int fd, std::string& buffer, std::string& body)
+{
+	char chunk[16384];
+	size_t header_end;
+	while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+		ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+		if (n <= 0)
+			return 0;
+		buffer.append(chunk, size_t(n));
+	}
+	size_t length_pos = buffer.find("Content-Length: ");
+	size_t content_length = length_pos < header_end ? size_t(atoll(buffer.c_str() + length_pos + 16)) : 0;
+	while (buffer.size() < header_end + 4 + content_length) {
+		ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+		if (n <= 0)
+			return 0;
+		buffer.append(chunk, size_t(n));
+	}
+	int status = atoi(buffer.c_str() + 9);
+	body = buffer.substr(header_end + 4, content_length);
+	buffer.erase(0, header_end + 4 + content_length);
+	return status;
+}
+
+bool test_epoll_web_server()
+{
+	const unsigned int port = 18247;
+	epoll_web_server_configuration configuration;
+	configuration.nr_workers = 2;
+	configuration.max_pending_requests = 1;
+	epoll_web_server_runner runner(port, configuration);
+	int fd = connect_web_client(port);
+	TEST_ASSERT(fd >= 0)
+	std::string buffer, body;
+
+	// several requests on a keep-alive connection including pipelined ones
+	TEST_ASSERT(send_web_request(fd, "GET /echo?name=a%20b HTTP/1.1\r\nHost: localhost\r\n\r\n"))
+	TEST_ASSERT_EQ(receive_web_response(fd, buffer, body), 202)
+	TEST_ASSERT_EQ(body, "hello a b")
+	TEST_ASSERT(send_web_request(fd, "GET /echo?name=1 HTTP/1.1\r\n\r\nGET /echo?name=2 HTTP/1.1\r\n\r\n"))
+	TEST_ASSERT_EQ(receive_web_response(fd, buffer, body), 202)
+	TEST_ASSERT_EQ(body, "hello 1")
+	TEST_ASSERT_EQ(receive_web_response(fd, buffer, body), 202)
+	TEST_ASSERT_EQ(body, "hello 2")
+
+	// request body arriving in several parts
+	TEST_ASSERT(send_web_request(fd, "POST /post HTTP/1.1\r\nContent-Length: 10\r\n\r\n01234"))
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	TEST_ASSERT(send_web_request(fd, "56789"))
+	TEST_ASSERT_EQ(receive_web_response(fd, buffer, body), 202)
+	TEST_ASSERT_EQ(body, "0123456789")
+
+	// file responses
+	std::filesystem::path temp_path = std::filesystem::temp_directory_path();
+	std::string file_name = (temp_path / "test_epoll_web_server.bin").string();
+	std::string content(300000, 0);
+	for (size_t i = 0; i < content.size(); ++i)
+		content[i] = char(i * 7);
+	TEST_ASSERT(cgv::utils::file::write(file_name, content.data(), content.size(), false))
+	TEST_ASSERT(send_web_request(fd, "GET /file?name=" + file_name + " HTTP/1.1\r\n\r\n"))
+	TEST_ASSERT_EQ(receive_web_response(fd, buffer, body), 202)
+	TEST_ASSERT(body == content)
+	TEST_ASSERT(send_web_request(fd, "GET /file?name=" + (temp_path / "does_not_exist").string() + " HTTP/1.1\r\n\r\n"))
+	TEST_ASSERT_EQ(receive_web_response(fd, buffer, body), 404)
+	cgv::utils::file::remove(file_name);
+
+	// exceptions of the handler
+	TEST_ASSERT(send_web_request(fd, "GET /throw HTTP/1.1\r\n\r\n"))
+	TEST_ASSERT_EQ(receive_web_response(fd, buffer, body), 500)
+
+	// server closes the connection if requested
+	TEST_ASSERT(send_web_request(fd, "GET /echo HTTP/1.1\r\nConnection: close\r\n\r\n"))
+	TEST_ASSERT_EQ(receive_web_response(fd, buffer, body), 202)
+	TEST_ASSERT_EQ(receive_web_response(fd, buffer, body), 0)
+	close(fd);
+
+	// requests received before the client shuts down its sending side are answered before the connection is closed
+	fd = connect_web_client(port);
+	// corking holds back the requests, such that they arrive together with the shutdown
+	int one = 1;
+	TEST_ASSERT(setsockopt(fd, IPPROTO_TCP, TCP_CORK, &one, sizeof(one)) == 0)
+	TEST_ASSERT(send_web_request(fd, "GET /slow HTTP/1.1\r\n\r\nGET /echo?name=last HTTP/1.1\r\n\r\n"))
+	TEST_ASSERT(shutdown(fd, SHUT_WR) == 0)
+	buffer.clear();
+	TEST_ASSERT_EQ(receive_web_response(fd, buffer, body), 202)
+	TEST_ASSERT_EQ(body, "slow")
+	TEST_ASSERT_EQ(receive_web_response(fd, buffer, body), 202)
+	TEST_ASSERT_EQ(body, "hello last")
+	TEST_ASSERT_EQ(receive_web_response(fd, buffer, body), 0)
+	close(fd);
+
+	// concurrent clients are served although only one request can be pending
+	std::atomic<int> nr_answered(0);
+	std::vector<std::thread> clients;
+	for (int t = 0; t < 4; ++t)
+		clients.push_back(std::thread([&]() {
+			int cfd = connect_web_client(port);
+			std::string cbuffer, cbody;
+			for (int i = 0; i < 50; ++i)
+				if (send_web_request(cfd, "GET /echo?name=c HTTP/1.1\r\n\r\n") &&
+					receive_web_response(cfd, cbuffer, cbody) == 202 && cbody == "hello c")
+					++nr_answered;
+			close(cfd);
+		}));
+	for (auto& t : clients)
+		t.join();
+	TEST_ASSERT_EQ(nr_answered.load(), 200)
+
+	// malformed requests
+	fd = connect_web_client(port);
+	TEST_ASSERT(send_web_request(fd, "GARBAGE\r\n\r\n"))
+	buffer.clear();
+	TEST_ASSERT_EQ(receive_web_response(fd, buffer, body), 400)
+	close(fd);
+	return true;
+}
+
+/// number of concurrent keep-alive connections of the load test
+const unsigned nr_web_clients = 8;
+/// number of requests sent over each connection per repetition
+const unsigned nr_web_requests_per_client = 500;
+
+/// load test of the epoll web server that reports requests per second and the 99th percentile of the latency
+bool benchmark_epoll_web_server(benchmark_state& state)
+{
+	const unsigned int port = 18248;
+	epoll_web_server_runner runner(port, epoll_web_server_configuration());
+	std::vector<int> fds;
+	for (unsigned c = 0; c < nr_web_clients; ++c) {
+		fds.push_back(connect_web_client(port));
+		if (fds.back() < 0)
+			return false;
+	}
+	std::vector<std::vector<double> > latencies(nr_web_clients);
+	std::atomic<unsigned> nr_failed(0);
+	state.set_work(double(nr_web_clients * nr_web_requests_per_client), "requests");
+	state.measure([&]() {
+		std::vector<std::thread> clients;
+		for (unsigned c = 0; c < nr_web_clients; ++c)
+			clients.push_back(std::thread([&, c]() {
+				std::string buffer, body;
+				for (unsigned i = 0; i < nr_web_requests_per_client; ++i) {
+					auto start = std::chrono::steady_clock::now();
+					if (!send_web_request(fds[c], "GET /echo?name=load HTTP/1.1\r\n\r\n") ||
+						receive_web_response(fds[c], buffer, body) != 202)
+						++nr_failed;
+					latencies[c].push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+				}
+			}));
+		for (auto& t : clients)
+			t.join();
+	});
+	for (int fd : fds)
+		close(fd);
+	std::vector<double> all;
+	for (const auto& l : latencies)
+		all.insert(all.end(), l.begin(), l.end());
+	std::sort(all.begin(), all.end());
+	std::cout << "epoll web server p99 latency: " << 1e6 * all[all.size() * 99 / 100] << " us" << std::endl;
+	return nr_failed == 0;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_epoll_web_server_reg("co_web_epoll::epoll_web_server_provider", test_epoll_web_server);
+extern CGV_API benchmark_registration benchmark_epoll_web_server_reg("epoll web server load test", benchmark_epoll_web_server);
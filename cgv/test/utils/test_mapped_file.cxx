@@ -0,0 +1,174 @@
+#include <cgv/base/register.h>
+#include <cgv/utils/mapped_file.h>
+#include <cgv/utils/chunked_file_reader.h>
+#include <cgv/utils/file.h>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace cgv::base;
+using namespace cgv::utils;
+
+/// return the name of a file in the temporary directory of the system
+std::string get_temp_file_name(const std::string& name)
+{
+	return (std::filesystem::temp_directory_path() / name).string();
+}
+
+bool test_mapped_file()
+{
+	std::string file_name = get_temp_file_name("test_mapped_file.bin");
+	std::vector<unsigned> values(300000);
+	for (size_t i = 0; i < values.size(); ++i)
+		values[i] = unsigned(i * 2654435761u);
+	FILE* fp = fopen(file_name.c_str(), "wb");
+	TEST_ASSERT(fp != 0)
+	TEST_ASSERT(file::write_string_bin("header", fp))
+	TEST_ASSERT_EQ(fwrite(&values[0], sizeof(unsigned), values.size(), fp), values.size())
+	fclose(fp);
+
+	// sequential reading
+	{
+		mapped_file mf(file_name);
+		TEST_ASSERT(mf.is_open())
+		TEST_ASSERT_EQ(mf.size(), 8 + values.size() * sizeof(unsigned))
+		mf.set_prefetch_window(64 * 1024);
+		TEST_ASSERT(mf.advise(mapped_file::SEQUENTIAL))
+		std::string header;
+		TEST_ASSERT(mf.read_string_bin(header))
+		TEST_ASSERT_EQ(header, "header")
+		std::vector<unsigned> read_values(values.size());
+		for (size_t i = 0; i < values.size(); i += 1000)
+			TEST_ASSERT(mf.read_array(&read_values[i], 1000))
+		TEST_ASSERT(read_values == values)
+		TEST_ASSERT_EQ(mf.position(), mf.size())
+		unsigned v;
+		TEST_ASSERT(!mf.read(v))
+		TEST_ASSERT(mf.seek(8 + 4 * sizeof(unsigned)))
+		TEST_ASSERT(mf.read(v))
+		TEST_ASSERT_EQ(v, values[4])
+		TEST_ASSERT(mf.get_ptr(mf.size()) == 0)
+		TEST_ASSERT(!mf.seek(mf.size() + 1))
+	}
+	TEST_ASSERT(!mapped_file(get_temp_file_name("does_not_exist/test_mapped_file.bin")).is_open())
+
+	// writing through the mapping
+	{
+		mapped_file mf;
+		TEST_ASSERT(mf.open(file_name, mapped_file::READ_WRITE, 16))
+		TEST_ASSERT_EQ(mf.size(), 16u)
+		for (int i = 0; i < 16; ++i)
+			mf.data()[i] = char('a' + i);
+		TEST_ASSERT(mf.flush())
+	}
+	std::string content;
+	TEST_ASSERT(file::read(file_name, content))
+	TEST_ASSERT_EQ(content, "abcdefghijklmnop")
+
+	// chunked reading of a part of the file with less chunks than needed
+	chunked_file_reader reader(5, 2);
+	TEST_ASSERT(reader.open(file_name, 1, 13))
+	std::string chunks;
+	const char* data;
+	size_t size;
+	unsigned nr_chunks = 0;
+	while (reader.next_chunk(data, size)) {
+		chunks += std::string(data, size);
+		++nr_chunks;
+	}
+	TEST_ASSERT_EQ(chunks, "bcdefghijklmn")
+	TEST_ASSERT_EQ(nr_chunks, 3u)
+	TEST_ASSERT(!reader.has_failed())
+	// closing before all chunks are consumed stops the reading thread
+	TEST_ASSERT(reader.open(file_name))
+	TEST_ASSERT(reader.next_chunk(data, size) && size == 5)
+	reader.close();
+	file::remove(file_name);
+	return true;
+}
+
+/// size of the file used to compare the reading methods
+const size_t benchmark_file_size = size_t(256) << 20;
+
+const std::string& get_benchmark_file_name()
+{
+	static std::string file_name;
+	if (file_name.empty()) {
+		file_name = get_temp_file_name("benchmark_mapped_file.bin");
+		if (file::size(file_name) != benchmark_file_size) {
+			std::vector<char> data(benchmark_file_size);
+			for (size_t i = 0; i < data.size(); ++i)
+				data[i] = char(i * 31);
+			file::write(file_name, data.data(), data.size(), false);
+		}
+	}
+	return file_name;
+}
+
+/// read file as done by binary loaders before with fread into the target array
+bool benchmark_fread(benchmark_state& state)
+{
+	std::vector<char> data(benchmark_file_size);
+	state.set_work(benchmark_file_size * 1e-6, "MB");
+	bool success = true;
+	state.measure([&]() {
+		FILE* fp = fopen(get_benchmark_file_name().c_str(), "rb");
+		success = success && fp && fread(data.data(), 1, data.size(), fp) == data.size();
+		if (fp)
+			fclose(fp);
+	});
+	return success;
+}
+
+/// read file with file::read into a newly allocated buffer
+bool benchmark_file_read(benchmark_state& state)
+{
+	state.set_work(benchmark_file_size * 1e-6, "MB");
+	bool success = true;
+	state.measure([&]() {
+		size_t size;
+		char* data = file::read(get_benchmark_file_name(), false, &size);
+		success = success && data && size == benchmark_file_size;
+		delete[] data;
+	});
+	return success;
+}
+
+/// read file with mapped_file into the target array as done by the binary loaders
+bool benchmark_mapped_file(benchmark_state& state)
+{
+	std::vector<char> data(benchmark_file_size);
+	state.set_work(benchmark_file_size * 1e-6, "MB");
+	bool success = true;
+	state.measure([&]() {
+		mapped_file mf(get_benchmark_file_name());
+		mf.advise(mapped_file::SEQUENTIAL);
+		success = success && mf.read_array(data.data(), data.size());
+	});
+	return success;
+}
+
+/// process file chunk wise while the next chunks are read in the background
+bool benchmark_chunked_file_reader(benchmark_state& state)
+{
+	state.set_work(benchmark_file_size * 1e-6, "MB");
+	size_t nr_bytes = 0;
+	state.measure([&]() {
+		chunked_file_reader reader;
+		reader.open(get_benchmark_file_name());
+		const char* data;
+		size_t size;
+		while (reader.next_chunk(data, size))
+			nr_bytes += size;
+	});
+	return nr_bytes % benchmark_file_size == 0;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_mapped_file_reg("cgv::utils::mapped_file", test_mapped_file);
+extern CGV_API benchmark_registration benchmark_fread_reg("file reading with fread", benchmark_fread);
+extern CGV_API benchmark_registration benchmark_file_read_reg("file reading with file::read", benchmark_file_read);
+extern CGV_API benchmark_registration benchmark_mapped_file_reg("file reading with mapped_file", benchmark_mapped_file);
+extern CGV_API benchmark_registration benchmark_chunked_file_reader_reg("file reading with chunked_file_reader", benchmark_chunked_file_reader);
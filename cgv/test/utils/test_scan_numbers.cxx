@@ -0,0 +1,188 @@
+#include <cgv/base/register.h>
+#include <cgv/utils/scan.h>
+#include <cgv/utils/advanced_scan.h>
+#include <cgv/utils/tokenizer.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace cgv::base;
+using namespace cgv::utils;
+
+/// check that parse_double and parse_float agree with the exactly rounding standard library functions
+bool check_parse_exactness(const std::string& s)
+{
+	double d;
+	float f;
+	const char* end = s.c_str() + s.size();
+	if (parse_double(s.c_str(), end, d) != end || parse_float(s.c_str(), end, f) != end)
+		return false;
+	double d_ref = strtod(s.c_str(), 0);
+	float f_ref = strtof(s.c_str(), 0);
+	return memcmp(&d, &d_ref, sizeof(double)) == 0 && memcmp(&f, &f_ref, sizeof(float)) == 0;
+}
+
+bool test_scan_numbers()
+{
+	// single values
+	const char* cases[] = {
+		"0", "-0", "+1", "1.5", "-3.25e2", ".5", "5.", "1e-5", "123456789012345678901234567890", "0.000000000000000000000123456",
+		"1.7976931348623157e308", "4.9e-324", "2.2250738585072014e-308", "3.4028235e38", "1.17549435e-38", "1e-45",
+		"9007199254740993", "0.1", "0.30000000000000004", "16777217", "33554435", "1.00000005960464477539062", "123.45678"
+	};
+	for (const char* c : cases)
+		TEST_ASSERT(check_parse_exactness(c))
+
+	std::mt19937_64 rng(7);
+	char buffer[64];
+	for (unsigned i = 0; i < 100000; ++i) {
+		std::uniform_real_distribution<double> exponent(-40, 40);
+		double value = (rng() & 1 ? -1 : 1) * double(rng() % 100000000) * pow(10.0, exponent(rng));
+		snprintf(buffer, sizeof(buffer), i % 2 ? "%.9g" : "%.17g", value);
+		TEST_ASSERT(check_parse_exactness(buffer))
+		snprintf(buffer, sizeof(buffer), "%.*f", int(rng() % 10), double(rng() % 10000000) / 1000.0);
+		TEST_ASSERT(check_parse_exactness(buffer))
+	}
+
+	// end of number and failures
+	std::string s = "12.5e3x";
+	double d = 0;
+	TEST_ASSERT(parse_double(s.c_str(), s.c_str() + s.size(), d) == s.c_str() + 6)
+	TEST_ASSERT_EQ(d, 12500.0)
+	s = "2e+";
+	TEST_ASSERT(parse_double(s.c_str(), s.c_str() + s.size(), d) == s.c_str() + 1)
+	TEST_ASSERT_EQ(d, 2.0)
+	s = "-.e5";
+	TEST_ASSERT(parse_double(s.c_str(), s.c_str() + s.size(), d) == 0)
+	s = "inf";
+	TEST_ASSERT(parse_double(s.c_str(), s.c_str() + s.size(), d) == s.c_str() + 3)
+	TEST_ASSERT(d > 1e308)
+	s = "+-5";
+	TEST_ASSERT(parse_double(s.c_str(), s.c_str() + s.size(), d) == 0)
+	float f = 0;
+	TEST_ASSERT(parse_float(s.c_str(), s.c_str() + s.size(), f) == 0)
+	s = "1e999";
+	TEST_ASSERT(parse_double(s.c_str(), s.c_str() + s.size(), d) == s.c_str() + s.size())
+	TEST_ASSERT(d > 1e308)
+	int i = 0;
+	s = "-2147483648 2147483648";
+	TEST_ASSERT(parse_int(s.c_str(), s.c_str() + s.size(), i) == s.c_str() + 11)
+	TEST_ASSERT_EQ(i, -2147483647 - 1)
+	TEST_ASSERT(parse_int(s.c_str() + 12, s.c_str() + s.size(), i) == 0)
+
+	// bulk parsing stops at text and at the given count
+	s = " 1 2.5\t-3e1\r\n4 five 6";
+	float values[8];
+	const char* new_end;
+	TEST_ASSERT_EQ(parse_floats(s.c_str(), s.c_str() + s.size(), values, 8, &new_end), 4u)
+	TEST_ASSERT(values[0] == 1.0f && values[1] == 2.5f && values[2] == -30.0f && values[3] == 4.0f)
+	TEST_ASSERT(new_end == s.c_str() + s.find("five"))
+	TEST_ASSERT_EQ(parse_floats(s.c_str(), s.c_str() + s.size(), values, 2, &new_end), 2u)
+	TEST_ASSERT(new_end == s.c_str() + s.find("-3e1"))
+	int ints[3];
+	s = "10 -20 30";
+	TEST_ASSERT_EQ(parse_ints(s.c_str(), s.c_str() + s.size(), ints, 3), 3u)
+	TEST_ASSERT(ints[0] == 10 && ints[1] == -20 && ints[2] == 30)
+
+	// is_double keeps its behavior
+	TEST_ASSERT(is_double("1.25", d) && d == 1.25)
+	TEST_ASSERT(!is_double("1.25x", d))
+	TEST_ASSERT(!is_double("abc", d))
+	TEST_ASSERT(!is_double("+-5", d))
+	TEST_ASSERT(!is_double("1e999", d))
+	TEST_ASSERT(!is_double("-1e-999", d))
+	return true;
+}
+
+/// number of lines of the generated point cloud text
+const unsigned nr_scan_lines = 200000;
+
+/// generate the content of a point cloud text file with lines of the form x y z r g b I as read by point_cloud::read_xyz
+std::string generate_xyz_content()
+{
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float> crd(-100.0f, 100.0f);
+	std::string content;
+	char buffer[128];
+	for (unsigned i = 0; i < nr_scan_lines; ++i) {
+		snprintf(buffer, sizeof(buffer), "%.6f %.6f %.6f %d %d %d %d\n", crd(rng), crd(rng), crd(rng),
+			int(rng() % 256), int(rng() % 256), int(rng() % 256), int(rng() % 4096));
+		content += buffer;
+	}
+	return content;
+}
+
+/// parse lines with sscanf as done by the point cloud readers before
+bool benchmark_scan_sscanf(benchmark_state& state)
+{
+	std::string content = generate_xyz_content();
+	std::vector<line> lines;
+	split_to_lines(content, lines);
+	state.set_work(content.size() * 1e-6, "MB");
+	double sum = 0;
+	state.measure([&]() {
+		for (const auto& l : lines) {
+			float x, y, z;
+			int r, g, b, I;
+			char tmp = *l.end;
+			content[l.end - content.c_str()] = 0;
+			if (sscanf(l.begin, "%f %f %f %d %d %d %d", &x, &y, &z, &r, &g, &b, &I) == 7)
+				sum += x;
+			content[l.end - content.c_str()] = tmp;
+		}
+	});
+	return sum != 0;
+}
+
+/// parse lines with the tokenizer and is_double
+bool benchmark_scan_is_double(benchmark_state& state)
+{
+	std::string content = generate_xyz_content();
+	std::vector<line> lines;
+	split_to_lines(content, lines);
+	state.set_work(content.size() * 1e-6, "MB");
+	double sum = 0;
+	state.measure([&]() {
+		std::vector<token> numbers;
+		for (const auto& l : lines) {
+			numbers.clear();
+			tokenizer(l).bite_all(numbers);
+			double values[7];
+			size_t j = 0;
+			while (j < numbers.size() && j < 7 && is_double(numbers[j].begin, numbers[j].end, values[j]))
+				++j;
+			if (j == 7)
+				sum += values[0];
+		}
+	});
+	return sum != 0;
+}
+
+/// parse lines with parse_floats as done by the point cloud readers now
+bool benchmark_scan_parse_floats(benchmark_state& state)
+{
+	std::string content = generate_xyz_content();
+	std::vector<line> lines;
+	split_to_lines(content, lines);
+	state.set_work(content.size() * 1e-6, "MB");
+	double sum = 0;
+	state.measure([&]() {
+		for (const auto& l : lines) {
+			float values[7];
+			if (parse_floats(l.begin, l.end, values, 7) == 7)
+				sum += values[0];
+		}
+	});
+	return sum != 0;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_scan_numbers_reg("cgv::utils::parse_floats", test_scan_numbers);
+extern CGV_API benchmark_registration benchmark_scan_sscanf_reg("ascii point parsing with sscanf", benchmark_scan_sscanf);
+extern CGV_API benchmark_registration benchmark_scan_is_double_reg("ascii point parsing with is_double", benchmark_scan_is_double);
+extern CGV_API benchmark_registration benchmark_scan_parse_floats_reg("ascii point parsing with parse_floats", benchmark_scan_parse_floats);
@@ -0,0 +1,140 @@
+#include <cgv/base/register.h>
+#include <cgv/utils/trace_profiler.h>
+#include <cgv/utils/stopwatch.h>
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <cmath>
+
+using namespace cgv::base;
+using namespace cgv::utils;
+
+void profiled_leaf(volatile unsigned& counter)
+{
+	CGV_PROFILE_ZONE("leaf");
+	++counter;
+}
+
+void profiled_parent(volatile unsigned& counter, unsigned nr_leafs)
+{
+	CGV_PROFILE_ZONE("parent");
+	for (unsigned i = 0; i < nr_leafs; ++i)
+		profiled_leaf(counter);
+}
+
+bool test_trace_profiler()
+{
+	volatile unsigned counter = 0;
+	trace_profiler::enable(false);
+	trace_profiler::clear();
+	profiled_parent(counter, 3);
+	std::vector<trace_profiler::zone_event> events;
+	trace_profiler::collect_events(events);
+	TEST_ASSERT(events.empty())
+
+	// nesting within one thread
+	trace_profiler::enable();
+	profiled_parent(counter, 3);
+	trace_profiler::enable(false);
+	trace_profiler::collect_events(events);
+	TEST_ASSERT_EQ(events.size(), size_t(4))
+	if (events.size() == 4) {
+		TEST_ASSERT_EQ(std::string(events[0].info->name), "parent")
+		TEST_ASSERT_EQ(events[0].depth, 0u)
+		for (size_t i = 1; i < 4; ++i) {
+			TEST_ASSERT_EQ(std::string(events[i].info->name), "leaf")
+			TEST_ASSERT_EQ(events[i].depth, 1u)
+			TEST_ASSERT(events[i].begin >= events[0].begin && events[i].end <= events[0].end)
+		}
+	}
+	std::vector<trace_profiler::zone_statistic> statistics;
+	trace_profiler::compute_statistics(statistics);
+	TEST_ASSERT_EQ(statistics.size(), size_t(2))
+	if (statistics.size() == 2) {
+		TEST_ASSERT_EQ(std::string(statistics[0].info->name), "parent")
+		TEST_ASSERT_EQ(statistics[1].nr_calls, size_t(3))
+		TEST_ASSERT(std::abs(statistics[0].self_time + statistics[1].total_time - statistics[0].total_time) < 1e-9)
+	}
+
+	// events of several threads are kept in separate buffers
+	trace_profiler::clear();
+	trace_profiler::enable();
+	std::vector<std::thread> threads;
+	for (unsigned t = 0; t < 4; ++t)
+		threads.push_back(std::thread([t]() {
+			volatile unsigned c = 0;
+			trace_profiler::set_thread_name(std::string("worker ") + std::to_string(t));
+			profiled_parent(c, 10);
+		}));
+	for (auto& t : threads)
+		t.join();
+	trace_profiler::enable(false);
+	trace_profiler::collect_events(events);
+	TEST_ASSERT_EQ(events.size(), size_t(44))
+	for (size_t i = 1; i < events.size(); ++i)
+		TEST_ASSERT(events[i - 1].thread_index < events[i].thread_index ||
+			(events[i - 1].thread_index == events[i].thread_index && events[i - 1].begin <= events[i].begin))
+
+	// export contains complete events and thread names
+	std::stringstream ss;
+	trace_profiler::write_chrome_trace(ss);
+	std::string trace = ss.str();
+	TEST_ASSERT(trace.find("\"traceEvents\"") != std::string::npos)
+	TEST_ASSERT(trace.find("\"name\":\"worker 2\"") != std::string::npos)
+	size_t nr_complete_events = 0;
+	for (size_t pos = 0; (pos = trace.find("\"ph\":\"X\"", pos)) != std::string::npos; ++pos)
+		++nr_complete_events;
+	TEST_ASSERT_EQ(nr_complete_events, size_t(44))
+
+	// ring buffers overwrite the oldest events
+	trace_profiler::set_buffer_capacity(16);
+	trace_profiler::clear();
+	trace_profiler::enable();
+	std::thread([]() {
+		volatile unsigned c = 0;
+		profiled_parent(c, 20);
+	}).join();
+	trace_profiler::enable(false);
+	trace_profiler::collect_events(events);
+	TEST_ASSERT_EQ(events.size(), size_t(16))
+	TEST_ASSERT_EQ(trace_profiler::get_nr_lost_events(), size_t(5))
+	trace_profiler::set_buffer_capacity(65536);
+	trace_profiler::clear();
+	return true;
+}
+
+/// report the cost of a zone with disabled and enabled recording
+bool test_trace_profiler_overhead()
+{
+	const unsigned n = 1000000;
+	volatile unsigned counter = 0;
+	double t_plain = 0, t_disabled = 0, t_enabled = 0;
+	{
+		cgv::utils::stopwatch s(&t_plain, false);
+		for (unsigned i = 0; i < n; ++i)
+			++counter;
+	}
+	trace_profiler::enable(false);
+	{
+		cgv::utils::stopwatch s(&t_disabled, false);
+		for (unsigned i = 0; i < n; ++i)
+			profiled_leaf(counter);
+	}
+	trace_profiler::clear();
+	trace_profiler::enable();
+	{
+		cgv::utils::stopwatch s(&t_enabled, false);
+		for (unsigned i = 0; i < n; ++i)
+			profiled_leaf(counter);
+	}
+	trace_profiler::enable(false);
+	trace_profiler::clear();
+	std::cout << "\n  zone cost: disabled " << 1e9 * (t_disabled - t_plain) / n << " ns, enabled " << 1e9 * (t_enabled - t_plain) / n << " ns" << std::endl;
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_trace_profiler_reg("cgv::utils::trace_profiler", test_trace_profiler);
+extern CGV_API test_registration test_trace_profiler_overhead_reg("cgv::utils::trace_profiler overhead", test_trace_profiler_overhead);
@@ -154,6 +154,13 @@ public:
 			rh.reflect_member("custom_quad", custom_quad);
 	}
 
+	// Part of the cgv::base::base interface, allows config file processing to look up
+	// the reflected members in a per type cache as all of them are members of this class
+	bool use_reflection_cache() const
+	{
+		return true;
+	}
+
 	// Part of the cgv::base::base interface, should be implemented to respond to write
 	// access to reflected data members of this class, e.g. from config file processing
 	// or gui interaction.
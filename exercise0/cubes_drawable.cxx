@@ -105,6 +105,13 @@ public:
             rh.reflect_member("render_mode", *render_mode_uint);
     }
 
+    // All reflected properties are members of this class, so they can be looked up in
+    // the per type reflection cache
+    bool use_reflection_cache() const
+    {
+        return true;
+    }
+
     // Handle property changes
     void on_set(void* member_ptr)
     {
@@ -32,6 +32,8 @@ public:
 	gl_implicit_surface_drawable();
 	void on_set(void* member_ptr);
 	bool self_reflect(cgv::reflect::reflection_handler& rh);
+	/// all reflected members belong to the drawable, such that the reflection cache can be used
+	bool use_reflection_cache() const { return true; }
 	std::string get_type_name() const;
 	void create_gui();
 };
@@ -16,6 +16,8 @@ public:
 	void on_set(void* member_ptr);
 	/// reflect members to expose them to serialization
 	bool self_reflect(cgv::reflect::reflection_handler& rh);
+	/// use the reflection cache as the colors are members of the instance. Derived classes that reflect temporaries or dynamically allocated members need to return false.
+	bool use_reflection_cache() const { return true; }
 	/// returns "implicit_primitive"
 	std::string get_type_name() const;
 	/// create gui of children. Call this inside implementations of create_gui of derived classes.
@@ -41,6 +41,8 @@ public:
 	std::string get_type_name() const { return "knot_vector"; }
 	/// reflect members to expose them to serialization
 	bool self_reflect(cgv::reflect::reflection_handler& rh);
+	/// the reflection cache cannot be used as the number of points and the point coordinates are not stored at fixed offsets
+	bool use_reflection_cache() const { return false; }
 	/// implementation of updates needed after members changed
 	void on_set(void* member_ptr);
 	/// create gui to edit the points in the knot vector and to allow appending a new point